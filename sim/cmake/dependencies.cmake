@@ -41,9 +41,21 @@ FetchContent_Declare(
 )
 FetchContent_MakeAvailable(googletest)
 
+# Google benchmark
+# disable benchmark's own tests, which would fetch another googletest
+set(BENCHMARK_ENABLE_TESTING OFF)
+set(BENCHMARK_ENABLE_GTEST_TESTS OFF)
+FetchContent_Declare(
+  benchmark
+  GIT_REPOSITORY https://github.com/google/benchmark.git
+  GIT_TAG        v1.5.2
+  GIT_PROGRESS   TRUE
+)
+FetchContent_MakeAvailable(benchmark)
+
 # phony/target that does pulls & builds in dependencies
 set(TARGET_DEPS "deps")
 add_custom_target(
     ${TARGET_DEPS}
-    DEPENDS libprotobuf grpc++ grpc++_reflection gtest_main
+    DEPENDS libprotobuf grpc++ grpc++_reflection gtest_main benchmark_main
 )
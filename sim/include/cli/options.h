@@ -0,0 +1,33 @@
+#ifndef BENTOBOX_OPTIONS_H
+#define BENTOBOX_OPTIONS_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace cli {
+
+// Command line options given as --name value
+class Options {
+   private:
+    std::map<std::string, std::string> values;
+
+   public:
+    // Parses the arguments from argv[start] onwards
+    Options(int argc, char* argv[], int start);
+
+    // Removes and returns the option's value, or the default if it was not
+    // given. Options left over at the end were not recognised.
+    std::string take(const std::string& name, const std::string& defaultValue);
+    uint32_t take(const std::string& name, uint32_t defaultValue);
+    uint64_t take(const std::string& name, uint64_t defaultValue);
+    float take(const std::string& name, float defaultValue);
+    double take(const std::string& name, double defaultValue);
+
+    // Throws if any option has not been taken
+    void checkAllTaken() const;
+};
+
+}  // namespace cli
+
+#endif  // BENTOBOX_OPTIONS_H
@@ -0,0 +1,55 @@
+#ifndef BENTOBOX_COMMANDBUFFER_H
+#define BENTOBOX_COMMANDBUFFER_H
+
+#include <core/ics/component.h>
+#include <core/ics/componentStore.h>
+#include <index/entityIndex.h>
+#include <index/indexStore.h>
+
+#include <vector>
+
+namespace ics {
+// Records structural changes to a simulation's entities, i.e. spawning and
+// despawning entities, so that they are applied together at a sync point.
+// Graphs are evaluated against a fixed set of entities and components, so any
+// structural change made while a step is running is deferred until the step
+// ends. This keeps iteration over the stores valid during the step.
+class CommandBuffer {
+   private:
+    struct Spawn {
+        index::EntityIndex::EntityId entityId;
+        std::vector<CompGroup> groups;
+    };
+
+    std::vector<Spawn> spawns;
+    std::vector<index::EntityIndex::EntityId> despawns;
+
+   public:
+    // Reserves an ID for a new entity with components of the given types.
+    // The entity's components are only created when the buffer is flushed.
+    // Throws std::out_of_range if a type is unknown, and
+    // std::invalid_argument if a type is given twice in archetype storage.
+    index::EntityIndex::EntityId spawn(index::IndexStore& indexStore,
+                                       std::vector<CompGroup> groups);
+    // Same as above, but reserves the given ID. Throws std::invalid_argument
+    // if the ID is already in use.
+    index::EntityIndex::EntityId spawn(index::IndexStore& indexStore,
+                                       std::vector<CompGroup> groups,
+                                       index::EntityIndex::EntityId entityId);
+
+    // Records that the entity should be removed. Throws std::out_of_range if
+    // there is no such entity.
+    void despawn(const index::IndexStore& indexStore,
+                 index::EntityIndex::EntityId entityId);
+
+    bool empty() const;
+
+    // Applies the recorded changes to the stores and clears the buffer. The
+    // buffer is cleared even if applying the changes fails.
+    // Spawns are applied before despawns, so an entity can be despawned in
+    // the same step that it is spawned in.
+    void flush(index::IndexStore& indexStore, ComponentStore& compStore);
+};
+}  // namespace ics
+
+#endif  // BENTOBOX_COMMANDBUFFER_H
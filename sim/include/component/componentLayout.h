@@ -0,0 +1,44 @@
+#ifndef BENTOBOX_COMPONENTLAYOUT_H
+#define BENTOBOX_COMPONENTLAYOUT_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "bento/protos/ecs.pb.h"
+#include "bento/protos/types.pb.h"
+
+namespace ics::component {
+// Dense ID of an attribute within its component type
+typedef uint32_t AttrId;
+
+// Interns the attribute names of a component type into AttrIds. AttrIds are
+// assigned in the sorted order of the attribute names, starting from 0, so
+// that attribute values can be stored in arrays indexed by AttrId. A layout
+// is created once per component type and shared by all its components.
+class ComponentLayout {
+   private:
+    bento::protos::ComponentDef compDef;
+    // Maps AttrId -> attribute name and schema type
+    std::vector<std::string> attrNames;
+    std::vector<bento::protos::Type> attrTypes;
+    std::unordered_map<std::string, AttrId> attrIds;
+
+   public:
+    explicit ComponentLayout(bento::protos::ComponentDef compDef);
+
+    const bento::protos::ComponentDef& getCompDef() const { return compDef; }
+    size_t size() const { return attrNames.size(); }
+
+    bool hasAttr(const std::string& attrName) const;
+    // Throws std::out_of_range if the component has no such attribute
+    AttrId getAttrId(const std::string& attrName) const;
+    const std::string& getAttrName(AttrId attrId) const;
+    const bento::protos::Type& getAttrType(AttrId attrId) const;
+
+    // Returns the heap memory held by the layout, including its ComponentDef
+    size_t getMemoryUsage() const;
+};
+}  // namespace ics::component
+
+#endif  // BENTOBOX_COMPONENTLAYOUT_H
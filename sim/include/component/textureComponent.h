@@ -27,6 +27,9 @@ bento::protos::ComponentDef createCompDef() {
 
 namespace ics::component {
 struct Texture2DComponent : public UserComponent {
+    // AttrId of the texture attribute
+    static constexpr AttrId TEXTURE = 0;
+
     Texture2DComponent()
         : UserComponent(TEXTURE2D_COMPONENT_NAME, createCompDef()) {}
 };
@@ -1,36 +1,64 @@
 #ifndef BENTOBOX_USERCOMPONENT_H
 #define BENTOBOX_USERCOMPONENT_H
 
+#include <memory>
 #include <string>
-#include <unordered_map>
+#include <vector>
 #include <core/ics/component.h>
 #include "bento/protos/types.pb.h"
 #include "bento/protos/values.pb.h"
 #include "bento/protos/ecs.pb.h"
+#include "componentLayout.h"
 
 namespace ics::component {
 
 class UserComponent : public ics::BaseComponent {
    private:
-    // Stores a map from attribute name to value.
-    std::unordered_map<std::string, bento::protos::Value> values;
+    // Shared by all components of the same type
+    std::shared_ptr<const ComponentLayout> layout;
+    // Stores the value of each attribute, indexed by AttrId.
+    std::vector<bento::protos::Value> values;
 
    public:
     // Since we can't programmatically make new types, the component types are
     // differentiated by this type name.
     std::string typeName;
 
-    // Stores the component definition
-    bento::protos::ComponentDef compDef;
-
     UserComponent(std::string typeName, bento::protos::ComponentDef compDef)
-        : typeName(std::move(typeName)), compDef(std::move(compDef)) {}
+        : UserComponent(std::move(typeName),
+                        std::make_shared<const ComponentLayout>(
+                            std::move(compDef))) {}
+    UserComponent(std::string typeName,
+                  std::shared_ptr<const ComponentLayout> layout)
+        : layout(std::move(layout)), typeName(std::move(typeName)) {
+        values.resize(this->layout->size());
+    }
+
+    const std::shared_ptr<const ComponentLayout>& getLayout() const {
+        return layout;
+    }
+    const bento::protos::ComponentDef& getCompDef() const {
+        return layout->getCompDef();
+    }
+
+    const bento::protos::Value& getValue(AttrId attrId);
+    bento::protos::Value& getMutableValue(AttrId attrId);
+    void setValue(AttrId attrId, const bento::protos::Value& value);
+
+    // Returns the values of the attributes, indexed by AttrId. Attributes
+    // which have not been set hold an empty value.
+    const std::vector<bento::protos::Value>& getValues() const;
 
-    const bento::protos::Value& getValue(const std::string& attrName);
-    bento::protos::Value& getMutableValue(const std::string& attrName);
+    // Returns the heap memory held by the attribute values and the type name.
+    // The layout is shared, so it is not counted.
+    size_t getMemoryUsage() const;
 
-    void setValue(const std::string& attrName,
-                  const bento::protos::Value& value);
+    // Assigns value to valToSet, which holds the given attribute of a
+    // component with the given layout. The value is converted to the
+    // attribute's type if needed. Throws if value does not fit the schema.
+    static void assignValue(const ComponentLayout& layout, AttrId attrId,
+                            bento::protos::Value& valToSet,
+                            const bento::protos::Value& value);
 };
 }  // namespace ics::component
 
@@ -0,0 +1,72 @@
+#ifndef BENTOBOX_SIMGENERATOR_H
+#define BENTOBOX_SIMGENERATOR_H
+
+#include <bento/protos/graph.pb.h>
+#include <bento/protos/sim.pb.h>
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+// Generates synthetic simulations to measure the engine with. The generated
+// simulations only depend on their config, including the seed, so the same
+// config always produces the same SimulationDef.
+namespace generator {
+
+// Relative weights of the ops chosen for the inner nodes of op trees
+typedef std::map<bento::protos::Node::OpCase, double> OpWeights;
+
+// Returns equal weights for the math ops that keep finite inputs finite,
+// apart from division by zero
+OpWeights defaultOpWeights();
+
+// Config shared by all the generated simulations
+struct WorldConfig {
+    std::string name = "generated";
+    uint32_t entityCount = 100;
+    // Seeds the generator's choices, and is used as the seed of the
+    // simulation's Random nodes
+    uint64_t seed = 1;
+    bento::protos::SimulationDef::Storage storage =
+        bento::protos::SimulationDef::COMPONENT;
+};
+
+// Bodies with a Position, Velocity and Mass which attract each other. Each
+// body is attracted by a fixed number of randomly chosen bodies, as the graph
+// has no way to loop over all of them.
+struct NBodyConfig : WorldConfig {
+    uint32_t interactions = 8;
+    float timeStep = 0.01f;
+};
+bento::protos::SimulationDef generateNBody(const NBodyConfig& config);
+
+// Boids with a Position and Velocity that steer towards the centre and
+// heading of a fixed number of randomly chosen neighbours, and away from
+// neighbours that are too close. Their speed is clamped with Max/Min nodes.
+struct FlockingConfig : WorldConfig {
+    uint32_t neighbours = 8;
+    float cohesion = 0.01f;
+    float alignment = 0.05f;
+    float separation = 0.5f;
+    float maxSpeed = 2.0f;
+};
+bento::protos::SimulationDef generateFlocking(const FlockingConfig& config);
+
+// Entities with a random mix of component types, whose attributes are set by
+// random trees of ops. Each system sets one attribute of every entity to a
+// tree of the given depth, whose leaves are constants or attributes of the
+// same entity.
+struct OpTreeConfig : WorldConfig {
+    uint32_t componentTypes = 4;
+    uint32_t attributesPerComponent = 4;
+    uint32_t componentsPerEntity = 2;
+    uint32_t systems = 1;
+    uint32_t depth = 4;
+    // Ops which produce booleans or only accept integers cannot be chosen
+    OpWeights opWeights = defaultOpWeights();
+};
+bento::protos::SimulationDef generateOpTree(const OpTreeConfig& config);
+
+}  // namespace generator
+
+#endif  // BENTOBOX_SIMGENERATOR_H
@@ -8,6 +8,9 @@
 #include <index/indexStore.h>
 #include <core/ics/util/composable.h>
 
+#include <span>
+#include <vector>
+
 namespace ics {
 template <class C>
 requires std::is_base_of_v<component::UserComponent, C> CompStoreId
@@ -17,16 +20,100 @@ addComponent(index::IndexStore& indexStore, ComponentStore& compStore,
 
     // Update the ComponentType index
     auto compIndex = compTypeIndex.addComponentType(c.typeName);
+    indexStore.attribute.addLayout(compIndex, c.getLayout());
     // Add the component to the component store
     auto compId = addComponent(compStore, c, compIndex);
 
     return compId;
 }
 
+// Adds the component to the store and assigns it to the entity. The entity
+// and signature indexes are updated together so that cached signature queries
+// stay consistent with the store.
+// When archetype storage is used, the component is stored in its entity's
+// archetype table instead, and is identified by (CompGroup, EntityId).
+template <class C>
+requires std::is_base_of_v<component::UserComponent, C> CompStoreId
+addComponent(index::IndexStore& indexStore, ComponentStore& compStore,
+             index::EntityIndex::EntityId entityId, const C& c) {
+    if (indexStore.useArchetypes) {
+        auto compIndex = indexStore.componentType.addComponentType(c.typeName);
+        indexStore.attribute.addLayout(compIndex, c.getLayout());
+        indexStore.archetype.addComponent(entityId, compIndex, c);
+        indexStore.signature.addComponent(entityId, compIndex);
+        indexStore.version.addComponent(entityId, compIndex,
+                                        c.getLayout()->size());
+
+        return CompStoreId(compIndex, entityId);
+    }
+
+    auto compStoreId = addComponent(indexStore, compStore, c);
+    indexStore.entity.addComponent(entityId, compStoreId);
+    indexStore.signature.addComponent(entityId, compStoreId.first);
+    indexStore.version.addComponent(entityId, compStoreId.first,
+                                    c.getLayout()->size());
+
+    return compStoreId;
+}
+
+// Adds a component of each of the given types to each of the entities. The
+// attributes of the new components are unset. This is much faster than
+// adding the components one at a time when creating many entities, as the
+// storage is reserved up front and filled one component type at a time.
+// With archetype storage, the entities must not have any components yet.
+void addEntities(index::IndexStore& indexStore, ComponentStore& compStore,
+                 std::span<const index::EntityIndex::EntityId> entityIds,
+                 const std::vector<CompGroup>& groups);
+
+// Removes the entity's component from the store and from the indexes
+void removeComponent(index::IndexStore& indexStore, ComponentStore& compStore,
+                     index::EntityIndex::EntityId entityId,
+                     const CompStoreId& compStoreId);
+
+// Removes the entity together with all of its components
+void removeEntity(index::IndexStore& indexStore, ComponentStore& compStore,
+                  index::EntityIndex::EntityId entityId);
+
+// Returns the entities which have components of all the given types.
+// Results are cached per set of types and kept up to date incrementally.
+const std::vector<index::EntityIndex::EntityId>& queryEntities(
+    index::IndexStore& indexStore, const std::vector<CompGroup>& groups);
+
 component::UserComponent& getComponent(index::IndexStore& indexStore,
                                        ComponentStore& compStore,
-                                       const std::string& typeName,
+                                       CompGroup group,
                                        index::EntityIndex::EntityId entityId);
+
+// Returns the value of an attribute of an entity's component. Works with both
+// component and archetype storage.
+bento::protos::Value& getAttribute(
+    index::IndexStore& indexStore, ComponentStore& compStore,
+    const index::AttributeIndex::AttrRefIds& refIds);
+// Overload which resolves the names in the AttributeRef with the
+// AttributeIndex. Refs interned when the simulation was applied are resolved
+// without hashing their names.
+bento::protos::Value& getAttribute(index::IndexStore& indexStore,
+                                   ComponentStore& compStore,
+                                   const bento::protos::AttributeRef& ref);
+
+// Returns the value of an attribute of an entity's component as it is
+// stored, which is empty if the attribute has not been set, or null if the
+// entity has no component of the type. Unlike getAttribute, it does not
+// throw, so it suits reading many attributes which may not be set.
+const bento::protos::Value* findAttribute(
+    index::IndexStore& indexStore, ComponentStore& compStore,
+    const index::AttributeIndex::AttrRefIds& refIds);
+
+// Sets the value of an attribute of an entity's component. Works with both
+// component and archetype storage. The attribute's version is bumped, so
+// attributes have to be written through here for cached results to be
+// recomputed.
+void setAttribute(index::IndexStore& indexStore, ComponentStore& compStore,
+                  const index::AttributeIndex::AttrRefIds& refIds,
+                  const bento::protos::Value& value);
+void setAttribute(index::IndexStore& indexStore, ComponentStore& compStore,
+                  const bento::protos::AttributeRef& ref,
+                  const bento::protos::Value& value);
 }  // namespace ics
 
 #endif  // BENTOBOX_COMPONENTSTOREEXT_H
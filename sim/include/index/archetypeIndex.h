@@ -0,0 +1,115 @@
+#ifndef BENTOBOX_ARCHETYPEINDEX_H
+#define BENTOBOX_ARCHETYPEINDEX_H
+
+#include <component/userComponent.h>
+#include <core/ics/componentSet.h>
+#include <index/entityIndex.h>
+#include <index/signatureIndex.h>
+
+#include <map>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace ics::index {
+// Stores entities grouped by archetype. An archetype is the set of component
+// types (CompGroups) that an entity has. All entities of an archetype are
+// stored in a single table, with one column per attribute of each component
+// type. The row of an entity is the same in every column of its table, so a
+// system reading several attributes of many entities scans contiguous arrays.
+// Entities in archetype storage have at most one component of each type.
+class ArchetypeIndex {
+   public:
+    typedef SignatureIndex::Signature Signature;
+    typedef std::vector<bento::protos::Value> Column;
+    typedef std::unordered_map<
+        CompGroup, std::shared_ptr<const component::ComponentLayout>>
+        Layouts;
+
+    struct Archetype {
+        Signature signature;
+        // The entity stored in each row of the table
+        std::vector<EntityIndex::EntityId> entities;
+        // Layout of each component type in the archetype
+        Layouts layouts;
+        // Columns of the table, keyed by component type then indexed by the
+        // AttrId of the attribute
+        std::unordered_map<CompGroup, std::vector<Column>> columns;
+
+        Column& column(CompGroup group, component::AttrId attrId);
+        const Column& column(CompGroup group, component::AttrId attrId) const;
+
+        // Returns the heap memory held by the table, including the attribute
+        // values stored in it
+        size_t getMemoryUsage() const;
+    };
+
+   private:
+    // Tables keyed by signature. std::map keeps pointers to the archetypes
+    // valid as new archetypes are added.
+    std::map<Signature, Archetype> archetypes;
+
+    struct Row {
+        Archetype* archetype;
+        size_t index;
+    };
+    std::unordered_map<EntityIndex::EntityId, Row> entityRows;
+
+    Archetype& getArchetype(const Signature& signature);
+    // Appends an empty row for the entity to the archetype's table
+    size_t appendRow(Archetype& archetype, EntityIndex::EntityId entityId);
+    // Moves the entity's row from its current table into the given archetype,
+    // keeping the values of the component types that both tables share
+    void moveEntity(EntityIndex::EntityId entityId, Archetype& archetype);
+    // Removes the row from the table by moving the last row into its place
+    void swapRemoveRow(Archetype& archetype, size_t index);
+
+   public:
+    void addComponent(EntityIndex::EntityId entityId, CompGroup group,
+                      const component::UserComponent& component);
+
+    void removeComponent(EntityIndex::EntityId entityId, CompGroup group);
+
+    // Adds a component of each type in layouts to each of the entities. The
+    // entities must not have any components yet, and the attributes of the
+    // new components are unset. The entities share a table, so its columns
+    // are only grown once instead of once per entity.
+    void addEntities(std::span<const EntityIndex::EntityId> entityIds,
+                     const Layouts& layouts);
+
+    bool hasComponent(EntityIndex::EntityId entityId, CompGroup group) const;
+
+    // Returns the component types of the entity's components
+    Signature getSignature(EntityIndex::EntityId entityId) const;
+
+    // Removes the entity's row, and with it all of its components
+    void removeEntity(EntityIndex::EntityId entityId);
+
+    // Returns the value of the entity's attribute. Throws if the attribute
+    // has not been set.
+    bento::protos::Value& getValue(EntityIndex::EntityId entityId,
+                                   CompGroup group, component::AttrId attrId);
+    // Returns the value of the entity's attribute as it is stored, which is
+    // empty if the attribute has not been set
+    const bento::protos::Value& getStoredValue(EntityIndex::EntityId entityId,
+                                               CompGroup group,
+                                               component::AttrId attrId) const;
+
+    // Sets the value of the entity's attribute, converting it to the type in
+    // the attribute's schema if needed
+    void setValue(EntityIndex::EntityId entityId, CompGroup group,
+                  component::AttrId attrId, const bento::protos::Value& value);
+
+    // Returns the tables of the archetypes that have all the component types
+    // in the signature
+    std::vector<const Archetype*> query(Signature signature) const;
+
+    // Returns the number of components stored in the tables
+    size_t getComponentCount() const;
+
+    size_t getMemoryUsage() const;
+};
+}  // namespace ics::index
+
+#endif  // BENTOBOX_ARCHETYPEINDEX_H
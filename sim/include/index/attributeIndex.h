@@ -0,0 +1,85 @@
+#ifndef BENTOBOX_ATTRIBUTEINDEX_H
+#define BENTOBOX_ATTRIBUTEINDEX_H
+
+#include <bento/protos/graph.pb.h>
+#include <bento/protos/references.pb.h>
+#include <component/componentLayout.h>
+#include <core/ics/componentSet.h>
+#include <index/componentTypeIndex.h>
+#include <index/entityIndex.h>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace ics::index {
+// Interns the names used to refer to attributes. Component type names are
+// interned into CompGroups by the ComponentTypeIndex, and attribute names are
+// interned into AttrIds by the ComponentLayout of each CompGroup, which this
+// index holds. AttributeRefs in a simulation's graphs are resolved into IDs
+// once, when the simulation is applied, so that evaluating the graphs does
+// not need to hash any names. The component type names of the graphs' Spawn
+// nodes are resolved into CompGroups at the same time.
+class AttributeIndex {
+   public:
+    // An AttributeRef with its names resolved into IDs
+    struct AttrRefIds {
+        CompGroup group;
+        EntityIndex::EntityId entityId;
+        component::AttrId attrId;
+    };
+
+   private:
+    // Layout of each component type, indexed by CompGroup
+    std::vector<std::shared_ptr<const component::ComponentLayout>> layouts;
+    // Resolved IDs of the AttributeRefs in the interned graphs. The refs are
+    // identified by address, so the interned graphs must outlive this index
+    // and must not be modified.
+    std::unordered_map<const bento::protos::AttributeRef*, AttrRefIds>
+        internedRefs;
+    // Resolved component types of the Spawn nodes in the interned graphs,
+    // identified by address like the refs
+    std::unordered_map<const bento::protos::Node_Spawn*,
+                       std::vector<CompGroup>>
+        internedSpawns;
+
+    bool canResolve(const ComponentTypeIndex& compTypeIndex,
+                    const bento::protos::AttributeRef& ref) const;
+    void internMessage(const ComponentTypeIndex& compTypeIndex,
+                       const google::protobuf::Message& message);
+
+   public:
+    // Sets the layout of the component type if it has not been set
+    void addLayout(CompGroup group,
+                   std::shared_ptr<const component::ComponentLayout> layout);
+    bool hasLayout(CompGroup group) const;
+    const component::ComponentLayout& getLayout(CompGroup group) const;
+    // Returns the layout of the component type, for creating components
+    // which share it
+    std::shared_ptr<const component::ComponentLayout> getSharedLayout(
+        CompGroup group) const;
+
+    // Resolves and remembers the IDs of all AttributeRefs and Spawn nodes in
+    // the graph. Those which do not refer to a known component type or
+    // attribute are skipped, and will fail when they are resolved.
+    void internGraph(const ComponentTypeIndex& compTypeIndex,
+                     const bento::protos::Graph& graph);
+
+    // Returns the IDs of the AttributeRef. Interned refs are looked up by
+    // address, other refs are resolved by name.
+    AttrRefIds resolve(const ComponentTypeIndex& compTypeIndex,
+                       const bento::protos::AttributeRef& ref) const;
+    // Returns the component types of the entities that the Spawn node
+    // creates. Interned nodes are looked up by address, other nodes are
+    // resolved by name.
+    std::vector<CompGroup> resolveSpawn(
+        const ComponentTypeIndex& compTypeIndex,
+        const bento::protos::Node_Spawn& spawn) const;
+
+    // Returns the heap memory held by the index. The layouts are shared with
+    // the components, so only the pointers to them are counted.
+    size_t getMemoryUsage() const;
+};
+}  // namespace ics::index
+
+#endif  // BENTOBOX_ATTRIBUTEINDEX_H
@@ -3,7 +3,10 @@
 
 #include <core/ics/component.h>
 #include <core/ics/componentSet.h>
+#include <core/ics/componentStore.h>
+#include <core/ics/sortedCompSet.h>
 
+#include <ranges>
 #include <string>
 #include <functional>
 #include <unordered_map>
@@ -15,31 +18,44 @@ class ComponentTypeIndex {
     CompGroup compGroup = 0;
 
    public:
+    // Creates a filter which keeps only the CompStoreIds of the given type's
+    // group.
+    // The filter is lazy: it takes a range of CompStoreIds and returns a view
+    // over it without copying. When given a CompSetView, the filter narrows
+    // the view down to the type's group so that other groups are never read.
+    // A SortedCompSet is narrowed down to the type's group in the same way.
     // The definition needs to be in the header file as the return type is auto
     // The return type is left as auto so that the capturing lambda is properly
     // represented. Type errors can occur at build-time when using function
     // pointer return types or std::function.
-    auto filterCompType(const std::string& name) {
-        auto compIndex = typeNameGroupMap.at(name);
-
-        return [compIndex](const ics::ComponentSet& compSet) {
-            // TODO(joeltio): find a way to make this more memory efficient
-            ics::ComponentSet newSet;
-            for (const CompStoreId& comp : compSet) {
-                if (comp.first == compIndex) {
-                    newSet.insert(comp);
-                }
+    auto filterCompGroup(CompGroup compIndex) {
+        return [compIndex]<std::ranges::viewable_range R>(R&& compSet) {
+            typedef std::remove_cvref_t<R> Set;
+            if constexpr (std::is_same_v<Set, ics::CompSetView> ||
+                          std::is_same_v<Set, ics::SortedCompSet>) {
+                return compSet.withGroup(compIndex);
+            } else {
+                return std::views::filter(
+                    std::forward<R>(compSet),
+                    [compIndex](const CompStoreId& comp) {
+                        return comp.first == compIndex;
+                    });
             }
-
-            return newSet;
         };
     }
 
-    bool hasComponentType(const std::string& name);
+    // Same as filterCompGroup, but looks up the type's group by its name
+    auto filterCompType(const std::string& name) {
+        return filterCompGroup(typeNameGroupMap.at(name));
+    }
+
+    bool hasComponentType(const std::string& name) const;
 
     CompGroup addComponentType(const std::string& name);
 
-    CompGroup getComponentType(const std::string& name);
+    CompGroup getComponentType(const std::string& name) const;
+
+    size_t getMemoryUsage() const;
 };
 }  // namespace ics::index
 
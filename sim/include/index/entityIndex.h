@@ -1,10 +1,15 @@
 #ifndef BENTOBOX_ENTITYINDEX_H
 #define BENTOBOX_ENTITYINDEX_H
 
+#include <algorithm>
+#include <array>
+#include <memory>
 #include <ranges>
-#include <unordered_set>
+#include <span>
+#include <vector>
 #include <core/ics/componentStore.h>
-#include <core/ics/util/setIntersection.h>
+#include <core/ics/sortedCompSet.h>
+#include <core/ics/util/smallVector.h>
 
 namespace ics::index {
 
@@ -12,24 +17,88 @@ class EntityIndex {
    public:
     typedef unsigned int EntityId;
 
+    // Components of an entity. Entities usually have a handful of components,
+    // so these are stored inline in the list without a heap allocation.
+    typedef util::SmallVector<CompStoreId, 4> CompList;
+
    private:
+    // Entities are stored as a sparse set. The sparse array maps an EntityId
+    // to the entity's position in the dense arrays. It is split into pages
+    // which are only allocated once an EntityId in the page is used, so
+    // large EntityIds do not require allocating the whole range below them.
+    static constexpr size_t PAGE_SIZE = 4096;
+    static constexpr size_t NO_INDEX = -1;
+    typedef std::array<size_t, PAGE_SIZE> Page;
+
     EntityId nextEntityId = 0;
-    std::unordered_map<EntityId, std::unordered_set<CompStoreId>> entityCompMap;
+    std::vector<std::unique_ptr<Page>> sparsePages;
+    // Dense arrays: denseEntities[i] is the EntityId whose components are
+    // stored in denseComponents[i]
+    std::vector<EntityId> denseEntities;
+    std::vector<CompList> denseComponents;
+
+    size_t findIndex(EntityId entityId) const;
+    // Returns the position of the entity in the dense arrays. Throws
+    // std::out_of_range if there is no such entity.
+    size_t indexOf(EntityId entityId) const;
+    void insertEntity(EntityId entityId);
 
    public:
     // Creates a filter to find CompStoreIds with the given entityId.
-    // Returns a lambda which is the filter. The lambda has the following
-    // signature: ComponentSet -> ComponentSet
+    // Returns a lambda which is the filter. The lambda takes a range of
+    // CompStoreIds and returns a lazy view of the CompStoreIds in the range
+    // which belong to the entity. When given a CompSetView, the entity's
+    // components are probed against the view instead, as an entity usually
+    // has far fewer components than the store. A SortedCompSet is intersected
+    // with the entity's components by merging. The entity's components are
+    // copied into the view, so it stays valid when the index changes.
     // The definition needs to be in the header file for return type deduction
     auto filterEntityId(EntityId entityId) {
-        return [this, entityId](
-                   const ics::ComponentSet& compSet) -> ics::ComponentSet {
-            const auto& compStoreIds = this->entityCompMap.at(entityId);
-            return util::setIntersection(compStoreIds, compSet);
+        return [this, entityId]<std::ranges::viewable_range R>(R&& compSet) {
+            CompList compStoreIds;
+            for (const auto& compStoreId : this->getComponents(entityId)) {
+                compStoreIds.push_back(compStoreId);
+            }
+            if constexpr (std::is_same_v<std::remove_cvref_t<R>,
+                                         ics::CompSetView>) {
+                return std::move(compStoreIds) |
+                       std::views::filter(
+                           [view = ics::CompSetView(compSet)](
+                               const CompStoreId& compStoreId) {
+                               return view.contains(compStoreId);
+                           });
+            } else if constexpr (std::is_same_v<std::remove_cvref_t<R>,
+                                                ics::SortedCompSet>) {
+                return util::setIntersection(ics::SortedCompSet(compStoreIds),
+                                             compSet);
+            } else {
+                return std::views::filter(
+                    std::forward<R>(compSet),
+                    [compStoreIds](const CompStoreId& compStoreId) {
+                        return std::ranges::find(compStoreIds, compStoreId) !=
+                               compStoreIds.end();
+                    });
+            }
         };
     }
 
     EntityId addEntityId();
+    // Returns the ID that addEntityId() would give out next, which is larger
+    // than any ID in use
+    EntityId getNextEntityId() const { return nextEntityId; }
+    // Adds an entity with the given ID. Throws std::invalid_argument if the
+    // ID is already in use.
+    EntityId addEntityId(EntityId entityId);
+    // Adds the given number of entities with consecutive IDs, which are all
+    // larger than any ID in use. Returns the ID of the first entity.
+    EntityId addEntityIds(size_t count);
+
+    // Reserves space for the given number of entities
+    void reserve(size_t capacity);
+
+    // Removes the entity. Its components have to be removed from the store
+    // separately.
+    void removeEntity(EntityId entityId);
 
     // Start with certain entity IDs
     template <class T>
@@ -44,16 +113,28 @@ class EntityIndex {
                 maxId = id;
             }
 
-            entityCompMap.emplace(id, std::unordered_set<CompStoreId>());
+            if (!hasEntity(id)) {
+                insertEntity(id);
+            }
         }
         nextEntityId = maxId + 1;
     }
 
     void addComponent(EntityId entityId, const CompStoreId& compStoreId);
 
-    std::unordered_set<CompStoreId> getComponents(EntityId entityId) const;
+    bool hasEntity(EntityId entityId) const;
+
+    // Returns the EntityIds of all entities, packed contiguously
+    std::span<const EntityId> getEntityIds() const;
+
+    // Returns the entity's components without copying them. The span is
+    // invalidated when entities or components are added or removed.
+    std::span<const CompStoreId> getComponents(EntityId entityId) const;
 
     void removeComponent(EntityId entityId, const CompStoreId& compStoreId);
+
+    // Returns the heap memory held by the sparse pages and the dense arrays
+    size_t getMemoryUsage() const;
 };
 }  // namespace ics::index
 
@@ -1,13 +1,25 @@
 #ifndef BENTOBOX_INDEXSTORE_H
 #define BENTOBOX_INDEXSTORE_H
 
+#include "archetypeIndex.h"
+#include "attributeIndex.h"
 #include "componentTypeIndex.h"
 #include "entityIndex.h"
+#include "signatureIndex.h"
+#include "versionIndex.h"
 
 namespace ics::index {
 struct IndexStore {
     ComponentTypeIndex componentType;
+    AttributeIndex attribute;
     EntityIndex entity;
+    SignatureIndex signature;
+    // Holds the components of entities when archetype storage is used.
+    // Otherwise, components are held in the ComponentStore.
+    ArchetypeIndex archetype;
+    bool useArchetypes = false;
+    // Versions of the attributes written through ics::setAttribute
+    VersionIndex version;
 };
 }  // namespace ics::index
 
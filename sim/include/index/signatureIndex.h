@@ -0,0 +1,71 @@
+#ifndef BENTOBOX_SIGNATUREINDEX_H
+#define BENTOBOX_SIGNATUREINDEX_H
+
+#include <core/ics/componentSet.h>
+#include <index/entityIndex.h>
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace ics::index {
+// Caches the entities that have all the component types in a signature.
+// A signature is a set of CompGroups. The first query for a signature builds
+// its entity list, after which the list is kept up to date as components are
+// added to and removed from entities. Repeated queries for the same
+// signature therefore do not rescan the entities.
+class SignatureIndex {
+   public:
+    typedef std::vector<CompGroup> Signature;
+
+   private:
+    struct Query {
+        Signature signature;
+        std::vector<EntityIndex::EntityId> entities;
+        // Position of each matching entity in entities
+        std::unordered_map<EntityIndex::EntityId, size_t> positions;
+
+        size_t getMemoryUsage() const;
+    };
+
+    // Number of components of each CompGroup that each entity has
+    std::unordered_map<EntityIndex::EntityId,
+                       std::unordered_map<CompGroup, size_t>>
+        entityGroupCounts;
+    // Cached queries, keyed by their sorted signature. std::map is used so
+    // that pointers to the queries stay valid as queries are added.
+    std::map<Signature, Query> queries;
+    // Cached queries which each CompGroup takes part in
+    std::unordered_map<CompGroup, std::vector<Query*>> groupQueries;
+
+    bool matches(EntityIndex::EntityId entityId,
+                 const Signature& signature) const;
+
+   public:
+    // Sorts the signature and removes duplicate CompGroups so that equivalent
+    // signatures compare equal
+    static void normalize(Signature& signature);
+
+    // Returns the entities which have at least one component of every
+    // CompGroup in the signature. The order of the CompGroups in the signature
+    // does not matter. The returned list is updated in place when components
+    // are added or removed.
+    const std::vector<EntityIndex::EntityId>& query(Signature signature);
+
+    // Returns whether the signature's entity list has been cached
+    bool isCached(Signature signature) const;
+
+    void addComponent(EntityIndex::EntityId entityId, CompGroup group);
+
+    void removeComponent(EntityIndex::EntityId entityId, CompGroup group);
+
+    // Reserves space for the given number of entities
+    void reserve(size_t entityCount);
+
+    // Returns the heap memory held by the component counts and the cached
+    // queries
+    size_t getMemoryUsage() const;
+};
+}  // namespace ics::index
+
+#endif  // BENTOBOX_SIGNATUREINDEX_H
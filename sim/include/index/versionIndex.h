@@ -0,0 +1,101 @@
+#ifndef BENTOBOX_VERSIONINDEX_H
+#define BENTOBOX_VERSIONINDEX_H
+
+#include <core/ics/componentSet.h>
+#include <index/attributeIndex.h>
+#include <index/entityIndex.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace ics::index {
+// Tracks when each attribute was last written, so that results computed from
+// attributes can be reused for as long as the attributes stay the same.
+// Every write stamps the attribute with the next value of a clock, so a
+// changed stamp means that the attribute has been written since.
+// Components created later in the place of removed components start without
+// a stamp, so removing components bumps the structure version instead.
+//
+// While changes are tracked, the attributes written and the components added
+// and removed are also collected until they are taken, so that the state
+// which changed can be found without comparing every attribute. The stamps
+// tell whether an attribute was already collected, so an attribute written
+// many times is collected once.
+class VersionIndex {
+   public:
+    typedef uint64_t Version;
+    // Version of attributes which have not been written since their
+    // component was created
+    static constexpr Version UNWRITTEN = 0;
+
+    struct Changes {
+        // Attributes written, or created with their component, each listed
+        // once. The components of some may have been removed since.
+        std::vector<AttributeIndex::AttrRefIds> attributes;
+        // Components removed, as the entity and the component's group
+        std::vector<std::pair<EntityIndex::EntityId, CompGroup>>
+            removedComponents;
+    };
+
+   private:
+    // Versions of the attributes of each entity's component, indexed by
+    // EntityId within the page, then by AttrId. Components whose attributes
+    // have not been written have no versions.
+    static constexpr size_t PAGE_SIZE = 1024;
+    struct Page {
+        std::array<std::vector<Version>, PAGE_SIZE> components;
+
+        size_t getMemoryUsage() const;
+    };
+
+    Version clock = UNWRITTEN;
+    Version structureVersion = 0;
+    // Pages of versions, indexed by CompGroup then by EntityId / PAGE_SIZE.
+    // Like the EntityIndex's sparse pages, a page is only allocated once an
+    // attribute of a component in it is written, so that looking up a
+    // version indexes arrays instead of hashing.
+    std::vector<std::vector<std::unique_ptr<Page>>> versions;
+
+    // Returns the versions of the entity's component, or null if its page
+    // has not been allocated
+    const std::vector<Version>* findVersions(
+        CompGroup group, EntityIndex::EntityId entityId) const;
+    std::vector<Version>& getVersions(CompGroup group,
+                                      EntityIndex::EntityId entityId);
+
+    bool trackingChanges = false;
+    // Attributes stamped after this version have already been collected
+    Version changesVersion = UNWRITTEN;
+    Changes changes;
+
+   public:
+    // Stamps the attribute as written, and returns its new version
+    Version bump(const AttributeIndex::AttrRefIds& refIds);
+    Version get(const AttributeIndex::AttrRefIds& refIds) const;
+
+    // Forgets the versions of the attributes of the entity's component, and
+    // bumps the structure version
+    void removeComponent(EntityIndex::EntityId entityId, CompGroup group);
+    Version getStructureVersion() const;
+
+    // Collects the attributes of the entity's new component as changed, if
+    // changes are tracked
+    void addComponent(EntityIndex::EntityId entityId, CompGroup group,
+                      size_t attrCount);
+
+    // Starts or stops collecting changes. Changes collected before are
+    // discarded.
+    void trackChanges(bool track);
+    bool isTrackingChanges() const { return trackingChanges; }
+    // Returns the changes collected since the changes were last taken, and
+    // starts collecting anew
+    Changes takeChanges();
+
+    size_t getMemoryUsage() const;
+};
+}  // namespace ics::index
+
+#endif  // BENTOBOX_VERSIONINDEX_H
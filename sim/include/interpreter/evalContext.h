@@ -0,0 +1,60 @@
+#ifndef BENTOBOX_EVALCONTEXT_H
+#define BENTOBOX_EVALCONTEXT_H
+
+#include <bento/protos/values.pb.h>
+#include <commandBuffer.h>
+#include <core/ics/componentStore.h>
+#include <google/protobuf/arena.h>
+#include <index/indexStore.h>
+#include <interpreter/random.h>
+#include <memory/allocationCounter.h>
+
+namespace interpreter {
+
+class OutputCache;
+class ParallelPlan;
+class Profiler;
+class ThreadPool;
+class WriteBuffer;
+
+// State shared by the nodes of a graph while it is being evaluated.
+// Values created while evaluating the nodes are temporaries, so they are
+// allocated on the arena instead of the heap. The arena is owned by the
+// caller, who frees all the temporaries at once by resetting the arena when
+// the values are no longer needed, e.g. at the end of a step.
+// Structural changes to the entities are recorded in the command buffer, and
+// are applied by the caller once evaluation is done.
+struct EvalContext {
+    ics::ComponentStore& compStore;
+    ics::index::IndexStore& indexStore;
+    google::protobuf::Arena& arena;
+    ics::CommandBuffer& commands;
+    // Source of the numbers drawn by Random nodes
+    RandomSource& random;
+    // If set, graph outputs whose inputs have not changed are skipped
+    OutputCache* outputCache = nullptr;
+    // If set, the nodes evaluated are counted and timed
+    Profiler* profiler = nullptr;
+    // If set, Mutate nodes are buffered here instead of being written, so
+    // that the whole step reads the state from before it
+    WriteBuffer* writes = nullptr;
+    // If both are set, the independent outputs of a graph are evaluated
+    // concurrently on the pool, unless the nodes are being profiled
+    ParallelPlan* parallelPlan = nullptr;
+    ThreadPool* threadPool = nullptr;
+    // Number of nodes evaluated with this context
+    uint64_t evalCount = 0;
+    // Heap allocations made on the pool's threads while evaluating outputs
+    // concurrently, which the thread using the context does not count
+    memory::AllocationCount poolAllocations{};
+
+    // Creates an empty Value which is owned by the arena
+    bento::protos::Value& createValue() {
+        return *google::protobuf::Arena::CreateMessage<bento::protos::Value>(
+            &arena);
+    }
+};
+
+}  // namespace interpreter
+
+#endif  // BENTOBOX_EVALCONTEXT_H
@@ -4,13 +4,44 @@
 #include <bento/protos/graph.pb.h>
 #include <core/ics/componentStore.h>
 #include <index/indexStore.h>
+#include <interpreter/evalContext.h>
+
+#include <vector>
 
 namespace interpreter {
 
+// What evaluating a node involves, found by walking the node and its children
+struct NodeInputs {
+    // Attributes retrieved by the nodes
+    std::vector<const bento::protos::AttributeRef*> refs;
+    size_t nodeCount = 0;
+    // False if any of the nodes draws random numbers, or spawns or despawns
+    // entities, in which case the walk stops at that node. Evaluating such
+    // a node gives a different result each time, and changes state other
+    // than the attribute being mutated.
+    bool pure = true;
+};
+// Walks the node and its children. Works on any message holding nodes.
+NodeInputs collectInputs(const google::protobuf::Message& node);
+
+// Evaluates the node. Temporaries are allocated on the context's arena, and
+// the returned value may be one of them.
+const bento::protos::Value& evaluateNode(EvalContext& ctx,
+                                         const bento::protos::Node& node);
+// Evaluates the node with temporaries allocated on a local arena, and returns
+// a copy of the result. Structural changes are applied before returning.
+// Random nodes draw from a new RandomSource with the default seed.
 bento::protos::Value evaluateNode(ics::ComponentStore& compStore,
                                   ics::index::IndexStore& indexStore,
                                   const bento::protos::Node& node);
 
+// Runs the graph's outputs, then its effects. Structural changes are left in
+// the context's command buffer. If the outputs are evaluated concurrently,
+// each wave of them sets its attributes once all of its outputs have been
+// evaluated. If an output fails, the attributes set by the outputs before it
+// are kept, like when the outputs are evaluated one at a time.
+void runGraph(EvalContext& ctx, const bento::protos::Graph& graph);
+// Runs the graph and applies its structural changes
 void runGraph(ics::ComponentStore& compStore,
               ics::index::IndexStore& indexStore,
               const bento::protos::Graph& graph);
@@ -5,107 +5,95 @@
 #include <bento/protos/values.pb.h>
 #include <core/ics/componentStore.h>
 #include <index/indexStore.h>
+#include <interpreter/evalContext.h>
 #include <proto/userValue.h>
 
 namespace interpreter {
 
+// Values returned by the operations are either owned by the EvalContext's
+// arena, or are references into the graph or the stored components. They are
+// only valid until the arena is reset or the components are changed.
 const bento::protos::Value& constOp(const bento::protos::Node_Const& node);
+bento::protos::Value& retrieveOp(EvalContext& ctx,
+                                 const bento::protos::Node_Retrieve& node);
 bento::protos::Value& retrieveOp(ics::ComponentStore& compStore,
                                  ics::index::IndexStore& indexStore,
                                  const bento::protos::Node_Retrieve& node);
+void mutateOp(EvalContext& ctx, const bento::protos::Node_Mutate& node);
+// Evaluates the node with temporaries allocated on a local arena
 void mutateOp(ics::ComponentStore& compStore,
               ics::index::IndexStore& indexStore,
               const bento::protos::Node_Mutate& node);
-bento::protos::Value switchOp(ics::ComponentStore& compStore,
-                              ics::index::IndexStore& indexStore,
-                              const bento::protos::Node_Switch& node);
+const bento::protos::Value& switchOp(EvalContext& ctx,
+                                     const bento::protos::Node_Switch& node);
 
 // Arithmetic
-bento::protos::Value addOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Add& node);
-bento::protos::Value subOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Sub& node);
-bento::protos::Value mulOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Mul& node);
-bento::protos::Value divOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Div& node);
-bento::protos::Value maxOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Max& node);
-bento::protos::Value minOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Min& node);
-bento::protos::Value absOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Abs& node);
-bento::protos::Value floorOp(ics::ComponentStore& compStore,
-                             ics::index::IndexStore& indexStore,
-                             const bento::protos::Node_Floor& node);
-bento::protos::Value ceilOp(ics::ComponentStore& compStore,
-                            ics::index::IndexStore& indexStore,
-                            const bento::protos::Node_Ceil& node);
-bento::protos::Value powOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Pow& node);
-bento::protos::Value modOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Mod& node);
-bento::protos::Value sinOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Sin& node);
-bento::protos::Value arcSinOp(ics::ComponentStore& compStore,
-                              ics::index::IndexStore& indexStore,
-                              const bento::protos::Node_ArcSin& node);
-bento::protos::Value cosOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Cos& node);
-bento::protos::Value arcCosOp(ics::ComponentStore& compStore,
-                              ics::index::IndexStore& indexStore,
-                              const bento::protos::Node_ArcCos& node);
-bento::protos::Value tanOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Tan& node);
-bento::protos::Value arcTanOp(ics::ComponentStore& compStore,
-                              ics::index::IndexStore& indexStore,
-                              const bento::protos::Node_ArcTan& node);
+const bento::protos::Value& addOp(EvalContext& ctx,
+                                  const bento::protos::Node_Add& node);
+const bento::protos::Value& subOp(EvalContext& ctx,
+                                  const bento::protos::Node_Sub& node);
+const bento::protos::Value& mulOp(EvalContext& ctx,
+                                  const bento::protos::Node_Mul& node);
+const bento::protos::Value& divOp(EvalContext& ctx,
+                                  const bento::protos::Node_Div& node);
+const bento::protos::Value& maxOp(EvalContext& ctx,
+                                  const bento::protos::Node_Max& node);
+const bento::protos::Value& minOp(EvalContext& ctx,
+                                  const bento::protos::Node_Min& node);
+const bento::protos::Value& absOp(EvalContext& ctx,
+                                  const bento::protos::Node_Abs& node);
+const bento::protos::Value& floorOp(EvalContext& ctx,
+                                    const bento::protos::Node_Floor& node);
+const bento::protos::Value& ceilOp(EvalContext& ctx,
+                                   const bento::protos::Node_Ceil& node);
+const bento::protos::Value& powOp(EvalContext& ctx,
+                                  const bento::protos::Node_Pow& node);
+const bento::protos::Value& modOp(EvalContext& ctx,
+                                  const bento::protos::Node_Mod& node);
+const bento::protos::Value& sinOp(EvalContext& ctx,
+                                  const bento::protos::Node_Sin& node);
+const bento::protos::Value& arcSinOp(EvalContext& ctx,
+                                     const bento::protos::Node_ArcSin& node);
+const bento::protos::Value& cosOp(EvalContext& ctx,
+                                  const bento::protos::Node_Cos& node);
+const bento::protos::Value& arcCosOp(EvalContext& ctx,
+                                     const bento::protos::Node_ArcCos& node);
+const bento::protos::Value& tanOp(EvalContext& ctx,
+                                  const bento::protos::Node_Tan& node);
+const bento::protos::Value& arcTanOp(EvalContext& ctx,
+                                     const bento::protos::Node_ArcTan& node);
 
-// Random number generation
-bento::protos::Value randomOp(ics::ComponentStore& compStore,
-                              ics::index::IndexStore& indexStore,
-                              const bento::protos::Node_Random& node);
+// Random number generation. The numbers are drawn from the node's stream in
+// the context's RandomSource.
+const bento::protos::Value& randomOp(EvalContext& ctx,
+                                     const bento::protos::Node_Random& node);
 
 // Boolean operations
-bento::protos::Value andOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_And& node);
-bento::protos::Value orOp(ics::ComponentStore& compStore,
-                          ics::index::IndexStore& indexStore,
-                          const bento::protos::Node_Or& node);
-bento::protos::Value notOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Not& node);
+const bento::protos::Value& andOp(EvalContext& ctx,
+                                  const bento::protos::Node_And& node);
+const bento::protos::Value& orOp(EvalContext& ctx,
+                                 const bento::protos::Node_Or& node);
+const bento::protos::Value& notOp(EvalContext& ctx,
+                                  const bento::protos::Node_Not& node);
 
 // Checks for equivalence of values (floating point rounding errors will not be
 // corrected)
-bento::protos::Value eqOp(ics::ComponentStore& compStore,
-                          ics::index::IndexStore& indexStore,
-                          const bento::protos::Node_Eq& node);
-bento::protos::Value gtOp(ics::ComponentStore& compStore,
-                          ics::index::IndexStore& indexStore,
-                          const bento::protos::Node_Gt& node);
-bento::protos::Value ltOp(ics::ComponentStore& compStore,
-                          ics::index::IndexStore& indexStore,
-                          const bento::protos::Node_Lt& node);
-bento::protos::Value geOp(ics::ComponentStore& compStore,
-                          ics::index::IndexStore& indexStore,
-                          const bento::protos::Node_Ge& node);
-bento::protos::Value leOp(ics::ComponentStore& compStore,
-                          ics::index::IndexStore& indexStore,
-                          const bento::protos::Node_Le& node);
+const bento::protos::Value& eqOp(EvalContext& ctx,
+                                 const bento::protos::Node_Eq& node);
+const bento::protos::Value& gtOp(EvalContext& ctx,
+                                 const bento::protos::Node_Gt& node);
+const bento::protos::Value& ltOp(EvalContext& ctx,
+                                 const bento::protos::Node_Lt& node);
+const bento::protos::Value& geOp(EvalContext& ctx,
+                                 const bento::protos::Node_Ge& node);
+const bento::protos::Value& leOp(EvalContext& ctx,
+                                 const bento::protos::Node_Le& node);
+
+// Entity lifecycle. The changes are recorded in the context's command buffer.
+const bento::protos::Value& spawnOp(EvalContext& ctx,
+                                    const bento::protos::Node_Spawn& node);
+const bento::protos::Value& despawnOp(EvalContext& ctx,
+                                      const bento::protos::Node_Despawn& node);
 
 }  // namespace interpreter
 
@@ -0,0 +1,97 @@
+#ifndef BENTOBOX_OUTPUTCACHE_H
+#define BENTOBOX_OUTPUTCACHE_H
+
+#include <bento/protos/graph.pb.h>
+#include <core/ics/util/memoryUsage.h>
+#include <index/indexStore.h>
+#include <interpreter/evalContext.h>
+
+#include <unordered_map>
+#include <vector>
+
+namespace interpreter {
+
+// Skips re-evaluating the Mutate outputs of a graph whose inputs have not
+// changed. The inputs of an output are the attributes retrieved anywhere
+// below it. An output is skipped when neither its inputs nor the attribute
+// that it sets have been written since it was last evaluated, as the
+// attribute then already holds the value that evaluating it would set.
+// Outputs that draw random numbers or spawn or despawn entities are always
+// evaluated, and removing any component makes every output evaluate again.
+// Outputs are identified by address, so their graphs must outlive the cache.
+class OutputCache {
+   private:
+    typedef ics::index::VersionIndex::Version Version;
+    typedef ics::index::AttributeIndex::AttrRefIds AttrRefIds;
+
+    // Found by walking the output's nodes once
+    struct Inputs {
+        bool cacheable = true;
+        std::vector<const bento::protos::AttributeRef*> refs;
+        // IDs of the refs and of the output's attribute. A ref always
+        // resolves to the same IDs, so they are resolved once, by the first
+        // start that can resolve all of them.
+        bool resolved = false;
+        std::vector<AttrRefIds> refIds;
+        AttrRefIds targetIds;
+
+        size_t getMemoryUsage() const {
+            return util::getMemoryUsage(refs) + util::getMemoryUsage(refIds);
+        }
+    };
+    // Versions of the output's attributes after it was last evaluated. The
+    // inputs' versions are taken before the output sets its attribute, so
+    // an output which reads its own attribute is never skipped.
+    struct Entry {
+        Version structureVersion;
+        std::vector<Version> inputVersions;
+        Version targetVersion;
+
+        size_t getMemoryUsage() const {
+            return util::getMemoryUsage(inputVersions);
+        }
+    };
+
+    std::unordered_map<const bento::protos::Node_Mutate*, Inputs> inputs;
+    std::unordered_map<const bento::protos::Node_Mutate*, Entry> entries;
+    size_t skipCount = 0;
+
+    // Returns the output's inputs, resolving their IDs if they have not
+    // been resolved yet
+    const Inputs& getInputs(const ics::index::IndexStore& indexStore,
+                            const bento::protos::Node_Mutate& output);
+    bool isFresh(const ics::index::IndexStore& indexStore,
+                 const bento::protos::Node_Mutate& output,
+                 const Inputs& outputInputs) const;
+
+   public:
+    // Versions taken by start for an output being evaluated
+    struct Pending {
+        bool resolved = false;
+        AttrRefIds targetIds;
+        Entry entry;
+    };
+
+    // Evaluates the output unless it can be skipped. Returns whether the
+    // output was evaluated.
+    bool run(EvalContext& ctx, const bento::protos::Node_Mutate& output);
+    // The parts of run before and after the output is evaluated, for outputs
+    // which are evaluated elsewhere, e.g. on other threads. start returns
+    // whether the output has to be evaluated, in which case finish is called
+    // once its attribute has been set.
+    bool start(const ics::index::IndexStore& indexStore,
+               const bento::protos::Node_Mutate& output, Pending& pending);
+    void finish(const ics::index::IndexStore& indexStore,
+                const bento::protos::Node_Mutate& output, Pending&& pending);
+
+    // Returns the number of outputs that have been skipped
+    size_t getSkipCount() const { return skipCount; }
+
+    size_t getMemoryUsage() const {
+        return util::getMemoryUsage(inputs) + util::getMemoryUsage(entries);
+    }
+};
+
+}  // namespace interpreter
+
+#endif  // BENTOBOX_OUTPUTCACHE_H
@@ -0,0 +1,62 @@
+#ifndef BENTOBOX_PARALLELPLAN_H
+#define BENTOBOX_PARALLELPLAN_H
+
+#include <bento/protos/graph.pb.h>
+#include <core/ics/util/memoryUsage.h>
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+namespace interpreter {
+
+// Splits the Mutate outputs of graphs into waves of consecutive outputs which
+// can be evaluated concurrently. No two outputs of a wave set the same
+// attribute, and no output retrieves an attribute set by an earlier output of
+// its wave. A later output may still set an attribute which an earlier output
+// of the wave retrieves: this is only safe because the outputs of a wave are
+// evaluated before any of their attributes are set, so each task must buffer
+// its values until the whole wave has been evaluated. Doing so gives the same
+// result as evaluating the outputs one at a time.
+// Outputs that draw random numbers or spawn or despawn entities change state
+// shared by the whole graph, so each of them is a wave of its own which is
+// evaluated alone.
+// Graphs are identified by address, so they must outlive the plan.
+class ParallelPlan {
+   public:
+    // Minimum number of nodes evaluated by each task of a wave. Smaller
+    // waves are evaluated on the calling thread, as handing them to other
+    // threads would take longer than evaluating them.
+    static constexpr size_t GRAIN_SIZE = 512;
+
+    struct Wave {
+        // Range of the wave's outputs in the graph's outputs
+        int begin;
+        int end;
+        // Number of nodes below the wave's outputs
+        size_t nodeCount = 0;
+        // False if the wave's output has to be evaluated alone
+        bool parallel = true;
+
+        int size() const { return end - begin; }
+    };
+
+   private:
+    std::unordered_map<const bento::protos::Graph*, std::vector<Wave>> plans;
+
+   public:
+    // Returns the waves of the graph's outputs, in the order of the outputs.
+    // The graph is only walked the first time.
+    const std::vector<Wave>& getWaves(const bento::protos::Graph& graph);
+
+    // Returns the number of tasks to split the wave into, given the number of
+    // threads which could help the calling thread. Returns 1 if the wave
+    // should be evaluated on the calling thread.
+    static size_t getTaskCount(const Wave& wave, size_t threadCount);
+
+    size_t getMemoryUsage() const { return util::getMemoryUsage(plans); }
+};
+
+}  // namespace interpreter
+
+#endif  // BENTOBOX_PARALLELPLAN_H
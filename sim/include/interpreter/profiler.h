@@ -0,0 +1,70 @@
+#ifndef BENTOBOX_PROFILER_H
+#define BENTOBOX_PROFILER_H
+
+#include <bento/protos/graph.pb.h>
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace interpreter {
+
+// Counts and times the systems run and the nodes evaluated by a simulation.
+// The time of a node excludes the time spent evaluating its child nodes, so
+// the times of the nodes of each type add up to the time spent in the graphs.
+// Profiling is off unless the profiler is set in the EvalContext, and costs
+// one pointer check per node while it is off.
+class Profiler {
+   public:
+    typedef std::chrono::steady_clock Clock;
+    typedef bento::protos::Node::OpCase OpCase;
+
+    struct Counter {
+        uint64_t count = 0;
+        Clock::duration total = Clock::duration::zero();
+
+        void add(Clock::duration duration) {
+            count++;
+            total += duration;
+        }
+    };
+
+    // Times a node from its construction until its destruction
+    class NodeTimer {
+       private:
+        Profiler& profiler;
+        OpCase op;
+        Clock::time_point start;
+        // Time spent in the children of the enclosing node so far
+        Clock::duration outerChildTime;
+
+       public:
+        NodeTimer(Profiler& profiler, OpCase op);
+        NodeTimer(const NodeTimer&) = delete;
+        NodeTimer& operator=(const NodeTimer&) = delete;
+        ~NodeTimer();
+    };
+
+   private:
+    // Indexed by OpCase
+    std::vector<Counter> nodes;
+    // SystemDef ID -> counter
+    std::map<uint32_t, Counter> systems;
+    // Time spent in the children of the node being evaluated
+    Clock::duration childTime = Clock::duration::zero();
+
+   public:
+    void addSystem(uint32_t systemId, Clock::duration duration);
+
+    // Returns the counters of the node types that have been evaluated
+    std::map<OpCase, Counter> getNodes() const;
+    const std::map<uint32_t, Counter>& getSystems() const { return systems; }
+
+    // Clears all the counters
+    void reset();
+};
+
+}  // namespace interpreter
+
+#endif  // BENTOBOX_PROFILER_H
@@ -0,0 +1,105 @@
+#ifndef BENTOBOX_RANDOM_H
+#define BENTOBOX_RANDOM_H
+
+#include <bento/protos/graph.pb.h>
+#include <google/protobuf/message.h>
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace interpreter {
+
+// Philox4x32-10 counter based random number generator. Instead of stepping
+// a hidden state, it maps a counter and a key to random bits with a fixed
+// number of rounds, so any part of a random stream can be generated directly
+// and independently of the other parts.
+class Philox4x32 {
+   public:
+    typedef std::array<uint32_t, 4> Counter;
+    typedef std::array<uint32_t, 2> Key;
+
+    // Returns the 4 random words for the counter under the key
+    static Counter generate(Counter counter, Key key);
+};
+
+// Generates the random numbers used by Random nodes. The numbers drawn by a
+// node are a function of (seed, step, node, draw) only, so a simulation with
+// the same seed produces the same numbers regardless of how its graphs are
+// scheduled. Each node has its own stream, which allows nodes to draw
+// numbers concurrently as long as each node is evaluated by one thread.
+class RandomSource {
+   private:
+    uint64_t seed;
+    uint64_t step = 0;
+    // IDs of the Random nodes, assigned in the order that they are found
+    std::unordered_map<const bento::protos::Node_Random*, uint32_t> nodeIds;
+    // Number of Philox blocks that each node has drawn during the step,
+    // indexed by node ID
+    std::vector<uint32_t> nodeBlocks;
+
+    void internMessage(const google::protobuf::Message& message);
+    uint32_t getNodeId(const bento::protos::Node_Random& node);
+
+   public:
+    explicit RandomSource(uint64_t seed = 0) : seed(seed) {}
+
+    uint64_t getSeed() const { return seed; }
+    void setSeed(uint64_t seed) { this->seed = seed; }
+
+    uint64_t getStep() const { return step; }
+    // Moves on to the next step, which gives every node a new stream
+    void nextStep();
+
+    // Assigns IDs to the graph's Random nodes. Graphs have to be interned in
+    // the same order for their nodes to receive the same IDs, and so the
+    // same numbers. Nodes which have not been interned are assigned an ID the
+    // first time they draw a number, which is not thread safe.
+    void internGraph(const bento::protos::Graph& graph);
+
+    // Fills out with random bits from the node's stream
+    void generate(const bento::protos::Node_Random& node,
+                  std::span<uint32_t> out);
+
+    // Fills out with random numbers uniformly distributed in [low, high).
+    // Filling many numbers at once amortises the cost of finding the node's
+    // stream.
+    template <std::floating_point T>
+    void uniform(const bento::protos::Node_Random& node, T low, T high,
+                 std::span<T> out);
+};
+
+template <std::floating_point T>
+void RandomSource::uniform(const bento::protos::Node_Random& node, T low,
+                           T high, std::span<T> out) {
+    // Each float uses 1 word, and each double uses 2 words
+    constexpr size_t WORDS = sizeof(T) / sizeof(uint32_t);
+    // Draw in chunks so that no buffer needs to be allocated
+    std::array<uint32_t, 64> bits;
+    constexpr size_t CHUNK = bits.size() / WORDS;
+
+    for (size_t i = 0; i < out.size(); i += CHUNK) {
+        auto count = std::min(CHUNK, out.size() - i);
+        generate(node, std::span(bits.data(), count * WORDS));
+        for (size_t j = 0; j < count; j++) {
+            // Keep as many bits as the mantissa holds, so that every value
+            // in [0, 1) is equally likely
+            T unit;
+            if constexpr (WORDS == 1) {
+                unit = (bits[j] >> 8) * 0x1p-24f;
+            } else {
+                uint64_t word = (uint64_t(bits[2 * j]) << 32) | bits[2 * j + 1];
+                unit = (word >> 11) * 0x1p-53;
+            }
+            out[i + j] = low + unit * (high - low);
+        }
+    }
+}
+
+}  // namespace interpreter
+
+#endif  // BENTOBOX_RANDOM_H
@@ -0,0 +1,80 @@
+#ifndef BENTOBOX_THREADPOOL_H
+#define BENTOBOX_THREADPOOL_H
+
+#include <memory/allocationCounter.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace interpreter {
+
+// Fixed set of worker threads which run the tasks of parallel loops. The pool
+// is shared, so loops may be run from several threads at once, e.g. by the
+// steps of different simulations. The thread running a loop also runs its
+// tasks, so a loop finishes even if every worker is busy with other loops.
+class ThreadPool {
+   private:
+    // Tasks of a loop which is being run. Workers keep the batch alive while
+    // they run its tasks, as the loop may return before a queued worker gets
+    // to it.
+    struct Batch {
+        std::function<void(size_t)> task;
+        size_t taskCount;
+        std::atomic<size_t> nextTask = 0;
+        std::atomic<size_t> doneCount = 0;
+        // Heap allocations made by the tasks run on the workers
+        std::atomic<uint64_t> workerAllocations = 0;
+        std::atomic<uint64_t> workerAllocatedBytes = 0;
+        // Guards done, and the exceptions
+        std::mutex mutex;
+        std::condition_variable done;
+        std::vector<std::exception_ptr> exceptions;
+
+        Batch(std::function<void(size_t)> task, size_t taskCount);
+        // Runs tasks of the batch until there are none left to start. The
+        // allocations of the tasks are counted if run on a worker.
+        void runTasks(bool onWorker);
+    };
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    // Batches which workers have been asked to help with
+    std::deque<std::shared_ptr<Batch>> queue;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    void work();
+
+   public:
+    // Starts the given number of worker threads
+    explicit ThreadPool(size_t threadCount);
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    // Waits for the workers to finish their tasks
+    ~ThreadPool();
+
+    // Runs task(i) for each i in [0, taskCount) on the workers and the
+    // calling thread, and waits for all of them to finish. If any task
+    // throws, the exception of the task with the lowest index is rethrown
+    // once every task has finished. Returns the heap allocations made by the
+    // tasks that ran on the workers, which are not counted as allocations of
+    // the calling thread.
+    memory::AllocationCount run(size_t taskCount,
+                                const std::function<void(size_t)>& task);
+
+    size_t getThreadCount() const { return workers.size(); }
+    // Returns the number of requests for help queued for the workers
+    size_t getQueueDepth();
+};
+
+}  // namespace interpreter
+
+#endif  // BENTOBOX_THREADPOOL_H
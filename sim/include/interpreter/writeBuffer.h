@@ -0,0 +1,46 @@
+#ifndef BENTOBOX_WRITEBUFFER_H
+#define BENTOBOX_WRITEBUFFER_H
+
+#include <bento/protos/values.pb.h>
+#include <core/ics/componentStore.h>
+#include <index/indexStore.h>
+
+#include <vector>
+
+namespace interpreter {
+
+// Back buffer of the attributes mutated by a double buffered step. Mutations
+// are held here instead of being written, so that every node evaluated in the
+// step reads the state from before the step. The buffer is written to the
+// components when the step ends, in the order that the mutations were made,
+// so the last mutation of an attribute wins.
+class WriteBuffer {
+   private:
+    struct Write {
+        ics::index::AttributeIndex::AttrRefIds refIds;
+        const bento::protos::Value* value;
+    };
+    std::vector<Write> writes;
+
+   public:
+    // Buffers the mutation. The value is not copied, so it must stay
+    // unchanged until the buffer is written, e.g. by copying it to the
+    // step's arena.
+    void add(const ics::index::AttributeIndex::AttrRefIds& refIds,
+             const bento::protos::Value& value);
+    // Buffers the other buffer's mutations after this one's, and empties the
+    // other buffer
+    void append(WriteBuffer& other);
+    // Writes the buffered mutations to the components, and empties the
+    // buffer. The buffer is emptied even if a write fails, in which case the
+    // mutations after it are dropped.
+    void write(ics::index::IndexStore& indexStore,
+               ics::ComponentStore& compStore);
+
+    bool empty() const { return writes.empty(); }
+    size_t size() const { return writes.size(); }
+};
+
+}  // namespace interpreter
+
+#endif  // BENTOBOX_WRITEBUFFER_H
@@ -0,0 +1,48 @@
+#ifndef BENTOBOX_LATENCYHISTOGRAM_H
+#define BENTOBOX_LATENCYHISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace load {
+
+// Histogram of latencies that keeps the quantiles accurate to within ~3%
+// with a fixed amount of memory. Values below 32 get a bucket each, and
+// every power of two above that is split into 32 equal buckets.
+// Not thread safe: each thread records into its own histogram, and the
+// histograms are merged at the end.
+class LatencyHistogram {
+   private:
+    static constexpr int SUB_BUCKET_BITS = 5;
+    static constexpr uint64_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+
+    std::vector<uint64_t> counts;
+    uint64_t count = 0;
+    uint64_t min = UINT64_MAX;
+    uint64_t max = 0;
+    double sum = 0;
+
+    static size_t getBucket(uint64_t value);
+    // Returns the largest value which falls in the bucket
+    static uint64_t getBucketMax(size_t bucket);
+
+   public:
+    LatencyHistogram();
+
+    void record(uint64_t value);
+    void merge(const LatencyHistogram& other);
+
+    uint64_t getCount() const { return count; }
+    // Returns 0 if nothing has been recorded
+    uint64_t getMin() const { return count == 0 ? 0 : min; }
+    uint64_t getMax() const { return max; }
+    double getMean() const { return count == 0 ? 0 : sum / count; }
+    // Returns the value below which the given fraction of the values fall,
+    // e.g. 0.99 for the 99th percentile
+    uint64_t getQuantile(double quantile) const;
+};
+
+}  // namespace load
+
+#endif  // BENTOBOX_LATENCYHISTOGRAM_H
@@ -0,0 +1,62 @@
+#ifndef BENTOBOX_LOADGENERATOR_H
+#define BENTOBOX_LOADGENERATOR_H
+
+#include <bento/protos/sim.pb.h>
+#include <load/latencyHistogram.h>
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace load {
+
+// Calls made by the load generator
+enum class Call { STEP_SIMULATION, GET_ATTRIBUTE, SET_ATTRIBUTE };
+const char* getCallName(Call call);
+
+struct LoadConfig {
+    // Address of the engine to load
+    std::string address = "localhost:54242";
+    // Number of gRPC connections to open
+    uint32_t connections = 4;
+    // Number of workers sharing each connection. Each worker waits for its
+    // call to return before making the next one.
+    uint32_t workersPerConnection = 4;
+    std::chrono::milliseconds duration = std::chrono::seconds(10);
+    // Relative weights of the calls that the workers make
+    std::map<Call, double> callWeights = {{Call::STEP_SIMULATION, 1},
+                                          {Call::GET_ATTRIBUTE, 4},
+                                          {Call::SET_ATTRIBUTE, 1}};
+    // Simulation applied once for each of the simulations. Its name is
+    // suffixed with the simulation's index. The workers get and set the
+    // attributes of its entities.
+    bento::protos::SimulationDef simDef;
+    uint32_t simulations = 4;
+    // Seeds the workers' choice of calls, simulations and attributes
+    uint64_t seed = 1;
+};
+
+struct CallStats {
+    // Latencies of the successful calls, in nanoseconds
+    LatencyHistogram latency;
+    uint64_t errors = 0;
+};
+
+struct LoadReport {
+    // Time from the start of the first call to the end of the last call
+    std::chrono::nanoseconds elapsed{0};
+    std::map<Call, CallStats> calls;
+};
+
+// Applies the simulations, calls the engine from all the workers for the
+// configured duration, then drops the simulations. Throws if the
+// simulations could not be applied.
+LoadReport runLoad(const LoadConfig& config);
+
+// Writes the throughput and latency quantiles of each call as a table
+void printReport(std::ostream& stream, const LoadReport& report);
+
+}  // namespace load
+
+#endif  // BENTOBOX_LOADGENERATOR_H
@@ -0,0 +1,30 @@
+#ifndef BENTOBOX_ALLOCATIONCOUNTER_H
+#define BENTOBOX_ALLOCATIONCOUNTER_H
+
+#include <cstdint>
+
+// The global operator new is replaced to count the heap allocations made by
+// each thread. Counting costs two thread local increments per allocation.
+// Allocations made by calling malloc directly are not counted.
+namespace memory {
+struct AllocationCount {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+
+    AllocationCount& operator+=(const AllocationCount& other) {
+        allocations += other.allocations;
+        bytes += other.bytes;
+        return *this;
+    }
+    AllocationCount operator-(const AllocationCount& other) const {
+        return {allocations - other.allocations, bytes - other.bytes};
+    }
+};
+
+// Returns the allocations made by the calling thread so far. The allocations
+// made by a block of code on one thread are the difference between the counts
+// before and after it.
+AllocationCount getThreadAllocations();
+}  // namespace memory
+
+#endif  // BENTOBOX_ALLOCATIONCOUNTER_H
@@ -0,0 +1,59 @@
+#ifndef BENTO_METRICSSERVER_H
+#define BENTO_METRICSSERVER_H
+/*
+ * bentobox-sim
+ * Metrics HTTP Server
+ */
+#include <functional>
+#include <string>
+#include <thread>
+
+/** Serves the engine's metrics over plain HTTP for Prometheus to scrape */
+namespace network {
+class MetricsServer {
+   private:
+    int port_;
+    std::string host_;
+    std::string address_;
+    // Listening socket
+    int listenFd = -1;
+    // Renders the metrics served on each request
+    std::function<std::string()> render;
+    std::jthread thread;
+
+    void serve(std::stop_token stopToken);
+    void handleConnection(int connFd);
+
+   public:
+    /**
+     * Creates and starts a HTTP server listening on the given host and port,
+     * which serves the text returned by render on GET /metrics. Requests are
+     * handled one at a time on the server's own thread.
+     *
+     * @param host The hostname to configure the server to listen on.
+     * @param port The port to configure the server to listen on. If 0, the
+     *   server will listen on an automatically chosen port.
+     * @param render Returns the metrics in the Prometheus text format. Called
+     *   from the server's thread.
+     *
+     * @throws runtime_error if the server fails to start.
+     */
+    MetricsServer(const std::string host, const int port,
+                  std::function<std::string()> render);
+
+    /** Shutdown the server on destruction */
+    ~MetricsServer() { this->shutdown(); }
+
+    /** Stop serving requests, and wait for the request being served */
+    void shutdown();
+
+    // Getters
+    /* Get the port that the server listens on */
+    int port() const { return port_; }
+    /* Get the host that the server listens on */
+    std::string host() const { return host_; }
+    /* Get the address that the server listens on in form HOST:PORT */
+    std::string address() const { return address_; }
+};
+}  // namespace network
+#endif /* ifndef BENTO_METRICSSERVER_H */
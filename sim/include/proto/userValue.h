@@ -160,19 +160,19 @@ void runFnWithValType(const bento::protos::Type& type, Fn fn) {
     }
 }
 
-// Runs a function on the given Value after figuring out its type.
+// Calls a function with the primitive held by the given Value after figuring
+// out its type. The function's return value is discarded.
 // For example, if `x` is an INT64, then, the lambda function will be called as:
 // fn(x.primitive().int_64());
 template <class... AllowedTypes, class Fn>
-bento::protos::Value runFnWithVal(const bento::protos::Value& x, Fn fn) {
+void visitVal(const bento::protos::Value& x, Fn fn) {
     // Validate that the given value conforms with the list of types. This is
     // done at runtime
     if (!isValOfTypes<AllowedTypes...>(x)) {
         throw std::runtime_error("Value given is not valid for this function.");
     }
 
-    auto val = bento::protos::Value();
-    bool valSet = false;
+    bool fnCalled = false;
     // Each constexpr here is evaluated at compile-time. Therefore, if a
     // protobuf value is not listed list of AllowedTypes, the if statement will
     // be completely removed.
@@ -185,74 +185,96 @@ bento::protos::Value runFnWithVal(const bento::protos::Value& x, Fn fn) {
     // C++ knows that we will never have a case we will run fn(getVal<STR>(x))
     if constexpr (typeInTypes<INT32, AllowedTypes...>) {
         if (isValOfType<INT32>(x)) {
-            setVal(val, fn(getVal<INT32>(x)));
-            valSet = true;
+            fn(getVal<INT32>(x));
+            fnCalled = true;
         }
     }
     if constexpr (typeInTypes<INT64, AllowedTypes...>) {
         if (isValOfType<INT64>(x)) {
-            setVal(val, fn(getVal<INT64>(x)));
-            valSet = true;
+            fn(getVal<INT64>(x));
+            fnCalled = true;
         }
     }
     if constexpr (typeInTypes<FLOAT32, AllowedTypes...>) {
         if (isValOfType<FLOAT32>(x)) {
-            setVal(val, fn(getVal<FLOAT32>(x)));
-            valSet = true;
+            fn(getVal<FLOAT32>(x));
+            fnCalled = true;
         }
     }
     if constexpr (typeInTypes<FLOAT64, AllowedTypes...>) {
         if (isValOfType<FLOAT64>(x)) {
-            setVal(val, fn(getVal<FLOAT64>(x)));
-            valSet = true;
+            fn(getVal<FLOAT64>(x));
+            fnCalled = true;
         }
     }
     if constexpr (typeInTypes<STR, AllowedTypes...>) {
         if (isValOfType<STR>(x)) {
-            setVal(val, fn(getVal<STR>(x)));
-            valSet = true;
+            fn(getVal<STR>(x));
+            fnCalled = true;
         }
     }
     if constexpr (typeInTypes<BOOL, AllowedTypes...>) {
         if (isValOfType<BOOL>(x)) {
-            setVal(val, fn(getVal<BOOL>(x)));
-            valSet = true;
+            fn(getVal<BOOL>(x));
+            fnCalled = true;
         }
     }
 
-    if (!valSet) {
+    if (!fnCalled) {
         throw std::runtime_error("No value when executing function.");
     }
+}
 
-    return val;
+// Runs a function on the given Value after figuring out its type, and stores
+// the result in `out`. No intermediate Values are created, so `out` can be
+// allocated by the caller, e.g. on an arena.
+// For example, if `x` is an INT64, then, the lambda function will be called as:
+// fn(x.primitive().int_64());
+template <class... AllowedTypes, class Fn>
+void runFnIntoVal(bento::protos::Value& out, const bento::protos::Value& x,
+                  Fn fn) {
+    visitVal<AllowedTypes...>(x, [&out, fn]<class X>(X x) {
+        setVal(out, fn(x));
+    });
 }
 
-// Runs a function on the given Value after figuring out its type.
+// Same as above, but for functions which take two values.
 // For example, if `x` is an INT64 and `y` is FLOAT32, then, the lambda function
 // will be called as:
 // fn(x.primitive().int_64(), y.primitive().float_32());
 template <class... AllowedTypes, class Fn>
-bento::protos::Value runFnWithVal(const bento::protos::Value& x,
-                                  const bento::protos::Value& y, Fn fn) {
-    auto val = bento::protos::Value();
-    // We need to deduce two types here. We use our existing function which
-    // deduces one type and run it twice.
-    runFnWithVal<AllowedTypes...>(x, [&val, &y, fn]<class X>(X x) {
-        // At this point, we have deduced the type of x. Now, we run the
-        // function again to deduce the type of y
-        val = runFnWithVal<AllowedTypes...>(y, [&x, fn]<class Y>(Y y) {
+void runFnIntoVal(bento::protos::Value& out, const bento::protos::Value& x,
+                  const bento::protos::Value& y, Fn fn) {
+    // We need to deduce two types here. We deduce the type of x first, then
+    // deduce the type of y with the value of x captured.
+    visitVal<AllowedTypes...>(x, [&out, &y, fn]<class X>(X x) {
+        visitVal<AllowedTypes...>(y, [&out, &x, fn]<class Y>(Y y) {
             // Now, we have deduced the type of x and y. We call the function
             // with both.
-            return fn(x, y);
+            setVal(out, fn(x, y));
         });
-
-        // The return value of this lambda is supposed to be some protobuf
-        // primitive type e.g. 20. However, we only have the final Value.
-        // Here, I return a dummy value but I have set the external scope's
-        // `val` to the final value.
-        return 3;
     });
+}
+
+// Runs a function on the given Value after figuring out its type.
+// For example, if `x` is an INT64, then, the lambda function will be called as:
+// fn(x.primitive().int_64());
+template <class... AllowedTypes, class Fn>
+bento::protos::Value runFnWithVal(const bento::protos::Value& x, Fn fn) {
+    auto val = bento::protos::Value();
+    runFnIntoVal<AllowedTypes...>(val, x, fn);
+    return val;
+}
 
+// Runs a function on the given Value after figuring out its type.
+// For example, if `x` is an INT64 and `y` is FLOAT32, then, the lambda function
+// will be called as:
+// fn(x.primitive().int_64(), y.primitive().float_32());
+template <class... AllowedTypes, class Fn>
+bento::protos::Value runFnWithVal(const bento::protos::Value& x,
+                                  const bento::protos::Value& y, Fn fn) {
+    auto val = bento::protos::Value();
+    runFnIntoVal<AllowedTypes...>(val, x, y, fn);
     return val;
 }
 
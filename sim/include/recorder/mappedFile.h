@@ -0,0 +1,51 @@
+#ifndef BENTOBOX_MAPPEDFILE_H
+#define BENTOBOX_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace recorder {
+
+// A file which is only appended to, and is written through a memory mapping.
+// Space for the file is allocated in increasingly large blocks, so appending
+// rarely needs a system call. The file is cut down to the bytes appended when
+// it is closed. Throws std::runtime_error if the file cannot be created or
+// grown, e.g. when the disk is full.
+class MappedFile {
+   private:
+    static const size_t INITIAL_CAPACITY = 1 << 20;
+
+    std::string path;
+    int fd = -1;
+    char* data = nullptr;
+    size_t capacity = 0;
+    size_t size = 0;
+
+    void grow(size_t minCapacity);
+
+   public:
+    // Creates the file, replacing any existing file at the path
+    explicit MappedFile(std::string path);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    // Appends count bytes to the file, and returns the offset they were
+    // written at
+    size_t append(const void* bytes, size_t count);
+    // Appends zero bytes until the size of the file is a multiple of the
+    // alignment
+    void pad(size_t alignment);
+    size_t getSize() const { return size; }
+    bool isClosed() const { return fd < 0; }
+
+    // Starts writing the appended bytes back to the file without waiting
+    void flush();
+    // Writes the appended bytes back and closes the file. Does nothing if
+    // the file has been closed.
+    void close();
+};
+
+}  // namespace recorder
+
+#endif  // BENTOBOX_MAPPEDFILE_H
@@ -0,0 +1,100 @@
+#ifndef BENTOBOX_TRAJECTORYRECORDER_H
+#define BENTOBOX_TRAJECTORYRECORDER_H
+
+#include <bento/protos/references.pb.h>
+#include <bento/protos/types.pb.h>
+#include <core/ics/componentStore.h>
+#include <google/protobuf/repeated_field.h>
+#include <index/indexStore.h>
+#include <recorder/mappedFile.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace recorder {
+
+// Records the values of a simulation's attributes after every step to an
+// append-only file, with the values of each attribute stored contiguously so
+// that they can be loaded without parsing. Each recorded attribute is a
+// column. A column records either one entity's attribute, or the attribute of
+// every entity with the component, in which case the IDs of the entities are
+// recorded with the values.
+//
+// All integers are little endian, and every section starts at a multiple of 8
+// bytes, padded with zeros:
+// - Header: the magic "BBTRAJ01", then u32 version, u32 column count, u32
+//   index interval, u32 reserved. Then for each column: u32 type (a
+//   Type::Primitive), u32 entity ID (0 for every entity), u32 component name
+//   length, u32 attribute name length, then the names.
+// - Step: u32 STEP_MAGIC, u32 column count, u64 step number. Then for each
+//   column: u32 value count, u32 reserved, the u32 entity IDs of the values
+//   (only for columns of every entity), then the values. BOOL and BYTE values
+//   take 1 byte, INT32 and FLOAT32 4 bytes, INT64 and FLOAT64 8 bytes.
+// - Index footer, written every index interval steps and when the recording
+//   is closed: u32 INDEX_MAGIC, u32 step count, u64 offset of the previous
+//   footer (NO_OFFSET if none), then the u64 offsets of the steps written
+//   since the previous footer.
+// - Trailer, written when the recording is closed: u64 offset of the last
+//   footer, then the magic "BBTREND\0". A file without a trailer was not
+//   closed, and can be read by scanning the steps from the header.
+class TrajectoryRecorder {
+   public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t STEP_MAGIC = 0x50455453;   // "STEP"
+    static constexpr uint32_t INDEX_MAGIC = 0x58444e49;  // "INDX"
+    static constexpr uint64_t NO_OFFSET = UINT64_MAX;
+    static constexpr uint32_t DEFAULT_INDEX_INTERVAL = 64;
+
+    struct Column {
+        bento::protos::Type::Primitive type;
+        // Recorded entity, or 0 to record every entity with the component
+        ics::index::EntityIndex::EntityId entityId;
+        std::string component;
+        std::string attribute;
+        ics::CompGroup group;
+        ics::component::AttrId attrId;
+    };
+
+   private:
+    MappedFile file;
+    std::vector<Column> columns;
+    uint32_t indexInterval;
+    uint64_t stepCount = 0;
+    // Offsets of the steps written since the last footer
+    std::vector<uint64_t> stepOffsets;
+    uint64_t lastFooterOffset = NO_OFFSET;
+    // Values of a column are gathered here before they are appended
+    std::vector<char> scratch;
+
+    void writeHeader();
+    void writeFooter();
+    void recordColumn(ics::index::IndexStore& indexStore,
+                      ics::ComponentStore& compStore, const Column& column);
+
+   public:
+    // Creates the recording, replacing any file at the path. Throws
+    // std::invalid_argument if an attribute does not exist or is not of a
+    // BYTE, INT32, INT64, FLOAT32, FLOAT64 or BOOL type.
+    TrajectoryRecorder(
+        const std::string& path, const ics::index::IndexStore& indexStore,
+        const google::protobuf::RepeatedPtrField<bento::protos::AttributeRef>&
+            attributes,
+        uint32_t indexInterval = DEFAULT_INDEX_INTERVAL);
+    ~TrajectoryRecorder();
+
+    // Appends the current values of the attributes as the given step.
+    // Entities which do not have a column's component are left out of it.
+    // Attributes which have not been set are recorded as zero.
+    void record(ics::index::IndexStore& indexStore,
+                ics::ComponentStore& compStore, uint64_t step);
+    // Writes the last footer and the trailer, and closes the file
+    void close();
+
+    uint64_t getStepCount() const { return stepCount; }
+    size_t getSize() const { return file.getSize(); }
+};
+
+}  // namespace recorder
+
+#endif  // BENTOBOX_TRAJECTORYRECORDER_H
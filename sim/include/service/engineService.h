@@ -6,15 +6,86 @@
  */
 
 #include "bento/protos/services.grpc.pb.h"
+#include <interpreter/threadPool.h>
+#include <service/metrics.h>
+#include <service/tickDriver.h>
+#include <service/tracer.h>
 #include <simulation.h>
 
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+
 namespace service {
+// Settings of the engine, given when it is started
+struct EngineOptions {
+    // Number of threads which help evaluate the systems. With no threads,
+    // the systems are evaluated on the threads handling calls.
+    size_t evalThreads = 0;
+    // Directory that recordings are written to. Clients name a file in it,
+    // so that they cannot write anywhere else on the engine's host.
+    // Recording is refused if unset.
+    std::string recordingsDir;
+    // Directory that traces are written to when a file is named, in the
+    // same way. Traces can still be returned in the response if unset.
+    std::string tracesDir;
+};
+
 class EngineServiceImpl final : public bento::protos::EngineService::Service {
    private:
     // simulation name -> simulation ptr
     std::unordered_map<std::string, std::unique_ptr<Simulation>> sims;
+    // Guards sims. Calls on a simulation hold it shared, so that the
+    // simulation is not dropped or replaced while it is in use. It is taken
+    // after driversMutex and before the Simulation's own mutex.
+    std::shared_mutex simsMutex;
+    // simulation name -> driver stepping the simulation on the engine
+    std::unordered_map<std::string, std::unique_ptr<TickDriver>> drivers;
+    // Guards drivers. Taken before simsMutex, so that a simulation's driver
+    // can be stopped before the simulation is dropped.
+    std::mutex driversMutex;
+    // Records the phases of the calls while tracing is on
+    Tracer tracer;
+    Metrics metrics;
+    // Evaluates the independent outputs of the systems concurrently. Shared
+    // by the simulations. Null if outputs are evaluated one at a time.
+    std::unique_ptr<interpreter::ThreadPool> evalPool;
+    std::string recordingsDir;
+    std::string tracesDir;
+
+    // Keeps a simulation locked for the duration of a call
+    struct SimHandle {
+        std::shared_lock<std::shared_mutex> simsLock;
+        std::unique_lock<std::mutex> simLock{};
+        // Null if there is no such simulation
+        Simulation* sim = nullptr;
+    };
+    // Locks the simulation with the given name. The time spent waiting for
+    // the locks is traced.
+    SimHandle lockSimulation(const std::string& name);
+    // Runs one step of the locked simulation
+    grpc::Status runStep(Simulation* sim, const std::string& name,
+                         uint64_t seed, bool profile);
+    // Refills the back snapshot of the locked simulation with the changes to
+    // its state, or copies the whole state into a new one, and swaps the
+    // snapshots
+    void publishSnapshot(Simulation& sim,
+                         const ics::index::VersionIndex::Changes& changes);
+    // Queues the changes to the simulation's state, or a keyframe, for each
+    // of its watchers, and publishes a snapshot if it is ticking
+    void publishState(Simulation& sim);
+    // Ends the streams watching the simulation
+    static void closeWatchers(Simulation& sim);
 
    public:
+    explicit EngineServiceImpl(EngineOptions options = EngineOptions());
+    // Stops the drivers before the members that their ticks use are
+    // destroyed
+    ~EngineServiceImpl() override;
+
+    // Returns the engine's metrics in the Prometheus text format
+    std::string renderMetrics();
+
     // See services.proto for documentation on service calls
     grpc::Status GetVersion(grpc::ServerContext* context,
                             const bento::protos::GetVersionReq* request,
@@ -42,6 +113,11 @@ class EngineServiceImpl final : public bento::protos::EngineService::Service {
         const bento::protos::StepSimulationReq* request,
         bento::protos::StepSimulationResp* response) override;
 
+    grpc::Status CreateEntities(
+        grpc::ServerContext* context,
+        const bento::protos::CreateEntitiesReq* request,
+        bento::protos::CreateEntitiesResp* response) override;
+
     grpc::Status GetAttribute(
         grpc::ServerContext* context,
         const bento::protos::GetAttributeReq* request,
@@ -50,6 +126,44 @@ class EngineServiceImpl final : public bento::protos::EngineService::Service {
         grpc::ServerContext* context,
         const bento::protos::SetAttributeReq* request,
         bento::protos::SetAttributeResp* response) override;
+    grpc::Status WatchSimulation(
+        grpc::ServerContext* context,
+        const bento::protos::WatchSimulationReq* request,
+        grpc::ServerWriter<bento::protos::WatchSimulationResp>* writer)
+        override;
+
+    grpc::Status GetProfile(grpc::ServerContext* context,
+                            const bento::protos::GetProfileReq* request,
+                            bento::protos::GetProfileResp* response) override;
+    grpc::Status GetSimulationStats(
+        grpc::ServerContext* context,
+        const bento::protos::GetSimulationStatsReq* request,
+        bento::protos::GetSimulationStatsResp* response) override;
+
+    grpc::Status StartTicking(
+        grpc::ServerContext* context,
+        const bento::protos::StartTickingReq* request,
+        bento::protos::StartTickingResp* response) override;
+    grpc::Status StopTicking(
+        grpc::ServerContext* context,
+        const bento::protos::StopTickingReq* request,
+        bento::protos::StopTickingResp* response) override;
+
+    grpc::Status StartRecording(
+        grpc::ServerContext* context,
+        const bento::protos::StartRecordingReq* request,
+        bento::protos::StartRecordingResp* response) override;
+    grpc::Status StopRecording(
+        grpc::ServerContext* context,
+        const bento::protos::StopRecordingReq* request,
+        bento::protos::StopRecordingResp* response) override;
+
+    grpc::Status StartTrace(grpc::ServerContext* context,
+                            const bento::protos::StartTraceReq* request,
+                            bento::protos::StartTraceResp* response) override;
+    grpc::Status StopTrace(grpc::ServerContext* context,
+                           const bento::protos::StopTraceReq* request,
+                           bento::protos::StopTraceResp* response) override;
 };
 }  // namespace service
 
@@ -0,0 +1,87 @@
+#ifndef BENTOBOX_METRICS_H
+#define BENTOBOX_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace service {
+
+// Collects the engine's counters and histograms, and writes them in the
+// Prometheus text exposition format. The metrics are updated by the calls as
+// they are handled, so that writing them out does not have to walk the
+// simulations. Gauges which describe the simulations are passed in when the
+// metrics are written instead.
+class Metrics {
+   public:
+    typedef std::chrono::steady_clock Clock;
+
+    // Upper bounds of the RPC latency buckets, in seconds
+    static constexpr std::array<double, 16> LATENCY_BUCKETS = {
+        0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025,
+        0.05,   0.1,     0.25,   0.5,   1,      2.5,   5,     10};
+
+    struct Histogram {
+        // Number of observations in each bucket, not cumulative. The last
+        // bucket holds the observations past the last bound.
+        std::array<uint64_t, LATENCY_BUCKETS.size() + 1> bucketCounts{};
+        double sum = 0;
+        uint64_t count = 0;
+
+        void observe(double value);
+    };
+
+    // Gauges of a simulation, gathered when the metrics are written
+    struct SimulationGauges {
+        std::string name;
+        uint64_t entityCount = 0;
+        uint64_t componentCount = 0;
+    };
+
+    // Counts an RPC as in flight from its construction until its destruction,
+    // and records its latency when it is destroyed
+    class RpcTimer {
+       private:
+        Metrics& metrics;
+        const char* method;
+        Clock::time_point start;
+
+       public:
+        RpcTimer(Metrics& metrics, const char* method);
+        RpcTimer(const RpcTimer&) = delete;
+        RpcTimer& operator=(const RpcTimer&) = delete;
+        ~RpcTimer();
+    };
+
+   private:
+    std::atomic<int64_t> rpcsInFlight = 0;
+    std::atomic<uint64_t> nodeEvaluations = 0;
+    // Guards the fields below
+    std::mutex mutex;
+    // RPC method name -> latency
+    std::map<std::string, Histogram> rpcLatencies;
+    // Simulation name -> number of steps run
+    std::map<std::string, uint64_t> simSteps;
+
+   public:
+    // Counts a step which the simulation ran successfully
+    void addStep(const std::string& simName);
+    void addNodeEvaluations(uint64_t count);
+    // Forgets the counters of a dropped simulation
+    void dropSimulation(const std::string& simName);
+
+    // evalQueueDepth is the number of requests for help queued for the
+    // engine's eval threads
+    void write(std::ostream& out, const std::vector<SimulationGauges>& sims,
+               size_t evalQueueDepth);
+};
+
+}  // namespace service
+
+#endif  // BENTOBOX_METRICS_H
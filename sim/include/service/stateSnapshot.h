@@ -0,0 +1,88 @@
+#ifndef BENTOBOX_STATESNAPSHOT_H
+#define BENTOBOX_STATESNAPSHOT_H
+
+#include <bento/protos/references.pb.h>
+#include <bento/protos/values.pb.h>
+#include <component/componentLayout.h>
+#include <core/ics/componentStore.h>
+#include <index/indexStore.h>
+#include <index/versionIndex.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace service {
+
+// A copy of every attribute of a simulation after a step, which can be read
+// without locking the simulation. Snapshots are double buffered: the
+// simulation publishes one snapshot while it refills the other, so that
+// readers always see the whole state of one step. A snapshot is filled
+// with the whole state once, and then refilled with only the attributes
+// which changed since, reusing the memory held by the values it had.
+class StateSnapshot {
+   private:
+    struct Key {
+        ics::index::EntityIndex::EntityId entityId;
+        ics::CompGroup group;
+
+        bool operator==(const Key& other) const = default;
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+    struct ComponentValues {
+        std::vector<bento::protos::Value> values;
+        // Update in which the component was last copied. Components which
+        // were not copied in the latest update have been removed.
+        uint64_t update = 0;
+
+        size_t getMemoryUsage() const;
+    };
+    struct ComponentType {
+        ics::CompGroup group;
+        std::shared_ptr<const ics::component::ComponentLayout> layout;
+    };
+
+    uint64_t step = 0;
+    uint64_t updateCount = 0;
+    std::unordered_map<Key, ComponentValues, KeyHash> components;
+    // Component types by name, so that names can be resolved without the
+    // simulation's indexes
+    std::unordered_map<std::string, ComponentType> componentTypes;
+    std::vector<bool> knownGroups;
+
+    void addComponentType(const ics::index::IndexStore& indexStore,
+                          ics::CompGroup group);
+    ComponentValues& getComponent(const ics::index::IndexStore& indexStore,
+                                  ics::index::EntityIndex::EntityId entityId,
+                                  ics::CompGroup group);
+
+   public:
+    // Copies the state of the simulation into the snapshot
+    void update(ics::index::IndexStore& indexStore,
+                ics::ComponentStore& compStore, uint64_t step);
+    // Copies the attributes which changed into the snapshot, and forgets the
+    // components which were removed. The snapshot has the state of the
+    // simulation if it had the state from before the changes.
+    void update(ics::index::IndexStore& indexStore,
+                ics::ComponentStore& compStore,
+                const ics::index::VersionIndex::Changes& changes,
+                uint64_t step);
+
+    // Returns the value of the attribute, or null if the entity has no such
+    // component or attribute. Throws std::runtime_error if the attribute has
+    // not been set, as reading it from the simulation does.
+    const bento::protos::Value* find(
+        const bento::protos::AttributeRef& ref) const;
+    // Step of the simulation that the snapshot is of
+    uint64_t getStep() const { return step; }
+
+    size_t getMemoryUsage() const;
+};
+
+}  // namespace service
+
+#endif  // BENTOBOX_STATESNAPSHOT_H
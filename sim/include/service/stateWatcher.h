@@ -0,0 +1,71 @@
+#ifndef BENTOBOX_STATEWATCHER_H
+#define BENTOBOX_STATEWATCHER_H
+
+#include <bento/protos/services.pb.h>
+#include <core/ics/componentStore.h>
+#include <index/indexStore.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+namespace service {
+
+// Queues the messages of a WatchSimulation stream. Messages are built while
+// the simulation is locked, and are sent by the stream's own thread, so a
+// slow watcher never holds up the simulation. If the watcher falls too far
+// behind, the queued changes are dropped, and a keyframe is sent instead.
+class StateWatcher {
+   public:
+    typedef std::shared_ptr<const bento::protos::WatchSimulationResp> Message;
+
+    static const uint32_t DEFAULT_KEYFRAME_INTERVAL = 64;
+    // Number of messages that can be queued before changes are dropped
+    static const size_t MAX_QUEUED = 64;
+
+   private:
+    std::mutex mutex;
+    std::condition_variable queued;
+    std::deque<Message> queue;
+    bool closed = false;
+
+    // Only used while the simulation is locked
+    uint32_t keyframeInterval;
+    uint32_t changesSinceKeyframe = 0;
+    bool keyframeNeeded = true;
+
+   public:
+    explicit StateWatcher(
+        uint32_t keyframeInterval = DEFAULT_KEYFRAME_INTERVAL);
+
+    // Returns whether the next message has to be a keyframe
+    bool needsKeyframe() const;
+    // Queues a message for the stream. Changes are dropped if too many
+    // messages are queued. A keyframe replaces the queued messages.
+    void push(Message message);
+    // Waits up to the timeout for a message. Returns null if there was none,
+    // or if the watcher has been closed.
+    Message pop(std::chrono::milliseconds timeout);
+
+    // Ends the stream, e.g. when the simulation is dropped
+    void close();
+    bool isClosed();
+};
+
+// Fills the message with every attribute of every entity
+void fillKeyframe(ics::index::IndexStore& indexStore,
+                  ics::ComponentStore& compStore,
+                  bento::protos::WatchSimulationResp& message);
+// Fills the message with the current values of the changed attributes, and
+// the removed components
+void fillChanges(ics::index::IndexStore& indexStore,
+                 ics::ComponentStore& compStore,
+                 const ics::index::VersionIndex::Changes& changes,
+                 bento::protos::WatchSimulationResp& message);
+
+}  // namespace service
+
+#endif  // BENTOBOX_STATEWATCHER_H
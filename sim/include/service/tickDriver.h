@@ -0,0 +1,61 @@
+#ifndef BENTOBOX_TICKDRIVER_H
+#define BENTOBOX_TICKDRIVER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace service {
+
+// Runs a tick function on a thread of its own, either at a fixed rate or as
+// fast as possible. Ticks are scheduled at fixed times, so a tick that runs
+// late is followed by ticks run back to back until the schedule is caught
+// up. If the ticks fall too far behind to catch up, the missed ticks are
+// skipped instead.
+class TickDriver {
+   public:
+    typedef std::chrono::steady_clock Clock;
+
+    // Number of missed ticks which are caught up. More are skipped.
+    static constexpr uint64_t MAX_CATCH_UP_TICKS = 10;
+
+   private:
+    Clock::duration period;
+    std::function<void()> tick;
+    std::atomic<uint64_t> tickCount = 0;
+    std::atomic<uint64_t> skippedTicks = 0;
+    std::atomic<bool> running = true;
+    std::mutex errorMutex;
+    std::string error;
+    std::jthread thread;
+
+    void run(std::stop_token stopToken);
+
+   public:
+    // Starts ticking. If the period is zero, the next tick starts as soon as
+    // the previous one ends. If tick throws, ticking stops, and the error is
+    // kept.
+    TickDriver(Clock::duration period, std::function<void()> tick);
+    TickDriver(const TickDriver&) = delete;
+    TickDriver& operator=(const TickDriver&) = delete;
+    // Stops ticking on destruction
+    ~TickDriver() { stop(); }
+
+    // Stops ticking, and waits for the tick being run
+    void stop();
+
+    bool isRunning() const { return running; }
+    uint64_t getTickCount() const { return tickCount; }
+    uint64_t getSkippedTicks() const { return skippedTicks; }
+    // Returns the error that stopped the ticking, or an empty string
+    std::string getError();
+};
+
+}  // namespace service
+
+#endif  // BENTOBOX_TICKDRIVER_H
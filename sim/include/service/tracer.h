@@ -0,0 +1,92 @@
+#ifndef BENTOBOX_TRACER_H
+#define BENTOBOX_TRACER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace service {
+
+// Records the phases of the calls handled by the engine as spans on a
+// timeline, together with the thread that ran them. The spans are written out
+// in Chrome's trace event format, which can be opened in Perfetto or
+// chrome://tracing. Tracing is off until it is started, and costs one atomic
+// load per span while it is off.
+class Tracer {
+   public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Span {
+        std::string name;
+        // Shown with the span, e.g. the name of the simulation
+        std::vector<std::pair<std::string, std::string>> args;
+        uint32_t threadId = 0;
+        Clock::time_point start;
+        Clock::duration duration = Clock::duration::zero();
+    };
+
+    struct Trace {
+        // Time at which the trace was started. Span times are given relative
+        // to it.
+        Clock::time_point origin;
+        std::vector<Span> spans;
+        // Number of spans which did not fit in the trace
+        uint64_t droppedCount = 0;
+    };
+
+    // Records a span from its construction until its destruction. Nothing is
+    // recorded if tracing was off when the span was constructed.
+    class Scope {
+       private:
+        Tracer* tracer = nullptr;
+        Span span;
+
+       public:
+        Scope(Tracer& tracer, const char* name);
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        ~Scope();
+
+        // Adds an arg shown with the span. The value is only copied if the
+        // span is recorded.
+        void addArg(const char* key, std::string_view value);
+        void addArg(const char* key, uint64_t value);
+    };
+
+    static const size_t DEFAULT_MAX_SPANS = 1 << 20;
+
+   private:
+    std::atomic<bool> enabled = false;
+    // Guards the fields below
+    std::mutex mutex;
+    Trace trace;
+    size_t maxSpans = DEFAULT_MAX_SPANS;
+
+    void add(Span span);
+
+   public:
+    // Starts recording spans, discarding any spans recorded before. Spans
+    // past maxSpans are counted but not kept.
+    void start(size_t maxSpans = DEFAULT_MAX_SPANS);
+    // Stops recording spans and returns the spans recorded since the trace
+    // was started
+    Trace stop();
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // Returns a small number identifying the calling thread, assigned in the
+    // order that threads first ask for it
+    static uint32_t getThreadId();
+};
+
+// Writes the trace as a Chrome trace event JSON object
+void writeChromeTrace(std::ostream& out, const Tracer::Trace& trace);
+
+}  // namespace service
+
+#endif  // BENTOBOX_TRACER_H
@@ -2,14 +2,51 @@
 #define BENTOBOX_SIMULATION_H
 
 #include <bento/protos/sim.pb.h>
+#include <commandBuffer.h>
 #include <core/ics/componentStore.h>
 #include <index/indexStore.h>
 #include <forward_list>
+#include <google/protobuf/arena.h>
 #include <ics.h>
+#include <interpreter/outputCache.h>
+#include <interpreter/parallelPlan.h>
+#include <interpreter/profiler.h>
+#include <interpreter/random.h>
+#include <interpreter/writeBuffer.h>
+#include <memory/allocationCounter.h>
+#include <recorder/trajectoryRecorder.h>
+#include <service/stateSnapshot.h>
+#include <service/stateWatcher.h>
 
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <utility>
+#include <vector>
 
 struct Simulation {
+    // Estimated heap memory held by a simulation, in bytes
+    struct MemoryUsage {
+        // Components and their attribute values, in either storage
+        size_t componentBytes = 0;
+        size_t indexBytes = 0;
+        // Component definitions and layouts, and the entity definitions
+        size_t schemaBytes = 0;
+        // Definitions of the systems and the init graph
+        size_t graphBytes = 0;
+        // State kept across steps, like the step arena, the output cache and
+        // the snapshots of a ticking simulation
+        size_t otherBytes = 0;
+
+        size_t getTotalBytes() const {
+            return componentBytes + indexBytes + schemaBytes + graphBytes +
+                   otherBytes;
+        }
+    };
+
     // Value that indicates that the entity ID is unset
     // An entity ID will be generated if the entity ID is set to this value
     static const ::google::protobuf::uint32 UNSET_ENTITY_ID = 0;
@@ -20,55 +57,139 @@ struct Simulation {
     // The simulation will be locked when it has started
     // No changes should be made to the simDef when it is locked
     bool locked = false;
+    // Temporaries created while running the graphs of a step are allocated on
+    // this arena, and are freed together by resetting the arena at the end of
+    // the step. The arena's first block is kept across resets, so steps which
+    // fit in it do not allocate from the heap at all.
+    static const size_t STEP_ARENA_BLOCK_SIZE = 64 * 1024;
+    std::vector<char> stepArenaBlock = std::vector<char>(STEP_ARENA_BLOCK_SIZE);
+    google::protobuf::Arena stepArena{createArenaOptions(stepArenaBlock)};
+    // Entities spawned or despawned during a step are recorded here, and are
+    // created or removed when the step ends
+    ics::CommandBuffer commands;
+    // Random numbers drawn by the graphs. The init graph runs in step 0, and
+    // the systems start running from step 1.
+    interpreter::RandomSource random;
+    // System outputs whose inputs have not changed since the previous step
+    // are skipped
+    interpreter::OutputCache outputCache;
+    // Outputs of the systems which can be evaluated concurrently
+    interpreter::ParallelPlan parallelPlan;
+    // Timings of the steps run with profiling on
+    interpreter::Profiler profiler;
+    // Held by the engine while a call reads or changes the simulation
+    std::mutex mutex;
+    // Heap allocations made by the last step, and by all the steps so far
+    memory::AllocationCount lastStepAllocations;
+    memory::AllocationCount totalStepAllocations;
+    // If set, the recorded attributes are appended after every step
+    std::unique_ptr<recorder::TrajectoryRecorder> recorder;
+    // Mutations of the step being run, if steps are double buffered
+    interpreter::WriteBuffer writeBuffer;
+    // Streams of the simulation's state. Changes to the state are tracked
+    // while there are any.
+    std::vector<std::shared_ptr<service::StateWatcher>> watchers;
+    // Set while the engine steps the simulation on its own
+    bool ticking = false;
+    // Latest state published while ticking, which calls read attributes from
+    // without waiting for the simulation. Null when not ticking.
+    std::atomic<std::shared_ptr<const service::StateSnapshot>> snapshot;
+    // The published snapshot, and the one refilled by the next step
+    std::shared_ptr<service::StateSnapshot> frontSnapshot;
+    std::shared_ptr<service::StateSnapshot> backSnapshot;
+    // Changes which the front snapshot was refilled with. The back snapshot
+    // is a step older, so it misses these as well as the next step's.
+    ics::index::VersionIndex::Changes frontChanges;
+    // Numbers of entities and components as of the latest change to them,
+    // which metrics read without locking the simulation
+    std::atomic<size_t> publishedEntityCount = 0;
+    std::atomic<size_t> publishedComponentCount = 0;
 
     explicit Simulation(bento::protos::SimulationDef simDef)
-        : simDef(std::move(simDef)) {
+        : simDef(std::move(simDef)), random(this->simDef.seed()) {
         // BE CAREFUL: Once simDef is moved into this->simDef, all references to
         // simDef are invalid. Always use this->simDef
 
-        // Create a map from component name to component def for use later
-        std::unordered_map<std::string, bento::protos::ComponentDef> compDefMap;
+        // Register every component type, including those which no entity
+        // has yet, so that entities with them can be spawned later. The
+        // layout is shared by all components of the same type.
+        typedef ics::component::ComponentLayout ComponentLayout;
         for (size_t i = 0; i < this->simDef.components_size(); i++) {
-            compDefMap[this->simDef.components(i).name()] =
-                this->simDef.components(i);
+            auto& compDef = this->simDef.components(i);
+            auto group =
+                indexStore.componentType.addComponentType(compDef.name());
+            indexStore.attribute.addLayout(
+                group, std::make_shared<const ComponentLayout>(compDef));
         }
 
-        // Retrieve all the existing entity IDs to configure the indexStore
+        indexStore.useArchetypes = this->simDef.storage() ==
+                                   bento::protos::SimulationDef::ARCHETYPE;
+
+        // Retrieve all the existing entity IDs to configure the indexStore,
+        // and count the entities so that the indexes can be sized up front
         std::forward_list<ics::index::EntityIndex::EntityId> configuredIds;
+        size_t entityCount = 0;
         for (size_t i = 0; i < this->simDef.entities_size(); i++) {
             auto& entity = this->simDef.entities(i);
             if (entity.id() != UNSET_ENTITY_ID) {
+                if (entity.count() > 1) {
+                    throw std::invalid_argument(
+                        "An entity definition with a count cannot have an "
+                        "ID.");
+                }
                 configuredIds.push_front(entity.id());
             }
+            entityCount += getCount(entity);
         }
 
         // Configure the indexStore with the existing entity IDs
+        indexStore.entity.reserve(entityCount);
+        indexStore.signature.reserve(entityCount);
         indexStore.entity.setEntityIds(configuredIds);
 
-        // Create the components and entity IDs (if needed) for all entities
+        // Create the entity IDs (if needed) for all entities, and group the
+        // entities by their component types so that the components of each
+        // type can be created together
+        std::map<std::vector<ics::CompGroup>,
+                 std::vector<ics::index::EntityIndex::EntityId>>
+            entitiesByGroups;
         for (size_t i = 0; i < this->simDef.entities_size(); i++) {
-            auto& entity = this->simDef.entities(i);
-            // If the entity ID is unset, create one and set it
+            auto& entity = *this->simDef.mutable_entities(i);
+            // If the entity ID is unset, create one and set it. IDs are
+            // generated after the largest configured ID, so the unset ID is
+            // never generated.
             if (entity.id() == UNSET_ENTITY_ID) {
-                ::google::protobuf::uint32 entityId;
-                do {
-                    entityId = indexStore.entity.addEntityId();
-                } while (entityId == UNSET_ENTITY_ID);
+                entity.set_id(indexStore.entity.addEntityIds(getCount(entity)));
+            }
 
-                this->simDef.mutable_entities(i)->set_id(entityId);
+            std::vector<ics::CompGroup> groups;
+            groups.reserve(entity.components_size());
+            for (const auto& compName : entity.components()) {
+                auto group =
+                    indexStore.componentType.addComponentType(compName);
+                // Components of undefined types have no attributes
+                if (!indexStore.attribute.hasLayout(group)) {
+                    auto compDef = bento::protos::ComponentDef();
+                    compDef.set_name(compName);
+                    indexStore.attribute.addLayout(
+                        group, std::make_shared<const ComponentLayout>(
+                                   std::move(compDef)));
+                }
+                groups.push_back(group);
             }
+            std::sort(groups.begin(), groups.end());
 
-            // Create the entity's components
-            for (size_t j = 0; j < entity.components_size(); j++) {
-                const auto& compName = entity.components(j);
-                auto comp = ics::component::UserComponent(compName,
-                                                          compDefMap[compName]);
-                auto compStoreId =
-                    ics::addComponent(indexStore, compStore, comp);
-                indexStore.entity.addComponent(entity.id(), compStoreId);
+            auto& entityIds = entitiesByGroups[std::move(groups)];
+            for (size_t j = 0; j < getCount(entity); j++) {
+                entityIds.push_back(entity.id() + j);
             }
         }
 
+        // Create the entities' components
+        for (const auto& [groups, entityIds] : entitiesByGroups) {
+            ics::addEntities(indexStore, compStore, entityIds, groups);
+        }
+
         // Find the maximum ID that the given simDefs use, then generate the
         // other IDs from there
         uint32_t maxId = 0;
@@ -88,6 +209,46 @@ struct Simulation {
                 this->simDef.mutable_systems(i)->set_id(maxId);
             }
         }
+
+        // Resolve the attribute names referenced by the graphs into integer
+        // IDs ahead of time so that evaluation does not hash strings
+        // The Random nodes are numbered here too, so that they draw the same
+        // numbers whenever the simulation is applied
+        auto& compTypeIndex = indexStore.componentType;
+        indexStore.attribute.internGraph(compTypeIndex,
+                                         this->simDef.init_graph());
+        random.internGraph(this->simDef.init_graph());
+        for (size_t i = 0; i < this->simDef.systems_size(); i++) {
+            const auto& graph = this->simDef.systems(i).graph();
+            indexStore.attribute.internGraph(compTypeIndex, graph);
+            random.internGraph(graph);
+        }
+    }
+
+    // The AttributeIndex refers to the graphs in simDef by address, so the
+    // simulation must stay in place
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    MemoryUsage getMemoryUsage() const;
+    // Returns the number of components of all the entities
+    size_t getComponentCount() const;
+    // Stores the current numbers of entities and components for metrics.
+    // Called after the entities or their components change.
+    void publishCounts();
+
+   private:
+    // Returns the number of entities that the EntityDef defines
+    static size_t getCount(const bento::protos::EntityDef& entity) {
+        return std::max<size_t>(entity.count(), 1);
+    }
+
+    static google::protobuf::ArenaOptions createArenaOptions(
+        std::vector<char>& block) {
+        google::protobuf::ArenaOptions options;
+        options.initial_block = block.data();
+        options.initial_block_size = block.size();
+        return options;
     }
 };
 
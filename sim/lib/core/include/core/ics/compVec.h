@@ -1,18 +1,21 @@
 #ifndef BENTOBOX_COMPVEC_H
 #define BENTOBOX_COMPVEC_H
 
-#include <any>
-#include <functional>
-#include <iostream>
-#include <memory>
-#include <queue>
-#include <typeindex>
-#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 #include "component.h"
+#include "util/memoryUsage.h"
 
 namespace ics {
+// CompIds are generation-tagged handles. The lower 32 bits index into the
+// CompVec's sparse array while the upper 32 bits hold the generation of that
+// sparse slot. Whenever a component is removed, the generation of its slot is
+// bumped so that stale CompIds no longer resolve to a component.
 typedef unsigned long CompId;
 
 template <Component C>
@@ -21,103 +24,195 @@ class CompVec {
     typedef typename std::vector<C>::size_type size_type;
 
    private:
-    CompId lastId = 0;
-    std::function<C&(std::vector<BaseComponent>* vectorPtr, size_type idx)>
-        getter;
-    std::function<const C&(const std::vector<BaseComponent>* vectorPtr,
-                           size_type idx)>
-        constGetter;
-    std::unordered_map<CompId, size_type> idToIndex;
-    std::queue<size_type> inactiveCompIdx;
+    // Entry in the sparse array. id is the CompId that currently owns the slot
+    // and index is the position of the component in the dense array.
+    struct Slot {
+        CompId id;
+        size_type index;
+    };
+
+    static constexpr CompId SLOT_MASK = 0xFFFFFFFF;
+    static constexpr unsigned GENERATION_SHIFT = 32;
+
+    // Components are stored packed in vec. denseIds[i] is the CompId of vec[i]
     std::vector<C> vec;
+    std::vector<CompId> denseIds;
+    // Maps the slot of a CompId to the component's position in vec
+    std::vector<Slot> sparse;
+    // Slots which have been freed by remove() and can be reused by add()
+    std::vector<CompId> freeSlots;
+
+    // CompVecs are stored type erased as CompVec<BaseComponent> in the
+    // ComponentStore. The size of the stored component and a function to move
+    // components within vec are captured when the CompVec is created so that
+    // the type erased CompVec still addresses and moves components correctly.
+    size_type elemSize;
+    void (*swapRemoveFn)(void* vecPtr, size_type idx);
+    void (*reserveFn)(void* vecPtr, size_type capacity);
 
    protected:
-    void isActiveCheck(CompId id) const;
-    size_type addToVec(const C& val);
+    size_type indexOf(CompId id) const;
+    C& elemAt(size_type index);
+    const C& elemAt(size_type index) const;
 
    public:
-    CompVec() {
-        getter = [](std::vector<BaseComponent>* vectorPtr,
-                    size_type idx) -> C& {
-            auto vecPtr = reinterpret_cast<std::vector<C>*>(vectorPtr);
-            return vecPtr->at(idx);
+    CompVec() : elemSize(sizeof(C)) {
+        swapRemoveFn = [](void* vecPtr, size_type idx) {
+            auto& typedVec = *reinterpret_cast<std::vector<C>*>(vecPtr);
+            // Fill the gap left by the removed component with the last
+            // component so that vec stays packed
+            if (idx != typedVec.size() - 1) {
+                typedVec[idx] = std::move(typedVec.back());
+            }
+            typedVec.pop_back();
         };
-
-        constGetter = [](const std::vector<BaseComponent>* vectorPtr,
-                         size_type idx) -> const C& {
-            const auto vecPtr =
-                reinterpret_cast<const std::vector<C>*>(vectorPtr);
-            return vecPtr->at(idx);
+        reserveFn = [](void* vecPtr, size_type capacity) {
+            reinterpret_cast<std::vector<C>*>(vecPtr)->reserve(capacity);
         };
     }
     CompId add(const C& val);
     void remove(CompId id);
-    size_type size();
+    bool contains(CompId id) const;
+    size_type size() const;
+    // Reserves space for the given number of components, so that adding
+    // that many components does not reallocate the storage
+    void reserve(size_type capacity);
+
+    // Returns the heap memory held by the CompVec and its components. Like
+    // iteration, this requires the CompVec to be accessed with its concrete
+    // component type.
+    size_t getMemoryUsage() const;
+
+    // Returns the CompIds of the stored components, in storage order.
+    const std::vector<CompId>& ids() const { return denseIds; }
+
+    // Iterates over the stored components contiguously, in the same order as
+    // ids(). Iteration requires the CompVec to be accessed with its concrete
+    // component type, e.g. through getCompVec<C>.
+    C* begin() { return vec.data(); }
+    C* end() { return vec.data() + vec.size(); }
+    const C* begin() const { return vec.data(); }
+    const C* end() const { return vec.data() + vec.size(); }
+
+    // Returns a view of (CompId, C&) pairs over the stored components.
+    // The view is invalidated when components are added or removed.
+    auto entries() {
+        return std::views::iota(size_type{0}, size()) |
+               std::views::transform([this](size_type i) {
+                   return std::pair<CompId, C&>(denseIds[i], vec[i]);
+               });
+    }
 
     C& at(CompId id);
+    const C& at(CompId id) const;
     C& operator[](CompId id);
     const C& operator[](CompId id) const;
 };
 
 template <Component C>
-void CompVec<C>::isActiveCheck(CompId id) const {
-    auto index = idToIndex.at(id);
-    const auto& comp = constGetter(
-        reinterpret_cast<const std::vector<BaseComponent>*>(&vec), index);
-    if (!comp.isActive) {
-        // TODO(joeltio): format the index into the string
+typename CompVec<C>::size_type CompVec<C>::indexOf(CompId id) const {
+    auto slot = id & SLOT_MASK;
+    // A single comparison against the stored id checks both that the slot is
+    // in use and that the generation matches
+    if (slot >= sparse.size() || sparse[slot].id != id) {
         throw std::out_of_range(
-            "compVec::isActiveCheck: component at index is inactive");
+            "compVec::indexOf: no component with the given CompId");
     }
+    return sparse[slot].index;
 }
 
 template <Component C>
-typename CompVec<C>::size_type CompVec<C>::addToVec(const C& val) {
-    if (!this->inactiveCompIdx.empty()) {
-        // Reuse old component space
-        CompVec<C>::size_type insertIdx = this->inactiveCompIdx.front();
-        this->vec.at(insertIdx) = val;
-        this->inactiveCompIdx.pop();
-        return insertIdx;
-    } else {
-        this->vec.push_back(val);
-        return vec.size() - 1;
-    }
+C& CompVec<C>::elemAt(size_type index) {
+    auto bytePtr = reinterpret_cast<std::byte*>(vec.data());
+    return *reinterpret_cast<C*>(bytePtr + index * elemSize);
+}
+
+template <Component C>
+const C& CompVec<C>::elemAt(size_type index) const {
+    auto bytePtr = reinterpret_cast<const std::byte*>(vec.data());
+    return *reinterpret_cast<const C*>(bytePtr + index * elemSize);
 }
 
 template <Component C>
 CompId CompVec<C>::add(const C& val) {
-    auto insertedIdx = addToVec(val);
-    // Update the idToIndex map
-    idToIndex.insert(std::make_pair(lastId + 1, insertedIdx));
-    ++lastId;
-    return lastId;
+    CompId id;
+    if (!freeSlots.empty()) {
+        // Reuse a freed slot. Its stored id already carries the bumped
+        // generation.
+        id = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        // Generations start at 1 so that 0 is never a valid CompId
+        id = (CompId(1) << GENERATION_SHIFT) | sparse.size();
+        sparse.push_back(Slot{});
+    }
+
+    sparse[id & SLOT_MASK] = Slot{id, vec.size()};
+    vec.push_back(val);
+    denseIds.push_back(id);
+    return id;
 }
 
 template <Component C>
 void CompVec<C>::remove(CompId id) {
-    auto index = idToIndex.at(id);
-    // Mark component as deleted
-    auto& comp =
-        getter(reinterpret_cast<std::vector<BaseComponent>*>(&vec), index);
-    comp.isActive = false;
-    // Queue the component for reuse
-    inactiveCompIdx.push(index);
-    // Remove the mapping from idToIdx
-    idToIndex.erase(id);
+    auto index = indexOf(id);
+    auto lastIndex = denseIds.size() - 1;
+
+    // Move the last component into the removed component's place
+    swapRemoveFn(&vec, index);
+    auto movedId = denseIds[lastIndex];
+    denseIds[index] = movedId;
+    denseIds.pop_back();
+    sparse[movedId & SLOT_MASK].index = index;
+
+    // Invalidate the removed CompId and queue its slot for reuse
+    auto slot = id & SLOT_MASK;
+    auto generation = (id >> GENERATION_SHIFT) + 1;
+    // Skip generation 0 on wrap around so that 0 stays an invalid CompId
+    if ((generation & SLOT_MASK) == 0) {
+        generation = 1;
+    }
+    auto nextId = ((generation & SLOT_MASK) << GENERATION_SHIFT) | slot;
+    sparse[slot].id = ~nextId;
+    freeSlots.push_back(nextId);
 }
 
 template <Component C>
-typename CompVec<C>::size_type CompVec<C>::size() {
-    return idToIndex.size();
+bool CompVec<C>::contains(CompId id) const {
+    auto slot = id & SLOT_MASK;
+    return slot < sparse.size() && sparse[slot].id == id;
+}
+
+template <Component C>
+typename CompVec<C>::size_type CompVec<C>::size() const {
+    return denseIds.size();
+}
+
+template <Component C>
+size_t CompVec<C>::getMemoryUsage() const {
+    return util::getMemoryUsage(vec) + util::getMemoryUsage(denseIds) +
+           util::getMemoryUsage(sparse) + util::getMemoryUsage(freeSlots);
+}
+
+template <Component C>
+void CompVec<C>::reserve(size_type capacity) {
+    reserveFn(&vec, capacity);
+    denseIds.reserve(capacity);
+    // Slots freed by remove() are reused before new slots are added
+    auto toAdd = capacity > size() ? capacity - size() : 0;
+    if (toAdd > freeSlots.size()) {
+        sparse.reserve(sparse.size() + toAdd - freeSlots.size());
+    }
 }
 
 template <Component C>
 C& CompVec<C>::at(CompId id) {
-    isActiveCheck(id);
-    auto index = idToIndex.at(id);
+    return elemAt(indexOf(id));
+}
 
-    return getter(reinterpret_cast<std::vector<BaseComponent>*>(&vec), index);
+template <Component C>
+const C& CompVec<C>::at(CompId id) const {
+    return elemAt(indexOf(id));
 }
 
 template <Component C>
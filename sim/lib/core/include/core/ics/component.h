@@ -5,10 +5,6 @@
 
 namespace ics {
 struct BaseComponent {
-    // isActive is used for memory pooling. When a component is marked as
-    // inactive, it is "deleted". The memory used by inactive components
-    // will be reused.
-    bool isActive = true;
     bool operator==(const BaseComponent&) const = default;
 };
 
@@ -1,6 +1,7 @@
 #ifndef BENTOBOX_COMPONENTSET_H
 #define BENTOBOX_COMPONENTSET_H
 
+#include <cstdint>
 #include <unordered_set>
 
 #include "compVec.h"
@@ -17,7 +18,13 @@ namespace std {
 template <>
 struct hash<ics::CompStoreId> {
     inline size_t operator()(const ics::CompStoreId &v) const {
-        return v.first * 31 + v.second;
+        // Mix the group into the CompId with the splitmix64 finalizer. CompIds
+        // of different groups overlap heavily, so a simple linear combination
+        // of the two collides often.
+        uint64_t x = v.second ^ (uint64_t(v.first) * 0x9E3779B97F4A7C15ull);
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
     }
 };
 }  // namespace std
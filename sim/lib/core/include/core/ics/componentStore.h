@@ -2,7 +2,9 @@
 #define BENTOBOX_COMPONENTSTORE_H
 
 #include <any>
+#include <iterator>
 #include <memory>
+#include <ranges>
 #include <unordered_map>
 
 #include "compVec.h"
@@ -22,6 +24,12 @@ CompVec<C>& getCompVec(ComponentStore& store, CompGroup group) {
     return castedCompVec;
 }
 
+template <Component C>
+const CompVec<C>& getCompVec(const ComponentStore& store, CompGroup group) {
+    const auto& compVec = *store.at(group);
+    return *reinterpret_cast<const ics::CompVec<C>*>(&compVec);
+}
+
 template <Component C>
 CompVec<C>& createCompVec(ComponentStore& store, CompGroup group) {
     ics::CompVec<C> vec;
@@ -48,7 +56,91 @@ C& getComponent(ComponentStore& store, CompStoreId compStoreId) {
     return vec.at(compStoreId.second);
 }
 
-ComponentSet asCompSet(const ComponentStore& store);
+// Returns a view of (CompStoreId, C&) pairs over all components in the given
+// group. This allows systems to sweep through components linearly.
+template <Component C>
+auto viewComponents(ComponentStore& store, CompGroup group) {
+    return getCompVec<C>(store, group).entries() |
+           std::views::transform([group](std::pair<CompId, C&> entry) {
+               return std::pair<CompStoreId, C&>(
+                   CompStoreId(group, entry.first), entry.second);
+           });
+}
+
+// A lazy view over the CompStoreIds in a ComponentStore. No ComponentSet is
+// materialized: the ids are read from the CompVecs while iterating. The view
+// can be narrowed down to a single group, which allows filters on the
+// component type to skip the other groups entirely.
+class CompSetView : public std::ranges::view_interface<CompSetView> {
+   private:
+    const ComponentStore* store = nullptr;
+    // Whether the view covers all groups, or only the given group
+    bool allGroups = true;
+    CompGroup group = 0;
+
+   public:
+    class iterator {
+       private:
+        ComponentStore::const_iterator groupIt;
+        ComponentStore::const_iterator groupEnd;
+        CompVec<BaseComponent>::size_type idx = 0;
+
+        // Moves on to the next group when the current group is exhausted
+        void skipExhaustedGroups() {
+            while (groupIt != groupEnd && idx >= groupIt->second->size()) {
+                ++groupIt;
+                idx = 0;
+            }
+        }
+
+       public:
+        typedef std::forward_iterator_tag iterator_concept;
+        typedef CompStoreId value_type;
+        typedef std::ptrdiff_t difference_type;
+
+        iterator() = default;
+        iterator(ComponentStore::const_iterator begin,
+                 ComponentStore::const_iterator end)
+            : groupIt(begin), groupEnd(end) {
+            skipExhaustedGroups();
+        }
+
+        CompStoreId operator*() const {
+            return CompStoreId(groupIt->first, groupIt->second->ids()[idx]);
+        }
+        iterator& operator++() {
+            ++idx;
+            skipExhaustedGroups();
+            return *this;
+        }
+        iterator operator++(int) {
+            auto prev = *this;
+            ++*this;
+            return prev;
+        }
+        bool operator==(const iterator& other) const {
+            return groupIt == other.groupIt &&
+                   (groupIt == groupEnd || idx == other.idx);
+        }
+    };
+
+    CompSetView() = default;
+    explicit CompSetView(const ComponentStore& store) : store(&store) {}
+    CompSetView(const ComponentStore& store, CompGroup group)
+        : store(&store), allGroups(false), group(group) {}
+
+    iterator begin() const;
+    iterator end() const;
+    CompVec<BaseComponent>::size_type size() const;
+    bool contains(const CompStoreId& compStoreId) const;
+
+    // Returns a view of only the CompStoreIds in the given group which are
+    // also in this view
+    CompSetView withGroup(CompGroup group) const;
+};
+
+// Returns a lazy view over all the CompStoreIds in the store
+CompSetView asCompSet(const ComponentStore& store);
 }  // namespace ics
 
 #endif  // BENTOBOX_COMPONENTSTORE_H
@@ -0,0 +1,138 @@
+#ifndef BENTOBOX_SORTEDCOMPSET_H
+#define BENTOBOX_SORTEDCOMPSET_H
+
+#include <algorithm>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "componentSet.h"
+#include "componentStore.h"
+
+namespace ics {
+// An alternative representation of a ComponentSet. The CompIds of each group
+// are kept in a packed, sorted array, and the groups themselves are sorted.
+// Set operations are linear merges over these arrays (see sortedSetOps.h)
+// instead of hash table probes, and iterating the set reads memory linearly.
+class SortedCompSet {
+   public:
+    typedef std::vector<CompId> GroupIds;
+
+   private:
+    // Sorted by CompGroup. Groups without CompIds are not stored.
+    std::vector<std::pair<CompGroup, GroupIds>> groups;
+
+    const GroupIds* findGroup(CompGroup group) const;
+
+    // Merges the groups of a and b, applying op to the CompIds of groups that
+    // are in both sets. Groups only in a or only in b are kept when
+    // keepOnlyA or keepOnlyB are set respectively.
+    static SortedCompSet combine(
+        const SortedCompSet& a, const SortedCompSet& b, bool keepOnlyA,
+        bool keepOnlyB,
+        void (*op)(std::span<const CompId>, std::span<const CompId>,
+                   std::vector<CompId>&));
+
+   public:
+    class iterator {
+       private:
+        const std::pair<CompGroup, GroupIds>* groupIt = nullptr;
+        size_t idx = 0;
+
+       public:
+        typedef std::forward_iterator_tag iterator_concept;
+        typedef CompStoreId value_type;
+        typedef std::ptrdiff_t difference_type;
+
+        iterator() = default;
+        explicit iterator(const std::pair<CompGroup, GroupIds>* groupIt)
+            : groupIt(groupIt) {}
+
+        CompStoreId operator*() const {
+            return CompStoreId(groupIt->first, groupIt->second[idx]);
+        }
+        iterator& operator++() {
+            // Groups are never empty, so moving to the next group is enough
+            if (++idx >= groupIt->second.size()) {
+                ++groupIt;
+                idx = 0;
+            }
+            return *this;
+        }
+        iterator operator++(int) {
+            auto prev = *this;
+            ++*this;
+            return prev;
+        }
+        bool operator==(const iterator& other) const = default;
+    };
+
+    SortedCompSet() = default;
+
+    // Creates the set from a range of CompStoreIds in any order
+    template <class R>
+    requires std::ranges::input_range<R> &&
+        std::is_convertible_v<std::ranges::range_value_t<R>, CompStoreId> &&
+        (!std::is_same_v<std::remove_cvref_t<R>, SortedCompSet>)
+    explicit SortedCompSet(R&& compStoreIds) {
+        std::vector<CompStoreId> sorted;
+        for (const CompStoreId& compStoreId : compStoreIds) {
+            sorted.push_back(compStoreId);
+        }
+        std::sort(sorted.begin(), sorted.end());
+        sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+        for (auto& [group, compId] : sorted) {
+            if (groups.empty() || groups.back().first != group) {
+                groups.emplace_back(group, GroupIds());
+            }
+            groups.back().second.push_back(compId);
+        }
+    }
+
+    iterator begin() const { return iterator(groups.data()); }
+    iterator end() const { return iterator(groups.data() + groups.size()); }
+
+    size_t size() const;
+    bool empty() const { return groups.empty(); }
+    bool contains(const CompStoreId& compStoreId) const;
+    void insert(const CompStoreId& compStoreId);
+
+    // Returns the sorted CompIds of the given group in the set
+    std::span<const CompId> groupIds(CompGroup group) const;
+
+    // Returns a set of only the CompStoreIds in the given group
+    SortedCompSet withGroup(CompGroup group) const;
+
+    static SortedCompSet intersect(const SortedCompSet& a,
+                                   const SortedCompSet& b);
+    static SortedCompSet unite(const SortedCompSet& a, const SortedCompSet& b);
+    static SortedCompSet subtract(const SortedCompSet& a,
+                                  const SortedCompSet& b);
+};
+
+// Returns all the CompStoreIds in the store as a SortedCompSet
+SortedCompSet asSortedCompSet(const ComponentStore& store);
+}  // namespace ics
+
+namespace util {
+inline ics::SortedCompSet setIntersection(const ics::SortedCompSet& a,
+                                          const ics::SortedCompSet& b) {
+    return ics::SortedCompSet::intersect(a, b);
+}
+
+inline ics::SortedCompSet setUnion(const ics::SortedCompSet& a,
+                                   const ics::SortedCompSet& b) {
+    return ics::SortedCompSet::unite(a, b);
+}
+
+inline ics::SortedCompSet setDifference(const ics::SortedCompSet& a,
+                                        const ics::SortedCompSet& b) {
+    return ics::SortedCompSet::subtract(a, b);
+}
+}  // namespace util
+
+#endif  // BENTOBOX_SORTEDCOMPSET_H
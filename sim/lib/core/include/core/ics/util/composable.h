@@ -2,25 +2,37 @@
 #define BENTOBOX_COMPOSABLE_H
 
 #include <concepts>
+#include <utility>
 #include <variant>
 
 namespace util {
+// Chains functions with the pipe syntax, e.g. Composable(x) | f | g.
+// Each stage receives the result of the previous stage. Temporary Composables
+// move their data into the next stage so that lazy views (e.g. std::ranges
+// views) can be passed through the chain without being copied or dangling.
 template <class Data>
 class Composable {
    public:
-    const Data data;
-    explicit Composable(Data d) : data(d){};
+    Data data;
+    explicit Composable(Data d) : data(std::forward<Data>(d)){};
 
     template <class Fn>
     // Require that Fn is a function that has argument of type Data, i.e. Fn:
     // (Data d) -> ??
-    requires std::invocable<Fn, Data>
+    requires std::invocable<Fn, Data&>
         // The return type is Composable<Return type of Fn(Data)>
-        auto operator|(Fn fn)
-            -> Composable<decltype(fn(std::declval<Data>()))> {
-        typedef decltype(fn(std::declval<Data>())) ReturnType;
+        auto operator|(Fn fn) & -> Composable<decltype(fn(data))> {
+        typedef decltype(fn(data)) ReturnType;
         return Composable<ReturnType>(fn(data));
     }
+
+    template <class Fn>
+    requires std::invocable<Fn, Data&&>
+        auto operator|(Fn fn) &&
+        -> Composable<decltype(fn(std::forward<Data>(data)))> {
+        typedef decltype(fn(std::forward<Data>(data))) ReturnType;
+        return Composable<ReturnType>(fn(std::forward<Data>(data)));
+    }
 };
 }  // namespace util
 
@@ -0,0 +1,118 @@
+#ifndef BENTOBOX_MEMORYUSAGE_H
+#define BENTOBOX_MEMORYUSAGE_H
+
+#include <concepts>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Estimates the heap memory held by a value, excluding the size of the value
+// itself. Containers count their storage together with the memory held by
+// their elements. The nodes of node based containers are estimated from
+// their layout in libstdc++, so the results are approximate, but they are
+// good enough to compare how much memory different parts of a simulation
+// use. Types report the memory that they hold through a getMemoryUsage()
+// member, and protobuf messages through SpaceUsedLong(). Other types are
+// assumed to hold no heap memory.
+namespace util {
+template <class T>
+concept ReportsMemoryUsage = requires(const T& value) {
+    { value.getMemoryUsage() } -> std::convertible_to<size_t>;
+};
+template <class T>
+concept ReportsSpaceUsed = requires(const T& value) {
+    { value.SpaceUsedLong() } -> std::convertible_to<size_t>;
+};
+
+template <class T>
+size_t getMemoryUsage(const T& value);
+size_t getMemoryUsage(const std::string& str);
+template <class K, class V>
+size_t getMemoryUsage(const std::pair<K, V>& pair);
+template <class T, class D>
+size_t getMemoryUsage(const std::unique_ptr<T, D>& ptr);
+template <class T, class A>
+size_t getMemoryUsage(const std::vector<T, A>& vec);
+template <class K, class V, class C, class A>
+size_t getMemoryUsage(const std::map<K, V, C, A>& map);
+template <class K, class V, class H, class E, class A>
+size_t getMemoryUsage(const std::unordered_map<K, V, H, E, A>& map);
+template <class T, class H, class E, class A>
+size_t getMemoryUsage(const std::unordered_set<T, H, E, A>& set);
+
+template <class T>
+size_t getMemoryUsage(const T& value) {
+    if constexpr (ReportsMemoryUsage<T>) {
+        return value.getMemoryUsage();
+    } else if constexpr (ReportsSpaceUsed<T>) {
+        return value.SpaceUsedLong() - sizeof(T);
+    } else {
+        return 0;
+    }
+}
+
+inline size_t getMemoryUsage(const std::string& str) {
+    // Short strings are stored inline
+    static const auto inlineCapacity = std::string().capacity();
+    return str.capacity() > inlineCapacity ? str.capacity() + 1 : 0;
+}
+
+template <class K, class V>
+size_t getMemoryUsage(const std::pair<K, V>& pair) {
+    return getMemoryUsage(pair.first) + getMemoryUsage(pair.second);
+}
+
+template <class T, class D>
+size_t getMemoryUsage(const std::unique_ptr<T, D>& ptr) {
+    return ptr ? sizeof(T) + getMemoryUsage(*ptr) : 0;
+}
+
+template <class T, class A>
+size_t getMemoryUsage(const std::vector<T, A>& vec) {
+    auto bytes = vec.capacity() * sizeof(T);
+    for (const auto& elem : vec) {
+        bytes += getMemoryUsage(elem);
+    }
+    return bytes;
+}
+
+// Each node holds the colour and the parent, left and right pointers
+template <class K, class V, class C, class A>
+size_t getMemoryUsage(const std::map<K, V, C, A>& map) {
+    auto bytes =
+        map.size() * (sizeof(std::pair<const K, V>) + 4 * sizeof(void*));
+    for (const auto& entry : map) {
+        bytes += getMemoryUsage(entry);
+    }
+    return bytes;
+}
+
+// Each node holds the next pointer and the cached hash
+template <class K, class V, class H, class E, class A>
+size_t getMemoryUsage(const std::unordered_map<K, V, H, E, A>& map) {
+    auto bytes =
+        map.bucket_count() * sizeof(void*) +
+        map.size() * (sizeof(std::pair<const K, V>) + 2 * sizeof(void*));
+    for (const auto& entry : map) {
+        bytes += getMemoryUsage(entry);
+    }
+    return bytes;
+}
+
+template <class T, class H, class E, class A>
+size_t getMemoryUsage(const std::unordered_set<T, H, E, A>& set) {
+    auto bytes = set.bucket_count() * sizeof(void*) +
+                 set.size() * (sizeof(T) + 2 * sizeof(void*));
+    for (const auto& elem : set) {
+        bytes += getMemoryUsage(elem);
+    }
+    return bytes;
+}
+}  // namespace util
+
+#endif  // BENTOBOX_MEMORYUSAGE_H
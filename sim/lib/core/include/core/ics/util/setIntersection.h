@@ -9,6 +9,11 @@ namespace util {
 template <class T>
 std::unordered_set<T> setIntersection(const std::unordered_set<T>& a,
                                       const std::unordered_set<T>& b) {
+    // Probe the larger set with the elements of the smaller set
+    if (a.size() > b.size()) {
+        return setIntersection(b, a);
+    }
+
     std::unordered_set<T> newSet;
     for (const T& aElement : a) {
         if (b.contains(aElement)) {
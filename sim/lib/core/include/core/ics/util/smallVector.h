@@ -0,0 +1,91 @@
+#ifndef BENTOBOX_SMALLVECTOR_H
+#define BENTOBOX_SMALLVECTOR_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace util {
+// A vector which stores up to N elements inline, without a heap allocation.
+// Only when more than N elements are stored are the elements moved to the
+// heap. This suits the many short lists that are kept per entity.
+template <class T, size_t N>
+class SmallVector {
+   private:
+    std::array<T, N> inlineElems{};
+    std::vector<T> heapElems;
+    size_t count = 0;
+
+    bool isInline() const { return count <= N && heapElems.empty(); }
+
+   public:
+    typedef T value_type;
+    typedef size_t size_type;
+
+    T* data() { return isInline() ? inlineElems.data() : heapElems.data(); }
+    const T* data() const {
+        return isInline() ? inlineElems.data() : heapElems.data();
+    }
+    size_type size() const { return count; }
+    bool empty() const { return count == 0; }
+    // Returns the heap memory held once the elements no longer fit inline
+    size_t getMemoryUsage() const { return heapElems.capacity() * sizeof(T); }
+
+    T* begin() { return data(); }
+    T* end() { return data() + count; }
+    const T* begin() const { return data(); }
+    const T* end() const { return data() + count; }
+
+    T& operator[](size_type i) { return data()[i]; }
+    const T& operator[](size_type i) const { return data()[i]; }
+
+    void push_back(const T& elem) {
+        if (count < N && heapElems.empty()) {
+            inlineElems[count] = elem;
+        } else {
+            // Spill the inline elements to the heap once they no longer fit
+            if (heapElems.empty()) {
+                heapElems.assign(inlineElems.begin(), inlineElems.end());
+            }
+            heapElems.push_back(elem);
+        }
+        ++count;
+    }
+
+    // Removes the first element equal to elem, keeping the order of the
+    // remaining elements. Returns whether an element was removed.
+    bool erase(const T& elem) {
+        auto it = std::find(begin(), end(), elem);
+        if (it == end()) {
+            return false;
+        }
+
+        std::move(it + 1, end(), it);
+        --count;
+        if (!heapElems.empty()) {
+            heapElems.pop_back();
+            // Move back inline once the elements fit again
+            if (count <= N) {
+                std::move(heapElems.begin(), heapElems.end(),
+                          inlineElems.begin());
+                heapElems.clear();
+                heapElems.shrink_to_fit();
+            }
+        }
+        return true;
+    }
+
+    bool contains(const T& elem) const {
+        return std::find(begin(), end(), elem) != end();
+    }
+
+    std::span<T> span() { return std::span<T>(data(), count); }
+    std::span<const T> span() const {
+        return std::span<const T>(data(), count);
+    }
+};
+}  // namespace util
+
+#endif  // BENTOBOX_SMALLVECTOR_H
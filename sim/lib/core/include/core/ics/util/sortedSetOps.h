@@ -0,0 +1,179 @@
+#ifndef BENTOBOX_SORTEDSETOPS_H
+#define BENTOBOX_SORTEDSETOPS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// The AVX2 paths are compiled with a target attribute, so they are built
+// whatever the target CPU of the build, and are used if the CPU running the
+// program supports AVX2
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define BENTOBOX_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+// Set operations on sorted arrays of unique elements. The results are
+// appended to out in sorted order. For 64-bit unsigned integers, intersection
+// and difference compare blocks of 4 elements at once with AVX2 when the CPU
+// supports it. Otherwise, and for other element types, a linear merge is
+// used.
+namespace util {
+namespace detail {
+#ifdef BENTOBOX_AVX2_TARGET
+// Returns true if the CPU running the program supports AVX2
+inline bool hasAvx2() {
+#ifdef __AVX2__
+    return true;
+#else
+    static const bool supported = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return supported;
+#endif
+}
+
+// Returns a 4 bit mask of the elements of a[0..4) which are equal to any of
+// the elements of b[0..4)
+BENTOBOX_AVX2_TARGET inline int blockMatchMask(const uint64_t* a,
+                                               const uint64_t* b) {
+    auto va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+    auto vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+    // Compare a against every rotation of b to compare all pairs
+    auto match = _mm256_cmpeq_epi64(va, vb);
+    match = _mm256_or_si256(
+        match, _mm256_cmpeq_epi64(
+                   va, _mm256_permute4x64_epi64(vb, _MM_SHUFFLE(0, 3, 2, 1))));
+    match = _mm256_or_si256(
+        match, _mm256_cmpeq_epi64(
+                   va, _mm256_permute4x64_epi64(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+    match = _mm256_or_si256(
+        match, _mm256_cmpeq_epi64(
+                   va, _mm256_permute4x64_epi64(vb, _MM_SHUFFLE(2, 1, 0, 3))));
+    return _mm256_movemask_pd(_mm256_castsi256_pd(match));
+}
+
+// Intersects whole blocks of a and b, advancing i and j past the blocks
+// compared. The remaining elements are left to the linear merge.
+template <class T>
+BENTOBOX_AVX2_TARGET void intersectBlocks(std::span<const T> a,
+                                          std::span<const T> b,
+                                          std::vector<T>& out, size_t& i,
+                                          size_t& j) {
+    auto aData = reinterpret_cast<const uint64_t*>(a.data());
+    auto bData = reinterpret_cast<const uint64_t*>(b.data());
+    while (i + 4 <= a.size() && j + 4 <= b.size()) {
+        auto mask = blockMatchMask(aData + i, bData + j);
+        for (int k = 0; k < 4; k++) {
+            if (mask & (1 << k)) {
+                out.push_back(a[i + k]);
+            }
+        }
+
+        // Move past the block(s) with the smaller maximum. The elements
+        // of that block cannot match any element in the other array's
+        // later blocks.
+        auto aMax = a[i + 3], bMax = b[j + 3];
+        i += aMax <= bMax ? 4 : 0;
+        j += bMax <= aMax ? 4 : 0;
+    }
+}
+
+// Subtracts b from whole blocks of a, advancing i and j past the blocks
+// compared. The bits of the elements in a's current block which have been
+// matched are left in matched.
+template <class T>
+BENTOBOX_AVX2_TARGET void subtractBlocks(std::span<const T> a,
+                                         std::span<const T> b,
+                                         std::vector<T>& out, size_t& i,
+                                         size_t& j, int& matched) {
+    auto aData = reinterpret_cast<const uint64_t*>(a.data());
+    auto bData = reinterpret_cast<const uint64_t*>(b.data());
+    while (i + 4 <= a.size() && j + 4 <= b.size()) {
+        matched |= blockMatchMask(aData + i, bData + j);
+
+        auto aMax = a[i + 3], bMax = b[j + 3];
+        if (aMax <= bMax) {
+            // No later block of b can match this block of a, so the
+            // unmatched elements are in the difference
+            for (int k = 0; k < 4; k++) {
+                if (!(matched & (1 << k))) {
+                    out.push_back(a[i + k]);
+                }
+            }
+            matched = 0;
+            i += 4;
+        }
+        j += bMax <= aMax ? 4 : 0;
+    }
+}
+#endif
+}  // namespace detail
+
+template <class T>
+void sortedIntersection(std::span<const T> a, std::span<const T> b,
+                        std::vector<T>& out) {
+    size_t i = 0, j = 0;
+#ifdef BENTOBOX_AVX2_TARGET
+    if constexpr (std::is_unsigned_v<T> && sizeof(T) == 8) {
+        if (detail::hasAvx2()) {
+            detail::intersectBlocks(a, b, out, i, j);
+        }
+    }
+#endif
+    while (i < a.size() && j < b.size()) {
+        if (a[i] < b[j]) {
+            ++i;
+        } else if (b[j] < a[i]) {
+            ++j;
+        } else {
+            out.push_back(a[i]);
+            ++i;
+            ++j;
+        }
+    }
+}
+
+template <class T>
+void sortedDifference(std::span<const T> a, std::span<const T> b,
+                      std::vector<T>& out) {
+    size_t i = 0, j = 0;
+    // Bits of the elements in the current block of a that have been matched
+    int matched = 0;
+#ifdef BENTOBOX_AVX2_TARGET
+    if constexpr (std::is_unsigned_v<T> && sizeof(T) == 8) {
+        if (detail::hasAvx2()) {
+            detail::subtractBlocks(a, b, out, i, j, matched);
+        }
+    }
+#endif
+    for (size_t start = i; i < a.size(); i++) {
+        // Skip elements of the current block already matched by SIMD
+        if (i - start < 4 && (matched & (1 << (i - start)))) {
+            continue;
+        }
+
+        while (j < b.size() && b[j] < a[i]) {
+            ++j;
+        }
+        if (j >= b.size() || a[i] < b[j]) {
+            out.push_back(a[i]);
+        }
+    }
+}
+
+template <class T>
+void sortedUnion(std::span<const T> a, std::span<const T> b,
+                 std::vector<T>& out) {
+    // A union writes every element of both arrays, so it is bound by the
+    // writes rather than by comparisons. A linear merge is used.
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(),
+                   std::back_inserter(out));
+}
+}  // namespace util
+
+#endif  // BENTOBOX_SORTEDSETOPS_H
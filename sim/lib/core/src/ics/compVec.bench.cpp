@@ -0,0 +1,62 @@
+#include <benchmark/benchmark.h>
+#include <core/ics/compVec.h>
+#include <core/ics/component.h>
+
+#include <vector>
+
+using namespace ics;
+
+namespace {
+struct BenchComp : public BaseComponent {
+    float x;
+    float y;
+};
+
+// Adds the given number of components to the vec, returning their IDs
+std::vector<CompId> fill(CompVec<BenchComp>& vec, int64_t count) {
+    std::vector<CompId> ids;
+    ids.reserve(count);
+    for (int64_t i = 0; i < count; i++) {
+        ids.push_back(vec.add(BenchComp{{}, float(i), float(i)}));
+    }
+    return ids;
+}
+}  // namespace
+
+static void BM_CompVecAdd(benchmark::State& state) {
+    for (auto _ : state) {
+        CompVec<BenchComp> vec;
+        fill(vec, state.range(0));
+        benchmark::DoNotOptimize(vec.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CompVecAdd)->RangeMultiplier(10)->Range(100, 1000000);
+
+static void BM_CompVecAt(benchmark::State& state) {
+    CompVec<BenchComp> vec;
+    auto ids = fill(vec, state.range(0));
+    for (auto _ : state) {
+        for (auto id : ids) {
+            benchmark::DoNotOptimize(vec.at(id));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CompVecAt)->RangeMultiplier(10)->Range(100, 1000000);
+
+static void BM_CompVecRemove(benchmark::State& state) {
+    for (auto _ : state) {
+        state.PauseTiming();
+        CompVec<BenchComp> vec;
+        auto ids = fill(vec, state.range(0));
+        state.ResumeTiming();
+
+        for (auto id : ids) {
+            vec.remove(id);
+        }
+        benchmark::DoNotOptimize(vec.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CompVecRemove)->RangeMultiplier(10)->Range(100, 1000000);
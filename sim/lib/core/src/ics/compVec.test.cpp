@@ -14,7 +14,7 @@ struct TestComp : public BaseComponent {
 
 TEST(TEST_SUITE, StoreAndRetrieve) {
     auto vec = CompVec<TestComp>();
-    auto id = vec.add(TestComp{true, 3});
+    auto id = vec.add(TestComp{{}, 3});
 
     TestComp value = vec.at(id);
     ASSERT_EQ(value.height, 3);
@@ -27,7 +27,7 @@ TEST(TEST_SUITE, RetrieveNonExistentComponent) {
 
 TEST(TEST_SUITE, RetrieveDeletedComponent) {
     auto vec = CompVec<TestComp>();
-    auto id = vec.add(TestComp{true, 3});
+    auto id = vec.add(TestComp{{}, 3});
     vec.remove(id);
     EXPECT_THROW(vec.at(id), std::out_of_range);
     EXPECT_THROW(vec[id], std::out_of_range);
@@ -37,7 +37,7 @@ TEST(TEST_SUITE, RetrieveByReference) {
     auto vec = CompVec<TestComp>();
 
     {
-        auto idx = vec.add(TestComp{true, 3});
+        auto idx = vec.add(TestComp{{}, 3});
 
         TestComp &comp = vec.at(idx);
         comp.height = 2;
@@ -47,7 +47,7 @@ TEST(TEST_SUITE, RetrieveByReference) {
     }
 
     {
-        auto idx = vec.add(TestComp{true, 3});
+        auto idx = vec.add(TestComp{{}, 3});
 
         TestComp &comp = vec[idx];
         comp.height = 2;
@@ -59,14 +59,105 @@ TEST(TEST_SUITE, RetrieveByReference) {
 
 TEST(TEST_SUITE, StoreAsUnknownAndRetrieve) {
     auto vec = CompVec<TestComp>();
-    auto trueCompId = vec.add(TestComp{true, 3});
-    auto falseCompId = vec.add(TestComp{false, 3});
-    vec.add(TestComp{true, 3});
+    auto firstCompId = vec.add(TestComp{{}, 3});
+    auto removedCompId = vec.add(TestComp{{}, 5});
+    auto lastCompId = vec.add(TestComp{{}, 7});
+    vec.remove(removedCompId);
     CompVec<TestComp> *vecPtr = &vec;
 
     auto storedVec = reinterpret_cast<CompVec<BaseComponent> *>(vecPtr);
 
-    ASSERT_EQ(storedVec->size(), 3);
-    ASSERT_TRUE(storedVec->at(trueCompId).isActive);
-    EXPECT_THROW(storedVec->at(falseCompId), std::out_of_range);
+    ASSERT_EQ(storedVec->size(), 2);
+    ASSERT_NO_THROW(storedVec->at(firstCompId));
+    ASSERT_NO_THROW(storedVec->at(lastCompId));
+    EXPECT_THROW(storedVec->at(removedCompId), std::out_of_range);
+
+    // Removing through the type erased CompVec keeps the components intact
+    storedVec->remove(firstCompId);
+    ASSERT_EQ(vec.size(), 1);
+    ASSERT_EQ(vec.at(lastCompId).height, 7);
+}
+
+TEST(TEST_SUITE, RemoveKeepsComponentsPacked) {
+    auto vec = CompVec<TestComp>();
+    auto id1 = vec.add(TestComp{{}, 1});
+    auto id2 = vec.add(TestComp{{}, 2});
+    auto id3 = vec.add(TestComp{{}, 3});
+
+    vec.remove(id1);
+    ASSERT_EQ(vec.size(), 2);
+    ASSERT_EQ(vec.ids().size(), 2);
+    // The remaining components should still be reachable by their ids
+    ASSERT_EQ(vec.at(id2).height, 2);
+    ASSERT_EQ(vec.at(id3).height, 3);
+    ASSERT_FALSE(vec.contains(id1));
+    ASSERT_TRUE(vec.contains(id2));
+    ASSERT_TRUE(vec.contains(id3));
+}
+
+TEST(TEST_SUITE, StaleIdAfterSlotReuse) {
+    auto vec = CompVec<TestComp>();
+    auto oldId = vec.add(TestComp{{}, 1});
+    vec.remove(oldId);
+
+    // The freed slot is reused, but with a new generation
+    auto newId = vec.add(TestComp{{}, 2});
+    ASSERT_NE(oldId, newId);
+    EXPECT_THROW(vec.at(oldId), std::out_of_range);
+    ASSERT_EQ(vec.at(newId).height, 2);
+}
+
+TEST(TEST_SUITE, IterateComponents) {
+    auto vec = CompVec<TestComp>();
+    vec.add(TestComp{{}, 1});
+    auto removedId = vec.add(TestComp{{}, 2});
+    vec.add(TestComp{{}, 3});
+    vec.remove(removedId);
+
+    int sum = 0;
+    for (auto &comp : vec) {
+        sum += comp.height;
+    }
+    ASSERT_EQ(sum, 4);
+
+    // Components can be modified through the iterator
+    for (auto &comp : vec) {
+        comp.height *= 10;
+    }
+    ASSERT_EQ(vec.begin()->height + (vec.begin() + 1)->height, 40);
+}
+
+TEST(TEST_SUITE, IterateEntries) {
+    auto vec = CompVec<TestComp>();
+    auto id1 = vec.add(TestComp{{}, 1});
+    auto id2 = vec.add(TestComp{{}, 2});
+    auto id3 = vec.add(TestComp{{}, 3});
+    vec.remove(id1);
+
+    int count = 0;
+    for (auto [compId, comp] : vec.entries()) {
+        // Each entry should pair the component with its own CompId
+        ASSERT_EQ(&vec.at(compId), &comp);
+        ASSERT_TRUE(compId == id2 || compId == id3);
+        ++count;
+    }
+    ASSERT_EQ(count, 2);
+    ASSERT_TRUE(std::ranges::random_access_range<decltype(vec.entries())>);
+}
+
+TEST(TEST_SUITE, ReserveThroughTypeErasedVec) {
+    auto vec = CompVec<TestComp>();
+    auto firstCompId = vec.add(TestComp{{}, 3});
+    auto storedVec = reinterpret_cast<CompVec<BaseComponent> *>(&vec);
+
+    // Reserving moves the stored components, which needs their real type
+    storedVec->reserve(100);
+    ASSERT_EQ(vec.size(), 1);
+    ASSERT_EQ(vec.at(firstCompId).height, 3);
+
+    auto data = vec.begin();
+    for (int i = 0; i < 99; i++) {
+        vec.add(TestComp{{}, i});
+    }
+    ASSERT_EQ(vec.begin(), data);
 }
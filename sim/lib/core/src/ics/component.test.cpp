@@ -11,15 +11,9 @@ struct DerivedComp : public BaseComponent {
 };
 
 TEST(TEST_SUITE, DerivedComponentsEquivalence) {
-    auto d1 = DerivedComp{
-        .height = 3,
-        .c = 'c',
-    };
+    auto d1 = DerivedComp{{}, 3, 'c'};
 
-    auto d2 = DerivedComp{
-        .height = 3,
-        .c = 'c',
-    };
+    auto d2 = DerivedComp{{}, 3, 'c'};
 
     auto d3 = d1;
 
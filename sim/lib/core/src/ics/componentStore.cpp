@@ -1,17 +1,66 @@
 #include <core/ics/componentStore.h>
 
 namespace ics {
-ComponentSet asCompSet(const ComponentStore &store) {
-    ComponentSet set;
-    for (auto &index_ptr_pair : store) {
-        auto &a = *index_ptr_pair.second;
-        // TODO(joeltio): This requires knowledge on how CompVec creates IDs.
-        // TODO(joeltio): iter functionality for compVec
-        for (auto i = 1; i <= a.size(); ++i) {
-            set.emplace(index_ptr_pair.first, i);
-        }
-    }
-
-    return set;
+CompSetView::iterator CompSetView::begin() const {
+    if (store == nullptr) {
+        return iterator();
+    }
+    if (allGroups) {
+        return iterator(store->begin(), store->end());
+    }
+
+    auto groupIt = store->find(group);
+    auto groupEnd = groupIt == store->end() ? groupIt : std::next(groupIt);
+    return iterator(groupIt, groupEnd);
+}
+
+CompSetView::iterator CompSetView::end() const {
+    if (store == nullptr) {
+        return iterator();
+    }
+    if (allGroups) {
+        return iterator(store->end(), store->end());
+    }
+
+    auto groupIt = store->find(group);
+    auto groupEnd = groupIt == store->end() ? groupIt : std::next(groupIt);
+    return iterator(groupEnd, groupEnd);
+}
+
+CompVec<BaseComponent>::size_type CompSetView::size() const {
+    if (store == nullptr) {
+        return 0;
+    }
+    if (!allGroups) {
+        return store->contains(group) ? store->at(group)->size() : 0;
+    }
+
+    CompVec<BaseComponent>::size_type total = 0;
+    for (auto &groupVecPair : *store) {
+        total += groupVecPair.second->size();
+    }
+    return total;
+}
+
+bool CompSetView::contains(const CompStoreId &compStoreId) const {
+    if (store == nullptr || (!allGroups && compStoreId.first != group)) {
+        return false;
+    }
+
+    auto groupIt = store->find(compStoreId.first);
+    return groupIt != store->end() &&
+           groupIt->second->contains(compStoreId.second);
+}
+
+CompSetView CompSetView::withGroup(CompGroup group) const {
+    if (store == nullptr || (!allGroups && this->group != group)) {
+        // The groups do not overlap, so the view is empty
+        return CompSetView();
+    }
+    return CompSetView(*store, group);
+}
+
+CompSetView asCompSet(const ComponentStore &store) {
+    return CompSetView(store);
 }
 }  // namespace ics
@@ -22,7 +22,7 @@ TEST(TEST_SUITE, CreateVec) {
 TEST(TEST_SUITE, CreateCompVecReturnsReference) {
     ComponentStore store;
     auto& vec = createCompVec<TestComponent>(store, 1);
-    vec.add(TestComponent{true, 20});
+    vec.add(TestComponent{{}, 20});
 
     auto retrievedVec = std::any_cast<CompVec<BaseComponent>>(*store.at(1));
     ASSERT_EQ(retrievedVec.size(), 1);
@@ -31,7 +31,7 @@ TEST(TEST_SUITE, CreateCompVecReturnsReference) {
 TEST(TEST_SUITE, GetComponentsRetrievesComponents) {
     ComponentStore store;
     auto& vec = createCompVec<TestComponent>(store, 1);
-    auto compId = vec.add(TestComponent{true, 20});
+    auto compId = vec.add(TestComponent{{}, 20});
 
     auto retrievedVec = getCompVec<TestComponent>(store, 1);
     ASSERT_EQ(retrievedVec.at(compId).height, 20);
@@ -42,7 +42,7 @@ TEST(TEST_SUITE, GetComponentsRetrievesComponentsByReference) {
     createCompVec<TestComponent>(store, 1);
 
     auto& vec1 = getCompVec<TestComponent>(store, 1);
-    vec1.add(TestComponent{true, 20});
+    vec1.add(TestComponent{{}, 20});
     auto& vec2 = getCompVec<TestComponent>(store, 1);
     ASSERT_EQ(vec2.size(), 1);
 }
@@ -50,7 +50,7 @@ TEST(TEST_SUITE, GetComponentsRetrievesComponentsByReference) {
 TEST(TEST_SUITE, AddComponentsCreatesNewVec) {
     ComponentStore store;
     ASSERT_EQ(store.size(), 0);
-    addComponent(store, TestComponent{true, 20}, 1);
+    addComponent(store, TestComponent{{}, 20}, 1);
     ASSERT_EQ(store.size(), 1);
 }
 
@@ -61,7 +61,7 @@ TEST(TEST_SUITE, AddComponentsAppendsToVec) {
     ASSERT_EQ(getCompVec<TestComponent>(store, 1).size(), 0);
 
     // Ensure that no new vectors are created
-    auto compFullId = addComponent(store, TestComponent{true, 20}, 1);
+    auto compFullId = addComponent(store, TestComponent{{}, 20}, 1);
     ASSERT_EQ(store.size(), 1);
 
     // Ensure that the item is actually appended
@@ -74,12 +74,12 @@ TEST(TEST_SUITE, AsCompSet) {
     ComponentStore store;
     ASSERT_EQ(asCompSet(store).size(), 0);
 
-    addComponent(store, TestComponent{true, 20}, 1);
-    addComponent(store, TestComponent{true, 20}, 1);
-    addComponent(store, TestComponent{true, 20}, 1);
-    addComponent(store, TestComponent{true, 20}, 1);
-    addComponent(store, TestComponent{true, 20}, 2);
-    addComponent(store, TestComponent{true, 20}, 2);
+    addComponent(store, TestComponent{{}, 20}, 1);
+    addComponent(store, TestComponent{{}, 20}, 1);
+    addComponent(store, TestComponent{{}, 20}, 1);
+    addComponent(store, TestComponent{{}, 20}, 1);
+    addComponent(store, TestComponent{{}, 20}, 2);
+    addComponent(store, TestComponent{{}, 20}, 2);
 
     int group1Count = 0;
     int group2Count = 0;
@@ -97,11 +97,77 @@ TEST(TEST_SUITE, AsCompSet) {
 
 TEST(TEST_SUITE, GetComponentByReference) {
     ComponentStore store;
-    auto compId = addComponent(store, TestComponent{true, 20}, 1);
+    auto compId = addComponent(store, TestComponent{{}, 20}, 1);
     ics::Component auto& comp = getComponent<TestComponent>(store, compId);
 
     ASSERT_EQ(comp.height, 20);
     comp.height = 50;
     auto retrievedComp = getComponent<TestComponent>(store, compId);
     ASSERT_EQ(retrievedComp.height, 50);
-}
\ No newline at end of file
+}
+
+TEST(TEST_SUITE, ViewComponents) {
+    ComponentStore store;
+    auto removedId = addComponent(store, TestComponent{{}, 20}, 1);
+    addComponent(store, TestComponent{{}, 30}, 1);
+    addComponent(store, TestComponent{{}, 40}, 2);
+    getCompVec<TestComponent>(store, 1).remove(removedId.second);
+
+    int count = 0;
+    for (auto [compStoreId, comp] : viewComponents<TestComponent>(store, 1)) {
+        ASSERT_EQ(compStoreId.first, 1);
+        ASSERT_EQ(comp.height, 30);
+        comp.height = 50;
+        ++count;
+    }
+    ASSERT_EQ(count, 1);
+
+    // Components yielded by the view are references into the store
+    for (auto& comp : getCompVec<TestComponent>(store, 1)) {
+        ASSERT_EQ(comp.height, 50);
+    }
+}
+
+TEST(TEST_SUITE, AsCompSetAfterRemoval) {
+    ComponentStore store;
+    auto removedId = addComponent(store, TestComponent{{}, 20}, 1);
+    auto keptId = addComponent(store, TestComponent{{}, 20}, 1);
+    getCompVec<TestComponent>(store, 1).remove(removedId.second);
+
+    auto compSet = asCompSet(store);
+    ASSERT_EQ(compSet.size(), 1);
+    ASSERT_TRUE(compSet.contains(keptId));
+    ASSERT_FALSE(compSet.contains(removedId));
+}
+
+TEST(TEST_SUITE, AsCompSetIsLazy) {
+    ComponentStore store;
+    auto compSet = asCompSet(store);
+    ASSERT_TRUE(compSet.empty());
+
+    // Components added after the view is created are seen by the view
+    auto compStoreId = addComponent(store, TestComponent{{}, 20}, 1);
+    ASSERT_EQ(compSet.size(), 1);
+    ASSERT_EQ(*compSet.begin(), compStoreId);
+}
+
+TEST(TEST_SUITE, AsCompSetWithGroup) {
+    ComponentStore store;
+    addComponent(store, TestComponent{{}, 20}, 1);
+    addComponent(store, TestComponent{{}, 30}, 1);
+    auto otherGroupId = addComponent(store, TestComponent{{}, 40}, 2);
+    // Empty groups are skipped when iterating
+    createCompVec<TestComponent>(store, 3);
+
+    auto compSet = asCompSet(store);
+    ASSERT_EQ(std::ranges::distance(compSet), 3);
+
+    auto groupSet = compSet.withGroup(2);
+    ASSERT_EQ(groupSet.size(), 1);
+    ASSERT_EQ(*groupSet.begin(), otherGroupId);
+    ASSERT_TRUE(compSet.contains(otherGroupId));
+
+    // Narrowing to a group outside of the view gives an empty view
+    ASSERT_TRUE(groupSet.withGroup(1).empty());
+    ASSERT_TRUE(compSet.withGroup(4).empty());
+}
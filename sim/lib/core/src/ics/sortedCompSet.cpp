@@ -0,0 +1,113 @@
+#include <core/ics/sortedCompSet.h>
+#include <core/ics/util/sortedSetOps.h>
+
+namespace ics {
+const SortedCompSet::GroupIds* SortedCompSet::findGroup(
+    CompGroup group) const {
+    auto it = std::lower_bound(
+        groups.begin(), groups.end(), group,
+        [](const auto& groupIds, CompGroup g) { return groupIds.first < g; });
+    if (it == groups.end() || it->first != group) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+size_t SortedCompSet::size() const {
+    size_t total = 0;
+    for (auto& [group, ids] : groups) {
+        total += ids.size();
+    }
+    return total;
+}
+
+bool SortedCompSet::contains(const CompStoreId& compStoreId) const {
+    auto ids = findGroup(compStoreId.first);
+    return ids != nullptr &&
+           std::binary_search(ids->begin(), ids->end(), compStoreId.second);
+}
+
+void SortedCompSet::insert(const CompStoreId& compStoreId) {
+    auto& [group, compId] = compStoreId;
+    auto groupIt = std::lower_bound(
+        groups.begin(), groups.end(), group,
+        [](const auto& groupIds, CompGroup g) { return groupIds.first < g; });
+    if (groupIt == groups.end() || groupIt->first != group) {
+        groupIt = groups.emplace(groupIt, group, GroupIds());
+    }
+
+    auto& ids = groupIt->second;
+    auto idIt = std::lower_bound(ids.begin(), ids.end(), compId);
+    if (idIt == ids.end() || *idIt != compId) {
+        ids.insert(idIt, compId);
+    }
+}
+
+std::span<const CompId> SortedCompSet::groupIds(CompGroup group) const {
+    auto ids = findGroup(group);
+    if (ids == nullptr) {
+        return std::span<const CompId>();
+    }
+    return std::span<const CompId>(*ids);
+}
+
+SortedCompSet SortedCompSet::withGroup(CompGroup group) const {
+    SortedCompSet groupSet;
+    auto ids = findGroup(group);
+    if (ids != nullptr) {
+        groupSet.groups.emplace_back(group, *ids);
+    }
+    return groupSet;
+}
+
+SortedCompSet SortedCompSet::combine(
+    const SortedCompSet& a, const SortedCompSet& b, bool keepOnlyA,
+    bool keepOnlyB,
+    void (*op)(std::span<const CompId>, std::span<const CompId>,
+               std::vector<CompId>&)) {
+    SortedCompSet result;
+    auto aIt = a.groups.begin(), bIt = b.groups.begin();
+    while (aIt != a.groups.end() || bIt != b.groups.end()) {
+        if (bIt == b.groups.end() ||
+            (aIt != a.groups.end() && aIt->first < bIt->first)) {
+            if (keepOnlyA) {
+                result.groups.push_back(*aIt);
+            }
+            ++aIt;
+        } else if (aIt == a.groups.end() || bIt->first < aIt->first) {
+            if (keepOnlyB) {
+                result.groups.push_back(*bIt);
+            }
+            ++bIt;
+        } else {
+            GroupIds ids;
+            op(aIt->second, bIt->second, ids);
+            if (!ids.empty()) {
+                result.groups.emplace_back(aIt->first, std::move(ids));
+            }
+            ++aIt;
+            ++bIt;
+        }
+    }
+    return result;
+}
+
+SortedCompSet SortedCompSet::intersect(const SortedCompSet& a,
+                                       const SortedCompSet& b) {
+    return combine(a, b, false, false, &util::sortedIntersection<CompId>);
+}
+
+SortedCompSet SortedCompSet::unite(const SortedCompSet& a,
+                                   const SortedCompSet& b) {
+    return combine(a, b, true, true, &util::sortedUnion<CompId>);
+}
+
+SortedCompSet SortedCompSet::subtract(const SortedCompSet& a,
+                                      const SortedCompSet& b) {
+    return combine(a, b, true, false, &util::sortedDifference<CompId>);
+}
+
+SortedCompSet asSortedCompSet(const ComponentStore& store) {
+    return SortedCompSet(asCompSet(store));
+}
+}  // namespace ics
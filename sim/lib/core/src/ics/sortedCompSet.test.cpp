@@ -0,0 +1,70 @@
+#include <core/ics/componentStore.h>
+#include <core/ics/sortedCompSet.h>
+#include <gtest/gtest.h>
+
+#define TEST_SUITE SortedCompSetTest
+
+using namespace ics;
+
+TEST(TEST_SUITE, CreateFromUnsortedIds) {
+    std::vector<CompStoreId> ids{{2, 5}, {1, 9}, {2, 1}, {1, 9}, {1, 3}};
+    SortedCompSet set(ids);
+    ASSERT_EQ(set.size(), 4);
+    ASSERT_TRUE(set.contains({2, 1}));
+    ASSERT_FALSE(set.contains({1, 5}));
+
+    // Iterates in (group, CompId) order
+    std::vector<CompStoreId> iterated(set.begin(), set.end());
+    std::vector<CompStoreId> expected{{1, 3}, {1, 9}, {2, 1}, {2, 5}};
+    ASSERT_EQ(iterated, expected);
+}
+
+TEST(TEST_SUITE, InsertAndWithGroup) {
+    SortedCompSet set;
+    ASSERT_TRUE(set.empty());
+    set.insert({3, 4});
+    set.insert({1, 8});
+    set.insert({3, 2});
+    set.insert({3, 4});
+    ASSERT_EQ(set.size(), 3);
+
+    auto groupIds = set.groupIds(3);
+    ASSERT_EQ(groupIds.size(), 2);
+    ASSERT_EQ(groupIds[0], 2);
+    ASSERT_EQ(set.withGroup(3).size(), 2);
+    ASSERT_TRUE(set.withGroup(2).empty());
+}
+
+TEST(TEST_SUITE, SetOperations) {
+    SortedCompSet a(std::vector<CompStoreId>{{1, 1}, {1, 2}, {2, 3}, {4, 1}});
+    SortedCompSet b(std::vector<CompStoreId>{{1, 2}, {2, 4}, {3, 1}, {4, 1}});
+
+    auto intersection = util::setIntersection(a, b);
+    ASSERT_EQ(intersection.size(), 2);
+    ASSERT_TRUE(intersection.contains({1, 2}));
+    ASSERT_TRUE(intersection.contains({4, 1}));
+    // Groups left empty by the intersection are dropped
+    ASSERT_TRUE(intersection.groupIds(2).empty());
+
+    ASSERT_EQ(util::setUnion(a, b).size(), 6);
+
+    auto difference = util::setDifference(a, b);
+    ASSERT_EQ(difference.size(), 2);
+    ASSERT_TRUE(difference.contains({1, 1}));
+    ASSERT_TRUE(difference.contains({2, 3}));
+}
+
+TEST(TEST_SUITE, CreateFromStore) {
+    struct TestComponent : public BaseComponent {
+        int height;
+    };
+    ComponentStore store;
+    for (int i = 0; i < 5; i++) {
+        addComponent(store, TestComponent{{}, i}, i % 2);
+    }
+
+    auto set = asSortedCompSet(store);
+    ASSERT_EQ(set.size(), 5);
+    ASSERT_EQ(set.groupIds(0).size(), 3);
+    ASSERT_TRUE(std::is_sorted(set.groupIds(0).begin(), set.groupIds(0).end()));
+}
@@ -1,7 +1,9 @@
 #include <core/ics/util/composable.h>
 #include <gtest/gtest.h>
 
+#include <ranges>
 #include <string>
+#include <vector>
 
 #define TEST_SUITE ComposableTest
 
@@ -27,3 +29,23 @@ TEST(TEST_SUITE, ComposeByReference) {
     auto val = Composable<Store&>(store) | &j;
     ASSERT_EQ(*val.data.at(1), 10);
 }
+
+TEST(TEST_SUITE, ComposeViews) {
+    std::vector<int> values{1, 2, 3, 4, 5, 6};
+    auto isEven = [](auto&& range) {
+        return std::views::filter(range, [](int x) { return x % 2 == 0; });
+    };
+    auto square = [](auto&& range) {
+        return std::views::transform(range, [](int x) { return x * x; });
+    };
+
+    // Views are moved along the chain and evaluated only when iterated
+    auto val = Composable<std::vector<int>&>(values) | isEven | square;
+    values.push_back(8);
+
+    int sum = 0;
+    for (int x : val.data) {
+        sum += x;
+    }
+    ASSERT_EQ(sum, 4 + 16 + 36 + 64);
+}
@@ -0,0 +1,61 @@
+#include <core/ics/util/memoryUsage.h>
+#include <core/ics/util/smallVector.h>
+#include <gtest/gtest.h>
+
+#define TEST_SUITE MemoryUsageTest
+
+using namespace util;
+
+namespace {
+struct Reporting {
+    size_t getMemoryUsage() const { return 100; }
+};
+}  // namespace
+
+TEST(TEST_SUITE, Vector) {
+    std::vector<int> vec;
+    ASSERT_EQ(getMemoryUsage(vec), 0);
+    vec.reserve(10);
+    ASSERT_EQ(getMemoryUsage(vec), 10 * sizeof(int));
+
+    // The memory held by the elements is counted too
+    std::vector<Reporting> reporting(2);
+    ASSERT_EQ(getMemoryUsage(reporting),
+              reporting.capacity() * sizeof(Reporting) + 200);
+}
+
+TEST(TEST_SUITE, String) {
+    // Short strings are stored inline
+    ASSERT_EQ(getMemoryUsage(std::string("short")), 0);
+    std::string longStr(100, 'a');
+    ASSERT_GE(getMemoryUsage(longStr), 100);
+}
+
+TEST(TEST_SUITE, NestedContainers) {
+    std::unordered_map<int, std::vector<int>> map;
+    map[1].reserve(50);
+    ASSERT_GE(getMemoryUsage(map), map.bucket_count() * sizeof(void*) +
+                                       sizeof(std::vector<int>) +
+                                       50 * sizeof(int));
+
+    std::map<std::string, Reporting> sorted;
+    sorted[std::string(100, 'a')];
+    ASSERT_GE(getMemoryUsage(sorted), 200);
+
+    std::vector<std::unique_ptr<Reporting>> ptrs;
+    ptrs.push_back(std::make_unique<Reporting>());
+    ptrs.push_back(nullptr);
+    ASSERT_EQ(getMemoryUsage(ptrs),
+              ptrs.capacity() * sizeof(std::unique_ptr<Reporting>) +
+                  sizeof(Reporting) + 100);
+}
+
+TEST(TEST_SUITE, SmallVector) {
+    SmallVector<int, 2> vec;
+    vec.push_back(1);
+    vec.push_back(2);
+    ASSERT_EQ(getMemoryUsage(vec), 0);
+    // Spills to the heap once the elements no longer fit inline
+    vec.push_back(3);
+    ASSERT_GE(getMemoryUsage(vec), 3 * sizeof(int));
+}
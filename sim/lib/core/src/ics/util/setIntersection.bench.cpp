@@ -0,0 +1,24 @@
+#include <benchmark/benchmark.h>
+#include <core/ics/util/setIntersection.h>
+
+#include <unordered_set>
+
+using namespace util;
+
+// Intersects a set with one 10 times larger that contains every other element
+// of the smaller set
+static void BM_SetIntersection(benchmark::State& state) {
+    std::unordered_set<int> small, large;
+    for (int i = 0; i < state.range(0); i++) {
+        small.insert(i);
+    }
+    for (int i = 0; i < state.range(0) * 10; i++) {
+        large.insert(i * 2);
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(setIntersection(small, large));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SetIntersection)->RangeMultiplier(10)->Range(100, 1000000);
@@ -0,0 +1,46 @@
+#include <core/ics/util/smallVector.h>
+#include <gtest/gtest.h>
+
+#define TEST_SUITE SmallVectorTest
+
+using namespace util;
+
+TEST(TEST_SUITE, PushAndErase) {
+    SmallVector<int, 2> vec;
+    ASSERT_TRUE(vec.empty());
+    vec.push_back(1);
+    vec.push_back(2);
+    ASSERT_EQ(vec.size(), 2);
+    ASSERT_TRUE(vec.contains(2));
+
+    ASSERT_TRUE(vec.erase(1));
+    ASSERT_FALSE(vec.erase(1));
+    ASSERT_EQ(vec.size(), 1);
+    ASSERT_EQ(vec[0], 2);
+}
+
+TEST(TEST_SUITE, SpillsToHeapAndBack) {
+    SmallVector<int, 2> vec;
+    for (int i = 0; i < 5; i++) {
+        vec.push_back(i);
+    }
+    ASSERT_EQ(vec.size(), 5);
+
+    int sum = 0;
+    for (int x : vec) {
+        sum += x;
+    }
+    ASSERT_EQ(sum, 10);
+
+    // The order of the elements is kept when they move back inline
+    vec.erase(0);
+    vec.erase(2);
+    vec.erase(3);
+    auto span = vec.span();
+    ASSERT_EQ(span.size(), 2);
+    ASSERT_EQ(span[0], 1);
+    ASSERT_EQ(span[1], 4);
+
+    vec.push_back(7);
+    ASSERT_EQ(vec[2], 7);
+}
@@ -0,0 +1,68 @@
+#include <core/ics/util/sortedSetOps.h>
+#include <gtest/gtest.h>
+
+#include <set>
+
+#define TEST_SUITE SortedSetOpsTest
+
+using namespace util;
+
+namespace {
+// Creates a sorted array of every step-th number in [start, end)
+std::vector<uint64_t> stepRange(uint64_t start, uint64_t end, uint64_t step) {
+    std::vector<uint64_t> range;
+    for (auto x = start; x < end; x += step) {
+        range.push_back(x);
+    }
+    return range;
+}
+}  // namespace
+
+TEST(TEST_SUITE, OperationsWithEmptySet) {
+    std::vector<uint64_t> empty;
+    auto set = stepRange(0, 10, 1);
+    std::vector<uint64_t> out;
+
+    sortedIntersection<uint64_t>(set, empty, out);
+    ASSERT_TRUE(out.empty());
+    sortedDifference<uint64_t>(empty, set, out);
+    ASSERT_TRUE(out.empty());
+    sortedDifference<uint64_t>(set, empty, out);
+    ASSERT_EQ(out, set);
+    out.clear();
+    sortedUnion<uint64_t>(empty, set, out);
+    ASSERT_EQ(out, set);
+}
+
+TEST(TEST_SUITE, MatchesStdSetOperations) {
+    // Sizes which are not multiples of 4 exercise both the block and the
+    // scalar paths
+    std::vector<std::pair<std::vector<uint64_t>, std::vector<uint64_t>>> cases{
+        {stepRange(0, 1000, 2), stepRange(0, 1000, 3)},
+        {stepRange(0, 1003, 1), stepRange(500, 530, 7)},
+        {stepRange(7, 50, 5), stepRange(0, 2000, 1)},
+        {stepRange(0, 10, 1), stepRange(10, 20, 1)},
+    };
+
+    for (auto& [a, b] : cases) {
+        std::vector<uint64_t> expected, out;
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(),
+                              std::back_inserter(expected));
+        sortedIntersection<uint64_t>(a, b, out);
+        ASSERT_EQ(out, expected);
+
+        expected.clear();
+        out.clear();
+        std::set_difference(a.begin(), a.end(), b.begin(), b.end(),
+                            std::back_inserter(expected));
+        sortedDifference<uint64_t>(a, b, out);
+        ASSERT_EQ(out, expected);
+
+        expected.clear();
+        out.clear();
+        std::set_union(a.begin(), a.end(), b.begin(), b.end(),
+                       std::back_inserter(expected));
+        sortedUnion<uint64_t>(a, b, out);
+        ASSERT_EQ(out, expected);
+    }
+}
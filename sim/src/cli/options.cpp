@@ -0,0 +1,56 @@
+#include <cli/options.h>
+
+#include <stdexcept>
+
+namespace cli {
+
+Options::Options(int argc, char* argv[], int start) {
+    for (int i = start; i < argc; i += 2) {
+        std::string name = argv[i];
+        if (name.rfind("--", 0) != 0 || i + 1 >= argc) {
+            throw std::invalid_argument("Expected --option value, got: " +
+                                        name);
+        }
+        values[name.substr(2)] = argv[i + 1];
+    }
+}
+
+std::string Options::take(const std::string& name,
+                          const std::string& defaultValue) {
+    auto it = values.find(name);
+    if (it == values.end()) {
+        return defaultValue;
+    }
+    auto value = it->second;
+    values.erase(it);
+    return value;
+}
+
+uint32_t Options::take(const std::string& name, uint32_t defaultValue) {
+    auto value = take(name, std::string());
+    return value.empty() ? defaultValue : std::stoul(value);
+}
+
+uint64_t Options::take(const std::string& name, uint64_t defaultValue) {
+    auto value = take(name, std::string());
+    return value.empty() ? defaultValue : std::stoull(value);
+}
+
+float Options::take(const std::string& name, float defaultValue) {
+    auto value = take(name, std::string());
+    return value.empty() ? defaultValue : std::stof(value);
+}
+
+double Options::take(const std::string& name, double defaultValue) {
+    auto value = take(name, std::string());
+    return value.empty() ? defaultValue : std::stod(value);
+}
+
+void Options::checkAllTaken() const {
+    if (!values.empty()) {
+        throw std::invalid_argument("Unknown option: --" +
+                                    values.begin()->first);
+    }
+}
+
+}  // namespace cli
@@ -0,0 +1,96 @@
+#include <commandBuffer.h>
+#include <ics.h>
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+
+namespace ics {
+namespace {
+// Ensures that components of the given types can be created when the buffer
+// is flushed, so that flushing does not fail halfway
+void checkSpawnGroups(const index::IndexStore& indexStore,
+                      const std::vector<CompGroup>& groups) {
+    for (auto group : groups) {
+        if (!indexStore.attribute.hasLayout(group)) {
+            throw std::out_of_range(
+                "Cannot spawn an entity with an unknown component type.");
+        }
+    }
+    if (indexStore.useArchetypes) {
+        auto sorted = groups;
+        std::sort(sorted.begin(), sorted.end());
+        if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+            throw std::invalid_argument(
+                "Cannot spawn an entity with more than one component of the "
+                "same type in archetype storage.");
+        }
+    }
+}
+}  // namespace
+
+index::EntityIndex::EntityId CommandBuffer::spawn(
+    index::IndexStore& indexStore, std::vector<CompGroup> groups) {
+    checkSpawnGroups(indexStore, groups);
+    // ID 0 is used by EntityDefs to mark an unset ID, so it is never given
+    // out
+    auto entityId = std::max<index::EntityIndex::EntityId>(
+        indexStore.entity.getNextEntityId(), 1);
+    indexStore.entity.addEntityId(entityId);
+
+    spawns.push_back(Spawn{entityId, std::move(groups)});
+    return entityId;
+}
+
+index::EntityIndex::EntityId CommandBuffer::spawn(
+    index::IndexStore& indexStore, std::vector<CompGroup> groups,
+    index::EntityIndex::EntityId entityId) {
+    checkSpawnGroups(indexStore, groups);
+    indexStore.entity.addEntityId(entityId);
+    spawns.push_back(Spawn{entityId, std::move(groups)});
+    return entityId;
+}
+
+void CommandBuffer::despawn(const index::IndexStore& indexStore,
+                            index::EntityIndex::EntityId entityId) {
+    if (!indexStore.entity.hasEntity(entityId)) {
+        throw std::out_of_range("No entity with the given ID to despawn.");
+    }
+    despawns.push_back(entityId);
+}
+
+bool CommandBuffer::empty() const { return spawns.empty() && despawns.empty(); }
+
+void CommandBuffer::flush(index::IndexStore& indexStore,
+                          ComponentStore& compStore) {
+    try {
+        // Create the components of entities with the same component types
+        // together, so that the storage of each type only grows once
+        std::map<std::vector<CompGroup>,
+                 std::vector<index::EntityIndex::EntityId>>
+            spawnsByGroups;
+        for (auto& spawn : spawns) {
+            std::sort(spawn.groups.begin(), spawn.groups.end());
+            spawnsByGroups[std::move(spawn.groups)].push_back(spawn.entityId);
+        }
+        for (const auto& [groups, entityIds] : spawnsByGroups) {
+            addEntities(indexStore, compStore, entityIds, groups);
+        }
+
+        for (auto entityId : despawns) {
+            // The entity may have been despawned more than once
+            if (indexStore.entity.hasEntity(entityId)) {
+                removeEntity(indexStore, compStore, entityId);
+            }
+        }
+    } catch (...) {
+        // The spawns' groups have been moved out, so they cannot be retried
+        spawns.clear();
+        despawns.clear();
+        throw;
+    }
+
+    spawns.clear();
+    despawns.clear();
+}
+}  // namespace ics
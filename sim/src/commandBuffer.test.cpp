@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <commandBuffer.h>
+#include <ics.h>
+#include <proto/userValue.h>
+#include <test_simulation.h>
+
+#define TEST_SUITE CommandBuffer
+
+using namespace ics;
+using test_simulation::TEST_COMPONENT_NAME;
+using test_simulation::TestComponent;
+
+class CommandBufferTest : public ::testing::TestWithParam<bool> {
+   protected:
+    ComponentStore compStore;
+    index::IndexStore indexStore;
+    CommandBuffer commands;
+    CompGroup group;
+
+    void SetUp() override {
+        // Run the tests with both component and archetype storage
+        indexStore.useArchetypes = GetParam();
+        // Reserve ID 0 as the Simulation does
+        indexStore.entity.addEntityId();
+        group = indexStore.componentType.addComponentType(TEST_COMPONENT_NAME);
+        indexStore.attribute.addLayout(group, TestComponent().getLayout());
+    }
+};
+
+TEST_P(CommandBufferTest, SpawnIsDeferredUntilFlush) {
+    auto entityId = commands.spawn(indexStore, {group});
+    ASSERT_NE(entityId, 0);
+    ASSERT_TRUE(indexStore.entity.hasEntity(entityId));
+    ASSERT_FALSE(commands.empty());
+    ASSERT_EQ(queryEntities(indexStore, {group}).size(), 0);
+
+    commands.flush(indexStore, compStore);
+    ASSERT_TRUE(commands.empty());
+    auto& entities = queryEntities(indexStore, {group});
+    ASSERT_EQ(entities.size(), 1);
+    ASSERT_EQ(entities[0], entityId);
+
+    auto ref = interpreter::createAttrRef(TEST_COMPONENT_NAME, entityId,
+                                          "width");
+    auto val = bento::protos::Value();
+    proto::setVal(val, proto::INT64{3});
+    setAttribute(indexStore, compStore, ref, val);
+    ASSERT_EQ(getAttribute(indexStore, compStore, ref).primitive().int_64(),
+              3);
+}
+
+TEST_P(CommandBufferTest, DespawnRemovesComponents) {
+    auto entityId1 = commands.spawn(indexStore, {group});
+    auto entityId2 = commands.spawn(indexStore, {group}, 10);
+    ASSERT_EQ(entityId2, 10);
+    ASSERT_THROW(commands.spawn(indexStore, {group}, 10),
+                 std::invalid_argument);
+    commands.flush(indexStore, compStore);
+
+    commands.despawn(indexStore, entityId1);
+    // Despawning twice in the same step is allowed
+    commands.despawn(indexStore, entityId1);
+    ASSERT_EQ(queryEntities(indexStore, {group}).size(), 2);
+    commands.flush(indexStore, compStore);
+
+    ASSERT_FALSE(indexStore.entity.hasEntity(entityId1));
+    auto& entities = queryEntities(indexStore, {group});
+    ASSERT_EQ(entities.size(), 1);
+    ASSERT_EQ(entities[0], entityId2);
+    ASSERT_THROW(commands.despawn(indexStore, entityId1), std::out_of_range);
+}
+
+TEST(TEST_SUITE, SpawnSkipsUnsetId) {
+    index::IndexStore indexStore;
+    auto group = indexStore.componentType.addComponentType(TEST_COMPONENT_NAME);
+    indexStore.attribute.addLayout(group, TestComponent().getLayout());
+    CommandBuffer commands;
+
+    ASSERT_EQ(commands.spawn(indexStore, {group}), 1);
+    ASSERT_FALSE(indexStore.entity.hasEntity(0));
+}
+
+TEST_P(CommandBufferTest, SpawnRequiresKnownTypes) {
+    ASSERT_THROW(commands.spawn(indexStore, {group + 1}), std::out_of_range);
+    ASSERT_TRUE(commands.empty());
+}
+
+TEST_P(CommandBufferTest, SpawnRejectsDuplicateTypesInArchetypes) {
+    if (indexStore.useArchetypes) {
+        ASSERT_THROW(commands.spawn(indexStore, {group, group}),
+                     std::invalid_argument);
+        ASSERT_TRUE(commands.empty());
+    } else {
+        // Component storage allows an entity several components of a type
+        auto entityId = commands.spawn(indexStore, {group, group});
+        commands.flush(indexStore, compStore);
+        ASSERT_EQ(indexStore.entity.getComponents(entityId).size(), 2);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(TEST_SUITE, CommandBufferTest, ::testing::Bool());
@@ -0,0 +1,47 @@
+#include <component/componentLayout.h>
+#include <core/ics/util/memoryUsage.h>
+
+#include <algorithm>
+
+namespace ics::component {
+
+ComponentLayout::ComponentLayout(bento::protos::ComponentDef compDef)
+    : compDef(std::move(compDef)) {
+    for (auto& [attrName, type] : this->compDef.schema()) {
+        attrNames.push_back(attrName);
+    }
+    // Protobuf maps have no defined order, so sort the names to make the
+    // AttrIds deterministic
+    std::sort(attrNames.begin(), attrNames.end());
+
+    for (AttrId attrId = 0; attrId < attrNames.size(); attrId++) {
+        attrIds.emplace(attrNames[attrId], attrId);
+        attrTypes.push_back(this->compDef.schema().at(attrNames[attrId]));
+    }
+}
+
+bool ComponentLayout::hasAttr(const std::string& attrName) const {
+    return attrIds.contains(attrName);
+}
+
+AttrId ComponentLayout::getAttrId(const std::string& attrName) const {
+    if (!attrIds.contains(attrName)) {
+        throw std::out_of_range("No such attribute name: " + attrName);
+    }
+    return attrIds.at(attrName);
+}
+
+const std::string& ComponentLayout::getAttrName(AttrId attrId) const {
+    return attrNames.at(attrId);
+}
+
+const bento::protos::Type& ComponentLayout::getAttrType(AttrId attrId) const {
+    return attrTypes.at(attrId);
+}
+
+size_t ComponentLayout::getMemoryUsage() const {
+    return util::getMemoryUsage(compDef) + util::getMemoryUsage(attrNames) +
+           util::getMemoryUsage(attrTypes) + util::getMemoryUsage(attrIds);
+}
+
+}  // namespace ics::component
@@ -0,0 +1,26 @@
+#include <benchmark/benchmark.h>
+#include <component/userComponent.h>
+
+#include <test_simulation.h>
+
+using test_simulation::TestComponent;
+
+namespace {
+bento::protos::Value createIntValue(int64_t value) {
+    auto protoValue = bento::protos::Value();
+    protoValue.mutable_primitive()->set_int_64(value);
+    protoValue.mutable_data_type()->set_primitive(
+        bento::protos::Type_Primitive_INT64);
+    return protoValue;
+}
+}  // namespace
+
+static void BM_UserComponentSetValueById(benchmark::State& state) {
+    TestComponent comp(1, 2);
+    auto value = createIntValue(3);
+    for (auto _ : state) {
+        comp.setValue(TestComponent::WIDTH, value);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UserComponentSetValueById);
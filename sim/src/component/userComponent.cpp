@@ -1,18 +1,17 @@
 #include <component/userComponent.h>
+#include <core/ics/util/memoryUsage.h>
 #include <google/protobuf/util/message_differencer.h>
 #include <proto/valueType.h>
 #include <proto/userValue.h>
 
 namespace ics::component {
 
-const bento::protos::Value& UserComponent::getValue(
-    const std::string& attrName) {
-    return getMutableValue(attrName);
+const bento::protos::Value& UserComponent::getValue(AttrId attrId) {
+    return getMutableValue(attrId);
 }
 
-bento::protos::Value& UserComponent::getMutableValue(
-    const std::string& attrName) {
-    auto& val = values[attrName];
+bento::protos::Value& UserComponent::getMutableValue(AttrId attrId) {
+    auto& val = values.at(attrId);
     if (!val.has_primitive() && !val.has_array()) {
         throw std::runtime_error(
             "Attempting to retrieve primitive value which has not been set");
@@ -21,12 +20,19 @@ bento::protos::Value& UserComponent::getMutableValue(
     return val;
 }
 
-void UserComponent::setValue(const std::string& attrName,
+void UserComponent::setValue(AttrId attrId,
                              const bento::protos::Value& value) {
-    if (!compDef.schema().contains(attrName)) {
-        throw std::out_of_range("No such attribute name: " + attrName);
-    }
+    assignValue(*layout, attrId, values.at(attrId), value);
+}
+
+const std::vector<bento::protos::Value>& UserComponent::getValues() const {
+    return values;
+}
 
+void UserComponent::assignValue(const ComponentLayout& layout, AttrId attrId,
+                                bento::protos::Value& valToSet,
+                                const bento::protos::Value& value) {
+    const auto& attrName = layout.getAttrName(attrId);
     if (!value.has_data_type()) {
         throw std::runtime_error(
             "Missing data type when setting value for attribute " + attrName);
@@ -41,8 +47,7 @@ void UserComponent::setValue(const std::string& attrName,
             ", data type: " + proto::valDataTypeName(value.data_type()));
     }
 
-    auto& valToSet = values[attrName];
-    auto& schemaType = compDef.schema().at(attrName);
+    auto& schemaType = layout.getAttrType(attrId);
     if (schemaType.has_array()) {
         // Just set the array value completely
         valToSet = value;
@@ -53,15 +58,12 @@ void UserComponent::setValue(const std::string& attrName,
     // If schemaType and value are numeric, try to convert
     if (proto::isProtoTypeOfTypes<proto_NUMERIC>(schemaType) &&
         proto::isValOfTypes<proto_NUMERIC>(value)) {
-        proto::runFnWithVal<proto_NUMERIC>(
+        proto::visitVal<proto_NUMERIC>(
             value, [&valToSet, &schemaType]<class X>(X x) {
                 proto::runFnWithValType<proto_NUMERIC>(
                     schemaType, [&valToSet, &x]<class Y>(Y* _) {
                         proto::setVal(valToSet, (Y)x);
                     });
-
-                // Return something random since it is required
-                return 3;
             });
         return;
     }
@@ -82,4 +84,8 @@ void UserComponent::setValue(const std::string& attrName,
     valToSet = value;
 }
 
+size_t UserComponent::getMemoryUsage() const {
+    return util::getMemoryUsage(values) + util::getMemoryUsage(typeName);
+}
+
 }  // namespace ics::component
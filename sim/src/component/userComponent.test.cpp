@@ -24,6 +24,10 @@ bento::protos::ComponentDef createCompDef() {
 }
 
 struct TestComponent : public UserComponent {
+    // AttrIds of the attributes, which the layout assigns in name order
+    static constexpr AttrId HEIGHT = 0;
+    static constexpr AttrId WIDTH = 1;
+
     TestComponent() : UserComponent(TEST_COMPONENT_NAME, createCompDef()) {}
 };
 }  // namespace
@@ -34,18 +38,18 @@ TEST(TEST_SUITE, SetAndGetValues) {
     height.mutable_primitive()->set_int_64(30);
     height.mutable_data_type()->set_primitive(
         bento::protos::Type_Primitive_INT64);
-    comp.setValue("height", height);
+    comp.setValue(TestComponent::HEIGHT, height);
 
     auto width = bento::protos::Value();
     width.mutable_primitive()->set_int_64(50);
     width.mutable_data_type()->set_primitive(
         bento::protos::Type_Primitive_INT64);
-    comp.setValue("width", width);
+    comp.setValue(TestComponent::WIDTH, width);
 
     ASSERT_EQ(height.primitive().int_64(),
-              comp.getValue("height").primitive().int_64());
+              comp.getValue(TestComponent::HEIGHT).primitive().int_64());
     ASSERT_EQ(width.primitive().int_64(),
-              comp.getValue("width").primitive().int_64());
+              comp.getValue(TestComponent::WIDTH).primitive().int_64());
     // Sanity check
     ASSERT_EQ(height.primitive().int_64(), 30);
 }
@@ -56,23 +60,23 @@ TEST(TEST_SUITE, SetValueRequiresCorrectDataType) {
     height.mutable_primitive()->set_int_64(30);
 
     // No data type
-    ASSERT_ANY_THROW(comp.setValue("height", height));
+    ASSERT_ANY_THROW(comp.setValue(TestComponent::HEIGHT, height));
 
     // Data type and stored type mismatch
     height.mutable_data_type()->set_primitive(
         bento::protos::Type_Primitive_STRING);
-    ASSERT_ANY_THROW(comp.setValue("height", height));
+    ASSERT_ANY_THROW(comp.setValue(TestComponent::HEIGHT, height));
 
     // Completely incorrect data type (cannot be converted)
     height.mutable_primitive()->set_str_val("hello");
-    ASSERT_ANY_THROW(comp.setValue("height", height));
+    ASSERT_ANY_THROW(comp.setValue(TestComponent::HEIGHT, height));
 
     // Correct data type
     height.mutable_primitive()->set_int_64(30);
     height.mutable_data_type()->set_primitive(
         bento::protos::Type_Primitive_INT64);
-    comp.setValue("height", height);
-    ASSERT_NO_THROW(comp.setValue("height", height));
+    comp.setValue(TestComponent::HEIGHT, height);
+    ASSERT_NO_THROW(comp.setValue(TestComponent::HEIGHT, height));
 }
 
 TEST(TEST_SUITE, SetValueImplicitCast) {
@@ -82,19 +86,49 @@ TEST(TEST_SUITE, SetValueImplicitCast) {
     height.mutable_data_type()->set_primitive(
         bento::protos::Type_Primitive_INT32);
 
-    comp.setValue("height", height);
+    comp.setValue(TestComponent::HEIGHT, height);
 
-    ASSERT_EQ(comp.getValue("height").primitive().int_64(), 30);
+    ASSERT_EQ(comp.getValue(TestComponent::HEIGHT).primitive().int_64(), 30);
 
     height.mutable_primitive()->set_float_32(20.0f);
     height.mutable_data_type()->set_primitive(
         bento::protos::Type_Primitive_FLOAT32);
 
-    comp.setValue("height", height);
-    ASSERT_EQ(comp.getValue("height").primitive().int_64(), 20);
+    comp.setValue(TestComponent::HEIGHT, height);
+    ASSERT_EQ(comp.getValue(TestComponent::HEIGHT).primitive().int_64(), 20);
 }
 
 TEST(TEST_SUITE, GetValueWhichHasNotBeenSet) {
     TestComponent comp;
-    ASSERT_ANY_THROW(comp.getValue("height"));
+    ASSERT_ANY_THROW(comp.getValue(TestComponent::HEIGHT));
+}
+
+TEST(TEST_SUITE, LayoutAssignsIdsInNameOrder) {
+    ComponentLayout layout(createCompDef());
+    ASSERT_EQ(layout.size(), 2);
+    ASSERT_EQ(layout.getAttrId("height"), 0);
+    ASSERT_EQ(layout.getAttrId("width"), 1);
+    ASSERT_EQ(layout.getAttrName(1), "width");
+    ASSERT_EQ(layout.getAttrType(0).primitive(),
+              bento::protos::Type_Primitive_INT64);
+    ASSERT_FALSE(layout.hasAttr("depth"));
+    ASSERT_THROW(layout.getAttrId("depth"), std::out_of_range);
+}
+
+TEST(TEST_SUITE, SetAndGetValuesById) {
+    auto layout = std::make_shared<const ComponentLayout>(createCompDef());
+    UserComponent comp(TEST_COMPONENT_NAME, layout);
+    UserComponent other(TEST_COMPONENT_NAME, layout);
+    ASSERT_EQ(comp.getLayout(), other.getLayout());
+
+    auto width = bento::protos::Value();
+    width.mutable_primitive()->set_int_64(50);
+    width.mutable_data_type()->set_primitive(
+        bento::protos::Type_Primitive_INT64);
+    auto widthId = layout->getAttrId("width");
+    comp.setValue(widthId, width);
+
+    ASSERT_EQ(comp.getValue(widthId).primitive().int_64(), 50);
+    ASSERT_EQ(comp.getValue(TestComponent::WIDTH).primitive().int_64(), 50);
+    ASSERT_ANY_THROW(other.getValue(widthId));
 }
@@ -0,0 +1,166 @@
+/*
+ * bentobox-sim
+ * Simulation Generator Entrypoint
+ */
+#include <cli/options.h>
+#include <generator/simGenerator.h>
+
+#include <google/protobuf/text_format.h>
+#include <google/protobuf/util/json_util.h>
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+using cli::Options;
+using std::string;
+
+namespace {
+const char USAGE[] =
+    "Usage: bentobox-gen <nbody|flocking|optree> [--option value]...\n"
+    "\n"
+    "Writes a generated SimulationDef, which can be applied with\n"
+    "ApplySimulation.\n"
+    "\n"
+    "Options for all workloads:\n"
+    "  --name NAME             name of the simulation\n"
+    "  --entities N            number of entities\n"
+    "  --seed N                seed of the generator and the simulation\n"
+    "  --storage TYPE          component or archetype\n"
+    "  --format FORMAT         binary, text or json (default binary)\n"
+    "  --out FILE              file to write to (default stdout)\n"
+    "nbody:\n"
+    "  --interactions N        bodies attracting each body\n"
+    "  --time-step X           time step of each simulation step\n"
+    "flocking:\n"
+    "  --neighbours N          neighbours steering each boid\n"
+    "  --cohesion X, --alignment X, --separation X, --max-speed X\n"
+    "optree:\n"
+    "  --component-types N     number of component types\n"
+    "  --attributes N          attributes per component type\n"
+    "  --components N          component types per entity\n"
+    "  --systems N             number of systems\n"
+    "  --depth N               depth of the op trees\n"
+    "  --ops OP=W,...          weights of the ops, eg. add_op=2,mul_op=1\n";
+
+void takeWorldOptions(Options& options, generator::WorldConfig& config) {
+    config.name = options.take("name", config.name);
+    config.entityCount = options.take("entities", config.entityCount);
+    config.seed = options.take("seed", config.seed);
+
+    auto storage = options.take("storage", string("component"));
+    if (storage == "archetype") {
+        config.storage = bento::protos::SimulationDef::ARCHETYPE;
+    } else if (storage != "component") {
+        throw std::invalid_argument("Unknown storage: " + storage);
+    }
+}
+
+// Parses weights formatted as op=weight,op=weight
+generator::OpWeights parseOpWeights(const string& text) {
+    generator::OpWeights weights;
+    std::istringstream stream(text);
+    string entry;
+    while (std::getline(stream, entry, ',')) {
+        auto separator = entry.find('=');
+        auto opName = entry.substr(0, separator);
+        auto field = bento::protos::Node::descriptor()->FindFieldByName(opName);
+        if (field == nullptr || field->containing_oneof() == nullptr) {
+            throw std::invalid_argument("Unknown op: " + opName);
+        }
+        auto op = static_cast<bento::protos::Node::OpCase>(field->number());
+        weights[op] = separator == string::npos
+                          ? 1.0
+                          : std::stod(entry.substr(separator + 1));
+    }
+    return weights;
+}
+
+bento::protos::SimulationDef generate(const string& workload,
+                                      Options& options) {
+    if (workload == "nbody") {
+        generator::NBodyConfig config;
+        takeWorldOptions(options, config);
+        config.interactions = options.take("interactions", config.interactions);
+        config.timeStep = options.take("time-step", config.timeStep);
+        return generator::generateNBody(config);
+    } else if (workload == "flocking") {
+        generator::FlockingConfig config;
+        takeWorldOptions(options, config);
+        config.neighbours = options.take("neighbours", config.neighbours);
+        config.cohesion = options.take("cohesion", config.cohesion);
+        config.alignment = options.take("alignment", config.alignment);
+        config.separation = options.take("separation", config.separation);
+        config.maxSpeed = options.take("max-speed", config.maxSpeed);
+        return generator::generateFlocking(config);
+    } else if (workload == "optree") {
+        generator::OpTreeConfig config;
+        takeWorldOptions(options, config);
+        config.componentTypes =
+            options.take("component-types", config.componentTypes);
+        config.attributesPerComponent =
+            options.take("attributes", config.attributesPerComponent);
+        config.componentsPerEntity =
+            options.take("components", config.componentsPerEntity);
+        config.systems = options.take("systems", config.systems);
+        config.depth = options.take("depth", config.depth);
+        auto ops = options.take("ops", string());
+        if (!ops.empty()) {
+            config.opWeights = parseOpWeights(ops);
+        }
+        return generator::generateOpTree(config);
+    }
+    throw std::invalid_argument("Unknown workload: " + workload);
+}
+
+string serialize(const bento::protos::SimulationDef& simDef,
+                 const string& format) {
+    string output;
+    if (format == "binary") {
+        simDef.SerializeToString(&output);
+    } else if (format == "text") {
+        google::protobuf::TextFormat::PrintToString(simDef, &output);
+    } else if (format == "json") {
+        google::protobuf::util::MessageToJsonString(simDef, &output);
+    } else {
+        throw std::invalid_argument("Unknown format: " + format);
+    }
+    return output;
+}
+}  // namespace
+
+/**
+ * Generates a simulation for scale and stress testing, see USAGE.
+ */
+int main(int argc, char* argv[]) {
+    if (argc < 2 || string(argv[1]) == "--help") {
+        std::cerr << USAGE;
+        return argc < 2 ? 1 : 0;
+    }
+
+    try {
+        Options options(argc, argv, 2);
+        auto format = options.take("format", string("binary"));
+        auto outPath = options.take("out", string());
+        auto simDef = generate(argv[1], options);
+        options.checkAllTaken();
+
+        auto output = serialize(simDef, format);
+        if (outPath.empty()) {
+            std::cout << output;
+        } else {
+            std::ofstream file(outPath, std::ios::binary);
+            file << output;
+            if (!file) {
+                throw std::runtime_error("Could not write to " + outPath);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "bentobox-gen: " << e.what() << "\n\n" << USAGE;
+        return 1;
+    }
+    return 0;
+}
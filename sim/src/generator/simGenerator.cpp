@@ -0,0 +1,413 @@
+#include <generator/simGenerator.h>
+#include <interpreter/util.h>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace generator {
+namespace {
+typedef bento::protos::Node Node;
+typedef Node::OpCase OpCase;
+typedef std::mt19937_64 Rng;
+
+// The standard distributions differ between standard libraries, so the
+// numbers are derived from the engine's output, which does not
+uint32_t pick(Rng& rng, uint32_t count) { return rng() % count; }
+
+float uniform(Rng& rng, float low, float high) {
+    return low + (high - low) * float((rng() >> 11) * 0x1.0p-53);
+}
+
+Node constNode(float value) {
+    auto node = Node();
+    auto heldValue = node.mutable_const_op()->mutable_held_value();
+    heldValue->mutable_primitive()->set_float_32(value);
+    heldValue->mutable_data_type()->set_primitive(
+        bento::protos::Type_Primitive_FLOAT32);
+    return node;
+}
+
+Node retrieveNode(const bento::protos::AttributeRef& ref) {
+    auto node = Node();
+    *node.mutable_retrieve_op()->mutable_retrieve_attr() = ref;
+    return node;
+}
+
+// Sets the op of the node, and returns the op's message
+google::protobuf::Message& setOp(Node& node, OpCase op) {
+    auto field = Node::descriptor()->FindFieldByNumber(op);
+    return *node.GetReflection()->MutableMessage(&node, field);
+}
+
+Node binaryNode(OpCase op, Node x, Node y) {
+    auto node = Node();
+    auto& opMessage = setOp(node, op);
+    auto reflection = opMessage.GetReflection();
+    auto descriptor = opMessage.GetDescriptor();
+    reflection->MutableMessage(&opMessage, descriptor->FindFieldByName("x"))
+        ->CopyFrom(x);
+    reflection->MutableMessage(&opMessage, descriptor->FindFieldByName("y"))
+        ->CopyFrom(y);
+    return node;
+}
+
+Node add(Node x, Node y) {
+    return binaryNode(OpCase::kAddOp, std::move(x), std::move(y));
+}
+Node sub(Node x, Node y) {
+    return binaryNode(OpCase::kSubOp, std::move(x), std::move(y));
+}
+Node mul(Node x, Node y) {
+    return binaryNode(OpCase::kMulOp, std::move(x), std::move(y));
+}
+Node div(Node x, Node y) {
+    return binaryNode(OpCase::kDivOp, std::move(x), std::move(y));
+}
+
+// Adds the nodes together, or returns 0 if there are none
+Node sum(std::vector<Node> nodes) {
+    if (nodes.empty()) {
+        return constNode(0.0f);
+    }
+    auto total = std::move(nodes[0]);
+    for (size_t i = 1; i < nodes.size(); i++) {
+        total = add(std::move(total), std::move(nodes[i]));
+    }
+    return total;
+}
+
+void addOutput(bento::protos::Graph& graph,
+               const bento::protos::AttributeRef& ref, Node value) {
+    auto& output = *graph.add_outputs();
+    *output.mutable_mutate_attr() = ref;
+    *output.mutable_to_node() = std::move(value);
+}
+
+// Creates the simulation with its component types and entities, each entity
+// with all the component types
+bento::protos::SimulationDef createSimDef(
+    const WorldConfig& config,
+    std::initializer_list<
+        std::pair<const char*, std::initializer_list<const char*>>>
+        components) {
+    bento::protos::SimulationDef simDef;
+    simDef.set_name(config.name);
+    simDef.set_seed(config.seed);
+    simDef.set_storage(config.storage);
+    for (const auto& [compName, attrNames] : components) {
+        auto& compDef = *simDef.add_components();
+        compDef.set_name(compName);
+        for (auto attrName : attrNames) {
+            (*compDef.mutable_schema())[attrName].set_primitive(
+                bento::protos::Type_Primitive_FLOAT32);
+        }
+    }
+    for (uint32_t i = 0; i < config.entityCount; i++) {
+        auto& entityDef = *simDef.add_entities();
+        entityDef.set_id(i + 1);
+        for (const auto& [compName, attrNames] : components) {
+            entityDef.add_components(compName);
+        }
+    }
+    return simDef;
+}
+
+// Chooses other entities for the entity to interact with. An entity never
+// interacts with itself, so none are chosen when it is the only entity.
+std::vector<uint32_t> pickOthers(Rng& rng, uint32_t entityId,
+                                 uint32_t entityCount, uint32_t count) {
+    std::vector<uint32_t> others;
+    if (entityCount < 2) {
+        return others;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        // Entity IDs run from 1 to entityCount
+        auto offset = 1 + pick(rng, entityCount - 1);
+        others.push_back((entityId - 1 + offset) % entityCount + 1);
+    }
+    return others;
+}
+
+// Refs to the x and y attributes of a component
+struct Vec2Ref {
+    bento::protos::AttributeRef x, y;
+
+    Vec2Ref(const char* compName, uint32_t entityId)
+        : x(interpreter::createAttrRef(compName, entityId, "x")),
+          y(interpreter::createAttrRef(compName, entityId, "y")) {}
+};
+
+// Adds a system that moves every entity by its velocity
+void addMoveSystem(bento::protos::SimulationDef& simDef,
+                   uint32_t entityCount, float timeStep) {
+    auto& graph = *simDef.add_systems()->mutable_graph();
+    for (uint32_t entityId = 1; entityId <= entityCount; entityId++) {
+        Vec2Ref position("Position", entityId), velocity("Velocity", entityId);
+        for (auto [pos, vel] : {std::pair(&position.x, &velocity.x),
+                                std::pair(&position.y, &velocity.y)}) {
+            addOutput(graph, *pos,
+                      add(retrieveNode(*pos),
+                          mul(retrieveNode(*vel), constNode(timeStep))));
+        }
+    }
+}
+
+// Squared distance between the positions, offset so that it is never 0
+Node softDistanceSq(const Vec2Ref& from, const Vec2Ref& to) {
+    auto dx = sub(retrieveNode(to.x), retrieveNode(from.x));
+    auto dy = sub(retrieveNode(to.y), retrieveNode(from.y));
+    return add(add(mul(dx, dx), mul(dy, dy)), constNode(0.01f));
+}
+
+const std::vector<OpCase> TREE_OPS = {
+    OpCase::kAddOp,    OpCase::kSubOp,    OpCase::kMulOp,   OpCase::kDivOp,
+    OpCase::kMaxOp,    OpCase::kMinOp,    OpCase::kAbsOp,   OpCase::kFloorOp,
+    OpCase::kCeilOp,   OpCase::kPowOp,    OpCase::kSinOp,   OpCase::kArcsinOp,
+    OpCase::kCosOp,    OpCase::kArccosOp, OpCase::kTanOp,   OpCase::kArctanOp,
+    OpCase::kRandomOp,
+};
+
+// Creates a random tree of ops, whose leaves retrieve one of the refs or are
+// constants
+Node createOpTree(Rng& rng, uint32_t depth,
+                  const std::vector<OpCase>& ops,
+                  const std::vector<double>& cumulativeWeights,
+                  const std::vector<bento::protos::AttributeRef>& refs) {
+    if (depth == 0) {
+        if (pick(rng, 2) == 0) {
+            return retrieveNode(refs[pick(rng, refs.size())]);
+        }
+        return constNode(uniform(rng, -1.0f, 1.0f));
+    }
+
+    auto choice = uniform(rng, 0.0f, cumulativeWeights.back());
+    auto opIt = std::upper_bound(cumulativeWeights.begin(),
+                                 cumulativeWeights.end() - 1, choice);
+    auto op = ops[opIt - cumulativeWeights.begin()];
+
+    // Fill every operand of the op, whatever they are named
+    auto node = Node();
+    auto& opMessage = setOp(node, op);
+    auto descriptor = opMessage.GetDescriptor();
+    for (int i = 0; i < descriptor->field_count(); i++) {
+        auto field = descriptor->field(i);
+        if (field->message_type() != Node::descriptor()) {
+            continue;
+        }
+        opMessage.GetReflection()
+            ->MutableMessage(&opMessage, field)
+            ->CopyFrom(createOpTree(rng, depth - 1, ops, cumulativeWeights,
+                                    refs));
+    }
+    return node;
+}
+}  // namespace
+
+OpWeights defaultOpWeights() {
+    OpWeights weights;
+    for (auto op : {OpCase::kAddOp, OpCase::kSubOp, OpCase::kMulOp,
+                    OpCase::kDivOp, OpCase::kMaxOp, OpCase::kMinOp,
+                    OpCase::kAbsOp, OpCase::kSinOp, OpCase::kCosOp}) {
+        weights[op] = 1.0;
+    }
+    return weights;
+}
+
+bento::protos::SimulationDef generateNBody(const NBodyConfig& config) {
+    Rng rng(config.seed);
+    auto simDef = createSimDef(config, {{"Position", {"x", "y"}},
+                                        {"Velocity", {"x", "y"}},
+                                        {"Mass", {"mass"}}});
+
+    auto& initGraph = *simDef.mutable_init_graph();
+    auto& gravityGraph = *simDef.add_systems()->mutable_graph();
+    for (uint32_t entityId = 1; entityId <= config.entityCount; entityId++) {
+        Vec2Ref position("Position", entityId), velocity("Velocity", entityId);
+        auto massRef = interpreter::createAttrRef("Mass", entityId, "mass");
+        addOutput(initGraph, position.x, constNode(uniform(rng, -100, 100)));
+        addOutput(initGraph, position.y, constNode(uniform(rng, -100, 100)));
+        addOutput(initGraph, velocity.x, constNode(uniform(rng, -1, 1)));
+        addOutput(initGraph, velocity.y, constNode(uniform(rng, -1, 1)));
+        addOutput(initGraph, massRef, constNode(uniform(rng, 1, 10)));
+
+        // a = sum(m * d / |d|^2) over the bodies interacting with this one
+        std::vector<Node> accX, accY;
+        for (auto otherId : pickOthers(rng, entityId, config.entityCount,
+                                       config.interactions)) {
+            Vec2Ref other("Position", otherId);
+            auto otherMass = retrieveNode(
+                interpreter::createAttrRef("Mass", otherId, "mass"));
+            auto distanceSq = softDistanceSq(position, other);
+            accX.push_back(
+                mul(otherMass,
+                    div(sub(retrieveNode(other.x), retrieveNode(position.x)),
+                        distanceSq)));
+            accY.push_back(
+                mul(otherMass,
+                    div(sub(retrieveNode(other.y), retrieveNode(position.y)),
+                        distanceSq)));
+        }
+
+        auto timeStep = constNode(config.timeStep);
+        addOutput(gravityGraph, velocity.x,
+                  add(retrieveNode(velocity.x),
+                      mul(sum(std::move(accX)), timeStep)));
+        addOutput(gravityGraph, velocity.y,
+                  add(retrieveNode(velocity.y),
+                      mul(sum(std::move(accY)), timeStep)));
+    }
+    addMoveSystem(simDef, config.entityCount, config.timeStep);
+    return simDef;
+}
+
+bento::protos::SimulationDef generateFlocking(const FlockingConfig& config) {
+    Rng rng(config.seed);
+    auto simDef = createSimDef(
+        config, {{"Position", {"x", "y"}}, {"Velocity", {"x", "y"}}});
+
+    auto& initGraph = *simDef.mutable_init_graph();
+    auto& steerGraph = *simDef.add_systems()->mutable_graph();
+    for (uint32_t entityId = 1; entityId <= config.entityCount; entityId++) {
+        Vec2Ref position("Position", entityId), velocity("Velocity", entityId);
+        addOutput(initGraph, position.x, constNode(uniform(rng, -100, 100)));
+        addOutput(initGraph, position.y, constNode(uniform(rng, -100, 100)));
+        addOutput(initGraph, velocity.x, constNode(uniform(rng, -1, 1)));
+        addOutput(initGraph, velocity.y, constNode(uniform(rng, -1, 1)));
+
+        auto neighbours = pickOthers(rng, entityId, config.entityCount,
+                                     config.neighbours);
+        if (neighbours.empty()) {
+            continue;
+        }
+        auto count = constNode(float(neighbours.size()));
+        for (auto axis : {&Vec2Ref::x, &Vec2Ref::y}) {
+            std::vector<Node> positions, velocities, pushes;
+            for (auto otherId : neighbours) {
+                Vec2Ref otherPosition("Position", otherId);
+                Vec2Ref otherVelocity("Velocity", otherId);
+                positions.push_back(retrieveNode(otherPosition.*axis));
+                velocities.push_back(retrieveNode(otherVelocity.*axis));
+                pushes.push_back(
+                    div(sub(retrieveNode(position.*axis),
+                            retrieveNode(otherPosition.*axis)),
+                        softDistanceSq(position, otherPosition)));
+            }
+
+            // Steer towards the neighbours' centre and heading, and away
+            // from the neighbours that are close
+            auto cohesion =
+                mul(sub(div(sum(std::move(positions)), count),
+                        retrieveNode(position.*axis)),
+                    constNode(config.cohesion));
+            auto alignment =
+                mul(sub(div(sum(std::move(velocities)), count),
+                        retrieveNode(velocity.*axis)),
+                    constNode(config.alignment));
+            auto separation =
+                mul(sum(std::move(pushes)), constNode(config.separation));
+            auto steered = add(retrieveNode(velocity.*axis),
+                               add(cohesion, add(alignment, separation)));
+
+            auto clamped = binaryNode(
+                OpCase::kMinOp,
+                binaryNode(OpCase::kMaxOp, steered,
+                           constNode(-config.maxSpeed)),
+                constNode(config.maxSpeed));
+            addOutput(steerGraph, velocity.*axis, std::move(clamped));
+        }
+    }
+    addMoveSystem(simDef, config.entityCount, 1.0f);
+    return simDef;
+}
+
+bento::protos::SimulationDef generateOpTree(const OpTreeConfig& config) {
+    if (config.componentsPerEntity > config.componentTypes) {
+        throw std::invalid_argument(
+            "Entities cannot have more components than there are component "
+            "types.");
+    }
+    if (config.componentsPerEntity == 0 || config.attributesPerComponent == 0) {
+        throw std::invalid_argument(
+            "Entities need at least one attribute to set.");
+    }
+    std::vector<OpCase> ops;
+    std::vector<double> cumulativeWeights;
+    for (const auto& [op, weight] : config.opWeights) {
+        if (std::find(TREE_OPS.begin(), TREE_OPS.end(), op) ==
+            TREE_OPS.end()) {
+            throw std::invalid_argument(
+                "Op " + Node::descriptor()->FindFieldByNumber(op)->name() +
+                " cannot be used in op trees.");
+        }
+        if (weight > 0) {
+            auto total = cumulativeWeights.empty() ? 0.0
+                                                   : cumulativeWeights.back();
+            ops.push_back(op);
+            cumulativeWeights.push_back(total + weight);
+        }
+    }
+    if (ops.empty() && config.depth > 0) {
+        throw std::invalid_argument("At least one op needs a weight.");
+    }
+
+    Rng rng(config.seed);
+    bento::protos::SimulationDef simDef;
+    simDef.set_name(config.name);
+    simDef.set_seed(config.seed);
+    simDef.set_storage(config.storage);
+
+    std::vector<std::string> compNames, attrNames;
+    for (uint32_t i = 0; i < config.attributesPerComponent; i++) {
+        attrNames.push_back("a" + std::to_string(i));
+    }
+    for (uint32_t i = 0; i < config.componentTypes; i++) {
+        compNames.push_back("Comp" + std::to_string(i));
+        auto& compDef = *simDef.add_components();
+        compDef.set_name(compNames.back());
+        for (const auto& attrName : attrNames) {
+            (*compDef.mutable_schema())[attrName].set_primitive(
+                bento::protos::Type_Primitive_FLOAT32);
+        }
+    }
+
+    auto& initGraph = *simDef.mutable_init_graph();
+    std::vector<bento::protos::Graph*> systemGraphs;
+    for (uint32_t i = 0; i < config.systems; i++) {
+        systemGraphs.push_back(simDef.add_systems()->mutable_graph());
+    }
+    std::vector<uint32_t> compIndexes(config.componentTypes);
+    for (uint32_t entityId = 1; entityId <= config.entityCount; entityId++) {
+        // Choose the entity's components with a partial shuffle
+        std::iota(compIndexes.begin(), compIndexes.end(), 0);
+        for (uint32_t i = 0; i < config.componentsPerEntity; i++) {
+            std::swap(compIndexes[i],
+                      compIndexes[i + pick(rng, config.componentTypes - i)]);
+        }
+
+        auto& entityDef = *simDef.add_entities();
+        entityDef.set_id(entityId);
+        std::vector<bento::protos::AttributeRef> refs;
+        for (uint32_t i = 0; i < config.componentsPerEntity; i++) {
+            const auto& compName = compNames[compIndexes[i]];
+            entityDef.add_components(compName);
+            for (const auto& attrName : attrNames) {
+                refs.push_back(interpreter::createAttrRef(
+                    compName.c_str(), entityId, attrName.c_str()));
+                addOutput(initGraph, refs.back(),
+                          constNode(uniform(rng, -1.0f, 1.0f)));
+            }
+        }
+
+        for (auto graph : systemGraphs) {
+            addOutput(*graph, refs[pick(rng, refs.size())],
+                      createOpTree(rng, config.depth, ops, cumulativeWeights,
+                                   refs));
+        }
+    }
+    return simDef;
+}
+
+}  // namespace generator
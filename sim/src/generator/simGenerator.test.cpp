@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <generator/simGenerator.h>
+
+#include <google/protobuf/util/message_differencer.h>
+#include <service/engineService.h>
+
+#define TEST_SUITE SimGenerator
+
+using namespace generator;
+using google::protobuf::util::MessageDifferencer;
+
+namespace {
+// Applies the simulation and runs it for a few steps, calling the service
+// directly
+void applyAndStep(const bento::protos::SimulationDef& simDef) {
+    service::EngineServiceImpl engineSvc;
+    bento::protos::ApplySimulationReq applyReq;
+    bento::protos::ApplySimulationResp applyResp;
+    *applyReq.mutable_simulation() = simDef;
+    auto status = engineSvc.ApplySimulation(nullptr, &applyReq, &applyResp);
+    ASSERT_TRUE(status.ok()) << status.error_message();
+
+    bento::protos::StepSimulationReq stepReq;
+    bento::protos::StepSimulationResp stepResp;
+    stepReq.set_name(simDef.name());
+    for (int i = 0; i < 3; i++) {
+        status = engineSvc.StepSimulation(nullptr, &stepReq, &stepResp);
+        ASSERT_TRUE(status.ok()) << status.error_message();
+    }
+}
+
+// Returns the depth of the deepest node below the node
+int getDepth(const google::protobuf::Message& message) {
+    int depth = 0;
+    auto reflection = message.GetReflection();
+    std::vector<const google::protobuf::FieldDescriptor*> fields;
+    reflection->ListFields(message, &fields);
+    for (auto field : fields) {
+        if (field->cpp_type() ==
+            google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE) {
+            auto& child = reflection->GetMessage(message, field);
+            auto childDepth = getDepth(child);
+            if (dynamic_cast<const bento::protos::Node*>(&child)) {
+                childDepth++;
+            }
+            depth = std::max(depth, childDepth);
+        }
+    }
+    return depth;
+}
+}  // namespace
+
+TEST(TEST_SUITE, GeneratedSimulationsRun) {
+    NBodyConfig nBody;
+    nBody.entityCount = 20;
+    applyAndStep(generateNBody(nBody));
+
+    FlockingConfig flocking;
+    flocking.entityCount = 20;
+    flocking.storage = bento::protos::SimulationDef::ARCHETYPE;
+    applyAndStep(generateFlocking(flocking));
+
+    OpTreeConfig opTree;
+    opTree.entityCount = 20;
+    opTree.systems = 2;
+    opTree.opWeights[bento::protos::Node::OpCase::kRandomOp] = 1.0;
+    applyAndStep(generateOpTree(opTree));
+}
+
+TEST(TEST_SUITE, SameConfigGivesSameSimulation) {
+    NBodyConfig config;
+    auto simDef = generateNBody(config);
+    ASSERT_EQ(simDef.entities_size(), config.entityCount);
+    ASSERT_TRUE(MessageDifferencer::Equals(simDef, generateNBody(config)));
+
+    config.seed++;
+    ASSERT_FALSE(MessageDifferencer::Equals(simDef, generateNBody(config)));
+}
+
+TEST(TEST_SUITE, OpTreeFollowsConfig) {
+    OpTreeConfig config;
+    config.entityCount = 10;
+    config.componentTypes = 5;
+    config.componentsPerEntity = 3;
+    config.depth = 3;
+    config.opWeights = {{bento::protos::Node::OpCase::kMulOp, 1.0}};
+    auto simDef = generateOpTree(config);
+
+    ASSERT_EQ(simDef.components_size(), 5);
+    for (const auto& entityDef : simDef.entities()) {
+        ASSERT_EQ(entityDef.components_size(), 3);
+    }
+    const auto& outputs = simDef.systems(0).graph().outputs();
+    ASSERT_EQ(outputs.size(), 10);
+    for (const auto& output : outputs) {
+        // The Mutate's node is the root of the tree
+        ASSERT_EQ(getDepth(output), config.depth + 1);
+        ASSERT_EQ(output.to_node().op_case(),
+                  bento::protos::Node::OpCase::kMulOp);
+    }
+
+    // Ops that do not produce numbers are rejected
+    config.opWeights = {{bento::protos::Node::OpCase::kEqOp, 1.0}};
+    ASSERT_THROW(generateOpTree(config), std::invalid_argument);
+}
@@ -0,0 +1,53 @@
+#include <benchmark/benchmark.h>
+#include <ics.h>
+
+#include <test_simulation.h>
+
+#include <memory>
+
+using test_simulation::TEST_COMPONENT_NAME;
+using test_simulation::TestComponent;
+
+namespace {
+struct World {
+    ics::ComponentStore compStore;
+    ics::index::IndexStore indexStore;
+    std::vector<ics::index::EntityIndex::EntityId> entityIds;
+};
+
+// Returns a world with the given number of entities. Large worlds take long
+// to create, so the last world is kept for the runs of the same benchmark.
+World& getWorld(int64_t entityCount) {
+    static std::unique_ptr<World> world;
+    if (world == nullptr || world->entityIds.size() != entityCount) {
+        world = nullptr;
+        world = std::make_unique<World>();
+        TestComponent comp(1, 2);
+        world->entityIds.reserve(entityCount);
+        for (int64_t i = 0; i < entityCount; i++) {
+            auto entityId = world->indexStore.entity.addEntityId();
+            ics::addComponent(world->indexStore, world->compStore, entityId,
+                              comp);
+            world->entityIds.push_back(entityId);
+        }
+    }
+    return *world;
+}
+}  // namespace
+
+// Looks up the components of a world with the given number of entities, one
+// entity per iteration
+static void BM_GetComponent(benchmark::State& state) {
+    auto& world = getWorld(state.range(0));
+    auto group =
+        world.indexStore.componentType.getComponentType(TEST_COMPONENT_NAME);
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ics::getComponent(
+            world.indexStore, world.compStore, group, world.entityIds[i]));
+        i = (i + 1) % world.entityIds.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetComponent)->RangeMultiplier(10)->Range(100, 1000000);
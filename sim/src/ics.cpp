@@ -1,26 +1,189 @@
 #include <ics.h>
 
 namespace ics {
+void addEntities(index::IndexStore& indexStore, ComponentStore& compStore,
+                 std::span<const index::EntityIndex::EntityId> entityIds,
+                 const std::vector<CompGroup>& groups) {
+    if (indexStore.useArchetypes) {
+        index::ArchetypeIndex::Layouts layouts;
+        for (auto group : groups) {
+            auto layout = indexStore.attribute.getSharedLayout(group);
+            if (!layouts.emplace(group, std::move(layout)).second) {
+                throw std::logic_error(
+                    "Entity already has a component of the same type. "
+                    "Archetype storage allows only one component of each "
+                    "type per entity.");
+            }
+        }
+        indexStore.archetype.addEntities(entityIds, layouts);
+    } else {
+        for (auto group : groups) {
+            auto layout = indexStore.attribute.getSharedLayout(group);
+            auto comp = component::UserComponent(layout->getCompDef().name(),
+                                                 layout);
+            auto& vec =
+                compStore.contains(group)
+                    ? getCompVec<component::UserComponent>(compStore, group)
+                    : createCompVec<component::UserComponent>(compStore, group);
+            vec.reserve(vec.size() + entityIds.size());
+            for (auto entityId : entityIds) {
+                auto compStoreId = CompStoreId(group, vec.add(comp));
+                indexStore.entity.addComponent(entityId, compStoreId);
+            }
+        }
+    }
+
+    for (auto entityId : entityIds) {
+        for (auto group : groups) {
+            indexStore.signature.addComponent(entityId, group);
+            indexStore.version.addComponent(
+                entityId, group, indexStore.attribute.getLayout(group).size());
+        }
+    }
+}
+
+void removeComponent(index::IndexStore& indexStore, ComponentStore& compStore,
+                     index::EntityIndex::EntityId entityId,
+                     const CompStoreId& compStoreId) {
+    if (indexStore.useArchetypes) {
+        indexStore.archetype.removeComponent(entityId, compStoreId.first);
+    } else {
+        compStore.at(compStoreId.first)->remove(compStoreId.second);
+        indexStore.entity.removeComponent(entityId, compStoreId);
+    }
+    indexStore.signature.removeComponent(entityId, compStoreId.first);
+    indexStore.version.removeComponent(entityId, compStoreId.first);
+}
+
+void removeEntity(index::IndexStore& indexStore, ComponentStore& compStore,
+                  index::EntityIndex::EntityId entityId) {
+    if (indexStore.useArchetypes) {
+        for (auto group : indexStore.archetype.getSignature(entityId)) {
+            indexStore.signature.removeComponent(entityId, group);
+            indexStore.version.removeComponent(entityId, group);
+        }
+        indexStore.archetype.removeEntity(entityId);
+    } else {
+        // Copy the entity's components as removing them changes the list
+        auto components = indexStore.entity.getComponents(entityId);
+        std::vector<CompStoreId> compStoreIds(components.begin(),
+                                              components.end());
+        for (const auto& compStoreId : compStoreIds) {
+            removeComponent(indexStore, compStore, entityId, compStoreId);
+        }
+    }
+    indexStore.entity.removeEntity(entityId);
+}
+
+const std::vector<index::EntityIndex::EntityId>& queryEntities(
+    index::IndexStore& indexStore, const std::vector<CompGroup>& groups) {
+    return indexStore.signature.query(groups);
+}
+
 component::UserComponent& getComponent(index::IndexStore& indexStore,
                                        ComponentStore& compStore,
-                                       const std::string& typeName,
+                                       CompGroup group,
                                        index::EntityIndex::EntityId entityId) {
     auto& compTypeIndex = indexStore.componentType;
     auto& entityIndex = indexStore.entity;
 
     auto components = util::Composable<ComponentStore&>(compStore) |
-                      ics::asCompSet | compTypeIndex.filterCompType(typeName) |
+                      ics::asCompSet | compTypeIndex.filterCompGroup(group) |
                       entityIndex.filterEntityId(entityId);
 
-    if (components.data.size() > 1) {
+    // The query is evaluated lazily, so only walk as far as needed to find
+    // out whether there is exactly one match
+    auto it = std::ranges::begin(components.data);
+    auto end = std::ranges::end(components.data);
+    if (it == end) {
+        throw std::runtime_error(
+            "No component with typeName and entityId found.");
+    }
+
+    auto compStoreId = *it;
+    if (++it != end) {
         throw std::logic_error(
             "More than one component match entity and type.");
-    } else if (components.data.empty()) {
+    }
+
+    return getComponent<component::UserComponent>(compStore, compStoreId);
+}
+
+namespace {
+// Ensures that the entity has a component of the group when archetype
+// storage is used
+void checkArchetypeComponent(index::IndexStore& indexStore, CompGroup group,
+                             index::EntityIndex::EntityId entityId) {
+    if (!indexStore.archetype.hasComponent(entityId, group)) {
         throw std::runtime_error(
             "No component with typeName and entityId found.");
     }
+}
+}  // namespace
 
-    auto compStoreId = *components.data.begin();
-    return getComponent<component::UserComponent>(compStore, compStoreId);
+bento::protos::Value& getAttribute(
+    index::IndexStore& indexStore, ComponentStore& compStore,
+    const index::AttributeIndex::AttrRefIds& refIds) {
+    auto& [group, entityId, attrId] = refIds;
+    if (indexStore.useArchetypes) {
+        checkArchetypeComponent(indexStore, group, entityId);
+        return indexStore.archetype.getValue(entityId, group, attrId);
+    }
+
+    auto& component = getComponent(indexStore, compStore, group, entityId);
+    return component.getMutableValue(attrId);
+}
+
+bento::protos::Value& getAttribute(index::IndexStore& indexStore,
+                                   ComponentStore& compStore,
+                                   const bento::protos::AttributeRef& ref) {
+    auto refIds = indexStore.attribute.resolve(indexStore.componentType, ref);
+    return getAttribute(indexStore, compStore, refIds);
+}
+
+const bento::protos::Value* findAttribute(
+    index::IndexStore& indexStore, ComponentStore& compStore,
+    const index::AttributeIndex::AttrRefIds& refIds) {
+    auto& [group, entityId, attrId] = refIds;
+    if (!indexStore.entity.hasEntity(entityId)) {
+        return nullptr;
+    }
+    if (indexStore.useArchetypes) {
+        if (!indexStore.archetype.hasComponent(entityId, group)) {
+            return nullptr;
+        }
+        return &indexStore.archetype.getStoredValue(entityId, group, attrId);
+    }
+
+    // Entities have few components, so they are searched directly
+    for (const auto& compStoreId : indexStore.entity.getComponents(entityId)) {
+        if (compStoreId.first == group) {
+            return &getComponent<component::UserComponent>(compStore,
+                                                           compStoreId)
+                        .getValues()[attrId];
+        }
+    }
+    return nullptr;
+}
+
+void setAttribute(index::IndexStore& indexStore, ComponentStore& compStore,
+                  const index::AttributeIndex::AttrRefIds& refIds,
+                  const bento::protos::Value& value) {
+    auto& [group, entityId, attrId] = refIds;
+    if (indexStore.useArchetypes) {
+        checkArchetypeComponent(indexStore, group, entityId);
+        indexStore.archetype.setValue(entityId, group, attrId, value);
+    } else {
+        auto& component = getComponent(indexStore, compStore, group, entityId);
+        component.setValue(attrId, value);
+    }
+    indexStore.version.bump(refIds);
+}
+
+void setAttribute(index::IndexStore& indexStore, ComponentStore& compStore,
+                  const bento::protos::AttributeRef& ref,
+                  const bento::protos::Value& value) {
+    auto refIds = indexStore.attribute.resolve(indexStore.componentType, ref);
+    setAttribute(indexStore, compStore, refIds, value);
 }
-}  // namespace ics
\ No newline at end of file
+}  // namespace ics
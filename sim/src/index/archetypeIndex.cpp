@@ -0,0 +1,284 @@
+#include <index/archetypeIndex.h>
+#include <core/ics/util/memoryUsage.h>
+
+#include <algorithm>
+
+namespace ics::index {
+ArchetypeIndex::Column& ArchetypeIndex::Archetype::column(
+    CompGroup group, component::AttrId attrId) {
+    return columns.at(group).at(attrId);
+}
+
+const ArchetypeIndex::Column& ArchetypeIndex::Archetype::column(
+    CompGroup group, component::AttrId attrId) const {
+    return columns.at(group).at(attrId);
+}
+
+ArchetypeIndex::Archetype& ArchetypeIndex::getArchetype(
+    const Signature& signature) {
+    auto& archetype = archetypes[signature];
+    archetype.signature = signature;
+    return archetype;
+}
+
+size_t ArchetypeIndex::appendRow(Archetype& archetype,
+                                 EntityIndex::EntityId entityId) {
+    auto index = archetype.entities.size();
+    archetype.entities.push_back(entityId);
+    for (auto& [group, groupColumns] : archetype.columns) {
+        for (auto& column : groupColumns) {
+            column.emplace_back();
+        }
+    }
+    return index;
+}
+
+void ArchetypeIndex::swapRemoveRow(Archetype& archetype, size_t index) {
+    auto lastIndex = archetype.entities.size() - 1;
+    if (index != lastIndex) {
+        auto movedEntityId = archetype.entities[lastIndex];
+        archetype.entities[index] = movedEntityId;
+        for (auto& [group, groupColumns] : archetype.columns) {
+            for (auto& column : groupColumns) {
+                column[index] = std::move(column[lastIndex]);
+            }
+        }
+        entityRows.at(movedEntityId).index = index;
+    }
+
+    archetype.entities.pop_back();
+    for (auto& [group, groupColumns] : archetype.columns) {
+        for (auto& column : groupColumns) {
+            column.pop_back();
+        }
+    }
+}
+
+void ArchetypeIndex::moveEntity(EntityIndex::EntityId entityId,
+                                Archetype& archetype) {
+    auto index = appendRow(archetype, entityId);
+    if (entityRows.contains(entityId)) {
+        auto prevRow = entityRows.at(entityId);
+        // Carry over the values of the component types that the entity keeps
+        for (auto& [group, groupColumns] : prevRow.archetype->columns) {
+            if (!archetype.columns.contains(group)) {
+                continue;
+            }
+            auto& columns = archetype.columns.at(group);
+            for (component::AttrId attrId = 0; attrId < groupColumns.size();
+                 attrId++) {
+                columns[attrId][index] =
+                    std::move(groupColumns[attrId][prevRow.index]);
+            }
+        }
+        swapRemoveRow(*prevRow.archetype, prevRow.index);
+    }
+
+    entityRows[entityId] = Row{&archetype, index};
+}
+
+void ArchetypeIndex::addComponent(EntityIndex::EntityId entityId,
+                                  CompGroup group,
+                                  const component::UserComponent& component) {
+    if (hasComponent(entityId, group)) {
+        throw std::logic_error(
+            "Entity already has a component of the same type. Archetype "
+            "storage allows only one component of each type per entity.");
+    }
+
+    Signature signature;
+    const Archetype* prevArchetype = nullptr;
+    if (entityRows.contains(entityId)) {
+        prevArchetype = entityRows.at(entityId).archetype;
+        signature = prevArchetype->signature;
+    }
+    signature.push_back(group);
+    SignatureIndex::normalize(signature);
+
+    auto& archetype = getArchetype(signature);
+    // Set up the columns if the archetype's table has just been created
+    if (archetype.layouts.empty()) {
+        if (prevArchetype != nullptr) {
+            archetype.layouts = prevArchetype->layouts;
+        }
+        archetype.layouts[group] = component.getLayout();
+        for (auto& [compGroup, layout] : archetype.layouts) {
+            archetype.columns[compGroup].resize(layout->size());
+        }
+    }
+
+    moveEntity(entityId, archetype);
+
+    // Copy the component's values into the table
+    auto index = entityRows.at(entityId).index;
+    auto& values = component.getValues();
+    for (component::AttrId attrId = 0; attrId < values.size(); attrId++) {
+        archetype.column(group, attrId)[index] = values[attrId];
+    }
+}
+
+void ArchetypeIndex::removeComponent(EntityIndex::EntityId entityId,
+                                     CompGroup group) {
+    if (!hasComponent(entityId, group)) {
+        throw std::out_of_range(
+            "Entity does not have a component of the given type");
+    }
+
+    auto row = entityRows.at(entityId);
+    auto signature = row.archetype->signature;
+    signature.erase(std::find(signature.begin(), signature.end(), group));
+
+    // Entities without components are not stored in any table
+    if (signature.empty()) {
+        swapRemoveRow(*row.archetype, row.index);
+        entityRows.erase(entityId);
+        return;
+    }
+
+    auto& archetype = getArchetype(signature);
+    if (archetype.layouts.empty()) {
+        archetype.layouts = row.archetype->layouts;
+        archetype.layouts.erase(group);
+        for (auto& [compGroup, layout] : archetype.layouts) {
+            archetype.columns[compGroup].resize(layout->size());
+        }
+    }
+
+    moveEntity(entityId, archetype);
+}
+
+void ArchetypeIndex::addEntities(
+    std::span<const EntityIndex::EntityId> entityIds, const Layouts& layouts) {
+    // Entities without components are not stored in any table
+    if (layouts.empty()) {
+        return;
+    }
+    for (auto entityId : entityIds) {
+        if (entityRows.contains(entityId)) {
+            throw std::logic_error(
+                "Entity already has components. Only entities without "
+                "components can be added together.");
+        }
+    }
+
+    Signature signature;
+    for (const auto& [group, layout] : layouts) {
+        signature.push_back(group);
+    }
+    SignatureIndex::normalize(signature);
+
+    auto& archetype = getArchetype(signature);
+    if (archetype.layouts.empty()) {
+        archetype.layouts = layouts;
+        for (auto& [compGroup, layout] : archetype.layouts) {
+            archetype.columns[compGroup].resize(layout->size());
+        }
+    }
+
+    // Grow each column of the table once for all the entities
+    auto firstIndex = archetype.entities.size();
+    archetype.entities.insert(archetype.entities.end(), entityIds.begin(),
+                              entityIds.end());
+    for (auto& [group, groupColumns] : archetype.columns) {
+        for (auto& column : groupColumns) {
+            column.resize(archetype.entities.size());
+        }
+    }
+
+    entityRows.reserve(entityRows.size() + entityIds.size());
+    for (size_t i = 0; i < entityIds.size(); i++) {
+        entityRows[entityIds[i]] = Row{&archetype, firstIndex + i};
+    }
+}
+
+bool ArchetypeIndex::hasComponent(EntityIndex::EntityId entityId,
+                                  CompGroup group) const {
+    if (!entityRows.contains(entityId)) {
+        return false;
+    }
+
+    const auto& signature = entityRows.at(entityId).archetype->signature;
+    return std::binary_search(signature.begin(), signature.end(), group);
+}
+
+ArchetypeIndex::Signature ArchetypeIndex::getSignature(
+    EntityIndex::EntityId entityId) const {
+    // Entities without components are not stored in any table
+    if (!entityRows.contains(entityId)) {
+        return Signature();
+    }
+    return entityRows.at(entityId).archetype->signature;
+}
+
+void ArchetypeIndex::removeEntity(EntityIndex::EntityId entityId) {
+    if (!entityRows.contains(entityId)) {
+        return;
+    }
+
+    auto row = entityRows.at(entityId);
+    swapRemoveRow(*row.archetype, row.index);
+    entityRows.erase(entityId);
+}
+
+bento::protos::Value& ArchetypeIndex::getValue(EntityIndex::EntityId entityId,
+                                               CompGroup group,
+                                               component::AttrId attrId) {
+    auto row = entityRows.at(entityId);
+    auto& val = row.archetype->column(group, attrId)[row.index];
+    if (!val.has_primitive() && !val.has_array()) {
+        throw std::runtime_error(
+            "Attempting to retrieve primitive value which has not been set");
+    }
+
+    return val;
+}
+
+const bento::protos::Value& ArchetypeIndex::getStoredValue(
+    EntityIndex::EntityId entityId, CompGroup group,
+    component::AttrId attrId) const {
+    auto row = entityRows.at(entityId);
+    return row.archetype->column(group, attrId)[row.index];
+}
+
+void ArchetypeIndex::setValue(EntityIndex::EntityId entityId, CompGroup group,
+                              component::AttrId attrId,
+                              const bento::protos::Value& value) {
+    auto row = entityRows.at(entityId);
+    auto& archetype = *row.archetype;
+    auto& valToSet = archetype.column(group, attrId)[row.index];
+    component::UserComponent::assignValue(*archetype.layouts.at(group), attrId,
+                                          valToSet, value);
+}
+
+std::vector<const ArchetypeIndex::Archetype*> ArchetypeIndex::query(
+    Signature signature) const {
+    SignatureIndex::normalize(signature);
+
+    std::vector<const Archetype*> matches;
+    for (auto& [archetypeSignature, archetype] : archetypes) {
+        if (!archetype.entities.empty() &&
+            std::includes(archetypeSignature.begin(), archetypeSignature.end(),
+                          signature.begin(), signature.end())) {
+            matches.push_back(&archetype);
+        }
+    }
+    return matches;
+}
+
+size_t ArchetypeIndex::getComponentCount() const {
+    size_t count = 0;
+    for (const auto& [signature, archetype] : archetypes) {
+        count += archetype.entities.size() * signature.size();
+    }
+    return count;
+}
+
+size_t ArchetypeIndex::Archetype::getMemoryUsage() const {
+    return util::getMemoryUsage(signature) + util::getMemoryUsage(entities) +
+           util::getMemoryUsage(layouts) + util::getMemoryUsage(columns);
+}
+
+size_t ArchetypeIndex::getMemoryUsage() const {
+    return util::getMemoryUsage(archetypes) + util::getMemoryUsage(entityRows);
+}
+}  // namespace ics::index
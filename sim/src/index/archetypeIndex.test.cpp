@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include <ics.h>
+#include <index/archetypeIndex.h>
+#include <interpreter/operations.h>
+#include <interpreter/util.h>
+#include <proto/userValue.h>
+#include <test_simulation.h>
+
+#define TEST_SUITE ArchetypeIndex
+
+using namespace ics::index;
+
+using test_simulation::TEST_COMPONENT_NAME;
+using test_simulation::TestComponent;
+
+namespace {
+const char OTHER_COMPONENT_NAME[] = "OtherComponent";
+const ics::component::AttrId WIDTH = TestComponent::WIDTH;
+const ics::component::AttrId HEIGHT = TestComponent::HEIGHT;
+// AttrId of the other component's only attribute
+const ics::component::AttrId SPEED = 0;
+// AttrId which the test component does not have
+const ics::component::AttrId DEPTH = 2;
+
+ics::component::UserComponent createOtherComponent() {
+    return ics::component::UserComponent(
+        OTHER_COMPONENT_NAME,
+        interpreter::createSimpleCompDef(
+            OTHER_COMPONENT_NAME,
+            {{"speed", bento::protos::Type_Primitive_FLOAT32}}));
+}
+
+template <class T>
+bento::protos::Value createVal(T x) {
+    auto val = bento::protos::Value();
+    proto::setVal(val, x);
+    return val;
+}
+}  // namespace
+
+TEST(TEST_SUITE, AddComponentsAndRetrieveValues) {
+    ArchetypeIndex index;
+    index.addComponent(1, 0, TestComponent(10, 20));
+    index.addComponent(2, 0, TestComponent(30, 40));
+
+    ASSERT_TRUE(index.hasComponent(1, 0));
+    ASSERT_FALSE(index.hasComponent(1, 1));
+    ASSERT_EQ(index.getValue(1, 0, WIDTH).primitive().int_64(), 10);
+    ASSERT_EQ(index.getValue(2, 0, HEIGHT).primitive().int_64(), 40);
+    // Unset attributes cannot be retrieved
+    index.addComponent(1, 1, createOtherComponent());
+    ASSERT_THROW(index.getValue(1, 1, SPEED), std::runtime_error);
+    ASSERT_THROW(index.getValue(1, 0, DEPTH), std::out_of_range);
+}
+
+TEST(TEST_SUITE, OnlyOneComponentOfEachType) {
+    ArchetypeIndex index;
+    index.addComponent(1, 0, TestComponent(10, 20));
+    ASSERT_THROW(index.addComponent(1, 0, TestComponent(10, 20)),
+                 std::logic_error);
+}
+
+TEST(TEST_SUITE, EntitiesWithSameComponentsShareTable) {
+    ArchetypeIndex index;
+    for (EntityIndex::EntityId entityId = 1; entityId <= 3; entityId++) {
+        index.addComponent(entityId, 0, TestComponent(entityId, 0));
+    }
+    index.addComponent(2, 1, createOtherComponent());
+
+    auto tables = index.query({0});
+    ASSERT_EQ(tables.size(), 2);
+    size_t nEntities = 0;
+    for (auto* table : tables) {
+        // Every column of a table has a row for each entity in the table
+        ASSERT_EQ(table->column(0, WIDTH).size(), table->entities.size());
+        nEntities += table->entities.size();
+    }
+    ASSERT_EQ(nEntities, 3);
+
+    tables = index.query({1, 0});
+    ASSERT_EQ(tables.size(), 1);
+    ASSERT_EQ(tables[0]->entities.size(), 1);
+    ASSERT_EQ(tables[0]->entities[0], 2);
+}
+
+TEST(TEST_SUITE, AddEntitiesTogether) {
+    ArchetypeIndex index;
+    index.addComponent(1, 0, TestComponent(10, 20));
+
+    std::vector<EntityIndex::EntityId> entityIds = {2, 3, 4};
+    auto layouts = ArchetypeIndex::Layouts{
+        {0, TestComponent().getLayout()},
+        {1, createOtherComponent().getLayout()}};
+    index.addEntities(entityIds, layouts);
+    ASSERT_THROW(index.addEntities(entityIds, layouts), std::logic_error);
+
+    auto tables = index.query({1, 0});
+    ASSERT_EQ(tables.size(), 1);
+    ASSERT_EQ(tables[0]->entities, entityIds);
+    ASSERT_EQ(tables[0]->column(1, SPEED).size(), 3);
+
+    // The new components' attributes are unset until they are set
+    ASSERT_THROW(index.getValue(3, 0, WIDTH), std::runtime_error);
+    index.setValue(3, 0, WIDTH, createVal(proto::INT64{7}));
+    ASSERT_EQ(index.getValue(3, 0, WIDTH).primitive().int_64(), 7);
+    ASSERT_EQ(index.getValue(1, 0, WIDTH).primitive().int_64(), 10);
+
+    // Entities added together can still move between tables
+    index.removeComponent(3, 1);
+    ASSERT_EQ(index.getValue(3, 0, WIDTH).primitive().int_64(), 7);
+    ASSERT_EQ(index.query({1}).at(0)->entities.size(), 2);
+}
+
+TEST(TEST_SUITE, MovingTablesKeepsValues) {
+    ArchetypeIndex index;
+    index.addComponent(1, 0, TestComponent(10, 20));
+    index.addComponent(2, 0, TestComponent(30, 40));
+
+    // Entity 1 moves to another table, and entity 2 fills its row
+    auto otherComponent = createOtherComponent();
+    otherComponent.setValue(SPEED, createVal(1.5f));
+    index.addComponent(1, 1, otherComponent);
+    ASSERT_EQ(index.getValue(1, 0, WIDTH).primitive().int_64(), 10);
+    ASSERT_EQ(index.getValue(1, 1, SPEED).primitive().float_32(), 1.5f);
+    ASSERT_EQ(index.getValue(2, 0, WIDTH).primitive().int_64(), 30);
+
+    index.removeComponent(1, 1);
+    ASSERT_FALSE(index.hasComponent(1, 1));
+    ASSERT_EQ(index.getValue(1, 0, HEIGHT).primitive().int_64(), 20);
+
+    index.removeComponent(1, 0);
+    ASSERT_FALSE(index.hasComponent(1, 0));
+    ASSERT_EQ(index.query({0})[0]->entities.size(), 1);
+}
+
+TEST(TEST_SUITE, SetValueConvertsToSchemaType) {
+    ArchetypeIndex index;
+    index.addComponent(1, 0, TestComponent(10, 20));
+    index.setValue(1, 0, WIDTH, createVal(2.5f));
+    ASSERT_EQ(index.getValue(1, 0, WIDTH).primitive().int_64(), 2);
+    ASSERT_THROW(index.setValue(1, 0, DEPTH, createVal(1.0f)),
+                 std::out_of_range);
+}
+
+TEST(TEST_SUITE, OperationsUseArchetypeStorage) {
+    ics::ComponentStore compStore;
+    IndexStore indexStore;
+    indexStore.useArchetypes = true;
+    auto entityId = indexStore.entity.addEntityId();
+    ics::addComponent(indexStore, compStore, entityId, TestComponent(10, 20));
+    // Components are not stored in the ComponentStore
+    ASSERT_TRUE(compStore.empty());
+
+    auto node = bento::protos::Node_Mutate();
+    node.mutable_mutate_attr()->CopyFrom(
+        interpreter::createAttrRef(TEST_COMPONENT_NAME, entityId, "width"));
+    node.mutable_to_node()->mutable_const_op()->mutable_held_value()->CopyFrom(
+        createVal(proto::INT64{42}));
+    interpreter::mutateOp(compStore, indexStore, node);
+
+    auto retrieveNode = bento::protos::Node_Retrieve();
+    retrieveNode.mutable_retrieve_attr()->CopyFrom(node.mutate_attr());
+    auto& value = interpreter::retrieveOp(compStore, indexStore, retrieveNode);
+    ASSERT_EQ(value.primitive().int_64(), 42);
+    auto group = indexStore.componentType.getComponentType(TEST_COMPONENT_NAME);
+    ASSERT_EQ(ics::queryEntities(indexStore, {group}).size(), 1);
+
+    retrieveNode.mutable_retrieve_attr()->set_component(OTHER_COMPONENT_NAME);
+    ASSERT_THROW(interpreter::retrieveOp(compStore, indexStore, retrieveNode),
+                 std::runtime_error);
+}
@@ -0,0 +1,138 @@
+#include <index/attributeIndex.h>
+#include <core/ics/util/memoryUsage.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace ics::index {
+
+bool AttributeIndex::canResolve(const ComponentTypeIndex& compTypeIndex,
+                                const bento::protos::AttributeRef& ref) const {
+    if (!compTypeIndex.hasComponentType(ref.component())) {
+        return false;
+    }
+
+    auto group = compTypeIndex.getComponentType(ref.component());
+    return hasLayout(group) && getLayout(group).hasAttr(ref.attribute());
+}
+
+void AttributeIndex::internMessage(const ComponentTypeIndex& compTypeIndex,
+                                   const google::protobuf::Message& message) {
+    if (auto ref = dynamic_cast<const bento::protos::AttributeRef*>(&message)) {
+        if (canResolve(compTypeIndex, *ref)) {
+            internedRefs[ref] = resolve(compTypeIndex, *ref);
+        }
+        return;
+    }
+    if (auto spawn = dynamic_cast<const bento::protos::Node_Spawn*>(&message)) {
+        auto known = std::all_of(
+            spawn->components().begin(), spawn->components().end(),
+            [&](const auto& name) {
+                return compTypeIndex.hasComponentType(name);
+            });
+        if (known) {
+            internedSpawns[spawn] = resolveSpawn(compTypeIndex, *spawn);
+        }
+        return;
+    }
+
+    // Walk through the set message fields with reflection so that any node
+    // type holding an AttributeRef is interned
+    auto reflection = message.GetReflection();
+    std::vector<const google::protobuf::FieldDescriptor*> fields;
+    reflection->ListFields(message, &fields);
+    for (auto field : fields) {
+        if (field->cpp_type() !=
+            google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE) {
+            continue;
+        }
+
+        if (field->is_repeated()) {
+            for (int i = 0; i < reflection->FieldSize(message, field); i++) {
+                internMessage(compTypeIndex, reflection->GetRepeatedMessage(
+                                                 message, field, i));
+            }
+        } else {
+            internMessage(compTypeIndex,
+                          reflection->GetMessage(message, field));
+        }
+    }
+}
+
+void AttributeIndex::addLayout(
+    CompGroup group, std::shared_ptr<const component::ComponentLayout> layout) {
+    if (group >= layouts.size()) {
+        layouts.resize(group + 1);
+    }
+    if (layouts[group] == nullptr) {
+        layouts[group] = std::move(layout);
+    }
+}
+
+bool AttributeIndex::hasLayout(CompGroup group) const {
+    return group < layouts.size() && layouts[group] != nullptr;
+}
+
+const component::ComponentLayout& AttributeIndex::getLayout(
+    CompGroup group) const {
+    if (!hasLayout(group)) {
+        throw std::out_of_range("No layout for the given component type");
+    }
+    return *layouts[group];
+}
+
+std::shared_ptr<const component::ComponentLayout>
+AttributeIndex::getSharedLayout(CompGroup group) const {
+    if (!hasLayout(group)) {
+        throw std::out_of_range("No layout for the given component type");
+    }
+    return layouts[group];
+}
+
+void AttributeIndex::internGraph(const ComponentTypeIndex& compTypeIndex,
+                                 const bento::protos::Graph& graph) {
+    internMessage(compTypeIndex, graph);
+}
+
+AttributeIndex::AttrRefIds AttributeIndex::resolve(
+    const ComponentTypeIndex& compTypeIndex,
+    const bento::protos::AttributeRef& ref) const {
+    if (internedRefs.contains(&ref)) {
+        return internedRefs.at(&ref);
+    }
+
+    // No component of an unknown type can exist, so report it the same way
+    // as a missing component
+    if (!compTypeIndex.hasComponentType(ref.component()) ||
+        !hasLayout(compTypeIndex.getComponentType(ref.component()))) {
+        throw std::runtime_error(
+            "No component with typeName and entityId found.");
+    }
+
+    auto group = compTypeIndex.getComponentType(ref.component());
+    return AttrRefIds{group, ref.entity_id(),
+                      getLayout(group).getAttrId(ref.attribute())};
+}
+
+std::vector<CompGroup> AttributeIndex::resolveSpawn(
+    const ComponentTypeIndex& compTypeIndex,
+    const bento::protos::Node_Spawn& spawn) const {
+    auto it = internedSpawns.find(&spawn);
+    if (it != internedSpawns.end()) {
+        return it->second;
+    }
+
+    std::vector<CompGroup> groups;
+    groups.reserve(spawn.components_size());
+    for (const auto& typeName : spawn.components()) {
+        groups.push_back(compTypeIndex.getComponentType(typeName));
+    }
+    return groups;
+}
+
+size_t AttributeIndex::getMemoryUsage() const {
+    return util::getMemoryUsage(layouts) + util::getMemoryUsage(internedRefs) +
+           util::getMemoryUsage(internedSpawns);
+}
+
+}  // namespace ics::index
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <index/attributeIndex.h>
+#include <interpreter/util.h>
+
+#define TEST_SUITE AttributeIndex
+
+using namespace ics::index;
+using namespace ics::component;
+
+namespace {
+std::shared_ptr<const ComponentLayout> createLayout() {
+    return std::make_shared<const ComponentLayout>(
+        interpreter::createSimpleCompDef(
+            "position", {{"y", bento::protos::Type_Primitive_INT64},
+                         {"x", bento::protos::Type_Primitive_INT64}}));
+}
+}  // namespace
+
+TEST(TEST_SUITE, AddLayoutKeepsFirstLayout) {
+    AttributeIndex index;
+    ASSERT_FALSE(index.hasLayout(1));
+    auto layout = createLayout();
+    index.addLayout(1, layout);
+    index.addLayout(1, createLayout());
+
+    ASSERT_TRUE(index.hasLayout(1));
+    ASSERT_FALSE(index.hasLayout(0));
+    ASSERT_EQ(&index.getLayout(1), layout.get());
+    ASSERT_THROW(index.getLayout(0), std::out_of_range);
+}
+
+TEST(TEST_SUITE, ResolveByName) {
+    ComponentTypeIndex compTypeIndex;
+    AttributeIndex index;
+    auto group = compTypeIndex.addComponentType("position");
+    index.addLayout(group, createLayout());
+
+    auto ref = interpreter::createAttrRef("position", 3, "y");
+    auto refIds = index.resolve(compTypeIndex, ref);
+    ASSERT_EQ(refIds.group, group);
+    ASSERT_EQ(refIds.entityId, 3);
+    ASSERT_EQ(refIds.attrId, index.getLayout(group).getAttrId("y"));
+
+    auto unknownAttr = interpreter::createAttrRef("position", 3, "z");
+    ASSERT_THROW(index.resolve(compTypeIndex, unknownAttr), std::out_of_range);
+    auto unknownComp = interpreter::createAttrRef("velocity", 3, "x");
+    ASSERT_THROW(index.resolve(compTypeIndex, unknownComp),
+                 std::runtime_error);
+}
+
+TEST(TEST_SUITE, InternGraphResolvesNestedRefs) {
+    ComponentTypeIndex compTypeIndex;
+    AttributeIndex index;
+    auto group = compTypeIndex.addComponentType("position");
+    index.addLayout(group, createLayout());
+
+    // x = y, where the retrieve is nested in the mutate
+    bento::protos::Graph graph;
+    auto& mutateOp = *graph.add_outputs();
+    *mutateOp.mutable_mutate_attr() =
+        interpreter::createAttrRef("position", 1, "x");
+    *mutateOp.mutable_to_node()
+         ->mutable_retrieve_op()
+         ->mutable_retrieve_attr() =
+        interpreter::createAttrRef("position", 1, "y");
+    index.internGraph(compTypeIndex, graph);
+
+    // Interned refs resolve to the same IDs as resolving by name
+    auto& retrieveRef = mutateOp.to_node().retrieve_op().retrieve_attr();
+    auto refIds = index.resolve(compTypeIndex, retrieveRef);
+    ASSERT_EQ(refIds.group, group);
+    ASSERT_EQ(refIds.entityId, 1);
+    ASSERT_EQ(refIds.attrId, index.getLayout(group).getAttrId("y"));
+
+    refIds = index.resolve(compTypeIndex, mutateOp.mutate_attr());
+    ASSERT_EQ(refIds.attrId, index.getLayout(group).getAttrId("x"));
+}
+
+TEST(TEST_SUITE, InternGraphSkipsUnknownRefs) {
+    ComponentTypeIndex compTypeIndex;
+    AttributeIndex index;
+    bento::protos::Graph graph;
+    *graph.add_inputs()->mutable_retrieve_attr() =
+        interpreter::createAttrRef("position", 1, "x");
+
+    ASSERT_NO_THROW(index.internGraph(compTypeIndex, graph));
+    ASSERT_ANY_THROW(
+        index.resolve(compTypeIndex, graph.inputs(0).retrieve_attr()));
+}
+
+TEST(TEST_SUITE, InternGraphResolvesSpawns) {
+    ComponentTypeIndex compTypeIndex;
+    AttributeIndex index;
+    auto group = compTypeIndex.addComponentType("position");
+
+    bento::protos::Graph graph;
+    auto& spawn = *graph.add_effects()->mutable_spawn_op();
+    spawn.add_components("position");
+    auto& unknownSpawn = *graph.add_effects()->mutable_spawn_op();
+    unknownSpawn.add_components("velocity");
+    index.internGraph(compTypeIndex, graph);
+
+    ASSERT_EQ(index.resolveSpawn(compTypeIndex, spawn),
+              std::vector<ics::CompGroup>{group});
+    // Spawns of unknown types fail when they are resolved
+    ASSERT_THROW(index.resolveSpawn(compTypeIndex, unknownSpawn),
+                 std::out_of_range);
+}
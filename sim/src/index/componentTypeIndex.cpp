@@ -1,8 +1,9 @@
 #include <index/componentTypeIndex.h>
+#include <core/ics/util/memoryUsage.h>
 
 namespace ics::index {
 
-bool ComponentTypeIndex::hasComponentType(const std::string& name) {
+bool ComponentTypeIndex::hasComponentType(const std::string& name) const {
     return typeNameGroupMap.contains(name);
 }
 
@@ -19,8 +20,12 @@ CompGroup ComponentTypeIndex::addComponentType(const std::string& name) {
     return typeNameGroupMap.at(name);
 }
 
-CompGroup ComponentTypeIndex::getComponentType(const std::string& name) {
+CompGroup ComponentTypeIndex::getComponentType(const std::string& name) const {
     return typeNameGroupMap.at(name);
 }
 
+size_t ComponentTypeIndex::getMemoryUsage() const {
+    return util::getMemoryUsage(typeNameGroupMap);
+}
+
 }  // namespace ics::index
\ No newline at end of file
@@ -51,3 +51,15 @@ TEST(TEST_SUITE, UseComponentTypeIsFilter) {
 
     ASSERT_EQ(cumProd, 130);
 }
+
+TEST(TEST_SUITE, UseComponentTypeFilterOnSortedCompSet) {
+    ComponentTypeIndex index;
+    auto group = index.addComponentType("TestComponent");
+    auto filter = index.filterCompType("TestComponent");
+
+    ics::SortedCompSet compSet(std::vector<ics::CompStoreId>{
+        {group, 2}, {group, 5}, {group + 1, 3}});
+    auto filteredSet = filter(compSet);
+    ASSERT_EQ(filteredSet.size(), 2);
+    ASSERT_TRUE(filteredSet.groupIds(group + 1).empty());
+}
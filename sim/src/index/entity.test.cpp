@@ -55,14 +55,14 @@ TEST(TEST_SUITE, UseIndexIdFilter) {
 
     auto filteredSet = filter(compSet);
     // None of the components match because no component was assigned an entity
-    ASSERT_EQ(filteredSet.size(), 0);
+    ASSERT_EQ(std::ranges::distance(filteredSet), 0);
 
     index.addComponent(entityId, std::pair(1, 2));
     index.addComponent(entityId, std::pair(1, 5));
     index.addComponent(entityId, std::pair(2, 13));
 
     filteredSet = filter(compSet);
-    ASSERT_EQ(filteredSet.size(), 3);
+    ASSERT_EQ(std::ranges::distance(filteredSet), 3);
 
     int cumProd = 1;
     for (auto pair : filteredSet) {
@@ -71,3 +71,130 @@ TEST(TEST_SUITE, UseIndexIdFilter) {
 
     ASSERT_EQ(cumProd, 130);
 }
+
+TEST(TEST_SUITE, UseIndexIdFilterOnCompSetView) {
+    ics::ComponentStore store;
+    EntityIndex index;
+    auto entityId = index.addEntityId();
+
+    auto compStoreId = ics::addComponent(store, ics::BaseComponent(), 1);
+    ics::addComponent(store, ics::BaseComponent(), 1);
+    auto otherGroupId = ics::addComponent(store, ics::BaseComponent(), 2);
+    index.addComponent(entityId, compStoreId);
+    index.addComponent(entityId, otherGroupId);
+
+    auto filter = index.filterEntityId(entityId);
+    ASSERT_EQ(std::ranges::distance(filter(ics::asCompSet(store))), 2);
+
+    auto filtered = filter(ics::asCompSet(store).withGroup(1));
+    ASSERT_EQ(std::ranges::distance(filtered), 1);
+    ASSERT_EQ(*filtered.begin(), compStoreId);
+
+    // The filter reads the store when it is evaluated, so components removed
+    // from the store are no longer matched
+    ics::getCompVec<ics::BaseComponent>(store, 1).remove(compStoreId.second);
+    ASSERT_EQ(std::ranges::distance(filter(ics::asCompSet(store))), 1);
+}
+
+TEST(TEST_SUITE, FilteredViewOutlivesIndexChanges) {
+    ics::ComponentStore store;
+    EntityIndex index;
+    auto entityId = index.addEntityId();
+    auto compStoreId = ics::addComponent(store, ics::BaseComponent(), 1);
+    index.addComponent(entityId, compStoreId);
+
+    auto filtered = index.filterEntityId(entityId)(ics::asCompSet(store));
+    // Adding entities moves the components held by the index
+    for (int i = 0; i < 1000; i++) {
+        index.addEntityId();
+    }
+    ASSERT_EQ(std::ranges::distance(filtered), 1);
+    ASSERT_EQ(*filtered.begin(), compStoreId);
+}
+
+TEST(TEST_SUITE, SetEntityIdsAcrossPages) {
+    EntityIndex index;
+    std::vector<EntityIndex::EntityId> ids{3, 100000, 7};
+    index.setEntityIds(ids);
+
+    ASSERT_TRUE(index.hasEntity(100000));
+    ASSERT_FALSE(index.hasEntity(4));
+    ASSERT_FALSE(index.hasEntity(200000));
+    ASSERT_THROW(index.getComponents(4), std::out_of_range);
+    ASSERT_EQ(index.getEntityIds().size(), 3);
+
+    // New entity IDs continue after the largest configured ID
+    ASSERT_EQ(index.addEntityId(), 100001);
+    ASSERT_EQ(index.getEntityIds().size(), 4);
+}
+
+TEST(TEST_SUITE, ManyComponentsPerEntity) {
+    EntityIndex index;
+    auto entityId = index.addEntityId();
+    // More components than are stored inline
+    for (ics::CompId i = 0; i < 10; i++) {
+        index.addComponent(entityId, std::pair(i, i));
+    }
+    index.addComponent(entityId, std::pair(3, 3));
+    ASSERT_EQ(index.getComponents(entityId).size(), 10);
+
+    for (ics::CompId i = 0; i < 8; i++) {
+        index.removeComponent(entityId, std::pair(i, i));
+    }
+    auto components = index.getComponents(entityId);
+    ASSERT_EQ(components.size(), 2);
+    ASSERT_EQ(components[0], std::pair(ics::CompGroup(8), ics::CompId(8)));
+}
+
+TEST(TEST_SUITE, UseIndexIdFilterOnSortedCompSet) {
+    EntityIndex index;
+    auto entityId = index.addEntityId();
+    index.addComponent(entityId, std::pair(1, 2));
+    index.addComponent(entityId, std::pair(2, 13));
+
+    ics::SortedCompSet compSet(
+        std::vector<ics::CompStoreId>{{1, 2}, {1, 5}, {2, 13}, {3, 7}});
+    auto filteredSet = index.filterEntityId(entityId)(compSet);
+    ASSERT_EQ(filteredSet.size(), 2);
+    ASSERT_TRUE(filteredSet.contains({2, 13}));
+}
+
+TEST(TEST_SUITE, AddEntityIdWithGivenId) {
+    EntityIndex index;
+    ASSERT_EQ(index.addEntityId(5), 5);
+    ASSERT_TRUE(index.hasEntity(5));
+    ASSERT_THROW(index.addEntityId(5), std::invalid_argument);
+    // Generated IDs continue after the given ID
+    ASSERT_EQ(index.addEntityId(), 6);
+}
+
+TEST(TEST_SUITE, RemoveEntity) {
+    EntityIndex index;
+    auto entityId1 = index.addEntityId();
+    auto entityId2 = index.addEntityId();
+    auto entityId3 = index.addEntityId();
+    index.addComponent(entityId3, std::pair(1, 1));
+
+    index.removeEntity(entityId1);
+    ASSERT_FALSE(index.hasEntity(entityId1));
+    ASSERT_THROW(index.getComponents(entityId1), std::out_of_range);
+    ASSERT_THROW(index.removeEntity(entityId1), std::out_of_range);
+
+    // The entity moved into the removed entity's place keeps its components
+    ASSERT_EQ(index.getEntityIds().size(), 2);
+    ASSERT_TRUE(index.hasEntity(entityId2));
+    ASSERT_EQ(index.getComponents(entityId3).size(), 1);
+}
+
+TEST(TEST_SUITE, AddEntityIdRange) {
+    EntityIndex index;
+    index.addEntityId(10);
+    auto firstEntityId = index.addEntityIds(5000);
+    // The range starts after the largest ID in use
+    ASSERT_EQ(firstEntityId, 11);
+    ASSERT_EQ(index.getEntityIds().size(), 5001);
+    ASSERT_TRUE(index.hasEntity(11));
+    ASSERT_TRUE(index.hasEntity(5010));
+    ASSERT_FALSE(index.hasEntity(5011));
+    ASSERT_EQ(index.addEntityId(), 5011);
+}
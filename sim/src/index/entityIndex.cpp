@@ -1,30 +1,123 @@
 #include <index/entityIndex.h>
+#include <core/ics/util/memoryUsage.h>
 
 namespace ics::index {
 
+size_t EntityIndex::findIndex(EntityId entityId) const {
+    auto pageIdx = entityId / PAGE_SIZE;
+    if (pageIdx >= sparsePages.size() || sparsePages[pageIdx] == nullptr) {
+        return NO_INDEX;
+    }
+    return (*sparsePages[pageIdx])[entityId % PAGE_SIZE];
+}
+
+size_t EntityIndex::indexOf(EntityId entityId) const {
+    auto index = findIndex(entityId);
+    if (index == NO_INDEX) {
+        throw std::out_of_range("EntityIndex: no entity with the given ID");
+    }
+    return index;
+}
+
+void EntityIndex::insertEntity(EntityId entityId) {
+    auto pageIdx = entityId / PAGE_SIZE;
+    if (pageIdx >= sparsePages.size()) {
+        sparsePages.resize(pageIdx + 1);
+    }
+    if (sparsePages[pageIdx] == nullptr) {
+        sparsePages[pageIdx] = std::make_unique<Page>();
+        sparsePages[pageIdx]->fill(NO_INDEX);
+    }
+
+    (*sparsePages[pageIdx])[entityId % PAGE_SIZE] = denseEntities.size();
+    denseEntities.push_back(entityId);
+    denseComponents.emplace_back();
+}
+
 EntityIndex::EntityId EntityIndex::addEntityId() {
     // Update the next entity id
     auto entityId = nextEntityId;
     nextEntityId++;
 
-    // Update the entityCompMap
-    entityCompMap.emplace(entityId, std::unordered_set<CompStoreId>());
+    insertEntity(entityId);
+    return entityId;
+}
+
+EntityIndex::EntityId EntityIndex::addEntityId(EntityId entityId) {
+    if (hasEntity(entityId)) {
+        throw std::invalid_argument("EntityIndex: entity ID is already in use");
+    }
+
+    insertEntity(entityId);
+    if (entityId >= nextEntityId) {
+        nextEntityId = entityId + 1;
+    }
     return entityId;
 }
 
+EntityIndex::EntityId EntityIndex::addEntityIds(size_t count) {
+    auto firstEntityId = nextEntityId;
+    reserve(denseEntities.size() + count);
+    for (size_t i = 0; i < count; i++) {
+        insertEntity(firstEntityId + i);
+    }
+    nextEntityId += count;
+    return firstEntityId;
+}
+
+void EntityIndex::reserve(size_t capacity) {
+    denseEntities.reserve(capacity);
+    denseComponents.reserve(capacity);
+}
+
+void EntityIndex::removeEntity(EntityId entityId) {
+    auto index = indexOf(entityId);
+    auto lastIndex = denseEntities.size() - 1;
+
+    // Move the last entity into the removed entity's place
+    if (index != lastIndex) {
+        auto movedEntityId = denseEntities[lastIndex];
+        denseEntities[index] = movedEntityId;
+        denseComponents[index] = std::move(denseComponents[lastIndex]);
+        (*sparsePages[movedEntityId / PAGE_SIZE])[movedEntityId % PAGE_SIZE] =
+            index;
+    }
+    denseEntities.pop_back();
+    denseComponents.pop_back();
+    (*sparsePages[entityId / PAGE_SIZE])[entityId % PAGE_SIZE] = NO_INDEX;
+}
+
 void EntityIndex::addComponent(EntityId entityId,
                                const CompStoreId& compStoreId) {
-    entityCompMap.at(entityId).insert(compStoreId);
+    auto& compList = denseComponents[indexOf(entityId)];
+    // Each CompStoreId is only stored once per entity
+    if (!compList.contains(compStoreId)) {
+        compList.push_back(compStoreId);
+    }
 }
 
-std::unordered_set<CompStoreId> EntityIndex::getComponents(
+bool EntityIndex::hasEntity(EntityId entityId) const {
+    return findIndex(entityId) != NO_INDEX;
+}
+
+std::span<const EntityIndex::EntityId> EntityIndex::getEntityIds() const {
+    return std::span<const EntityId>(denseEntities);
+}
+
+std::span<const CompStoreId> EntityIndex::getComponents(
     EntityId entityId) const {
-    return entityCompMap.at(entityId);
+    return denseComponents[indexOf(entityId)].span();
 }
 
 void EntityIndex::removeComponent(EntityId entityId,
                                   const CompStoreId& compStoreId) {
-    entityCompMap.at(entityId).erase(compStoreId);
+    denseComponents[indexOf(entityId)].erase(compStoreId);
+}
+
+size_t EntityIndex::getMemoryUsage() const {
+    return util::getMemoryUsage(sparsePages) +
+           util::getMemoryUsage(denseEntities) +
+           util::getMemoryUsage(denseComponents);
 }
 
-}  // namespace ics::index
\ No newline at end of file
+}  // namespace ics::index
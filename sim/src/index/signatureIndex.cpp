@@ -0,0 +1,112 @@
+#include <index/signatureIndex.h>
+#include <core/ics/util/memoryUsage.h>
+
+#include <algorithm>
+
+namespace ics::index {
+void SignatureIndex::normalize(Signature& signature) {
+    std::sort(signature.begin(), signature.end());
+    signature.erase(std::unique(signature.begin(), signature.end()),
+                    signature.end());
+}
+
+bool SignatureIndex::matches(EntityIndex::EntityId entityId,
+                             const Signature& signature) const {
+    if (!entityGroupCounts.contains(entityId)) {
+        return signature.empty();
+    }
+
+    const auto& groupCounts = entityGroupCounts.at(entityId);
+    return std::all_of(
+        signature.begin(), signature.end(),
+        [&groupCounts](CompGroup group) { return groupCounts.contains(group); });
+}
+
+const std::vector<EntityIndex::EntityId>& SignatureIndex::query(
+    Signature signature) {
+    normalize(signature);
+    if (queries.contains(signature)) {
+        return queries.at(signature).entities;
+    }
+
+    // Build the entity list for the new signature from the entities' groups
+    auto& query = queries[signature];
+    query.signature = signature;
+    for (const auto& [entityId, groupCounts] : entityGroupCounts) {
+        if (matches(entityId, signature)) {
+            query.positions.emplace(entityId, query.entities.size());
+            query.entities.push_back(entityId);
+        }
+    }
+
+    for (auto group : signature) {
+        groupQueries[group].push_back(&query);
+    }
+    return query.entities;
+}
+
+bool SignatureIndex::isCached(Signature signature) const {
+    normalize(signature);
+    return queries.contains(signature);
+}
+
+void SignatureIndex::addComponent(EntityIndex::EntityId entityId,
+                                  CompGroup group) {
+    auto& count = entityGroupCounts[entityId][group];
+    ++count;
+    // The entity's signature only changes on its first component of the group
+    if (count > 1 || !groupQueries.contains(group)) {
+        return;
+    }
+
+    for (auto* query : groupQueries.at(group)) {
+        if (matches(entityId, query->signature)) {
+            query->positions.emplace(entityId, query->entities.size());
+            query->entities.push_back(entityId);
+        }
+    }
+}
+
+void SignatureIndex::removeComponent(EntityIndex::EntityId entityId,
+                                     CompGroup group) {
+    auto& groupCounts = entityGroupCounts.at(entityId);
+    auto& count = groupCounts.at(group);
+    --count;
+    // The entity's signature only changes on its last component of the group
+    if (count > 0) {
+        return;
+    }
+    groupCounts.erase(group);
+
+    if (!groupQueries.contains(group)) {
+        return;
+    }
+    for (auto* query : groupQueries.at(group)) {
+        if (!query->positions.contains(entityId)) {
+            continue;
+        }
+
+        // Swap remove the entity from the query's entity list
+        auto position = query->positions.at(entityId);
+        auto lastEntityId = query->entities.back();
+        query->entities[position] = lastEntityId;
+        query->positions[lastEntityId] = position;
+        query->entities.pop_back();
+        query->positions.erase(entityId);
+    }
+}
+
+void SignatureIndex::reserve(size_t entityCount) {
+    entityGroupCounts.reserve(entityCount);
+}
+
+size_t SignatureIndex::Query::getMemoryUsage() const {
+    return util::getMemoryUsage(signature) + util::getMemoryUsage(entities) +
+           util::getMemoryUsage(positions);
+}
+
+size_t SignatureIndex::getMemoryUsage() const {
+    return util::getMemoryUsage(entityGroupCounts) +
+           util::getMemoryUsage(queries) + util::getMemoryUsage(groupQueries);
+}
+}  // namespace ics::index
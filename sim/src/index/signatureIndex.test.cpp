@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <ics.h>
+#include <index/signatureIndex.h>
+#include <test_simulation.h>
+
+#define TEST_SUITE SignatureIndex
+
+using namespace ics::index;
+
+TEST(TEST_SUITE, QueryMatchesEntitiesWithAllGroups) {
+    SignatureIndex index;
+    index.addComponent(1, 0);
+    index.addComponent(1, 1);
+    index.addComponent(2, 0);
+    index.addComponent(3, 1);
+
+    ASSERT_EQ(index.query({0}).size(), 2);
+    ASSERT_EQ(index.query({1}).size(), 2);
+
+    const auto& entities = index.query({1, 0});
+    ASSERT_EQ(entities.size(), 1);
+    ASSERT_EQ(entities[0], 1);
+}
+
+TEST(TEST_SUITE, SignatureOrderDoesNotMatter) {
+    SignatureIndex index;
+    ASSERT_FALSE(index.isCached({0, 1}));
+    index.query({1, 0, 1});
+    ASSERT_TRUE(index.isCached({0, 1}));
+    ASSERT_EQ(&index.query({0, 1}), &index.query({1, 0}));
+}
+
+TEST(TEST_SUITE, CachedQueryUpdatedOnAdd) {
+    SignatureIndex index;
+    const auto& entities = index.query({0, 1});
+    ASSERT_TRUE(entities.empty());
+
+    index.addComponent(1, 0);
+    ASSERT_TRUE(entities.empty());
+    index.addComponent(1, 1);
+    ASSERT_EQ(entities.size(), 1);
+    // Adding another component of the same group does not add the entity
+    // a second time
+    index.addComponent(1, 1);
+    ASSERT_EQ(entities.size(), 1);
+}
+
+TEST(TEST_SUITE, CachedQueryUpdatedOnRemove) {
+    SignatureIndex index;
+    for (EntityIndex::EntityId entityId = 1; entityId <= 3; entityId++) {
+        index.addComponent(entityId, 0);
+        index.addComponent(entityId, 1);
+    }
+    index.addComponent(2, 1);
+
+    const auto& entities = index.query({0, 1});
+    ASSERT_EQ(entities.size(), 3);
+
+    index.removeComponent(1, 0);
+    ASSERT_EQ(entities.size(), 2);
+    // Entity 2 still has a component of group 1 after the removal
+    index.removeComponent(2, 1);
+    ASSERT_EQ(entities.size(), 2);
+    index.removeComponent(2, 1);
+    ASSERT_EQ(entities.size(), 1);
+    ASSERT_EQ(entities[0], 3);
+}
+
+TEST(TEST_SUITE, QueryEntitiesByType) {
+    ics::index::IndexStore indexStore;
+    ics::ComponentStore compStore;
+    auto entityId = indexStore.entity.addEntityId();
+    auto otherEntityId = indexStore.entity.addEntityId();
+
+    // The query picks up components added after it was made
+    auto group = indexStore.componentType.addComponentType(
+        test_simulation::TEST_COMPONENT_NAME);
+    const auto& entities = ics::queryEntities(indexStore, {group});
+    ASSERT_TRUE(entities.empty());
+
+    auto compStoreId = ics::addComponent(indexStore, compStore, entityId,
+                                         test_simulation::TestComponent(1, 2));
+    ics::addComponent(indexStore, compStore, otherEntityId,
+                      test_simulation::TestComponent(3, 4));
+    ASSERT_EQ(entities.size(), 2);
+
+    ics::removeComponent(indexStore, compStore, entityId, compStoreId);
+    ASSERT_EQ(entities.size(), 1);
+    ASSERT_EQ(entities[0], otherEntityId);
+    ASSERT_EQ(indexStore.entity.getComponents(entityId).size(), 0);
+}
@@ -0,0 +1,123 @@
+#include <index/versionIndex.h>
+#include <core/ics/util/memoryUsage.h>
+
+#include <algorithm>
+#include <tuple>
+
+namespace ics::index {
+
+size_t VersionIndex::Page::getMemoryUsage() const {
+    size_t bytes = 0;
+    for (const auto& attrVersions : components) {
+        bytes += util::getMemoryUsage(attrVersions);
+    }
+    return bytes;
+}
+
+const std::vector<VersionIndex::Version>* VersionIndex::findVersions(
+    CompGroup group, EntityIndex::EntityId entityId) const {
+    auto pageIdx = entityId / PAGE_SIZE;
+    if (group >= versions.size() || pageIdx >= versions[group].size() ||
+        versions[group][pageIdx] == nullptr) {
+        return nullptr;
+    }
+    return &versions[group][pageIdx]->components[entityId % PAGE_SIZE];
+}
+
+std::vector<VersionIndex::Version>& VersionIndex::getVersions(
+    CompGroup group, EntityIndex::EntityId entityId) {
+    auto pageIdx = entityId / PAGE_SIZE;
+    if (group >= versions.size()) {
+        versions.resize(group + 1);
+    }
+    auto& pages = versions[group];
+    if (pageIdx >= pages.size()) {
+        pages.resize(pageIdx + 1);
+    }
+    if (pages[pageIdx] == nullptr) {
+        pages[pageIdx] = std::make_unique<Page>();
+    }
+    return pages[pageIdx]->components[entityId % PAGE_SIZE];
+}
+
+VersionIndex::Version VersionIndex::bump(
+    const AttributeIndex::AttrRefIds& refIds) {
+    auto& attrVersions = getVersions(refIds.group, refIds.entityId);
+    if (refIds.attrId >= attrVersions.size()) {
+        attrVersions.resize(refIds.attrId + 1, UNWRITTEN);
+    }
+    auto& version = attrVersions[refIds.attrId];
+    if (trackingChanges && version <= changesVersion) {
+        changes.attributes.push_back(refIds);
+    }
+    version = ++clock;
+    return version;
+}
+
+VersionIndex::Version VersionIndex::get(
+    const AttributeIndex::AttrRefIds& refIds) const {
+    auto attrVersions = findVersions(refIds.group, refIds.entityId);
+    if (attrVersions == nullptr || refIds.attrId >= attrVersions->size()) {
+        return UNWRITTEN;
+    }
+    return (*attrVersions)[refIds.attrId];
+}
+
+void VersionIndex::removeComponent(EntityIndex::EntityId entityId,
+                                   CompGroup group) {
+    if (findVersions(group, entityId) != nullptr) {
+        // Release the versions, as the entity may not get a component of
+        // this type again
+        std::vector<Version>().swap(getVersions(group, entityId));
+    }
+    structureVersion++;
+    if (trackingChanges) {
+        changes.removedComponents.emplace_back(entityId, group);
+    }
+}
+
+void VersionIndex::addComponent(EntityIndex::EntityId entityId,
+                                CompGroup group, size_t attrCount) {
+    if (!trackingChanges) {
+        return;
+    }
+    for (component::AttrId attrId = 0; attrId < attrCount; attrId++) {
+        changes.attributes.push_back({group, entityId, attrId});
+    }
+}
+
+void VersionIndex::trackChanges(bool track) {
+    trackingChanges = track;
+    changesVersion = clock;
+    changes = Changes();
+}
+
+VersionIndex::Changes VersionIndex::takeChanges() {
+    // New components are not stamped, so their attributes can be collected
+    // again if they are written after being created
+    auto key = [](const AttributeIndex::AttrRefIds& refIds) {
+        return std::tie(refIds.group, refIds.entityId, refIds.attrId);
+    };
+    auto& attributes = changes.attributes;
+    std::sort(attributes.begin(), attributes.end(),
+              [&](const auto& a, const auto& b) { return key(a) < key(b); });
+    attributes.erase(
+        std::unique(attributes.begin(), attributes.end(),
+                    [&](const auto& a, const auto& b) {
+                        return key(a) == key(b);
+                    }),
+        attributes.end());
+
+    changesVersion = clock;
+    return std::exchange(changes, Changes());
+}
+
+VersionIndex::Version VersionIndex::getStructureVersion() const {
+    return structureVersion;
+}
+
+size_t VersionIndex::getMemoryUsage() const {
+    return util::getMemoryUsage(versions);
+}
+
+}  // namespace ics::index
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include <index/versionIndex.h>
+
+#define TEST_SUITE VersionIndex
+
+using namespace ics::index;
+
+TEST(TEST_SUITE, BumpGivesNewVersion) {
+    VersionIndex index;
+    auto width = AttributeIndex::AttrRefIds{0, 1, 0};
+    auto height = AttributeIndex::AttrRefIds{0, 1, 1};
+    ASSERT_EQ(index.get(width), VersionIndex::UNWRITTEN);
+
+    auto version = index.bump(width);
+    ASSERT_NE(version, VersionIndex::UNWRITTEN);
+    ASSERT_EQ(index.get(width), version);
+    ASSERT_EQ(index.get(height), VersionIndex::UNWRITTEN);
+
+    // Every write changes the version, even when a different attribute was
+    // written in between
+    index.bump(height);
+    ASSERT_NE(index.bump(width), version);
+}
+
+TEST(TEST_SUITE, RemoveComponentForgetsVersions) {
+    VersionIndex index;
+    auto width = AttributeIndex::AttrRefIds{0, 1, 0};
+    auto otherEntity = AttributeIndex::AttrRefIds{0, 2, 0};
+    index.bump(width);
+    auto otherVersion = index.bump(otherEntity);
+    auto structureVersion = index.getStructureVersion();
+
+    index.removeComponent(1, 0);
+    ASSERT_EQ(index.get(width), VersionIndex::UNWRITTEN);
+    ASSERT_EQ(index.get(otherEntity), otherVersion);
+    ASSERT_NE(index.getStructureVersion(), structureVersion);
+}
+
+TEST(TEST_SUITE, TracksChangesOnce) {
+    VersionIndex index;
+    auto width = AttributeIndex::AttrRefIds{0, 1, 0};
+    auto height = AttributeIndex::AttrRefIds{0, 1, 1};
+    // Writes before tracking starts are not collected
+    index.bump(width);
+    index.trackChanges(true);
+    ASSERT_TRUE(index.takeChanges().attributes.empty());
+
+    index.bump(width);
+    index.bump(width);
+    index.addComponent(2, 1, 1);
+    index.bump(AttributeIndex::AttrRefIds{1, 2, 0});
+    index.removeComponent(3, 0);
+    auto changes = index.takeChanges();
+    ASSERT_EQ(changes.attributes.size(), 2);
+    ASSERT_EQ(changes.attributes[0].entityId, 1);
+    ASSERT_EQ(changes.attributes[1].entityId, 2);
+    ASSERT_EQ(changes.removedComponents.size(), 1);
+    ASSERT_EQ(changes.removedComponents[0].first, 3);
+
+    // Attributes are collected again once the changes have been taken
+    index.bump(width);
+    index.bump(height);
+    ASSERT_EQ(index.takeChanges().attributes.size(), 2);
+
+    index.trackChanges(false);
+    index.bump(width);
+    ASSERT_TRUE(index.takeChanges().attributes.empty());
+}
+
+TEST(TEST_SUITE, VersionsOfDistantEntities) {
+    VersionIndex index;
+    auto nearAttr = AttributeIndex::AttrRefIds{2, 1, 3};
+    auto farAttr = AttributeIndex::AttrRefIds{2, 1000000, 3};
+    auto nearVersion = index.bump(nearAttr);
+    auto farVersion = index.bump(farAttr);
+    ASSERT_EQ(index.get(nearAttr), nearVersion);
+    ASSERT_EQ(index.get(farAttr), farVersion);
+    ASSERT_EQ(index.get(AttributeIndex::AttrRefIds{2, 1000001, 3}),
+              VersionIndex::UNWRITTEN);
+    ASSERT_EQ(index.get(AttributeIndex::AttrRefIds{0, 1000000, 3}),
+              VersionIndex::UNWRITTEN);
+    ASSERT_GT(index.getMemoryUsage(), 0);
+
+    index.removeComponent(1000000, 2);
+    ASSERT_EQ(index.get(farAttr), VersionIndex::UNWRITTEN);
+    ASSERT_EQ(index.get(nearAttr), nearVersion);
+}
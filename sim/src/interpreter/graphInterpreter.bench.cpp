@@ -0,0 +1,176 @@
+#include <benchmark/benchmark.h>
+#include <interpreter/graphInterpreter.h>
+#include <interpreter/operations.h>
+
+#include <interpreter/util.h>
+#include <test_simulation.h>
+#include <ics.h>
+
+#include <string>
+
+using namespace interpreter;
+
+using test_simulation::TEST_COMPONENT_NAME;
+using test_simulation::TestComponent;
+
+namespace {
+typedef bento::protos::Node::OpCase OpCase;
+
+// World with one entity for the nodes to access
+struct World {
+    ics::ComponentStore compStore;
+    ics::index::IndexStore indexStore;
+    ics::index::EntityIndex::EntityId entityId =
+        indexStore.entity.addEntityId();
+
+    World() {
+        ics::addComponent(indexStore, compStore, entityId,
+                          TestComponent(1, 2));
+    }
+};
+
+bento::protos::Node createConst(float value) {
+    auto node = bento::protos::Node();
+    auto heldValue = node.mutable_const_op()->mutable_held_value();
+    heldValue->mutable_primitive()->set_float_32(value);
+    heldValue->mutable_data_type()->set_primitive(
+        bento::protos::Type_Primitive_FLOAT32);
+    return node;
+}
+
+bento::protos::Node createConst(int64_t value) {
+    auto node = bento::protos::Node();
+    auto heldValue = node.mutable_const_op()->mutable_held_value();
+    heldValue->mutable_primitive()->set_int_64(value);
+    heldValue->mutable_data_type()->set_primitive(
+        bento::protos::Type_Primitive_INT64);
+    return node;
+}
+
+bento::protos::Node createConst(bool value) {
+    auto node = bento::protos::Node();
+    auto heldValue = node.mutable_const_op()->mutable_held_value();
+    heldValue->mutable_primitive()->set_boolean(value);
+    heldValue->mutable_data_type()->set_primitive(
+        bento::protos::Type_Primitive_BOOL);
+    return node;
+}
+
+// Creates a node of the given op whose operands are constants, so that the
+// benchmark measures the op itself
+bento::protos::Node createOpNode(const World& world,
+                                 const google::protobuf::FieldDescriptor& op) {
+    auto node = bento::protos::Node();
+    switch (op.number()) {
+        case OpCase::kConstOp:
+            return createConst(0.5f);
+        case OpCase::kRetrieveOp:
+            *node.mutable_retrieve_op()->mutable_retrieve_attr() =
+                createAttrRef(TEST_COMPONENT_NAME, world.entityId, "width");
+            return node;
+        case OpCase::kSwitchOp:
+            *node.mutable_switch_op()->mutable_condition_node() =
+                createConst(true);
+            *node.mutable_switch_op()->mutable_true_node() = createConst(0.5f);
+            *node.mutable_switch_op()->mutable_false_node() =
+                createConst(0.25f);
+            return node;
+        case OpCase::kSpawnOp:
+            node.mutable_spawn_op()->add_components(TEST_COMPONENT_NAME);
+            return node;
+        case OpCase::kDespawnOp: {
+            auto heldValue = node.mutable_despawn_op()
+                                 ->mutable_entity_id()
+                                 ->mutable_const_op()
+                                 ->mutable_held_value();
+            heldValue->mutable_primitive()->set_int_64(world.entityId);
+            heldValue->mutable_data_type()->set_primitive(
+                bento::protos::Type_Primitive_INT64);
+            return node;
+        }
+    }
+
+    // Every other op only has operands, which are floats unless the op only
+    // takes booleans or integers. 0.5 is in the domain of all the math ops.
+    auto operand = createConst(0.5f);
+    if (op.number() == OpCase::kAndOp || op.number() == OpCase::kOrOp ||
+        op.number() == OpCase::kNotOp) {
+        operand = createConst(true);
+    } else if (op.number() == OpCase::kModOp) {
+        operand = createConst(int64_t(3));
+    }
+    auto reflection = node.GetReflection();
+    auto opMessage = reflection->MutableMessage(&node, &op);
+    auto opDescriptor = opMessage->GetDescriptor();
+    for (int i = 0; i < opDescriptor->field_count(); i++) {
+        auto field = opDescriptor->field(i);
+        if (field->message_type() != bento::protos::Node::descriptor()) {
+            continue;
+        }
+        opMessage->GetReflection()->MutableMessage(opMessage, field)->CopyFrom(
+            operand);
+    }
+    return node;
+}
+
+void BM_EvaluateNode(benchmark::State& state, OpCase op) {
+    World world;
+    auto node = createOpNode(
+        world, *bento::protos::Node::descriptor()->FindFieldByNumber(op));
+    google::protobuf::Arena arena;
+    ics::CommandBuffer commands;
+    RandomSource random;
+    auto ctx =
+        EvalContext{world.compStore, world.indexStore, arena, commands, random};
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(evaluateNode(ctx, node));
+        // Free the temporaries, as the end of a step would
+        arena.Reset();
+        if (!commands.empty()) {
+            state.PauseTiming();
+            commands = ics::CommandBuffer();
+            state.ResumeTiming();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Registers a benchmark for every op that evaluateNode can evaluate
+bool registerOpBenchmarks() {
+    auto descriptor = bento::protos::Node::descriptor();
+    auto ops = descriptor->FindOneofByName("op");
+    for (int i = 0; i < ops->field_count(); i++) {
+        auto op = ops->field(i);
+        // Mutate nodes are outputs, and are benchmarked through mutateOp
+        if (op->number() == OpCase::kMutateOp) {
+            continue;
+        }
+        benchmark::RegisterBenchmark(
+            ("BM_EvaluateNode/" + op->name()).c_str(), BM_EvaluateNode,
+            static_cast<OpCase>(op->number()));
+    }
+    return true;
+}
+const bool opBenchmarksRegistered = registerOpBenchmarks();
+}  // namespace
+
+static void BM_MutateOp(benchmark::State& state) {
+    World world;
+    auto node = bento::protos::Node_Mutate();
+    *node.mutable_mutate_attr() =
+        createAttrRef(TEST_COMPONENT_NAME, world.entityId, "width");
+    *node.mutable_to_node() = createConst(0.5f);
+    google::protobuf::Arena arena;
+    ics::CommandBuffer commands;
+    RandomSource random;
+    auto ctx =
+        EvalContext{world.compStore, world.indexStore, arena, commands, random};
+
+    for (auto _ : state) {
+        mutateOp(ctx, node);
+        arena.Reset();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MutateOp);
@@ -1,88 +1,271 @@
 #include <interpreter/graphInterpreter.h>
 #include <interpreter/operations.h>
+#include <interpreter/outputCache.h>
+#include <interpreter/parallelPlan.h>
+#include <interpreter/profiler.h>
+#include <interpreter/threadPool.h>
+#include <interpreter/writeBuffer.h>
 #include <ics.h>
 
-namespace interpreter {
+#include <algorithm>
+#include <exception>
+#include <vector>
 
-bento::protos::Value evaluateNode(ics::ComponentStore& compStore,
-                                  ics::index::IndexStore& indexStore,
-                                  const bento::protos::Node& node) {
+namespace interpreter {
+namespace {
+const bento::protos::Value& evaluateOp(EvalContext& ctx,
+                                       const bento::protos::Node& node) {
     typedef bento::protos::Node::OpCase OpCase;
-    typedef bento::protos::Value Value;
     switch (node.op_case()) {
         case OpCase::kConstOp:
             return constOp(node.const_op());
         case OpCase::kRetrieveOp:
-            return retrieveOp(compStore, indexStore, node.retrieve_op());
+            return retrieveOp(ctx, node.retrieve_op());
         case OpCase::kMutateOp:
             throw std::logic_error(
                 "Node to evaluate should not modify any attribute.");
         case OpCase::kSwitchOp:
-            return switchOp(compStore, indexStore, node.switch_op());
+            return switchOp(ctx, node.switch_op());
         case OpCase::kAddOp:
-            return addOp(compStore, indexStore, node.add_op());
+            return addOp(ctx, node.add_op());
         case OpCase::kSubOp:
-            return subOp(compStore, indexStore, node.sub_op());
+            return subOp(ctx, node.sub_op());
         case OpCase::kMulOp:
-            return mulOp(compStore, indexStore, node.mul_op());
+            return mulOp(ctx, node.mul_op());
         case OpCase::kDivOp:
-            return divOp(compStore, indexStore, node.div_op());
+            return divOp(ctx, node.div_op());
         case OpCase::kMaxOp:
-            return maxOp(compStore, indexStore, node.max_op());
+            return maxOp(ctx, node.max_op());
         case OpCase::kMinOp:
-            return minOp(compStore, indexStore, node.min_op());
+            return minOp(ctx, node.min_op());
         case OpCase::kAbsOp:
-            return absOp(compStore, indexStore, node.abs_op());
+            return absOp(ctx, node.abs_op());
         case OpCase::kFloorOp:
-            return floorOp(compStore, indexStore, node.floor_op());
+            return floorOp(ctx, node.floor_op());
         case OpCase::kCeilOp:
-            return ceilOp(compStore, indexStore, node.ceil_op());
+            return ceilOp(ctx, node.ceil_op());
         case OpCase::kPowOp:
-            return powOp(compStore, indexStore, node.pow_op());
+            return powOp(ctx, node.pow_op());
         case OpCase::kModOp:
-            return modOp(compStore, indexStore, node.mod_op());
+            return modOp(ctx, node.mod_op());
         case OpCase::kSinOp:
-            return sinOp(compStore, indexStore, node.sin_op());
+            return sinOp(ctx, node.sin_op());
         case OpCase::kArcsinOp:
-            return arcSinOp(compStore, indexStore, node.arcsin_op());
+            return arcSinOp(ctx, node.arcsin_op());
         case OpCase::kCosOp:
-            return cosOp(compStore, indexStore, node.cos_op());
+            return cosOp(ctx, node.cos_op());
         case OpCase::kArccosOp:
-            return arcCosOp(compStore, indexStore, node.arccos_op());
+            return arcCosOp(ctx, node.arccos_op());
         case OpCase::kTanOp:
-            return tanOp(compStore, indexStore, node.tan_op());
+            return tanOp(ctx, node.tan_op());
         case OpCase::kArctanOp:
-            return arcTanOp(compStore, indexStore, node.arctan_op());
+            return arcTanOp(ctx, node.arctan_op());
         case OpCase::kRandomOp:
-            return randomOp(compStore, indexStore, node.random_op());
+            return randomOp(ctx, node.random_op());
         case OpCase::kAndOp:
-            return andOp(compStore, indexStore, node.and_op());
+            return andOp(ctx, node.and_op());
         case OpCase::kOrOp:
-            return orOp(compStore, indexStore, node.or_op());
+            return orOp(ctx, node.or_op());
         case OpCase::kNotOp:
-            return notOp(compStore, indexStore, node.not_op());
+            return notOp(ctx, node.not_op());
         case OpCase::kEqOp:
-            return eqOp(compStore, indexStore, node.eq_op());
+            return eqOp(ctx, node.eq_op());
         case OpCase::kGtOp:
-            return gtOp(compStore, indexStore, node.gt_op());
+            return gtOp(ctx, node.gt_op());
         case OpCase::kLtOp:
-            return ltOp(compStore, indexStore, node.lt_op());
+            return ltOp(ctx, node.lt_op());
         case OpCase::kGeOp:
-            return geOp(compStore, indexStore, node.ge_op());
+            return geOp(ctx, node.ge_op());
         case OpCase::kLeOp:
-            return leOp(compStore, indexStore, node.le_op());
+            return leOp(ctx, node.le_op());
+        case OpCase::kSpawnOp:
+            return spawnOp(ctx, node.spawn_op());
+        case OpCase::kDespawnOp:
+            return despawnOp(ctx, node.despawn_op());
         default:
             throw std::domain_error("Unknown case when parsing OpCase.");
     }
 }
 
+// Adds what evaluating the message involves to inputs. Returns false once an
+// impure node is found.
+bool addInputs(const google::protobuf::Message& message, NodeInputs& inputs) {
+    if (dynamic_cast<const bento::protos::Node_Random*>(&message) ||
+        dynamic_cast<const bento::protos::Node_Spawn*>(&message) ||
+        dynamic_cast<const bento::protos::Node_Despawn*>(&message)) {
+        inputs.pure = false;
+        return false;
+    }
+    if (auto ref = dynamic_cast<const bento::protos::AttributeRef*>(&message)) {
+        inputs.refs.push_back(ref);
+        return true;
+    }
+    if (dynamic_cast<const bento::protos::Node*>(&message)) {
+        inputs.nodeCount++;
+    }
+
+    auto reflection = message.GetReflection();
+    std::vector<const google::protobuf::FieldDescriptor*> fields;
+    reflection->ListFields(message, &fields);
+    for (auto field : fields) {
+        if (field->cpp_type() !=
+            google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE) {
+            continue;
+        }
+
+        if (field->is_repeated()) {
+            for (int i = 0; i < reflection->FieldSize(message, field); i++) {
+                if (!addInputs(
+                        reflection->GetRepeatedMessage(message, field, i),
+                        inputs)) {
+                    return false;
+                }
+            }
+        } else if (!addInputs(reflection->GetMessage(message, field),
+                              inputs)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void runOutput(EvalContext& ctx, const bento::protos::Node_Mutate& output) {
+    if (ctx.outputCache != nullptr) {
+        ctx.outputCache->run(ctx, output);
+    } else {
+        mutateOp(ctx, output);
+    }
+}
+
+// Evaluates the wave's outputs in the given number of tasks on the context's
+// thread pool
+void runWave(EvalContext& ctx, const bento::protos::Graph& graph,
+             const ParallelPlan::Wave& wave, size_t taskCount) {
+    // The output cache is only used from this thread, before and after the
+    // outputs that cannot be skipped are evaluated
+    std::vector<const bento::protos::Node_Mutate*> outputs;
+    std::vector<OutputCache::Pending> pendings;
+    outputs.reserve(wave.size());
+    for (int i = wave.begin; i < wave.end; i++) {
+        const auto& output = graph.outputs(i);
+        OutputCache::Pending pending;
+        if (ctx.outputCache != nullptr &&
+            !ctx.outputCache->start(ctx.indexStore, output, pending)) {
+            continue;
+        }
+        outputs.push_back(&output);
+        pendings.push_back(std::move(pending));
+    }
+    taskCount = std::min(taskCount, outputs.size());
+
+    // Each task evaluates a slice of the outputs with a context of its own,
+    // and buffers the attributes that they set. Only the arena is shared, as
+    // the outputs of a wave do not draw random numbers or record commands.
+    std::vector<WriteBuffer> buffers(taskCount);
+    std::vector<uint64_t> evalCounts(taskCount);
+    std::vector<std::exception_ptr> errors(taskCount);
+    ctx.poolAllocations += ctx.threadPool->run(taskCount, [&](size_t task) {
+        auto taskCtx = EvalContext{ctx.compStore, ctx.indexStore, ctx.arena,
+                                   ctx.commands, ctx.random};
+        taskCtx.writes = &buffers[task];
+        auto begin = task * outputs.size() / taskCount;
+        auto end = (task + 1) * outputs.size() / taskCount;
+        try {
+            for (auto i = begin; i < end; i++) {
+                mutateOp(taskCtx, *outputs[i]);
+            }
+        } catch (...) {
+            errors[task] = std::current_exception();
+        }
+        evalCounts[task] = taskCtx.evalCount;
+    });
+
+    // Set the attributes in the order of the outputs, up to the first output
+    // which failed
+    for (size_t task = 0; task < taskCount; task++) {
+        ctx.evalCount += evalCounts[task];
+        if (ctx.writes != nullptr) {
+            ctx.writes->append(buffers[task]);
+        } else {
+            buffers[task].write(ctx.indexStore, ctx.compStore);
+        }
+        if (errors[task]) {
+            std::rethrow_exception(errors[task]);
+        }
+    }
+    if (ctx.outputCache != nullptr) {
+        for (size_t i = 0; i < outputs.size(); i++) {
+            ctx.outputCache->finish(ctx.indexStore, *outputs[i],
+                                    std::move(pendings[i]));
+        }
+    }
+}
+}  // namespace
+
+NodeInputs collectInputs(const google::protobuf::Message& node) {
+    NodeInputs inputs;
+    addInputs(node, inputs);
+    return inputs;
+}
+
+const bento::protos::Value& evaluateNode(EvalContext& ctx,
+                                         const bento::protos::Node& node) {
+    ctx.evalCount++;
+    if (ctx.profiler == nullptr) {
+        return evaluateOp(ctx, node);
+    }
+    Profiler::NodeTimer timer(*ctx.profiler, node.op_case());
+    return evaluateOp(ctx, node);
+}
+
+bento::protos::Value evaluateNode(ics::ComponentStore& compStore,
+                                  ics::index::IndexStore& indexStore,
+                                  const bento::protos::Node& node) {
+    google::protobuf::Arena arena;
+    ics::CommandBuffer commands;
+    RandomSource random;
+    auto ctx = EvalContext{compStore, indexStore, arena, commands, random};
+    // Copy the result out of the arena before it is freed
+    auto value = evaluateNode(ctx, node);
+    commands.flush(indexStore, compStore);
+    return value;
+}
+
+void runGraph(EvalContext& ctx, const bento::protos::Graph& graph) {
+    // Evaluate inputs. The profiler is not thread safe, so the outputs are
+    // evaluated one at a time while profiling.
+    if (ctx.parallelPlan == nullptr || ctx.threadPool == nullptr ||
+        ctx.profiler != nullptr) {
+        for (const auto& output : graph.outputs()) {
+            runOutput(ctx, output);
+        }
+    } else {
+        auto threadCount = ctx.threadPool->getThreadCount();
+        for (const auto& wave : ctx.parallelPlan->getWaves(graph)) {
+            auto taskCount = ParallelPlan::getTaskCount(wave, threadCount);
+            if (taskCount > 1) {
+                runWave(ctx, graph, wave, taskCount);
+                continue;
+            }
+            for (int i = wave.begin; i < wave.end; i++) {
+                runOutput(ctx, graph.outputs(i));
+            }
+        }
+    }
+    for (const auto& effect : graph.effects()) {
+        evaluateNode(ctx, effect);
+    }
+}
+
 void runGraph(ics::ComponentStore& compStore,
               ics::index::IndexStore& indexStore,
               const bento::protos::Graph& graph) {
-    // Evaluate inputs
-    for (const auto& output : graph.outputs()) {
-        mutateOp(compStore, indexStore, output);
-    }
+    google::protobuf::Arena arena;
+    ics::CommandBuffer commands;
+    RandomSource random;
+    auto ctx = EvalContext{compStore, indexStore, arena, commands, random};
+    runGraph(ctx, graph);
+    commands.flush(indexStore, compStore);
 }
 
 }  // namespace interpreter
\ No newline at end of file
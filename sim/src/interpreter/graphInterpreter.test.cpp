@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include <interpreter/graphInterpreter.h>
 #include <interpreter/operations.h>
+#include <interpreter/outputCache.h>
 
 #include <bento/protos/ecs.pb.h>
 #include <interpreter/util.h>
@@ -59,7 +60,7 @@ TEST_F(StoresFixture, RetrieveNode) {
 
     auto value = evaluateNode(compStore, indexStore, node);
     ASSERT_EQ(value.primitive().int_64(),
-              comp1.getValue("width").primitive().int_64());
+              comp1.getValue(TestComponent::WIDTH).primitive().int_64());
 }
 
 TEST_F(StoresFixture, MutateNode) {
@@ -80,15 +81,16 @@ TEST_F(StoresFixture, MutateNode) {
 
     // Make sure that this test is valid by ensuring that the value to change to
     // is not the default value
-    ASSERT_NE(newVal, comp1.getValue("width").primitive().int_64());
+    ASSERT_NE(newVal,
+              comp1.getValue(TestComponent::WIDTH).primitive().int_64());
 
     // Mutate the value
     mutateOp(compStore, indexStore, node);
 
-    auto& comp = ics::getComponent(indexStore, compStore, TEST_COMPONENT_NAME,
-                                   entity1Id);
-    ASSERT_EQ(comp.getValue("width").primitive().int_64(), newVal);
-    ASSERT_EQ(comp.getValue("width").data_type().primitive(),
+    auto group = indexStore.componentType.getComponentType(TEST_COMPONENT_NAME);
+    auto& comp = ics::getComponent(indexStore, compStore, group, entity1Id);
+    ASSERT_EQ(comp.getValue(TestComponent::WIDTH).primitive().int_64(), newVal);
+    ASSERT_EQ(comp.getValue(TestComponent::WIDTH).data_type().primitive(),
               bento::protos::Type_Primitive_INT64);
 }
 
@@ -421,6 +423,36 @@ TEST_F(StoresFixture, RandomNode) {
               bento::protos::Type_Primitive_FLOAT64);
 }
 
+TEST_F(StoresFixture, RandomNodeArray) {
+    auto node = bento::protos::Node();
+    auto randomOpNode = node.mutable_random_op();
+    randomOpNode->mutable_low()
+        ->mutable_const_op()
+        ->mutable_held_value()
+        ->mutable_primitive()
+        ->set_float_32(1.0f);
+    randomOpNode->mutable_high()
+        ->mutable_const_op()
+        ->mutable_held_value()
+        ->mutable_primitive()
+        ->set_float_32(2.0f);
+    randomOpNode->set_count(10);
+
+    auto result = evaluateNode(compStore, indexStore, node);
+    ASSERT_EQ(result.array().values_size(), 10);
+    ASSERT_EQ(result.data_type().array().dimensions(0), 10);
+    ASSERT_EQ(result.data_type().array().element_type(),
+              bento::protos::Type_Primitive_FLOAT32);
+    for (const auto& x : result.array().values()) {
+        ASSERT_GE(x.float_32(), 1.0f);
+        ASSERT_LE(x.float_32(), 2.0f);
+    }
+
+    // The numbers are reproducible
+    auto again = evaluateNode(compStore, indexStore, node);
+    ASSERT_EQ(result.SerializeAsString(), again.SerializeAsString());
+}
+
 TEST_F(StoresFixture, AndNode) {
     auto node = bento::protos::Node();
     auto andOpNode = node.mutable_and_op();
@@ -571,3 +603,224 @@ TEST_F(StoresFixture, ImplicitTypeConversion) {
         evaluateNode(compStore, indexStore, node).primitive().float_32(),
         x + y);
 }
+
+TEST_F(StoresFixture, TemporariesAllocatedOnArena) {
+    // width + (width * 2)
+    auto node = bento::protos::Node();
+    auto addOpNode = node.mutable_add_op();
+    *addOpNode->mutable_x()->mutable_retrieve_op()->mutable_retrieve_attr() =
+        createAttrRef(TEST_COMPONENT_NAME, entity1Id, "width");
+    auto mulOpNode = addOpNode->mutable_y()->mutable_mul_op();
+    *mulOpNode->mutable_x()->mutable_retrieve_op()->mutable_retrieve_attr() =
+        createAttrRef(TEST_COMPONENT_NAME, entity1Id, "width");
+    auto yVal =
+        mulOpNode->mutable_y()->mutable_const_op()->mutable_held_value();
+    yVal->mutable_primitive()->set_int_64(2);
+    yVal->mutable_data_type()->set_primitive(
+        bento::protos::Type_Primitive_INT64);
+
+    google::protobuf::Arena arena;
+    ics::CommandBuffer commands;
+    RandomSource random;
+    auto ctx = EvalContext{compStore, indexStore, arena, commands, random};
+    auto& result = evaluateNode(ctx, node);
+    ASSERT_EQ(result.GetArena(), &arena);
+    ASSERT_EQ(result.primitive().int_64(), 150);
+    ASSERT_GT(arena.SpaceUsed(), 0);
+
+    // Retrieved and constant values are not copied onto the arena
+    auto& retrieved = evaluateNode(ctx, addOpNode->x());
+    ASSERT_EQ(retrieved.GetArena(), nullptr);
+    ASSERT_EQ(&evaluateNode(ctx, mulOpNode->y()), yVal);
+
+    arena.Reset();
+    ASSERT_EQ(arena.SpaceUsed(), 0);
+}
+
+TEST_F(StoresFixture, SpawnAndDespawnEffects) {
+    // Add an entity through the signature index so that it can be queried
+    auto entity3Id = indexStore.entity.addEntityId();
+    ics::addComponent(indexStore, compStore, entity3Id, TestComponent{1, 2});
+
+    auto graph = bento::protos::Graph();
+    graph.add_effects()->mutable_spawn_op()->add_components(
+        TEST_COMPONENT_NAME);
+    auto entityIdVal = graph.add_effects()
+                           ->mutable_despawn_op()
+                           ->mutable_entity_id()
+                           ->mutable_const_op()
+                           ->mutable_held_value();
+    entityIdVal->mutable_primitive()->set_int_64(entity3Id);
+    entityIdVal->mutable_data_type()->set_primitive(
+        bento::protos::Type_Primitive_INT64);
+
+    google::protobuf::Arena arena;
+    ics::CommandBuffer commands;
+    RandomSource random;
+    auto ctx = EvalContext{compStore, indexStore, arena, commands, random};
+    runGraph(ctx, graph);
+
+    // The changes are only applied when the commands are flushed
+    ASSERT_TRUE(indexStore.entity.hasEntity(entity3Id));
+    auto group = indexStore.componentType.getComponentType(TEST_COMPONENT_NAME);
+    ASSERT_EQ(ics::queryEntities(indexStore, {group}).size(), 1);
+    commands.flush(indexStore, compStore);
+
+    ASSERT_FALSE(indexStore.entity.hasEntity(entity3Id));
+    auto& entities = ics::queryEntities(indexStore, {group});
+    ASSERT_EQ(entities.size(), 1);
+    ASSERT_NE(entities[0], entity3Id);
+}
+
+TEST_F(StoresFixture, SpawnDuplicateTypesInArchetypesThrows) {
+    // The spawn is refused when it is recorded, rather than failing the
+    // flush at the end of the step
+    indexStore.useArchetypes = true;
+    auto node = bento::protos::Node();
+    node.mutable_spawn_op()->add_components(TEST_COMPONENT_NAME);
+    node.mutable_spawn_op()->add_components(TEST_COMPONENT_NAME);
+
+    ASSERT_THROW(evaluateNode(compStore, indexStore, node),
+                 std::invalid_argument);
+}
+
+TEST_F(StoresFixture, DespawnUnknownEntityThrows) {
+    auto node = bento::protos::Node();
+    auto entityIdVal = node.mutable_despawn_op()
+                           ->mutable_entity_id()
+                           ->mutable_const_op()
+                           ->mutable_held_value();
+    entityIdVal->mutable_primitive()->set_int_64(1000);
+    entityIdVal->mutable_data_type()->set_primitive(
+        bento::protos::Type_Primitive_INT64);
+
+    ASSERT_THROW(evaluateNode(compStore, indexStore, node), std::out_of_range);
+}
+
+class OutputCacheFixture : public StoresFixture {
+   protected:
+    google::protobuf::Arena arena;
+    ics::CommandBuffer commands;
+    RandomSource random;
+    OutputCache outputCache;
+    EvalContext ctx{compStore, indexStore, arena,
+                    commands,  random,     &outputCache};
+
+    // Sets the entity's attribute to its other attribute plus one
+    static void addIncrement(bento::protos::Graph& graph,
+                             ics::index::EntityIndex::EntityId entityId,
+                             const char* attr,
+                             const char* fromAttr) {
+        auto& output = *graph.add_outputs();
+        *output.mutable_mutate_attr() =
+            createAttrRef(TEST_COMPONENT_NAME, entityId, attr);
+        auto& addOp = *output.mutable_to_node()->mutable_add_op();
+        *addOp.mutable_x()->mutable_retrieve_op()->mutable_retrieve_attr() =
+            createAttrRef(TEST_COMPONENT_NAME, entityId, fromAttr);
+        auto& oneVal =
+            *addOp.mutable_y()->mutable_const_op()->mutable_held_value();
+        oneVal.mutable_primitive()->set_int_64(1);
+        oneVal.mutable_data_type()->set_primitive(
+            bento::protos::Type_Primitive_INT64);
+    }
+
+    int64_t getAttr(ics::index::EntityIndex::EntityId entityId,
+                    const char* attr) {
+        return ics::getAttribute(
+                   indexStore, compStore,
+                   createAttrRef(TEST_COMPONENT_NAME, entityId, attr))
+            .primitive()
+            .int_64();
+    }
+};
+
+TEST_F(OutputCacheFixture, SkipsUnchangedOutput) {
+    // width = height + 1
+    auto graph = bento::protos::Graph();
+    addIncrement(graph, entity1Id, "width", "height");
+
+    runGraph(ctx, graph);
+    ASSERT_EQ(getAttr(entity1Id, "width"), 31);
+    ASSERT_EQ(outputCache.getSkipCount(), 0);
+
+    runGraph(ctx, graph);
+    ASSERT_EQ(getAttr(entity1Id, "width"), 31);
+    ASSERT_EQ(outputCache.getSkipCount(), 1);
+}
+
+TEST_F(OutputCacheFixture, ReevaluatesAfterWrite) {
+    // width = height + 1
+    auto graph = bento::protos::Graph();
+    addIncrement(graph, entity1Id, "width", "height");
+    runGraph(ctx, graph);
+
+    // Writing the input makes the output evaluate again
+    auto heightVal = bento::protos::Value();
+    heightVal.mutable_primitive()->set_int_64(40);
+    heightVal.mutable_data_type()->set_primitive(
+        bento::protos::Type_Primitive_INT64);
+    ics::setAttribute(indexStore, compStore,
+                      createAttrRef(TEST_COMPONENT_NAME, entity1Id, "height"),
+                      heightVal);
+    runGraph(ctx, graph);
+    ASSERT_EQ(getAttr(entity1Id, "width"), 41);
+    ASSERT_EQ(outputCache.getSkipCount(), 0);
+
+    // So does writing the output's own attribute
+    ics::setAttribute(indexStore, compStore,
+                      createAttrRef(TEST_COMPONENT_NAME, entity1Id, "width"),
+                      heightVal);
+    runGraph(ctx, graph);
+    ASSERT_EQ(getAttr(entity1Id, "width"), 41);
+    ASSERT_EQ(outputCache.getSkipCount(), 0);
+
+    // Removing a component evaluates every output again
+    auto entity3Id = indexStore.entity.addEntityId();
+    ics::addComponent(indexStore, compStore, entity3Id, TestComponent{1, 2});
+    ics::removeEntity(indexStore, compStore, entity3Id);
+    runGraph(ctx, graph);
+    ASSERT_EQ(outputCache.getSkipCount(), 0);
+}
+
+TEST_F(OutputCacheFixture, OutputReadingItselfAlwaysRuns) {
+    // width = width + 1
+    auto graph = bento::protos::Graph();
+    addIncrement(graph, entity1Id, "width", "width");
+
+    runGraph(ctx, graph);
+    runGraph(ctx, graph);
+    ASSERT_EQ(getAttr(entity1Id, "width"), 52);
+    ASSERT_EQ(outputCache.getSkipCount(), 0);
+}
+
+TEST_F(OutputCacheFixture, RandomOutputAlwaysRuns) {
+    // height = width + 1, width = random
+    auto graph = bento::protos::Graph();
+    addIncrement(graph, entity2Id, "height", "width");
+    auto& output = *graph.add_outputs();
+    *output.mutable_mutate_attr() =
+        createAttrRef(TEST_COMPONENT_NAME, entity1Id, "width");
+    auto randomOpNode = output.mutable_to_node()->mutable_random_op();
+    randomOpNode->mutable_low()
+        ->mutable_const_op()
+        ->mutable_held_value()
+        ->mutable_primitive()
+        ->set_float_32(0.0f);
+    randomOpNode->mutable_high()
+        ->mutable_const_op()
+        ->mutable_held_value()
+        ->mutable_primitive()
+        ->set_float_32(1000000.0f);
+
+    auto widthRef = createAttrRef(TEST_COMPONENT_NAME, entity1Id, "width");
+    runGraph(ctx, graph);
+    auto width =
+        ics::getAttribute(indexStore, compStore, widthRef).SerializeAsString();
+    random.nextStep();
+    runGraph(ctx, graph);
+    ASSERT_NE(
+        ics::getAttribute(indexStore, compStore, widthRef).SerializeAsString(),
+        width);
+    // Only the output which does not draw random numbers is skipped
+    ASSERT_EQ(outputCache.getSkipCount(), 1);
+}
@@ -1,9 +1,11 @@
 #include <interpreter/operations.h>
 #include <interpreter/graphInterpreter.h>
+#include <interpreter/writeBuffer.h>
 #include <proto/userValue.h>
 #include <ics.h>
 #include <cmath>
-#include <random>
+#include <span>
+#include <vector>
 
 namespace interpreter {
 
@@ -11,38 +13,58 @@ const bento::protos::Value& constOp(const bento::protos::Node_Const& node) {
     return node.held_value();
 }
 
-bento::protos::Value& retrieveOp(ics::ComponentStore& compStore,
-                                 ics::index::IndexStore& indexStore,
+bento::protos::Value& retrieveOp(EvalContext& ctx,
                                  const bento::protos::Node_Retrieve& node) {
     // Get the AttributeRef
     auto& ref = node.retrieve_attr();
-    // Retrieve the component
-    auto& component = ics::getComponent(indexStore, compStore, ref.component(),
-                                        ref.entity_id());
-    // Get the attribute of the component
-    return component.getMutableValue(ref.attribute());
+    // Get the attribute of the entity's component
+    return ics::getAttribute(ctx.indexStore, ctx.compStore, ref);
 }
 
-void mutateOp(ics::ComponentStore& compStore,
-              ics::index::IndexStore& indexStore,
-              const bento::protos::Node_Mutate& node) {
+bento::protos::Value& retrieveOp(ics::ComponentStore& compStore,
+                                 ics::index::IndexStore& indexStore,
+                                 const bento::protos::Node_Retrieve& node) {
+    google::protobuf::Arena arena;
+    ics::CommandBuffer commands;
+    RandomSource random;
+    auto ctx = EvalContext{compStore, indexStore, arena, commands, random};
+    return retrieveOp(ctx, node);
+}
+
+void mutateOp(EvalContext& ctx, const bento::protos::Node_Mutate& node) {
     // Get the new value to set
-    auto val = evaluateNode(compStore, indexStore, node.to_node());
+    auto& val = evaluateNode(ctx, node.to_node());
 
-    // Get a reference to the value to modify
+    // Set the value of the referenced attribute
     auto& ref = node.mutate_attr();
-    auto& component = ics::getComponent(indexStore, compStore, ref.component(),
-                                        ref.entity_id());
+    if (ctx.writes == nullptr) {
+        ics::setAttribute(ctx.indexStore, ctx.compStore, ref, val);
+        return;
+    }
 
-    // Set the value
-    component.setValue(ref.attribute(), val);
+    // The value may be an attribute which is mutated later in the step, so
+    // buffer a copy of it
+    auto refIds = ctx.indexStore.attribute.resolve(ctx.indexStore.componentType,
+                                                   ref);
+    auto& copy = ctx.createValue();
+    copy.CopyFrom(val);
+    ctx.writes->add(refIds, copy);
 }
 
-bento::protos::Value switchOp(ics::ComponentStore& compStore,
-                              ics::index::IndexStore& indexStore,
-                              const bento::protos::Node_Switch& node) {
-    auto conditionVal =
-        evaluateNode(compStore, indexStore, node.condition_node());
+void mutateOp(ics::ComponentStore& compStore,
+              ics::index::IndexStore& indexStore,
+              const bento::protos::Node_Mutate& node) {
+    google::protobuf::Arena arena;
+    ics::CommandBuffer commands;
+    RandomSource random;
+    auto ctx = EvalContext{compStore, indexStore, arena, commands, random};
+    mutateOp(ctx, node);
+    commands.flush(indexStore, compStore);
+}
+
+const bento::protos::Value& switchOp(EvalContext& ctx,
+                                     const bento::protos::Node_Switch& node) {
+    auto& conditionVal = evaluateNode(ctx, node.condition_node());
     // Ensure that the value returned is a boolean
     if (!conditionVal.has_primitive() ||
         conditionVal.primitive().value_case() !=
@@ -52,53 +74,56 @@ bento::protos::Value switchOp(ics::ComponentStore& compStore,
     }
 
     if (conditionVal.primitive().boolean()) {
-        return evaluateNode(compStore, indexStore, node.true_node());
+        return evaluateNode(ctx, node.true_node());
     } else {
-        return evaluateNode(compStore, indexStore, node.false_node());
+        return evaluateNode(ctx, node.false_node());
     }
 }
 
-bento::protos::Value addOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Add& node) {
-    auto xVal = evaluateNode(compStore, indexStore, node.x());
-    auto yVal = evaluateNode(compStore, indexStore, node.y());
+const bento::protos::Value& addOp(EvalContext& ctx,
+                                  const bento::protos::Node_Add& node) {
+    auto& xVal = evaluateNode(ctx, node.x());
+    auto& yVal = evaluateNode(ctx, node.y());
     auto op = []<class X, class Y>(X x, Y y) { return x + y; };
-    return proto::runFnWithVal<proto_NUMERIC>(xVal, yVal, op);
+    auto& val = ctx.createValue();
+    proto::runFnIntoVal<proto_NUMERIC>(val, xVal, yVal, op);
+    return val;
 }
 
-bento::protos::Value subOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Sub& node) {
-    auto xVal = evaluateNode(compStore, indexStore, node.x());
-    auto yVal = evaluateNode(compStore, indexStore, node.y());
+const bento::protos::Value& subOp(EvalContext& ctx,
+                                  const bento::protos::Node_Sub& node) {
+    auto& xVal = evaluateNode(ctx, node.x());
+    auto& yVal = evaluateNode(ctx, node.y());
     auto op = []<class X, class Y>(X x, Y y) { return x - y; };
-    return proto::runFnWithVal<proto_NUMERIC>(xVal, yVal, op);
+    auto& val = ctx.createValue();
+    proto::runFnIntoVal<proto_NUMERIC>(val, xVal, yVal, op);
+    return val;
 }
 
-bento::protos::Value mulOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Mul& node) {
-    auto xVal = evaluateNode(compStore, indexStore, node.x());
-    auto yVal = evaluateNode(compStore, indexStore, node.y());
+const bento::protos::Value& mulOp(EvalContext& ctx,
+                                  const bento::protos::Node_Mul& node) {
+    auto& xVal = evaluateNode(ctx, node.x());
+    auto& yVal = evaluateNode(ctx, node.y());
     auto op = []<class X, class Y>(X x, Y y) { return x * y; };
-    return proto::runFnWithVal<proto_NUMERIC>(xVal, yVal, op);
+    auto& val = ctx.createValue();
+    proto::runFnIntoVal<proto_NUMERIC>(val, xVal, yVal, op);
+    return val;
 }
 
-bento::protos::Value divOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Div& node) {
-    auto xVal = evaluateNode(compStore, indexStore, node.x());
-    auto yVal = evaluateNode(compStore, indexStore, node.y());
+const bento::protos::Value& divOp(EvalContext& ctx,
+                                  const bento::protos::Node_Div& node) {
+    auto& xVal = evaluateNode(ctx, node.x());
+    auto& yVal = evaluateNode(ctx, node.y());
     auto op = []<class X, class Y>(X x, Y y) { return x / y; };
-    return proto::runFnWithVal<proto_NUMERIC>(xVal, yVal, op);
+    auto& val = ctx.createValue();
+    proto::runFnIntoVal<proto_NUMERIC>(val, xVal, yVal, op);
+    return val;
 }
 
-bento::protos::Value maxOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Max& node) {
-    auto xVal = evaluateNode(compStore, indexStore, node.x());
-    auto yVal = evaluateNode(compStore, indexStore, node.y());
+const bento::protos::Value& maxOp(EvalContext& ctx,
+                                  const bento::protos::Node_Max& node) {
+    auto& xVal = evaluateNode(ctx, node.x());
+    auto& yVal = evaluateNode(ctx, node.y());
     auto op = []<class X, class Y>(X x, Y y) {
         typedef decltype(std::declval<X>() + std::declval<Y>()) RetType;
         if (x > y) {
@@ -107,14 +132,15 @@ bento::protos::Value maxOp(ics::ComponentStore& compStore,
             return (RetType)y;
         }
     };
-    return proto::runFnWithVal<proto_NUMERIC>(xVal, yVal, op);
+    auto& val = ctx.createValue();
+    proto::runFnIntoVal<proto_NUMERIC>(val, xVal, yVal, op);
+    return val;
 }
 
-bento::protos::Value minOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Min& node) {
-    auto xVal = evaluateNode(compStore, indexStore, node.x());
-    auto yVal = evaluateNode(compStore, indexStore, node.y());
+const bento::protos::Value& minOp(EvalContext& ctx,
+                                  const bento::protos::Node_Min& node) {
+    auto& xVal = evaluateNode(ctx, node.x());
+    auto& yVal = evaluateNode(ctx, node.y());
     auto op = []<class X, class Y>(X x, Y y) {
         typedef decltype(std::declval<X>() + std::declval<Y>()) RetType;
         if (x < y) {
@@ -123,136 +149,180 @@ bento::protos::Value minOp(ics::ComponentStore& compStore,
             return (RetType)y;
         }
     };
-    return proto::runFnWithVal<proto_NUMERIC>(xVal, yVal, op);
+    auto& val = ctx.createValue();
+    proto::runFnIntoVal<proto_NUMERIC>(val, xVal, yVal, op);
+    return val;
 }
 
-bento::protos::Value absOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Abs& node) {
-    auto xVal = evaluateNode(compStore, indexStore, node.x());
+const bento::protos::Value& absOp(EvalContext& ctx,
+                                  const bento::protos::Node_Abs& node) {
+    auto& xVal = evaluateNode(ctx, node.x());
     auto op = []<class C>(C x) { return abs(x); };
-    return proto::runFnWithVal<proto_NUMERIC>(xVal, op);
+    auto& val = ctx.createValue();
+    proto::runFnIntoVal<proto_NUMERIC>(val, xVal, op);
+    return val;
 }
 
-bento::protos::Value floorOp(ics::ComponentStore& compStore,
-                             ics::index::IndexStore& indexStore,
-                             const bento::protos::Node_Floor& node) {
-    auto xVal = evaluateNode(compStore, indexStore, node.x());
+const bento::protos::Value& floorOp(EvalContext& ctx,
+                                    const bento::protos::Node_Floor& node) {
+    auto& xVal = evaluateNode(ctx, node.x());
     auto op = []<class C>(C x) { return floor(x); };
-    return proto::runFnWithVal<proto_NUMERIC>(xVal, op);
+    auto& val = ctx.createValue();
+    proto::runFnIntoVal<proto_NUMERIC>(val, xVal, op);
+    return val;
 }
 
-bento::protos::Value ceilOp(ics::ComponentStore& compStore,
-                            ics::index::IndexStore& indexStore,
-                            const bento::protos::Node_Ceil& node) {
-    auto xVal = evaluateNode(compStore, indexStore, node.x());
+const bento::protos::Value& ceilOp(EvalContext& ctx,
+                                   const bento::protos::Node_Ceil& node) {
+    auto& xVal = evaluateNode(ctx, node.x());
     auto op = []<class C>(C x) { return ceil(x); };
-    return proto::runFnWithVal<proto_NUMERIC>(xVal, op);
+    auto& val = ctx.createValue();
+    proto::runFnIntoVal<proto_NUMERIC>(val, xVal, op);
+    return val;
 }
 
-bento::protos::Value powOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Pow& node) {
-    auto xVal = evaluateNode(compStore, indexStore, node.x());
-    auto yVal = evaluateNode(compStore, indexStore, node.y());
+const bento::protos::Value& powOp(EvalContext& ctx,
+                                  const bento::protos::Node_Pow& node) {
+    auto& xVal = evaluateNode(ctx, node.x());
+    auto& yVal = evaluateNode(ctx, node.y());
     auto op = []<class X, class Y>(X x, Y y) { return pow(x, y); };
-    return proto::runFnWithVal<proto_NUMERIC>(xVal, yVal, op);
+    auto& val = ctx.createValue();
+    proto::runFnIntoVal<proto_NUMERIC>(val, xVal, yVal, op);
+    return val;
 }
 
-bento::protos::Value modOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Mod& node) {
-    auto xVal = evaluateNode(compStore, indexStore, node.x());
-    auto yVal = evaluateNode(compStore, indexStore, node.y());
+const bento::protos::Value& modOp(EvalContext& ctx,
+                                  const bento::protos::Node_Mod& node) {
+    auto& xVal = evaluateNode(ctx, node.x());
+    auto& yVal = evaluateNode(ctx, node.y());
 
     auto op = []<class X, class Y>(X x, Y y) { return x % y; };
-    return proto::runFnWithVal<proto::INT32, proto::INT64>(xVal, yVal, op);
+    auto& val = ctx.createValue();
+    proto::runFnIntoVal<proto::INT32, proto::INT64>(val, xVal, yVal, op);
+    return val;
 }
 
-bento::protos::Value sinOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Sin& node) {
-    auto xVal = evaluateNode(compStore, indexStore, node.x());
+const bento::protos::Value& sinOp(EvalContext& ctx,
+                                  const bento::protos::Node_Sin& node) {
+    auto& xVal = evaluateNode(ctx, node.x());
     auto op = []<class C>(C x) { return sin(x); };
-    return proto::runFnWithVal<proto_NUMERIC>(xVal, op);
+    auto& val = ctx.createValue();
+    proto::runFnIntoVal<proto_NUMERIC>(val, xVal, op);
+    return val;
 }
 
-bento::protos::Value arcSinOp(ics::ComponentStore& compStore,
-                              ics::index::IndexStore& indexStore,
-                              const bento::protos::Node_ArcSin& node) {
-    auto xVal = evaluateNode(compStore, indexStore, node.x());
+const bento::protos::Value& arcSinOp(EvalContext& ctx,
+                                     const bento::protos::Node_ArcSin& node) {
+    auto& xVal = evaluateNode(ctx, node.x());
     auto op = []<class C>(C x) {
         if (x < -1 || x > 1) {
             throw std::domain_error("arcSin's valid domain is [-1, 1].");
         }
         return asin(x);
     };
-    return proto::runFnWithVal<proto_NUMERIC>(xVal, op);
+    auto& val = ctx.createValue();
+    proto::runFnIntoVal<proto_NUMERIC>(val, xVal, op);
+    return val;
 }
 
-bento::protos::Value cosOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Cos& node) {
-    auto xVal = evaluateNode(compStore, indexStore, node.x());
+const bento::protos::Value& cosOp(EvalContext& ctx,
+                                  const bento::protos::Node_Cos& node) {
+    auto& xVal = evaluateNode(ctx, node.x());
     auto op = []<class C>(C x) { return cos(x); };
-    return proto::runFnWithVal<proto_NUMERIC>(xVal, op);
+    auto& val = ctx.createValue();
+    proto::runFnIntoVal<proto_NUMERIC>(val, xVal, op);
+    return val;
 }
 
-bento::protos::Value arcCosOp(ics::ComponentStore& compStore,
-                              ics::index::IndexStore& indexStore,
-                              const bento::protos::Node_ArcCos& node) {
-    auto xVal = evaluateNode(compStore, indexStore, node.x());
+const bento::protos::Value& arcCosOp(EvalContext& ctx,
+                                     const bento::protos::Node_ArcCos& node) {
+    auto& xVal = evaluateNode(ctx, node.x());
     auto op = []<class C>(C x) {
         if (x < -1 || x > 1) {
             throw std::domain_error("arcCos's valid domain is [-1, 1].");
         }
         return acos(x);
     };
-    return proto::runFnWithVal<proto_NUMERIC>(xVal, op);
+    auto& val = ctx.createValue();
+    proto::runFnIntoVal<proto_NUMERIC>(val, xVal, op);
+    return val;
 }
 
-bento::protos::Value tanOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Tan& node) {
-    auto xVal = evaluateNode(compStore, indexStore, node.x());
+const bento::protos::Value& tanOp(EvalContext& ctx,
+                                  const bento::protos::Node_Tan& node) {
+    auto& xVal = evaluateNode(ctx, node.x());
     auto op = []<class C>(C x) { return tan(x); };
-    return proto::runFnWithVal<proto_NUMERIC>(xVal, op);
+    auto& val = ctx.createValue();
+    proto::runFnIntoVal<proto_NUMERIC>(val, xVal, op);
+    return val;
 }
 
-bento::protos::Value arcTanOp(ics::ComponentStore& compStore,
-                              ics::index::IndexStore& indexStore,
-                              const bento::protos::Node_ArcTan& node) {
-    auto xVal = evaluateNode(compStore, indexStore, node.x());
+const bento::protos::Value& arcTanOp(EvalContext& ctx,
+                                     const bento::protos::Node_ArcTan& node) {
+    auto& xVal = evaluateNode(ctx, node.x());
     auto op = []<class C>(C x) { return atan(x); };
-    return proto::runFnWithVal<proto_NUMERIC>(xVal, op);
+    auto& val = ctx.createValue();
+    proto::runFnIntoVal<proto_NUMERIC>(val, xVal, op);
+    return val;
 }
 
 // Generate random number
-bento::protos::Value randomOp(ics::ComponentStore& compStore,
-                              ics::index::IndexStore& indexStore,
-                              const bento::protos::Node_Random& node) {
-    // Create random device and generator
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-
-    auto lowVal = evaluateNode(compStore, indexStore, node.low());
-    auto highVal = evaluateNode(compStore, indexStore, node.high());
+const bento::protos::Value& randomOp(EvalContext& ctx,
+                                     const bento::protos::Node_Random& node) {
+    auto& lowVal = evaluateNode(ctx, node.low());
+    auto& highVal = evaluateNode(ctx, node.high());
+
+    auto& val = ctx.createValue();
+    if (node.count() == 0) {
+        auto op = [&ctx, &node]<class X, class Y>(X low, Y high) {
+            typedef decltype(std::declval<X>() + std::declval<Y>())
+                CombinedType;
+            CombinedType x;
+            ctx.random.uniform(node, static_cast<CombinedType>(low),
+                               static_cast<CombinedType>(high),
+                               std::span(&x, 1));
+            return x;
+        };
+        proto::runFnIntoVal<proto::FLOAT32, proto::FLOAT64>(val, lowVal,
+                                                            highVal, op);
+        return val;
+    }
 
-    auto op = []<class X, class Y>(X low, Y high) {
+    // Generate the whole array in one batch
+    auto fillArray = [&ctx, &node, &val]<class X, class Y>(X low, Y high) {
         typedef decltype(std::declval<X>() + std::declval<Y>()) CombinedType;
-        auto dist = std::uniform_real_distribution(
-            static_cast<CombinedType>(low), static_cast<CombinedType>(high));
-        return dist(gen);
+        std::vector<CombinedType> xs(node.count());
+        ctx.random.uniform(node, static_cast<CombinedType>(low),
+                           static_cast<CombinedType>(high), std::span(xs));
+
+        auto arrayType = val.mutable_data_type()->mutable_array();
+        arrayType->add_dimensions(node.count());
+        auto values = val.mutable_array()->mutable_values();
+        values->Reserve(node.count());
+        for (auto x : xs) {
+            if constexpr (std::is_same_v<CombinedType, proto::FLOAT32>) {
+                values->Add()->set_float_32(x);
+            } else {
+                values->Add()->set_float_64(x);
+            }
+        }
+        arrayType->set_element_type(
+            std::is_same_v<CombinedType, proto::FLOAT32>
+                ? bento::protos::Type_Primitive_FLOAT32
+                : bento::protos::Type_Primitive_FLOAT64);
     };
-    return proto::runFnWithVal<proto::FLOAT32, proto::FLOAT64>(lowVal, highVal,
-                                                               op);
+    proto::visitVal<proto::FLOAT32, proto::FLOAT64>(
+        lowVal, [&highVal, &fillArray]<class X>(X low) {
+            proto::visitVal<proto::FLOAT32, proto::FLOAT64>(
+                highVal, [&]<class Y>(Y high) { fillArray(low, high); });
+        });
+    return val;
 }
 
-bento::protos::Value andOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_And& node) {
-    auto xVal = evaluateNode(compStore, indexStore, node.x());
-    auto yVal = evaluateNode(compStore, indexStore, node.y());
+const bento::protos::Value& andOp(EvalContext& ctx,
+                                  const bento::protos::Node_And& node) {
+    auto& xVal = evaluateNode(ctx, node.x());
+    auto& yVal = evaluateNode(ctx, node.y());
 
     if (!proto::isValOfType<proto::BOOL>(xVal) ||
         !proto::isValOfType<proto::BOOL>(yVal)) {
@@ -260,7 +330,7 @@ bento::protos::Value andOp(ics::ComponentStore& compStore,
             "Cannot run AND operation on non-boolean values.");
     }
 
-    auto val = bento::protos::Value();
+    auto& val = ctx.createValue();
     val.mutable_primitive()->set_boolean(xVal.primitive().boolean() and
                                          yVal.primitive().boolean());
     val.mutable_data_type()->set_primitive(bento::protos::Type_Primitive_BOOL);
@@ -268,11 +338,10 @@ bento::protos::Value andOp(ics::ComponentStore& compStore,
     return val;
 }
 
-bento::protos::Value orOp(ics::ComponentStore& compStore,
-                          ics::index::IndexStore& indexStore,
-                          const bento::protos::Node_Or& node) {
-    auto xVal = evaluateNode(compStore, indexStore, node.x());
-    auto yVal = evaluateNode(compStore, indexStore, node.y());
+const bento::protos::Value& orOp(EvalContext& ctx,
+                                 const bento::protos::Node_Or& node) {
+    auto& xVal = evaluateNode(ctx, node.x());
+    auto& yVal = evaluateNode(ctx, node.y());
 
     if (!proto::isValOfType<proto::BOOL>(xVal) ||
         !proto::isValOfType<proto::BOOL>(yVal)) {
@@ -280,7 +349,7 @@ bento::protos::Value orOp(ics::ComponentStore& compStore,
             "Cannot run OR operation on non-boolean values.");
     }
 
-    auto val = bento::protos::Value();
+    auto& val = ctx.createValue();
     val.mutable_primitive()->set_boolean(xVal.primitive().boolean() or
                                          yVal.primitive().boolean());
     val.mutable_data_type()->set_primitive(bento::protos::Type_Primitive_BOOL);
@@ -288,82 +357,114 @@ bento::protos::Value orOp(ics::ComponentStore& compStore,
     return val;
 }
 
-bento::protos::Value notOp(ics::ComponentStore& compStore,
-                           ics::index::IndexStore& indexStore,
-                           const bento::protos::Node_Not& node) {
-    auto xVal = evaluateNode(compStore, indexStore, node.x());
+const bento::protos::Value& notOp(EvalContext& ctx,
+                                  const bento::protos::Node_Not& node) {
+    auto& xVal = evaluateNode(ctx, node.x());
 
     if (!proto::isValOfType<proto::BOOL>(xVal)) {
         throw std::domain_error(
             "Cannot run NOT operation on non-boolean values.");
     }
 
-    auto val = bento::protos::Value();
+    auto& val = ctx.createValue();
     val.mutable_primitive()->set_boolean(!xVal.primitive().boolean());
     val.mutable_data_type()->set_primitive(bento::protos::Type_Primitive_BOOL);
 
     return val;
 }
 
-bento::protos::Value eqOp(ics::ComponentStore& compStore,
-                          ics::index::IndexStore& indexStore,
-                          const bento::protos::Node_Eq& node) {
-    auto xVal = evaluateNode(compStore, indexStore, node.x());
-    auto yVal = evaluateNode(compStore, indexStore, node.y());
+const bento::protos::Value& eqOp(EvalContext& ctx,
+                                 const bento::protos::Node_Eq& node) {
+    auto& xVal = evaluateNode(ctx, node.x());
+    auto& yVal = evaluateNode(ctx, node.y());
 
     auto op = []<class X, class Y>(X x, Y y) { return x == y; };
+    auto& val = ctx.createValue();
     if (proto::isValOfTypes<proto_NUMERIC>(xVal)) {
         // Run the function with other possible numeric comparisons
-        return proto::runFnWithVal<proto_NUMERIC>(xVal, yVal, op);
+        proto::runFnIntoVal<proto_NUMERIC>(val, xVal, yVal, op);
     } else if (proto::isValOfType<proto::STR>(xVal)) {
         // Run the function with only string values allowed
-        return proto::runFnWithVal<proto::STR>(xVal, yVal, op);
+        proto::runFnIntoVal<proto::STR>(val, xVal, yVal, op);
     } else if (proto::isValOfType<proto::BOOL>(xVal)) {
-        return proto::runFnWithVal<proto::BOOL>(xVal, yVal, op);
+        proto::runFnIntoVal<proto::BOOL>(val, xVal, yVal, op);
     } else {
         throw std::domain_error(
             "Checking equivalence between given values is not possible.");
     }
+
+    return val;
 }
 
-bento::protos::Value gtOp(ics::ComponentStore& compStore,
-                          ics::index::IndexStore& indexStore,
-                          const bento::protos::Node_Gt& node) {
-    auto xVal = evaluateNode(compStore, indexStore, node.x());
-    auto yVal = evaluateNode(compStore, indexStore, node.y());
+const bento::protos::Value& gtOp(EvalContext& ctx,
+                                 const bento::protos::Node_Gt& node) {
+    auto& xVal = evaluateNode(ctx, node.x());
+    auto& yVal = evaluateNode(ctx, node.y());
 
     auto op = []<class X, class Y>(X x, Y y) { return x > y; };
-    return proto::runFnWithVal<proto_NUMERIC>(xVal, yVal, op);
+    auto& val = ctx.createValue();
+    proto::runFnIntoVal<proto_NUMERIC>(val, xVal, yVal, op);
+    return val;
 }
 
-bento::protos::Value ltOp(ics::ComponentStore& compStore,
-                          ics::index::IndexStore& indexStore,
-                          const bento::protos::Node_Lt& node) {
-    auto xVal = evaluateNode(compStore, indexStore, node.x());
-    auto yVal = evaluateNode(compStore, indexStore, node.y());
+const bento::protos::Value& ltOp(EvalContext& ctx,
+                                 const bento::protos::Node_Lt& node) {
+    auto& xVal = evaluateNode(ctx, node.x());
+    auto& yVal = evaluateNode(ctx, node.y());
 
     auto op = []<class X, class Y>(X x, Y y) { return x < y; };
-    return proto::runFnWithVal<proto_NUMERIC>(xVal, yVal, op);
+    auto& val = ctx.createValue();
+    proto::runFnIntoVal<proto_NUMERIC>(val, xVal, yVal, op);
+    return val;
 }
 
-bento::protos::Value geOp(ics::ComponentStore& compStore,
-                          ics::index::IndexStore& indexStore,
-                          const bento::protos::Node_Ge& node) {
-    auto xVal = evaluateNode(compStore, indexStore, node.x());
-    auto yVal = evaluateNode(compStore, indexStore, node.y());
+const bento::protos::Value& geOp(EvalContext& ctx,
+                                 const bento::protos::Node_Ge& node) {
+    auto& xVal = evaluateNode(ctx, node.x());
+    auto& yVal = evaluateNode(ctx, node.y());
 
     auto op = []<class X, class Y>(X x, Y y) { return x >= y; };
-    return proto::runFnWithVal<proto_NUMERIC>(xVal, yVal, op);
+    auto& val = ctx.createValue();
+    proto::runFnIntoVal<proto_NUMERIC>(val, xVal, yVal, op);
+    return val;
 }
 
-bento::protos::Value leOp(ics::ComponentStore& compStore,
-                          ics::index::IndexStore& indexStore,
-                          const bento::protos::Node_Le& node) {
-    auto xVal = evaluateNode(compStore, indexStore, node.x());
-    auto yVal = evaluateNode(compStore, indexStore, node.y());
+const bento::protos::Value& leOp(EvalContext& ctx,
+                                 const bento::protos::Node_Le& node) {
+    auto& xVal = evaluateNode(ctx, node.x());
+    auto& yVal = evaluateNode(ctx, node.y());
 
     auto op = []<class X, class Y>(X x, Y y) { return x <= y; };
-    return proto::runFnWithVal<proto_NUMERIC>(xVal, yVal, op);
+    auto& val = ctx.createValue();
+    proto::runFnIntoVal<proto_NUMERIC>(val, xVal, yVal, op);
+    return val;
+}
+
+const bento::protos::Value& spawnOp(EvalContext& ctx,
+                                    const bento::protos::Node_Spawn& node) {
+    auto groups = ctx.indexStore.attribute.resolveSpawn(
+        ctx.indexStore.componentType, node);
+    auto entityId = ctx.commands.spawn(ctx.indexStore, std::move(groups));
+
+    auto& val = ctx.createValue();
+    proto::setVal(val, static_cast<proto::INT64>(entityId));
+    return val;
+}
+
+const bento::protos::Value& despawnOp(EvalContext& ctx,
+                                      const bento::protos::Node_Despawn& node) {
+    auto& entityIdVal = evaluateNode(ctx, node.entity_id());
+    ics::index::EntityIndex::EntityId entityId;
+    proto::visitVal<proto::INT32, proto::INT64>(
+        entityIdVal, [&entityId]<class X>(X x) {
+            if (x < 0) {
+                throw std::domain_error("Entity IDs cannot be negative.");
+            }
+            entityId = static_cast<ics::index::EntityIndex::EntityId>(x);
+        });
+    ctx.commands.despawn(ctx.indexStore, entityId);
+
+    return entityIdVal;
 }
 
 }  // namespace interpreter
\ No newline at end of file
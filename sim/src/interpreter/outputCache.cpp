@@ -0,0 +1,108 @@
+#include <interpreter/outputCache.h>
+#include <interpreter/graphInterpreter.h>
+#include <interpreter/operations.h>
+
+#include <stdexcept>
+
+namespace interpreter {
+
+const OutputCache::Inputs& OutputCache::getInputs(
+    const ics::index::IndexStore& indexStore,
+    const bento::protos::Node_Mutate& output) {
+    auto [it, inserted] = inputs.try_emplace(&output);
+    auto& outputInputs = it->second;
+    if (inserted) {
+        auto nodeInputs = collectInputs(output.to_node());
+        outputInputs.cacheable = nodeInputs.pure;
+        outputInputs.refs = std::move(nodeInputs.refs);
+    }
+    if (!outputInputs.cacheable || outputInputs.resolved) {
+        return outputInputs;
+    }
+
+    // Refs which cannot be resolved fail when the output is evaluated, so
+    // leave reporting the error to the evaluation, and try again next time
+    const auto& compTypes = indexStore.componentType;
+    try {
+        std::vector<AttrRefIds> refIds;
+        refIds.reserve(outputInputs.refs.size());
+        for (auto ref : outputInputs.refs) {
+            refIds.push_back(indexStore.attribute.resolve(compTypes, *ref));
+        }
+        outputInputs.targetIds =
+            indexStore.attribute.resolve(compTypes, output.mutate_attr());
+        outputInputs.refIds = std::move(refIds);
+        outputInputs.resolved = true;
+    } catch (const std::exception&) {
+    }
+    return outputInputs;
+}
+
+bool OutputCache::isFresh(const ics::index::IndexStore& indexStore,
+                          const bento::protos::Node_Mutate& output,
+                          const Inputs& outputInputs) const {
+    auto it = entries.find(&output);
+    if (it == entries.end()) {
+        return false;
+    }
+
+    const auto& entry = it->second;
+    const auto& versions = indexStore.version;
+    if (entry.structureVersion != versions.getStructureVersion() ||
+        entry.targetVersion != versions.get(outputInputs.targetIds)) {
+        return false;
+    }
+    for (size_t i = 0; i < outputInputs.refIds.size(); i++) {
+        if (entry.inputVersions[i] != versions.get(outputInputs.refIds[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool OutputCache::start(const ics::index::IndexStore& indexStore,
+                        const bento::protos::Node_Mutate& output,
+                        Pending& pending) {
+    const auto& outputInputs = getInputs(indexStore, output);
+    if (!outputInputs.cacheable || !outputInputs.resolved) {
+        return true;
+    }
+    if (isFresh(indexStore, output, outputInputs)) {
+        skipCount++;
+        return false;
+    }
+
+    auto& entry = pending.entry;
+    entry.structureVersion = indexStore.version.getStructureVersion();
+    entry.inputVersions.reserve(outputInputs.refIds.size());
+    for (const auto& refIds : outputInputs.refIds) {
+        entry.inputVersions.push_back(indexStore.version.get(refIds));
+    }
+    pending.targetIds = outputInputs.targetIds;
+    pending.resolved = true;
+    return true;
+}
+
+void OutputCache::finish(const ics::index::IndexStore& indexStore,
+                         const bento::protos::Node_Mutate& output,
+                         Pending&& pending) {
+    if (!pending.resolved) {
+        return;
+    }
+    auto& entry = pending.entry;
+    entry.targetVersion = indexStore.version.get(pending.targetIds);
+    entries[&output] = std::move(entry);
+}
+
+bool OutputCache::run(EvalContext& ctx,
+                      const bento::protos::Node_Mutate& output) {
+    Pending pending;
+    if (!start(ctx.indexStore, output, pending)) {
+        return false;
+    }
+    mutateOp(ctx, output);
+    finish(ctx.indexStore, output, std::move(pending));
+    return true;
+}
+
+}  // namespace interpreter
@@ -0,0 +1,71 @@
+#include <interpreter/parallelPlan.h>
+#include <interpreter/graphInterpreter.h>
+
+#include <algorithm>
+#include <set>
+#include <string_view>
+#include <tuple>
+
+namespace interpreter {
+namespace {
+// Identifies an attribute by its ref, which views the graph's strings
+typedef std::tuple<uint32_t, std::string_view, std::string_view> AttrKey;
+
+AttrKey getKey(const bento::protos::AttributeRef& ref) {
+    return {ref.entity_id(), ref.component(), ref.attribute()};
+}
+
+std::vector<ParallelPlan::Wave> planWaves(const bento::protos::Graph& graph) {
+    std::vector<ParallelPlan::Wave> waves;
+    // Attributes set by the outputs of the last wave
+    std::set<AttrKey> written;
+    auto startWave = [&](int begin, bool parallel) {
+        waves.push_back(ParallelPlan::Wave{begin, begin, 0, parallel});
+        written.clear();
+    };
+
+    for (int i = 0; i < graph.outputs_size(); i++) {
+        const auto& output = graph.outputs(i);
+        auto inputs = collectInputs(output.to_node());
+        if (!inputs.pure) {
+            startWave(i, false);
+            waves.back().end = i + 1;
+            continue;
+        }
+
+        auto target = getKey(output.mutate_attr());
+        auto readsWritten = std::any_of(
+            inputs.refs.begin(), inputs.refs.end(),
+            [&](auto ref) { return written.contains(getKey(*ref)); });
+        if (waves.empty() || !waves.back().parallel || readsWritten ||
+            written.contains(target)) {
+            startWave(i, true);
+        }
+        auto& wave = waves.back();
+        wave.end = i + 1;
+        wave.nodeCount += inputs.nodeCount;
+        written.insert(target);
+    }
+    return waves;
+}
+}  // namespace
+
+const std::vector<ParallelPlan::Wave>& ParallelPlan::getWaves(
+    const bento::protos::Graph& graph) {
+    auto it = plans.find(&graph);
+    if (it == plans.end()) {
+        it = plans.emplace(&graph, planWaves(graph)).first;
+    }
+    return it->second;
+}
+
+size_t ParallelPlan::getTaskCount(const Wave& wave, size_t threadCount) {
+    if (!wave.parallel) {
+        return 1;
+    }
+    auto taskCount = std::min({static_cast<size_t>(wave.size()),
+                               wave.nodeCount / GRAIN_SIZE, threadCount + 1});
+    return std::max(taskCount, size_t(1));
+}
+
+}  // namespace interpreter
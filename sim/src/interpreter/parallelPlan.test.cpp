@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+#include <interpreter/graphInterpreter.h>
+#include <interpreter/outputCache.h>
+#include <interpreter/parallelPlan.h>
+#include <interpreter/threadPool.h>
+#include <interpreter/writeBuffer.h>
+
+#include <interpreter/util.h>
+#include <test_simulation.h>
+#include <ics.h>
+
+#include <vector>
+
+#define TEST_SUITE ParallelPlan
+
+using namespace interpreter;
+
+using test_simulation::TEST_COMPONENT_NAME;
+using test_simulation::TestComponent;
+
+namespace {
+typedef ics::index::EntityIndex::EntityId EntityId;
+
+// Sets the entity's attribute to its other attribute plus one
+void addIncrement(bento::protos::Graph& graph, EntityId targetId,
+                  const char* attr, EntityId sourceId, const char* fromAttr) {
+    auto& output = *graph.add_outputs();
+    *output.mutable_mutate_attr() =
+        createAttrRef(TEST_COMPONENT_NAME, targetId, attr);
+    auto& addOp = *output.mutable_to_node()->mutable_add_op();
+    *addOp.mutable_x()->mutable_retrieve_op()->mutable_retrieve_attr() =
+        createAttrRef(TEST_COMPONENT_NAME, sourceId, fromAttr);
+    auto& oneVal = *addOp.mutable_y()->mutable_const_op()->mutable_held_value();
+    oneVal.mutable_primitive()->set_int_64(1);
+    oneVal.mutable_data_type()->set_primitive(
+        bento::protos::Type_Primitive_INT64);
+}
+
+// Sets the entity's attribute to a random number
+void addRandom(bento::protos::Graph& graph, EntityId targetId,
+               const char* attr) {
+    auto& output = *graph.add_outputs();
+    *output.mutable_mutate_attr() =
+        createAttrRef(TEST_COMPONENT_NAME, targetId, attr);
+    auto randomOpNode = output.mutable_to_node()->mutable_random_op();
+    randomOpNode->mutable_low()
+        ->mutable_const_op()
+        ->mutable_held_value()
+        ->mutable_primitive()
+        ->set_int_64(0);
+    randomOpNode->mutable_high()
+        ->mutable_const_op()
+        ->mutable_held_value()
+        ->mutable_primitive()
+        ->set_int_64(100);
+}
+
+void assertWave(const ParallelPlan::Wave& wave, int begin, int end,
+                bool parallel) {
+    ASSERT_EQ(wave.begin, begin);
+    ASSERT_EQ(wave.end, end);
+    ASSERT_EQ(wave.parallel, parallel);
+}
+}  // namespace
+
+TEST(TEST_SUITE, SplitsDependentOutputs) {
+    auto graph = bento::protos::Graph();
+    // Independent of each other
+    addIncrement(graph, 0, "width", 0, "height");
+    addIncrement(graph, 1, "width", 1, "width");
+    // Reads an attribute set earlier in the wave
+    addIncrement(graph, 2, "width", 0, "width");
+    // Sets an attribute set earlier in the wave
+    addIncrement(graph, 2, "width", 3, "height");
+    // Draws random numbers
+    addRandom(graph, 4, "width");
+    addIncrement(graph, 5, "width", 4, "width");
+
+    ParallelPlan plan;
+    const auto& waves = plan.getWaves(graph);
+    ASSERT_EQ(waves.size(), 5);
+    assertWave(waves[0], 0, 2, true);
+    assertWave(waves[1], 2, 3, true);
+    assertWave(waves[2], 3, 4, true);
+    assertWave(waves[3], 4, 5, false);
+    assertWave(waves[4], 5, 6, true);
+    // Add, Retrieve and Const nodes for each output
+    ASSERT_EQ(waves[0].nodeCount, 6);
+
+    // The plan is kept for the graph
+    ASSERT_EQ(&plan.getWaves(graph), &waves);
+}
+
+TEST(TEST_SUITE, TaskCountFollowsGrainSize) {
+    auto wave = ParallelPlan::Wave{0, 100, 3 * ParallelPlan::GRAIN_SIZE};
+    ASSERT_EQ(ParallelPlan::getTaskCount(wave, 7), 3);
+    ASSERT_EQ(ParallelPlan::getTaskCount(wave, 1), 2);
+    ASSERT_EQ(ParallelPlan::getTaskCount(wave, 0), 1);
+
+    // Too small to be worth splitting
+    wave.nodeCount = ParallelPlan::GRAIN_SIZE;
+    ASSERT_EQ(ParallelPlan::getTaskCount(wave, 7), 1);
+    // No more tasks than outputs
+    wave = ParallelPlan::Wave{0, 2, 100 * ParallelPlan::GRAIN_SIZE};
+    ASSERT_EQ(ParallelPlan::getTaskCount(wave, 7), 2);
+    wave.parallel = false;
+    ASSERT_EQ(ParallelPlan::getTaskCount(wave, 7), 1);
+}
+
+class ParallelGraphFixture : public ::testing::Test {
+   protected:
+    // Enough outputs for a wave to be split between the threads
+    static constexpr int ENTITY_COUNT = 1000;
+
+    ics::ComponentStore compStore;
+    ics::index::IndexStore indexStore;
+    std::vector<EntityId> entityIds;
+    google::protobuf::Arena arena;
+    ics::CommandBuffer commands;
+    RandomSource random;
+    ParallelPlan plan;
+    ThreadPool pool{3};
+    EvalContext ctx{compStore, indexStore, arena, commands, random};
+
+    void SetUp() override {
+        for (int i = 0; i < ENTITY_COUNT; i++) {
+            auto entityId = indexStore.entity.addEntityId();
+            ics::addComponent(indexStore, compStore, entityId,
+                              TestComponent{0, i});
+            entityIds.push_back(entityId);
+        }
+        ctx.parallelPlan = &plan;
+        ctx.threadPool = &pool;
+    }
+
+    // width = height + 1 for each entity
+    bento::protos::Graph createGraph() {
+        auto graph = bento::protos::Graph();
+        for (auto entityId : entityIds) {
+            addIncrement(graph, entityId, "width", entityId, "height");
+        }
+        return graph;
+    }
+
+    int64_t getWidth(EntityId entityId) {
+        return ics::getAttribute(
+                   indexStore, compStore,
+                   createAttrRef(TEST_COMPONENT_NAME, entityId, "width"))
+            .primitive()
+            .int_64();
+    }
+};
+
+TEST_F(ParallelGraphFixture, EvaluatesWaveConcurrently) {
+    auto graph = createGraph();
+    const auto& waves = plan.getWaves(graph);
+    ASSERT_EQ(waves.size(), 1);
+    auto threadCount = pool.getThreadCount();
+    ASSERT_GT(ParallelPlan::getTaskCount(waves[0], threadCount), 1);
+
+    runGraph(ctx, graph);
+    for (int i = 0; i < ENTITY_COUNT; i++) {
+        ASSERT_EQ(getWidth(entityIds[i]), i + 1);
+    }
+    ASSERT_EQ(ctx.evalCount, 3 * ENTITY_COUNT);
+}
+
+TEST_F(ParallelGraphFixture, KeepsWritesBeforeFailure) {
+    // The output in the middle sets an attribute which does not exist
+    auto graph = createGraph();
+    auto failing = ENTITY_COUNT / 2;
+    graph.mutable_outputs(failing)->mutable_mutate_attr()->set_attribute(
+        "depth");
+
+    ASSERT_ANY_THROW(runGraph(ctx, graph));
+    for (int i = 0; i < ENTITY_COUNT; i++) {
+        ASSERT_EQ(getWidth(entityIds[i]), i < failing ? i + 1 : 0);
+    }
+}
+
+TEST_F(ParallelGraphFixture, SkipsCachedOutputs) {
+    OutputCache outputCache;
+    ctx.outputCache = &outputCache;
+    auto graph = createGraph();
+    runGraph(ctx, graph);
+    ASSERT_EQ(outputCache.getSkipCount(), 0);
+
+    runGraph(ctx, graph);
+    ASSERT_EQ(outputCache.getSkipCount(), ENTITY_COUNT);
+    ASSERT_EQ(getWidth(entityIds.back()), ENTITY_COUNT);
+}
+
+TEST_F(ParallelGraphFixture, BuffersWritesInOrder) {
+    WriteBuffer writes;
+    ctx.writes = &writes;
+    auto graph = createGraph();
+    runGraph(ctx, graph);
+    ASSERT_EQ(writes.size(), ENTITY_COUNT);
+    ASSERT_EQ(getWidth(entityIds[1]), 0);
+
+    writes.write(indexStore, compStore);
+    for (int i = 0; i < ENTITY_COUNT; i++) {
+        ASSERT_EQ(getWidth(entityIds[i]), i + 1);
+    }
+}
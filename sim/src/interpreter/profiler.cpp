@@ -0,0 +1,43 @@
+#include <interpreter/profiler.h>
+
+namespace interpreter {
+
+Profiler::NodeTimer::NodeTimer(Profiler& profiler, OpCase op)
+    : profiler(profiler),
+      op(op),
+      start(Clock::now()),
+      outerChildTime(profiler.childTime) {
+    profiler.childTime = Clock::duration::zero();
+}
+
+Profiler::NodeTimer::~NodeTimer() {
+    auto elapsed = Clock::now() - start;
+    if (profiler.nodes.size() <= op) {
+        profiler.nodes.resize(op + 1);
+    }
+    profiler.nodes[op].add(elapsed - profiler.childTime);
+    // This node is a child of the enclosing node
+    profiler.childTime = outerChildTime + elapsed;
+}
+
+void Profiler::addSystem(uint32_t systemId, Clock::duration duration) {
+    systems[systemId].add(duration);
+}
+
+std::map<Profiler::OpCase, Profiler::Counter> Profiler::getNodes() const {
+    std::map<OpCase, Counter> counters;
+    for (size_t op = 0; op < nodes.size(); op++) {
+        if (nodes[op].count > 0) {
+            counters[static_cast<OpCase>(op)] = nodes[op];
+        }
+    }
+    return counters;
+}
+
+void Profiler::reset() {
+    nodes.clear();
+    systems.clear();
+    childTime = Clock::duration::zero();
+}
+
+}  // namespace interpreter
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <interpreter/graphInterpreter.h>
+#include <interpreter/profiler.h>
+
+#include <interpreter/util.h>
+#include <test_simulation.h>
+#include <ics.h>
+
+#include <thread>
+
+#define TEST_SUITE Profiler
+
+using namespace interpreter;
+
+TEST(TEST_SUITE, NodeTimeExcludesChildren) {
+    typedef bento::protos::Node::OpCase OpCase;
+    Profiler profiler;
+    {
+        Profiler::NodeTimer outer(profiler, OpCase::kAddOp);
+        {
+            Profiler::NodeTimer inner(profiler, OpCase::kMulOp);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        Profiler::NodeTimer sibling(profiler, OpCase::kMulOp);
+    }
+
+    auto nodes = profiler.getNodes();
+    ASSERT_EQ(nodes.size(), 2);
+    ASSERT_EQ(nodes[OpCase::kAddOp].count, 1);
+    ASSERT_EQ(nodes[OpCase::kMulOp].count, 2);
+    // The time spent sleeping is only counted in the inner node
+    ASSERT_GE(nodes[OpCase::kMulOp].total, std::chrono::milliseconds(20));
+    ASSERT_LT(nodes[OpCase::kAddOp].total, std::chrono::milliseconds(20));
+
+    profiler.reset();
+    ASSERT_TRUE(profiler.getNodes().empty());
+}
+
+TEST(TEST_SUITE, CountsEvaluatedNodes) {
+    ics::ComponentStore compStore;
+    ics::index::IndexStore indexStore;
+    auto entityId = indexStore.entity.addEntityId();
+    ics::addComponent(indexStore, compStore, entityId,
+                      test_simulation::TestComponent{1, 2});
+
+    // width + (width * 2)
+    auto node = bento::protos::Node();
+    auto addOpNode = node.mutable_add_op();
+    *addOpNode->mutable_x()->mutable_retrieve_op()->mutable_retrieve_attr() =
+        createAttrRef(test_simulation::TEST_COMPONENT_NAME, entityId,
+                      "width");
+    auto mulOpNode = addOpNode->mutable_y()->mutable_mul_op();
+    *mulOpNode->mutable_x()->mutable_retrieve_op()->mutable_retrieve_attr() =
+        createAttrRef(test_simulation::TEST_COMPONENT_NAME, entityId,
+                      "width");
+    auto yVal =
+        mulOpNode->mutable_y()->mutable_const_op()->mutable_held_value();
+    yVal->mutable_primitive()->set_int_64(2);
+    yVal->mutable_data_type()->set_primitive(
+        bento::protos::Type_Primitive_INT64);
+
+    google::protobuf::Arena arena;
+    ics::CommandBuffer commands;
+    RandomSource random;
+    Profiler profiler;
+    auto ctx = EvalContext{compStore, indexStore, arena, commands, random};
+    evaluateNode(ctx, node);
+    ASSERT_TRUE(profiler.getNodes().empty());
+
+    ctx.profiler = &profiler;
+    evaluateNode(ctx, node);
+    auto nodes = profiler.getNodes();
+    typedef bento::protos::Node::OpCase OpCase;
+    ASSERT_EQ(nodes.size(), 4);
+    ASSERT_EQ(nodes[OpCase::kAddOp].count, 1);
+    ASSERT_EQ(nodes[OpCase::kMulOp].count, 1);
+    ASSERT_EQ(nodes[OpCase::kRetrieveOp].count, 2);
+    ASSERT_EQ(nodes[OpCase::kConstOp].count, 1);
+}
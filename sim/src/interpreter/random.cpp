@@ -0,0 +1,90 @@
+#include <interpreter/random.h>
+
+namespace interpreter {
+namespace {
+// Round multipliers and key increments from the Philox paper
+const uint32_t PHILOX_M0 = 0xD2511F53;
+const uint32_t PHILOX_M1 = 0xCD9E8D57;
+const uint32_t PHILOX_W0 = 0x9E3779B9;
+const uint32_t PHILOX_W1 = 0xBB67AE85;
+const int PHILOX_ROUNDS = 10;
+}  // namespace
+
+Philox4x32::Counter Philox4x32::generate(Counter counter, Key key) {
+    for (int round = 0; round < PHILOX_ROUNDS; round++) {
+        auto product0 = uint64_t(PHILOX_M0) * counter[0];
+        auto product1 = uint64_t(PHILOX_M1) * counter[2];
+        counter = Counter{
+            uint32_t(product1 >> 32) ^ counter[1] ^ key[0],
+            uint32_t(product1),
+            uint32_t(product0 >> 32) ^ counter[3] ^ key[1],
+            uint32_t(product0),
+        };
+        key[0] += PHILOX_W0;
+        key[1] += PHILOX_W1;
+    }
+    return counter;
+}
+
+void RandomSource::nextStep() {
+    step++;
+    std::fill(nodeBlocks.begin(), nodeBlocks.end(), 0);
+}
+
+void RandomSource::internMessage(const google::protobuf::Message& message) {
+    if (auto node = dynamic_cast<const bento::protos::Node_Random*>(&message)) {
+        getNodeId(*node);
+    }
+
+    // Walk through the set message fields with reflection so that Random
+    // nodes nested in any node type are found. The fields are listed in
+    // field number order, so the walk is the same for equal graphs.
+    auto reflection = message.GetReflection();
+    std::vector<const google::protobuf::FieldDescriptor*> fields;
+    reflection->ListFields(message, &fields);
+    for (auto field : fields) {
+        if (field->cpp_type() !=
+            google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE) {
+            continue;
+        }
+
+        if (field->is_repeated()) {
+            for (int i = 0; i < reflection->FieldSize(message, field); i++) {
+                internMessage(
+                    reflection->GetRepeatedMessage(message, field, i));
+            }
+        } else {
+            internMessage(reflection->GetMessage(message, field));
+        }
+    }
+}
+
+uint32_t RandomSource::getNodeId(const bento::protos::Node_Random& node) {
+    auto [it, inserted] = nodeIds.emplace(&node, nodeBlocks.size());
+    if (inserted) {
+        nodeBlocks.push_back(0);
+    }
+    return it->second;
+}
+
+void RandomSource::internGraph(const bento::protos::Graph& graph) {
+    internMessage(graph);
+}
+
+void RandomSource::generate(const bento::protos::Node_Random& node,
+                            std::span<uint32_t> out) {
+    auto nodeId = getNodeId(node);
+    auto key = Philox4x32::Key{uint32_t(seed), uint32_t(seed >> 32)};
+    auto& block = nodeBlocks[nodeId];
+
+    for (size_t i = 0; i < out.size(); i += 4) {
+        auto counter = Philox4x32::Counter{block, nodeId, uint32_t(step),
+                                           uint32_t(step >> 32)};
+        block++;
+        auto words = Philox4x32::generate(counter, key);
+        std::copy_n(words.begin(), std::min<size_t>(4, out.size() - i),
+                    out.begin() + i);
+    }
+}
+
+}  // namespace interpreter
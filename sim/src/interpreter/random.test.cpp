@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <interpreter/random.h>
+
+#include <vector>
+
+#define TEST_SUITE Random
+
+using namespace interpreter;
+
+TEST(TEST_SUITE, PhiloxKnownAnswers) {
+    // Known answer tests from the Random123 reference implementation
+    auto zeros = Philox4x32::generate({0, 0, 0, 0}, {0, 0});
+    ASSERT_EQ(zeros,
+              (Philox4x32::Counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c,
+                                   0x9b00dbd8}));
+
+    auto ones = Philox4x32::generate(
+        {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+        {0xffffffff, 0xffffffff});
+    ASSERT_EQ(ones, (Philox4x32::Counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6,
+                                         0x6d5451fd}));
+
+    auto pi = Philox4x32::generate(
+        {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344},
+        {0xa4093822, 0x299f31d0});
+    ASSERT_EQ(pi, (Philox4x32::Counter{0xd16cfe09, 0x94fdcceb, 0x5001e420,
+                                       0x24126ea1}));
+}
+
+TEST(TEST_SUITE, SameSeedGivesSameNumbers) {
+    auto graph = bento::protos::Graph();
+    auto& node1 = *graph.add_effects()->mutable_random_op();
+    auto& node2 = *graph.add_effects()->mutable_random_op();
+
+    RandomSource source1(42);
+    RandomSource source2(42);
+    source1.internGraph(graph);
+    source2.internGraph(graph);
+
+    std::vector<double> xs1(10), xs2(10), ys(10);
+    source1.uniform(node1, 0.0, 1.0, std::span(xs1));
+    source2.uniform(node1, 0.0, 1.0, std::span(xs2));
+    ASSERT_EQ(xs1, xs2);
+
+    // Each node has its own stream
+    source1.uniform(node2, 0.0, 1.0, std::span(ys));
+    ASSERT_NE(xs1, ys);
+
+    // Further draws continue the stream instead of repeating it
+    source2.uniform(node1, 0.0, 1.0, std::span(xs2));
+    ASSERT_NE(xs1, xs2);
+
+    // Each step draws new numbers
+    source1.nextStep();
+    source1.uniform(node1, 0.0, 1.0, std::span(ys));
+    ASSERT_NE(xs1, ys);
+
+    RandomSource otherSeed(43);
+    otherSeed.internGraph(graph);
+    otherSeed.uniform(node1, 0.0, 1.0, std::span(ys));
+    ASSERT_NE(xs1, ys);
+}
+
+TEST(TEST_SUITE, UniformInRange) {
+    auto node = bento::protos::Node_Random();
+    RandomSource source;
+
+    std::vector<float> xs(1000);
+    source.uniform(node, -2.0f, 3.0f, std::span(xs));
+    float sum = 0;
+    for (auto x : xs) {
+        ASSERT_GE(x, -2.0f);
+        ASSERT_LE(x, 3.0f);
+        sum += x;
+    }
+    // The mean of a uniform distribution is the middle of the range
+    ASSERT_NEAR(sum / xs.size(), 0.5f, 0.2f);
+}
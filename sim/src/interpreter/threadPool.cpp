@@ -0,0 +1,110 @@
+#include <interpreter/threadPool.h>
+
+#include <algorithm>
+
+namespace interpreter {
+
+ThreadPool::Batch::Batch(std::function<void(size_t)> task, size_t taskCount)
+    : task(std::move(task)), taskCount(taskCount), exceptions(taskCount) {}
+
+void ThreadPool::Batch::runTasks(bool onWorker) {
+    for (auto i = nextTask++; i < taskCount; i = nextTask++) {
+        auto allocationsBefore = memory::getThreadAllocations();
+        try {
+            task(i);
+        } catch (...) {
+            // Each task has a slot of its own, so no lock is needed
+            exceptions[i] = std::current_exception();
+        }
+        // Counted before the task is done, so that the caller sees them
+        if (onWorker) {
+            auto count = memory::getThreadAllocations() - allocationsBefore;
+            workerAllocations += count.allocations;
+            workerAllocatedBytes += count.bytes;
+        }
+        if (++doneCount == taskCount) {
+            std::lock_guard lock(mutex);
+            done.notify_all();
+        }
+    }
+}
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++) {
+        workers.emplace_back([this]() { this->work(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::work() {
+    while (true) {
+        std::shared_ptr<Batch> batch;
+        {
+            std::unique_lock lock(mutex);
+            wake.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            batch = std::move(queue.front());
+            queue.pop_front();
+        }
+        batch->runTasks(true);
+    }
+}
+
+memory::AllocationCount ThreadPool::run(
+    size_t taskCount, const std::function<void(size_t)>& task) {
+    if (taskCount == 0) {
+        return {};
+    }
+
+    auto batch = std::make_shared<Batch>(task, taskCount);
+    // The calling thread runs tasks too, so ask for one helper less than
+    // there are tasks
+    auto helperCount = std::min(workers.size(), taskCount - 1);
+    if (helperCount > 0) {
+        {
+            std::lock_guard lock(mutex);
+            for (size_t i = 0; i < helperCount; i++) {
+                queue.push_back(batch);
+            }
+        }
+        if (helperCount == 1) {
+            wake.notify_one();
+        } else {
+            wake.notify_all();
+        }
+    }
+
+    batch->runTasks(false);
+    {
+        std::unique_lock lock(batch->mutex);
+        batch->done.wait(lock, [&]() {
+            return batch->doneCount == batch->taskCount;
+        });
+    }
+    for (const auto& exception : batch->exceptions) {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+    return {batch->workerAllocations, batch->workerAllocatedBytes};
+}
+
+size_t ThreadPool::getQueueDepth() {
+    std::lock_guard lock(mutex);
+    return queue.size();
+}
+
+}  // namespace interpreter
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <interpreter/threadPool.h>
+
+#include <atomic>
+#include <latch>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define TEST_SUITE ThreadPool
+
+using namespace interpreter;
+
+TEST(TEST_SUITE, RunsEachTaskOnce) {
+    ThreadPool pool(3);
+    ASSERT_EQ(pool.getThreadCount(), 3);
+
+    std::vector<std::atomic<int>> runs(100);
+    pool.run(runs.size(), [&runs](size_t i) { runs[i]++; });
+    for (const auto& count : runs) {
+        ASSERT_EQ(count, 1);
+    }
+}
+
+TEST(TEST_SUITE, RunsOnCallerWithoutThreads) {
+    ThreadPool pool(0);
+    std::vector<std::thread::id> threads(4);
+    pool.run(threads.size(),
+             [&threads](size_t i) { threads[i] = std::this_thread::get_id(); });
+    for (const auto& thread : threads) {
+        ASSERT_EQ(thread, std::this_thread::get_id());
+    }
+}
+
+TEST(TEST_SUITE, RethrowsFirstFailure) {
+    ThreadPool pool(2);
+    std::atomic<int> runs = 0;
+    try {
+        pool.run(10, [&runs](size_t i) {
+            runs++;
+            if (i == 3 || i == 7) {
+                throw std::runtime_error(std::to_string(i));
+            }
+        });
+        FAIL() << "Expected the failure to be rethrown";
+    } catch (const std::runtime_error& e) {
+        ASSERT_STREQ(e.what(), "3");
+    }
+    // The other tasks still run
+    ASSERT_EQ(runs, 10);
+}
+
+TEST(TEST_SUITE, SharedByCallers) {
+    ThreadPool pool(2);
+    std::atomic<int> runs = 0;
+    std::vector<std::thread> callers;
+    for (int i = 0; i < 4; i++) {
+        callers.emplace_back([&]() {
+            for (int j = 0; j < 50; j++) {
+                pool.run(8, [&runs](size_t) { runs++; });
+            }
+        });
+    }
+    for (auto& caller : callers) {
+        caller.join();
+    }
+    ASSERT_EQ(runs, 4 * 50 * 8);
+}
+
+TEST(TEST_SUITE, CountsWorkerAllocations) {
+    ThreadPool pool(2);
+    // None of the tasks finish until all of them have started, so two of
+    // them have to run on the workers
+    std::latch started(3);
+    auto before = memory::getThreadAllocations();
+    auto workerCount = pool.run(3, [&started](size_t i) {
+        started.arrive_and_wait();
+        auto ptr = std::make_unique<int[]>(10);
+        ptr[0] = i;
+    });
+    auto callerCount = memory::getThreadAllocations() - before;
+
+    ASSERT_EQ(workerCount.allocations, 2);
+    ASSERT_EQ(workerCount.bytes, 2 * 10 * sizeof(int));
+    // The caller's task is counted on the caller
+    ASSERT_GE(callerCount.allocations, 1);
+}
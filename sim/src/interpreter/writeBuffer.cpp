@@ -0,0 +1,31 @@
+#include <interpreter/writeBuffer.h>
+#include <ics.h>
+
+namespace interpreter {
+
+void WriteBuffer::add(const ics::index::AttributeIndex::AttrRefIds& refIds,
+                      const bento::protos::Value& value) {
+    writes.push_back({refIds, &value});
+}
+
+void WriteBuffer::append(WriteBuffer& other) {
+    writes.insert(writes.end(), other.writes.begin(), other.writes.end());
+    other.writes.clear();
+}
+
+void WriteBuffer::write(ics::index::IndexStore& indexStore,
+                        ics::ComponentStore& compStore) {
+    try {
+        for (const auto& write : writes) {
+            ics::setAttribute(indexStore, compStore, write.refIds,
+                              *write.value);
+        }
+    } catch (...) {
+        writes.clear();
+        throw;
+    }
+    // Keep the capacity for the next step
+    writes.clear();
+}
+
+}  // namespace interpreter
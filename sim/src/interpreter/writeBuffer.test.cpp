@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include <interpreter/graphInterpreter.h>
+#include <interpreter/writeBuffer.h>
+
+#include <interpreter/util.h>
+#include <test_simulation.h>
+#include <ics.h>
+
+#define TEST_SUITE WriteBuffer
+
+using namespace interpreter;
+
+using test_simulation::TEST_COMPONENT_NAME;
+using test_simulation::TestComponent;
+
+namespace {
+// Creates an output which sets the target attribute to the source attribute
+bento::protos::Node_Mutate createCopy(
+    const bento::protos::AttributeRef& target,
+    const bento::protos::AttributeRef& source) {
+    bento::protos::Node_Mutate output;
+    output.mutable_mutate_attr()->CopyFrom(target);
+    output.mutable_to_node()
+        ->mutable_retrieve_op()
+        ->mutable_retrieve_attr()
+        ->CopyFrom(source);
+    return output;
+}
+}  // namespace
+
+TEST(TEST_SUITE, OutputsReadStateBeforeStep) {
+    ics::ComponentStore compStore;
+    ics::index::IndexStore indexStore;
+    auto entityId = indexStore.entity.addEntityId();
+    ics::addComponent(indexStore, compStore, entityId, TestComponent{50, 30});
+    auto width = createAttrRef(TEST_COMPONENT_NAME, entityId, "width");
+    auto height = createAttrRef(TEST_COMPONENT_NAME, entityId, "height");
+
+    // Swapping the attributes only works if the second output reads the
+    // width from before the first output set it
+    bento::protos::Graph graph;
+    graph.mutable_outputs()->Add(createCopy(width, height));
+    graph.mutable_outputs()->Add(createCopy(height, width));
+
+    google::protobuf::Arena arena;
+    ics::CommandBuffer commands;
+    RandomSource random;
+    WriteBuffer writes;
+    auto ctx = EvalContext{compStore, indexStore, arena, commands, random};
+    ctx.writes = &writes;
+    runGraph(ctx, graph);
+    ASSERT_EQ(writes.size(), 2);
+    // Nothing is written until the buffer is
+    ASSERT_EQ(ics::getAttribute(indexStore, compStore, width)
+                  .primitive()
+                  .int_64(),
+              50);
+
+    writes.write(indexStore, compStore);
+    ASSERT_TRUE(writes.empty());
+    ASSERT_EQ(ics::getAttribute(indexStore, compStore, width)
+                  .primitive()
+                  .int_64(),
+              30);
+    ASSERT_EQ(ics::getAttribute(indexStore, compStore, height)
+                  .primitive()
+                  .int_64(),
+              50);
+}
+
+TEST(TEST_SUITE, EmptiedWhenWriteFails) {
+    ics::ComponentStore compStore;
+    ics::index::IndexStore indexStore;
+    auto entityId = indexStore.entity.addEntityId();
+    ics::addComponent(indexStore, compStore, entityId, TestComponent{50, 30});
+    auto group = indexStore.componentType.getComponentType(TEST_COMPONENT_NAME);
+
+    // The entity which is written to does not exist
+    bento::protos::Value value;
+    value.mutable_primitive()->set_int_64(1);
+    value.mutable_data_type()->set_primitive(
+        bento::protos::Type_Primitive_INT64);
+    WriteBuffer writes;
+    writes.add({group, entityId + 1, 0}, value);
+    ASSERT_ANY_THROW(writes.write(indexStore, compStore));
+    ASSERT_TRUE(writes.empty());
+}
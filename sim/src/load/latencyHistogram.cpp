@@ -0,0 +1,66 @@
+#include <load/latencyHistogram.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace load {
+
+LatencyHistogram::LatencyHistogram()
+    : counts(getBucket(UINT64_MAX) + 1, 0) {}
+
+size_t LatencyHistogram::getBucket(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+        return value;
+    }
+    // The top SUB_BUCKET_BITS + 1 bits of the value select the bucket
+    int exponent = std::bit_width(value) - 1;
+    int shift = exponent - SUB_BUCKET_BITS;
+    auto subBucket = (value >> shift) & (SUB_BUCKETS - 1);
+    return (shift + 1) * SUB_BUCKETS + subBucket;
+}
+
+uint64_t LatencyHistogram::getBucketMax(size_t bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+    int shift = bucket / SUB_BUCKETS - 1;
+    auto subBucket = bucket % SUB_BUCKETS;
+    auto lowest = (SUB_BUCKETS + subBucket) << shift;
+    return lowest + ((uint64_t(1) << shift) - 1);
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    counts[getBucket(value)]++;
+    count++;
+    min = std::min(min, value);
+    max = std::max(max, value);
+    sum += value;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < counts.size(); i++) {
+        counts[i] += other.counts[i];
+    }
+    count += other.count;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+    sum += other.sum;
+}
+
+uint64_t LatencyHistogram::getQuantile(double quantile) const {
+    if (count == 0) {
+        return 0;
+    }
+    auto rank = std::max<uint64_t>(1, std::ceil(quantile * count));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return std::clamp(getBucketMax(i), getMin(), max);
+        }
+    }
+    return max;
+}
+
+}  // namespace load
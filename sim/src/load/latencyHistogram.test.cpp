@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include <load/latencyHistogram.h>
+
+#define TEST_SUITE LatencyHistogram
+
+using namespace load;
+
+TEST(TEST_SUITE, SmallValuesAreExact) {
+    LatencyHistogram histogram;
+    for (uint64_t i = 1; i <= 20; i++) {
+        histogram.record(i);
+    }
+    ASSERT_EQ(histogram.getCount(), 20);
+    ASSERT_EQ(histogram.getMin(), 1);
+    ASSERT_EQ(histogram.getMax(), 20);
+    ASSERT_DOUBLE_EQ(histogram.getMean(), 10.5);
+    ASSERT_EQ(histogram.getQuantile(0.5), 10);
+    ASSERT_EQ(histogram.getQuantile(0.95), 19);
+    ASSERT_EQ(histogram.getQuantile(1.0), 20);
+}
+
+TEST(TEST_SUITE, QuantilesWithinRelativeError) {
+    LatencyHistogram histogram;
+    for (uint64_t i = 1; i <= 1000000; i++) {
+        histogram.record(i * 1000);
+    }
+    for (double quantile : {0.5, 0.9, 0.99, 0.999}) {
+        double expected = quantile * 1e9;
+        double actual = histogram.getQuantile(quantile);
+        ASSERT_NEAR(actual / expected, 1.0, 1.0 / 32);
+        // The upper bound of the bucket is returned
+        ASSERT_GE(actual, expected);
+    }
+    ASSERT_EQ(histogram.getQuantile(1.0), 1000000000);
+}
+
+TEST(TEST_SUITE, MergeCombinesCounts) {
+    LatencyHistogram fast, slow, empty;
+    for (int i = 0; i < 99; i++) {
+        fast.record(20);
+    }
+    slow.record(1000000);
+
+    fast.merge(slow);
+    fast.merge(empty);
+    ASSERT_EQ(fast.getCount(), 100);
+    ASSERT_EQ(fast.getMin(), 20);
+    ASSERT_EQ(fast.getMax(), 1000000);
+    ASSERT_EQ(fast.getQuantile(0.99), 20);
+    ASSERT_EQ(fast.getQuantile(0.999), 1000000);
+
+    ASSERT_EQ(empty.getQuantile(0.5), 0);
+    ASSERT_EQ(empty.getMin(), 0);
+}
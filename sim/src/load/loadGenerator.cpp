@@ -0,0 +1,348 @@
+#include <load/loadGenerator.h>
+
+#include <bento/protos/services.grpc.pb.h>
+#include <grpc++/grpc++.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using bento::protos::EngineService;
+using grpc::ClientContext;
+using grpc::Status;
+
+namespace load {
+namespace {
+typedef std::chrono::steady_clock Clock;
+
+struct Worker {
+    std::shared_ptr<EngineService::Stub> stub;
+    std::mt19937_64 rng;
+    std::map<Call, CallStats> calls;
+};
+
+std::string getSimName(const LoadConfig& config, uint32_t index) {
+    return config.simDef.name() + "-" + std::to_string(index);
+}
+
+// An attribute to get or set, with the type of the values it holds
+struct AttrTarget {
+    bento::protos::AttributeRef ref;
+    bento::protos::Type_Primitive type;
+};
+
+// Returns whether the load generator can create values of the type
+bool isSupported(const bento::protos::Type& type) {
+    switch (type.primitive()) {
+        case bento::protos::Type_Primitive_INT32:
+        case bento::protos::Type_Primitive_INT64:
+        case bento::protos::Type_Primitive_FLOAT32:
+        case bento::protos::Type_Primitive_FLOAT64:
+        case bento::protos::Type_Primitive_BOOL:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Returns an attribute of every entity in the simulation. The entity IDs are
+// taken from the simDef, so it should be the one the engine applied.
+std::vector<AttrTarget> getAttrTargets(
+    const bento::protos::SimulationDef& simDef) {
+    std::map<std::string, std::pair<std::string, bento::protos::Type_Primitive>>
+        compAttrs;
+    for (const auto& compDef : simDef.components()) {
+        for (const auto& [attrName, type] : compDef.schema()) {
+            if (isSupported(type)) {
+                compAttrs[compDef.name()] = {attrName, type.primitive()};
+                break;
+            }
+        }
+    }
+
+    std::vector<AttrTarget> targets;
+    for (const auto& entityDef : simDef.entities()) {
+        for (const auto& compName : entityDef.components()) {
+            auto it = compAttrs.find(compName);
+            if (it == compAttrs.end()) {
+                continue;
+            }
+            // A template defines count entities with consecutive IDs
+            auto count = std::max<uint32_t>(entityDef.count(), 1);
+            for (uint32_t i = 0; i < count; i++) {
+                auto& target = targets.emplace_back();
+                target.ref.set_entity_id(entityDef.id() + i);
+                target.ref.set_component(compName);
+                target.ref.set_attribute(it->second.first);
+                target.type = it->second.second;
+            }
+            break;
+        }
+    }
+    return targets;
+}
+
+// Sets the value to a random value of the type
+void setRandomValue(bento::protos::Value& value,
+                    bento::protos::Type_Primitive type, std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> pickValue(-1, 1);
+    std::uniform_int_distribution<int32_t> pickInt(-100, 100);
+    auto& primitive = *value.mutable_primitive();
+    switch (type) {
+        case bento::protos::Type_Primitive_INT32:
+            primitive.set_int_32(pickInt(rng));
+            break;
+        case bento::protos::Type_Primitive_INT64:
+            primitive.set_int_64(pickInt(rng));
+            break;
+        case bento::protos::Type_Primitive_FLOAT32:
+            primitive.set_float_32(static_cast<float>(pickValue(rng)));
+            break;
+        case bento::protos::Type_Primitive_FLOAT64:
+            primitive.set_float_64(pickValue(rng));
+            break;
+        case bento::protos::Type_Primitive_BOOL:
+            primitive.set_boolean(pickInt(rng) > 0);
+            break;
+        default:
+            throw std::domain_error("Unsupported attribute type.");
+    }
+    value.mutable_data_type()->set_primitive(type);
+}
+
+std::shared_ptr<EngineService::Stub> connect(const std::string& address,
+                                             uint32_t index) {
+    // Channels with the same args share a connection, so give each one an
+    // arg of its own
+    grpc::ChannelArguments args;
+    args.SetInt("bentobox.load.connection", index);
+    return EngineService::NewStub(grpc::CreateCustomChannel(
+        address, grpc::InsecureChannelCredentials(), args));
+}
+
+// Drops the simulations applied so far when it goes out of scope, so that
+// none are left behind on the engine when the load fails
+struct AppliedSimulations {
+    const LoadConfig& config;
+    const std::vector<std::shared_ptr<EngineService::Stub>>& stubs;
+    uint32_t count = 0;
+
+    ~AppliedSimulations() {
+        for (uint32_t i = 0; i < count; i++) {
+            bento::protos::DropSimulationReq req;
+            bento::protos::DropSimulationResp resp;
+            ClientContext context;
+            req.set_name(getSimName(config, i));
+            stubs[i % stubs.size()]->DropSimulation(&context, req, &resp);
+        }
+    }
+};
+
+void runWorker(Worker& worker, const LoadConfig& config,
+               const std::vector<AttrTarget>& targets,
+               Clock::time_point end) {
+    std::vector<Call> calls;
+    std::vector<double> cumulativeWeights;
+    double total = 0;
+    for (const auto& [call, weight] : config.callWeights) {
+        if (weight > 0) {
+            total += weight;
+            calls.push_back(call);
+            cumulativeWeights.push_back(total);
+        }
+    }
+    std::uniform_real_distribution<double> pickWeight(0, total);
+    std::uniform_int_distribution<uint32_t> pickSim(0, config.simulations - 1);
+    std::uniform_int_distribution<size_t> pickTarget(
+        0, targets.empty() ? 0 : targets.size() - 1);
+    while (Clock::now() < end) {
+        auto weight = pickWeight(worker.rng);
+        auto callIt = std::upper_bound(cumulativeWeights.begin(),
+                                       cumulativeWeights.end() - 1, weight);
+        auto call = calls[callIt - cumulativeWeights.begin()];
+        auto simName = getSimName(config, pickSim(worker.rng));
+
+        ClientContext context;
+        Status status;
+        auto start = Clock::now();
+        switch (call) {
+            case Call::STEP_SIMULATION: {
+                bento::protos::StepSimulationReq req;
+                bento::protos::StepSimulationResp resp;
+                req.set_name(simName);
+                status = worker.stub->StepSimulation(&context, req, &resp);
+                break;
+            }
+            case Call::GET_ATTRIBUTE: {
+                bento::protos::GetAttributeReq req;
+                bento::protos::GetAttributeResp resp;
+                req.set_sim_name(simName);
+                *req.mutable_attribute() =
+                    targets[pickTarget(worker.rng)].ref;
+                status = worker.stub->GetAttribute(&context, req, &resp);
+                break;
+            }
+            case Call::SET_ATTRIBUTE: {
+                bento::protos::SetAttributeReq req;
+                bento::protos::SetAttributeResp resp;
+                req.set_sim_name(simName);
+                const auto& target = targets[pickTarget(worker.rng)];
+                *req.mutable_attribute() = target.ref;
+                setRandomValue(*req.mutable_value(), target.type, worker.rng);
+                status = worker.stub->SetAttribute(&context, req, &resp);
+                break;
+            }
+        }
+        auto latency = Clock::now() - start;
+
+        auto& stats = worker.calls[call];
+        if (status.ok()) {
+            stats.latency.record(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(latency)
+                    .count());
+        } else {
+            stats.errors++;
+        }
+    }
+}
+}  // namespace
+
+const char* getCallName(Call call) {
+    switch (call) {
+        case Call::STEP_SIMULATION:
+            return "StepSimulation";
+        case Call::GET_ATTRIBUTE:
+            return "GetAttribute";
+        case Call::SET_ATTRIBUTE:
+            return "SetAttribute";
+    }
+    throw std::domain_error("Unknown call.");
+}
+
+LoadReport runLoad(const LoadConfig& config) {
+    if (config.connections == 0 || config.workersPerConnection == 0 ||
+        config.simulations == 0) {
+        throw std::invalid_argument(
+            "There must be at least one connection, worker and simulation.");
+    }
+    // The IDs of unset entities are only known once applied, but whether
+    // there are attributes to call is known now
+    bool hasAttrs = !getAttrTargets(config.simDef).empty();
+    bool hasCalls = false;
+    for (const auto& [call, weight] : config.callWeights) {
+        if (weight <= 0) {
+            continue;
+        }
+        hasCalls = true;
+        if (call != Call::STEP_SIMULATION && !hasAttrs) {
+            throw std::invalid_argument(
+                "The simulation has no attributes to get or set.");
+        }
+    }
+    if (!hasCalls) {
+        throw std::invalid_argument("At least one call needs a weight.");
+    }
+
+    std::vector<std::shared_ptr<EngineService::Stub>> stubs;
+    for (uint32_t i = 0; i < config.connections; i++) {
+        stubs.push_back(connect(config.address, i));
+    }
+
+    // Apply the simulations. They share the simDef, so the engine assigns
+    // each of them the same entity IDs.
+    std::vector<AttrTarget> targets;
+    AppliedSimulations applied{config, stubs};
+    for (uint32_t i = 0; i < config.simulations; i++) {
+        bento::protos::ApplySimulationReq req;
+        bento::protos::ApplySimulationResp resp;
+        ClientContext context;
+        *req.mutable_simulation() = config.simDef;
+        req.mutable_simulation()->set_name(getSimName(config, i));
+        auto status = stubs[i % stubs.size()]->ApplySimulation(&context, req,
+                                                               &resp);
+        if (!status.ok()) {
+            throw std::runtime_error("Could not apply simulation: " +
+                                     status.error_message());
+        }
+        applied.count++;
+        if (i == 0) {
+            targets = getAttrTargets(resp.simulation());
+        }
+    }
+
+    std::vector<Worker> workers;
+    for (uint32_t i = 0; i < config.connections; i++) {
+        for (uint32_t j = 0; j < config.workersPerConnection; j++) {
+            workers.push_back(Worker{stubs[i],
+                                     std::mt19937_64(config.seed +
+                                                     workers.size()),
+                                     {}});
+        }
+    }
+
+    LoadReport report;
+    auto start = Clock::now();
+    auto end = start + config.duration;
+    {
+        std::vector<std::exception_ptr> errors(workers.size());
+        std::vector<std::jthread> threads;
+        for (size_t i = 0; i < workers.size(); i++) {
+            threads.emplace_back([&, i]() {
+                try {
+                    runWorker(workers[i], config, targets, end);
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            });
+        }
+        threads.clear();
+        report.elapsed = Clock::now() - start;
+        for (const auto& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    for (const auto& worker : workers) {
+        for (const auto& [call, stats] : worker.calls) {
+            auto& reportStats = report.calls[call];
+            reportStats.latency.merge(stats.latency);
+            reportStats.errors += stats.errors;
+        }
+    }
+    return report;
+}
+
+void printReport(std::ostream& stream, const LoadReport& report) {
+    auto seconds = std::chrono::duration<double>(report.elapsed).count();
+    auto toMs = [](uint64_t ns) { return ns / 1e6; };
+
+    stream << std::left << std::setw(16) << "call" << std::right
+           << std::setw(10) << "calls" << std::setw(8) << "errors"
+           << std::setw(12) << "calls/s" << std::setw(10) << "mean ms"
+           << std::setw(10) << "p50 ms" << std::setw(10) << "p99 ms"
+           << std::setw(10) << "p999 ms" << std::setw(10) << "max ms"
+           << "\n";
+    stream << std::fixed << std::setprecision(3);
+    for (const auto& [call, stats] : report.calls) {
+        const auto& latency = stats.latency;
+        stream << std::left << std::setw(16) << getCallName(call)
+               << std::right << std::setw(10) << latency.getCount()
+               << std::setw(8) << stats.errors << std::setw(12)
+               << std::setprecision(1) << latency.getCount() / seconds
+               << std::setprecision(3) << std::setw(10)
+               << latency.getMean() / 1e6 << std::setw(10)
+               << toMs(latency.getQuantile(0.5)) << std::setw(10)
+               << toMs(latency.getQuantile(0.99)) << std::setw(10)
+               << toMs(latency.getQuantile(0.999)) << std::setw(10)
+               << toMs(latency.getMax()) << "\n";
+    }
+}
+
+}  // namespace load
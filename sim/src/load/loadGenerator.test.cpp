@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <load/loadGenerator.h>
+
+#include <generator/simGenerator.h>
+#include <network/grpcServer.h>
+#include <service/engineService.h>
+
+#include <sstream>
+
+#define TEST_SUITE LoadGenerator
+#define TEST_PORT 54244
+
+using namespace load;
+
+TEST(TEST_SUITE, RunLoadAgainstServer) {
+    service::EngineServiceImpl engineSvc;
+    network::GRPCServer server("localhost", TEST_PORT, {&engineSvc});
+
+    generator::OpTreeConfig world;
+    world.name = "load";
+    world.entityCount = 10;
+    LoadConfig config;
+    config.address = "localhost:" + std::to_string(TEST_PORT);
+    // The engine does not lock its simulations yet, so only one call is
+    // made at a time
+    config.connections = 1;
+    config.workersPerConnection = 1;
+    config.simulations = 2;
+    config.duration = std::chrono::milliseconds(200);
+    config.simDef = generator::generateOpTree(world);
+
+    auto report = runLoad(config);
+    ASSERT_EQ(report.calls.size(), 3);
+    for (const auto& [call, stats] : report.calls) {
+        ASSERT_GT(stats.latency.getCount(), 0) << getCallName(call);
+        ASSERT_EQ(stats.errors, 0) << getCallName(call);
+        ASSERT_LE(stats.latency.getQuantile(0.5),
+                  stats.latency.getQuantile(0.99));
+    }
+    ASSERT_GE(report.elapsed, config.duration);
+
+    std::stringstream output;
+    printReport(output, report);
+    ASSERT_NE(output.str().find("StepSimulation"), std::string::npos);
+
+    // The simulations were dropped
+    bento::protos::ListSimulationReq listReq;
+    bento::protos::ListSimulationResp listResp;
+    engineSvc.ListSimulation(nullptr, &listReq, &listResp);
+    ASSERT_EQ(listResp.sim_names_size(), 0);
+}
+
+TEST(TEST_SUITE, CallsAppliedEntitiesByType) {
+    service::EngineServiceImpl engineSvc;
+    network::GRPCServer server("localhost", TEST_PORT, {&engineSvc});
+
+    // Entities with IDs assigned by the engine, one of them a template
+    LoadConfig config;
+    config.address = "localhost:" + std::to_string(TEST_PORT);
+    config.connections = 1;
+    config.workersPerConnection = 1;
+    config.simulations = 1;
+    config.duration = std::chrono::milliseconds(100);
+    // Getting an attribute fails until it has been set
+    config.callWeights = {{Call::SET_ATTRIBUTE, 1}};
+    config.simDef.set_name("typed");
+    auto& compDef = *config.simDef.add_components();
+    compDef.set_name("counter");
+    (*compDef.mutable_schema())["value"].set_primitive(
+        bento::protos::Type_Primitive_INT64);
+    config.simDef.add_entities()->add_components("counter");
+    auto& entityDef = *config.simDef.add_entities();
+    entityDef.add_components("counter");
+    entityDef.set_count(5);
+
+    auto report = runLoad(config);
+    const auto& stats = report.calls[Call::SET_ATTRIBUTE];
+    ASSERT_GT(stats.latency.getCount(), 0);
+    ASSERT_EQ(stats.errors, 0);
+}
+
+TEST(TEST_SUITE, DropsSimulationsOnFailure) {
+    service::EngineServiceImpl engineSvc;
+    network::GRPCServer server("localhost", TEST_PORT, {&engineSvc});
+
+    generator::OpTreeConfig world;
+    world.name = "failing";
+    world.entityCount = 10;
+    LoadConfig config;
+    config.address = "localhost:" + std::to_string(TEST_PORT);
+    config.simulations = 2;
+    config.simDef = generator::generateOpTree(world);
+
+    // The second simulation cannot be replaced while the engine steps it
+    bento::protos::ApplySimulationReq applyReq;
+    bento::protos::ApplySimulationResp applyResp;
+    *applyReq.mutable_simulation() = config.simDef;
+    applyReq.mutable_simulation()->set_name("failing-1");
+    ASSERT_TRUE(engineSvc.ApplySimulation(nullptr, &applyReq, &applyResp).ok());
+    bento::protos::StartTickingReq tickReq;
+    bento::protos::StartTickingResp tickResp;
+    tickReq.set_sim_name("failing-1");
+    tickReq.set_tick_rate(10);
+    ASSERT_TRUE(engineSvc.StartTicking(nullptr, &tickReq, &tickResp).ok());
+
+    ASSERT_THROW(runLoad(config), std::runtime_error);
+    // Only the simulation which was there before is left
+    bento::protos::ListSimulationReq listReq;
+    bento::protos::ListSimulationResp listResp;
+    engineSvc.ListSimulation(nullptr, &listReq, &listResp);
+    ASSERT_EQ(listResp.sim_names_size(), 1);
+    ASSERT_EQ(listResp.sim_names(0), "failing-1");
+}
+
+TEST(TEST_SUITE, AttributeCallsNeedAttributes) {
+    LoadConfig config;
+    config.simDef.set_name("empty");
+    ASSERT_THROW(runLoad(config), std::invalid_argument);
+}
@@ -0,0 +1,121 @@
+/*
+ * bentobox-sim
+ * Load Generator Entrypoint
+ */
+#include <cli/options.h>
+#include <generator/simGenerator.h>
+#include <load/loadGenerator.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+using cli::Options;
+using std::string;
+
+namespace {
+const char USAGE[] =
+    "Usage: bentobox-load [--option value]...\n"
+    "\n"
+    "Calls a running engine from many workers, and reports the throughput\n"
+    "and latency of the calls.\n"
+    "\n"
+    "Options:\n"
+    "  --address HOST:PORT     engine to load (default localhost:54242)\n"
+    "  --connections N         gRPC connections to open\n"
+    "  --workers N             concurrent workers per connection\n"
+    "  --duration SECONDS      how long to call the engine for\n"
+    "  --mix CALL=W,...        weights of the calls, of step, get and set\n"
+    "                          (default step=1,get=4,set=1)\n"
+    "  --simulations N         copies of the simulation to apply\n"
+    "  --sim-def FILE          binary SimulationDef to apply, as written by\n"
+    "                          bentobox-gen. By default an optree world is\n"
+    "                          generated.\n"
+    "  --entities N            entities of the generated world\n"
+    "  --depth N               op tree depth of the generated world\n"
+    "  --seed N                seed of the world and the workers\n";
+
+std::map<load::Call, double> parseMix(const string& text) {
+    const std::map<string, load::Call> callNames = {
+        {"step", load::Call::STEP_SIMULATION},
+        {"get", load::Call::GET_ATTRIBUTE},
+        {"set", load::Call::SET_ATTRIBUTE},
+    };
+    std::map<load::Call, double> weights;
+    std::istringstream stream(text);
+    string entry;
+    while (std::getline(stream, entry, ',')) {
+        auto separator = entry.find('=');
+        auto it = callNames.find(entry.substr(0, separator));
+        if (it == callNames.end() || separator == string::npos) {
+            throw std::invalid_argument("Expected call=weight, got: " + entry);
+        }
+        weights[it->second] = std::stod(entry.substr(separator + 1));
+    }
+    return weights;
+}
+
+bento::protos::SimulationDef readSimDef(const string& path) {
+    std::ifstream file(path, std::ios::binary);
+    bento::protos::SimulationDef simDef;
+    if (!file || !simDef.ParseFromIstream(&file)) {
+        throw std::runtime_error("Could not read a SimulationDef from " +
+                                 path);
+    }
+    return simDef;
+}
+}  // namespace
+
+/**
+ * Generates load against a running engine, see USAGE.
+ */
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "--help") {
+        std::cerr << USAGE;
+        return 0;
+    }
+
+    try {
+        Options options(argc, argv, 1);
+        load::LoadConfig config;
+        config.address = options.take("address", config.address);
+        config.connections = options.take("connections", config.connections);
+        config.workersPerConnection =
+            options.take("workers", config.workersPerConnection);
+        config.duration = std::chrono::milliseconds(
+            uint64_t(options.take("duration", 10.0) * 1000));
+        auto mix = options.take("mix", string());
+        if (!mix.empty()) {
+            config.callWeights = parseMix(mix);
+        }
+        config.simulations = options.take("simulations", config.simulations);
+        config.seed = options.take("seed", config.seed);
+
+        auto simDefPath = options.take("sim-def", string());
+        if (simDefPath.empty()) {
+            generator::OpTreeConfig world;
+            world.name = "load";
+            world.seed = config.seed;
+            world.entityCount = options.take("entities", world.entityCount);
+            world.depth = options.take("depth", world.depth);
+            config.simDef = generator::generateOpTree(world);
+        } else {
+            config.simDef = readSimDef(simDefPath);
+        }
+        options.checkAllTaken();
+
+        std::cout << "Loading " << config.address << " with "
+                  << config.connections * config.workersPerConnection
+                  << " workers for "
+                  << std::chrono::duration<double>(config.duration).count()
+                  << "s" << std::endl;
+        auto report = load::runLoad(config);
+        load::printReport(std::cout, report);
+    } catch (const std::exception& e) {
+        std::cerr << "bentobox-load: " << e.what() << "\n\n" << USAGE;
+        return 1;
+    }
+    return 0;
+}
@@ -9,10 +9,16 @@
 #include <ics.h>
 #include <system/render.h>
 #include <network/grpcServer.h>
+#include <network/metricsServer.h>
 #include <service/engineService.h>
 
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
 using grpc::Service;
 using network::GRPCServer;
+using network::MetricsServer;
 using service::EngineServiceImpl;
 using std::invalid_argument;
 using std::list;
@@ -44,6 +50,14 @@ string getEnv(const string name, const string defaultValue) {
  * Environment Variable parameters:
  * - BENTOBOX_SIM_HOST - the host/ip that bentobox-sim listens on.
  * - BENTOBOX_SIM_PORT - the port that bentobox-sim listens on.
+ * - BENTOBOX_SIM_METRICS_PORT - the port that bentobox-sim serves Prometheus
+ *   metrics on, at /metrics.
+ * - BENTOBOX_SIM_EVAL_THREADS - the number of threads that help evaluate the
+ *   systems' outputs. Defaults to one less than the number of cores.
+ * - BENTOBOX_SIM_RECORDINGS_DIR - the directory that recordings are written
+ *   to. Recording is disabled if unset.
+ * - BENTOBOX_SIM_TRACES_DIR - the directory that traces are written to when a
+ *   file is named. Traces are only returned in the response if unset.
  */
 int main(int argc, char *argv[]) {
     // setup graphics
@@ -60,28 +74,28 @@ int main(int argc, char *argv[]) {
     value.mutable_primitive()->set_int_64(1);
     value.mutable_data_type()->set_primitive(
         bento::protos::Type_Primitive_INT64);
-    tex1.setValue("texture", value);
+    tex1.setValue(ics::component::Texture2DComponent::TEXTURE, value);
 
     auto tex2 = ics::component::Texture2DComponent();
     value = bento::protos::Value();
     value.mutable_primitive()->set_int_64(2);
     value.mutable_data_type()->set_primitive(
         bento::protos::Type_Primitive_INT64);
-    tex2.setValue("texture", value);
+    tex2.setValue(ics::component::Texture2DComponent::TEXTURE, value);
 
     auto tex3 = ics::component::Texture2DComponent();
     value = bento::protos::Value();
     value.mutable_primitive()->set_int_64(3);
     value.mutable_data_type()->set_primitive(
         bento::protos::Type_Primitive_INT64);
-    tex3.setValue("texture", value);
+    tex3.setValue(ics::component::Texture2DComponent::TEXTURE, value);
 
     auto tex4 = ics::component::Texture2DComponent();
     value = bento::protos::Value();
     value.mutable_primitive()->set_int_64(4);
     value.mutable_data_type()->set_primitive(
         bento::protos::Type_Primitive_INT64);
-    tex4.setValue("texture", value);
+    tex4.setValue(ics::component::Texture2DComponent::TEXTURE, value);
 
     ics::addComponent(indexStore, componentStore, tex1);
     ics::addComponent(indexStore, componentStore, tex2);
@@ -95,12 +109,34 @@ int main(int argc, char *argv[]) {
     string host = getEnv("BENTOBOX_SIM_HOST", "localhost");
     int port = std::stoi(getEnv("BENTOBOX_SIM_PORT", "54242"));
 
-    EngineServiceImpl engineService;
+    // the thread running a step evaluates outputs too, so leave it a core
+    auto cores = std::max(std::thread::hardware_concurrency(), 1u);
+    int evalThreads =
+        std::stoi(getEnv("BENTOBOX_SIM_EVAL_THREADS", to_string(cores - 1)));
+    if (evalThreads < 0) {
+        throw invalid_argument(
+            "BENTOBOX_SIM_EVAL_THREADS must not be negative");
+    }
+    service::EngineOptions options;
+    options.evalThreads = evalThreads;
+    options.recordingsDir = getEnv("BENTOBOX_SIM_RECORDINGS_DIR", "");
+    options.tracesDir = getEnv("BENTOBOX_SIM_TRACES_DIR", "");
+
+    EngineServiceImpl engineService(options);
     list<Service *> services = {&engineService};
     GRPCServer server(host, port, services);
 
     std::cout << "bentobox-sim listening on " << server.address() << std::endl;
 
+    // serve metrics on the same host, on a separate port
+    int metricsPort = std::stoi(getEnv("BENTOBOX_SIM_METRICS_PORT", "54250"));
+    MetricsServer metricsServer(
+        host, metricsPort,
+        [&engineService]() { return engineService.renderMetrics(); });
+
+    std::cout << "bentobox-sim serving metrics on " << metricsServer.address()
+              << "/metrics" << std::endl;
+
     // run engine main loop
     while (!windowContext.shouldClose()) {
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
@@ -0,0 +1,39 @@
+#include <memory/allocationCounter.h>
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+// Constant initialized, so that allocations can be counted before the
+// thread's other thread locals have been constructed
+thread_local uint64_t allocationCount = 0;
+thread_local uint64_t allocatedBytes = 0;
+}  // namespace
+
+namespace memory {
+AllocationCount getThreadAllocations() {
+    return {allocationCount, allocatedBytes};
+}
+}  // namespace memory
+
+// The other forms of operator new, except the aligned ones, allocate through
+// this one, and the default operator delete frees with std::free
+void* operator new(std::size_t size) {
+    allocationCount++;
+    allocatedBytes += size;
+    // malloc(0) may return null, which operator new must not do
+    while (true) {
+        if (auto ptr = std::malloc(size == 0 ? 1 : size)) {
+            return ptr;
+        }
+        auto handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+#include <memory/allocationCounter.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#define TEST_SUITE AllocationCounter
+
+using namespace memory;
+
+// Keeps the compiler from eliding the allocations
+static void* volatile sink;
+
+TEST(TEST_SUITE, CountsAllocations) {
+    auto before = getThreadAllocations();
+    auto ptr = std::make_unique<int[]>(100);
+    std::vector<char> vec(1000);
+    sink = ptr.get();
+    sink = vec.data();
+    auto count = getThreadAllocations() - before;
+
+    ASSERT_EQ(count.allocations, 2);
+    ASSERT_EQ(count.bytes, 100 * sizeof(int) + 1000);
+}
+
+TEST(TEST_SUITE, CountsPerThread) {
+    auto before = getThreadAllocations();
+    std::thread thread([]() {
+        for (int i = 0; i < 10; i++) {
+            sink = std::make_unique<int>(i).get();
+        }
+    });
+    thread.join();
+    auto count = getThreadAllocations() - before;
+
+    // Only starting the thread allocates on this thread
+    ASSERT_LT(count.allocations, 10);
+}
@@ -0,0 +1,167 @@
+/*
+ * bentobox-sim
+ * Metrics HTTP Server
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "network/metricsServer.h"
+
+using std::runtime_error;
+using std::string;
+using std::to_string;
+
+namespace {
+// How often the server checks whether it has been shut down
+const int POLL_TIMEOUT_MS = 100;
+// Time that a client has to send its request
+const int RECEIVE_TIMEOUT_S = 1;
+// Requests for the metrics are short, so longer requests are cut off
+const size_t MAX_REQUEST_SIZE = 8192;
+
+void sendAll(int fd, const string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        auto n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return;
+        }
+        sent += n;
+    }
+}
+
+string formatResponse(const char* status, const string& body) {
+    std::ostringstream response;
+    response << "HTTP/1.1 " << status << "\r\n"
+             << "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n\r\n"
+             << body;
+    return response.str();
+}
+}  // namespace
+
+namespace network {
+MetricsServer::MetricsServer(const string host, const int port,
+                             std::function<string()> render)
+    : render(std::move(render)) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* addrs = nullptr;
+    if (getaddrinfo(host.c_str(), to_string(port).c_str(), &hints, &addrs) !=
+        0) {
+        throw runtime_error("Could not resolve metrics server host: " + host);
+    }
+
+    // Listen on the first address that can be bound
+    for (auto addr = addrs; addr != nullptr; addr = addr->ai_next) {
+        listenFd =
+            socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+        if (listenFd < 0) {
+            continue;
+        }
+        int reuse = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        if (bind(listenFd, addr->ai_addr, addr->ai_addrlen) == 0 &&
+            listen(listenFd, SOMAXCONN) == 0) {
+            break;
+        }
+        close(listenFd);
+        listenFd = -1;
+    }
+    freeaddrinfo(addrs);
+    if (listenFd < 0) {
+        throw runtime_error("Could not start metrics server on " + host + ":" +
+                            to_string(port) + ": " + std::strerror(errno));
+    }
+
+    // Find the port that was chosen if none was given
+    sockaddr_storage boundAddr{};
+    socklen_t boundAddrLen = sizeof(boundAddr);
+    getsockname(listenFd, reinterpret_cast<sockaddr*>(&boundAddr),
+                &boundAddrLen);
+    char portStr[NI_MAXSERV];
+    getnameinfo(reinterpret_cast<sockaddr*>(&boundAddr), boundAddrLen,
+                nullptr, 0, portStr, sizeof(portStr), NI_NUMERICSERV);
+    port_ = std::stoi(portStr);
+    host_ = host;
+    address_ = host + ":" + to_string(port_);
+
+    thread = std::jthread(
+        [this](std::stop_token stopToken) { this->serve(stopToken); });
+}
+
+void MetricsServer::shutdown() {
+    if (thread.joinable()) {
+        thread.request_stop();
+        thread.join();
+    }
+    if (listenFd >= 0) {
+        close(listenFd);
+        listenFd = -1;
+    }
+}
+
+void MetricsServer::serve(std::stop_token stopToken) {
+    while (!stopToken.stop_requested()) {
+        pollfd pollFd{listenFd, POLLIN, 0};
+        if (poll(&pollFd, 1, POLL_TIMEOUT_MS) <= 0) {
+            continue;
+        }
+        int connFd = accept(listenFd, nullptr, nullptr);
+        if (connFd < 0) {
+            continue;
+        }
+        handleConnection(connFd);
+        close(connFd);
+    }
+}
+
+void MetricsServer::handleConnection(int connFd) {
+    timeval timeout{RECEIVE_TIMEOUT_S, 0};
+    setsockopt(connFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    // Read until the end of the request's headers. Requests for the metrics
+    // have no body.
+    string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == string::npos &&
+           request.size() < MAX_REQUEST_SIZE) {
+        auto n = recv(connFd, buffer, sizeof(buffer), 0);
+        if (n <= 0) {
+            return;
+        }
+        request.append(buffer, n);
+    }
+
+    // Only the request line is needed, e.g. "GET /metrics HTTP/1.1"
+    std::istringstream requestLine(request.substr(0, request.find("\r\n")));
+    string method, target;
+    requestLine >> method >> target;
+    if (method != "GET") {
+        sendAll(connFd, formatResponse("405 Method Not Allowed", ""));
+        return;
+    }
+    if (target != "/metrics") {
+        sendAll(connFd, formatResponse("404 Not Found", ""));
+        return;
+    }
+
+    try {
+        sendAll(connFd, formatResponse("200 OK", render()));
+    } catch (const std::exception& e) {
+        sendAll(connFd,
+                formatResponse("500 Internal Server Error", e.what()));
+    }
+}
+}  // namespace network
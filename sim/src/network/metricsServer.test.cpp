@@ -0,0 +1,83 @@
+/*
+ * bentobox-sim
+ * Metrics HTTP Server tests
+ */
+
+#include <gtest/gtest.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "network/metricsServer.h"
+
+#define TEST_SUITE MetricsServer
+
+using network::MetricsServer;
+using std::string;
+using std::to_string;
+
+namespace {
+// Sends the request to the server and returns the whole response
+string request(const MetricsServer& server, const string& request) {
+    addrinfo hints{};
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addrs = nullptr;
+    if (getaddrinfo("localhost", to_string(server.port()).c_str(), &hints,
+                    &addrs) != 0) {
+        throw std::runtime_error("Could not resolve localhost");
+    }
+    int fd = -1;
+    for (auto addr = addrs; addr != nullptr && fd < 0; addr = addr->ai_next) {
+        fd = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+        if (fd >= 0 && connect(fd, addr->ai_addr, addr->ai_addrlen) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addrs);
+    if (fd < 0) {
+        throw std::runtime_error("Could not connect to the metrics server");
+    }
+
+    send(fd, request.data(), request.size(), 0);
+    // The server closes the connection after responding
+    string response;
+    char buffer[1024];
+    ssize_t n;
+    while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        response.append(buffer, n);
+    }
+    close(fd);
+    return response;
+}
+}  // namespace
+
+TEST(TEST_SUITE, ServeMetrics) {
+    int renderCount = 0;
+    MetricsServer server("localhost", 0, [&renderCount]() {
+        renderCount++;
+        return string("bentobox_simulations 1\n");
+    });
+    ASSERT_GT(server.port(), 0);
+    ASSERT_EQ(server.address(), "localhost:" + to_string(server.port()));
+
+    auto response =
+        request(server, "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    ASSERT_EQ(response.rfind("HTTP/1.1 200 OK\r\n", 0), 0);
+    ASSERT_NE(response.find("Content-Length: 23\r\n"), string::npos);
+    ASSERT_NE(response.find("\r\n\r\nbentobox_simulations 1\n"), string::npos);
+    ASSERT_EQ(renderCount, 1);
+
+    response = request(server, "GET / HTTP/1.1\r\n\r\n");
+    ASSERT_EQ(response.rfind("HTTP/1.1 404 Not Found\r\n", 0), 0);
+    response = request(server, "POST /metrics HTTP/1.1\r\n\r\n");
+    ASSERT_EQ(response.rfind("HTTP/1.1 405 Method Not Allowed\r\n", 0), 0);
+    ASSERT_EQ(renderCount, 1);
+}
+
+TEST(TEST_SUITE, Shutdown) {
+    MetricsServer server("localhost", 0, []() { return string(); });
+    server.shutdown();
+    // Shutting down again does nothing
+    server.shutdown();
+}
@@ -149,10 +149,8 @@ bool valHasCorrectDataType(const bento::protos::Value& val) {
     bool result;
     runFnWithValType<proto_ANY>(
         val.data_type(), [&val, &result]<class X>(X* _) {
-            runFnWithVal<proto_ANY>(val, [&result]<class Y>(Y y) {
+            visitVal<proto_ANY>(val, [&result]<class Y>(Y y) {
                 result = std::is_same_v<X, Y>;
-                // Return something random since it is required
-                return 3;
             });
         });
 
@@ -0,0 +1,111 @@
+#include <recorder/mappedFile.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace recorder {
+namespace {
+std::runtime_error fileError(const std::string& message,
+                             const std::string& path, int error) {
+    return std::runtime_error(message + " " + path + ": " +
+                              std::strerror(error));
+}
+}  // namespace
+
+MappedFile::MappedFile(std::string path) : path(std::move(path)) {
+    fd = open(this->path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw fileError("Could not create", this->path, errno);
+    }
+    try {
+        grow(INITIAL_CAPACITY);
+    } catch (...) {
+        ::close(fd);
+        fd = -1;
+        throw;
+    }
+}
+
+MappedFile::~MappedFile() {
+    try {
+        close();
+    } catch (const std::exception&) {
+        // The file may be left longer than the bytes appended to it
+    }
+}
+
+void MappedFile::grow(size_t minCapacity) {
+    auto newCapacity = std::max(capacity * 2, minCapacity);
+    // Allocate the blocks up front, as writing to a mapped page that the
+    // disk has no space for would crash the engine instead of failing here
+    auto error = posix_fallocate(fd, 0, newCapacity);
+    if (error != 0) {
+        throw fileError("Could not grow", path, error);
+    }
+
+    if (data != nullptr) {
+        munmap(data, capacity);
+        data = nullptr;
+    }
+    auto mapped =
+        mmap(nullptr, newCapacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        capacity = 0;
+        throw fileError("Could not map", path, errno);
+    }
+    data = static_cast<char*>(mapped);
+    capacity = newCapacity;
+}
+
+size_t MappedFile::append(const void* bytes, size_t count) {
+    if (fd < 0) {
+        throw std::logic_error("Cannot append to a closed file: " + path);
+    }
+    if (size + count > capacity) {
+        grow(size + count);
+    }
+    auto offset = size;
+    std::memcpy(data + offset, bytes, count);
+    size += count;
+    return offset;
+}
+
+void MappedFile::pad(size_t alignment) {
+    static const char zeros[64] = {};
+    auto padding = (alignment - size % alignment) % alignment;
+    while (padding > 0) {
+        auto count = std::min(padding, sizeof(zeros));
+        append(zeros, count);
+        padding -= count;
+    }
+}
+
+void MappedFile::flush() {
+    if (data != nullptr) {
+        msync(data, size, MS_ASYNC);
+    }
+}
+
+void MappedFile::close() {
+    if (fd < 0) {
+        return;
+    }
+    if (data != nullptr) {
+        msync(data, size, MS_SYNC);
+        munmap(data, capacity);
+        data = nullptr;
+    }
+    auto truncateError = ftruncate(fd, size) != 0 ? errno : 0;
+    ::close(fd);
+    fd = -1;
+    if (truncateError != 0) {
+        throw fileError("Could not truncate", path, truncateError);
+    }
+}
+
+}  // namespace recorder
@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include <recorder/mappedFile.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#define TEST_SUITE MappedFile
+
+using namespace recorder;
+
+namespace {
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in),
+                       std::istreambuf_iterator<char>());
+}
+}  // namespace
+
+TEST(TEST_SUITE, AppendsAndCutsFileOnClose) {
+    auto path = testing::TempDir() + "mappedFile.bin";
+    MappedFile file(path);
+    ASSERT_EQ(file.append("abc", 3), 0);
+    file.pad(8);
+    ASSERT_EQ(file.append("de", 2), 8);
+    ASSERT_EQ(file.getSize(), 10);
+    file.close();
+    ASSERT_TRUE(file.isClosed());
+
+    ASSERT_EQ(readFile(path), std::string("abc\0\0\0\0\0de", 10));
+}
+
+TEST(TEST_SUITE, GrowsPastInitialCapacity) {
+    auto path = testing::TempDir() + "mappedFileGrow.bin";
+    std::vector<char> block(1 << 16, 'x');
+    {
+        MappedFile file(path);
+        for (int i = 0; i < 40; i++) {
+            block[0] = static_cast<char>(i);
+            ASSERT_EQ(file.append(block.data(), block.size()),
+                      i * block.size());
+        }
+        // Closed on destruction
+    }
+
+    auto contents = readFile(path);
+    ASSERT_EQ(contents.size(), 40 * block.size());
+    ASSERT_EQ(contents[39 * block.size()], 39);
+    ASSERT_EQ(contents.back(), 'x');
+}
+
+TEST(TEST_SUITE, ThrowsIfFileCannotBeCreated) {
+    ASSERT_THROW(MappedFile("/nonexistent/directory/file.bin"),
+                 std::runtime_error);
+}
@@ -0,0 +1,235 @@
+#include <recorder/trajectoryRecorder.h>
+#include <ics.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+namespace recorder {
+namespace {
+// Values are written in the engine's byte order, which the format fixes
+static_assert(std::endian::native == std::endian::little,
+              "Trajectories are recorded in little endian byte order");
+
+const char HEADER_MAGIC[8] = {'B', 'B', 'T', 'R', 'A', 'J', '0', '1'};
+const char TRAILER_MAGIC[8] = {'B', 'B', 'T', 'R', 'E', 'N', 'D', '\0'};
+const size_t ALIGNMENT = 8;
+
+template <class T>
+void put(std::vector<char>& out, T value) {
+    auto offset = out.size();
+    out.resize(offset + sizeof(T));
+    std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+void pad(std::vector<char>& out) {
+    out.resize((out.size() + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT);
+}
+
+void putValue(std::vector<char>& out, bento::protos::Type::Primitive type,
+              const bento::protos::Value& value) {
+    typedef bento::protos::Type Type;
+    const auto& primitive = value.primitive();
+    switch (type) {
+        case Type::BYTE:
+            put<int8_t>(out, primitive.int_8());
+            break;
+        case Type::INT32:
+            put<int32_t>(out, primitive.int_32());
+            break;
+        case Type::INT64:
+            put<int64_t>(out, primitive.int_64());
+            break;
+        case Type::FLOAT32:
+            put<float>(out, primitive.float_32());
+            break;
+        case Type::FLOAT64:
+            put<double>(out, primitive.float_64());
+            break;
+        case Type::BOOL:
+            put<uint8_t>(out, primitive.boolean());
+            break;
+        default:
+            throw std::logic_error("Cannot record values of this type");
+    }
+}
+
+bool isRecordable(const bento::protos::Type& type) {
+    typedef bento::protos::Type Type;
+    if (type.kind_case() != Type::kPrimitive) {
+        return false;
+    }
+    switch (type.primitive()) {
+        case Type::BYTE:
+        case Type::INT32:
+        case Type::INT64:
+        case Type::FLOAT32:
+        case Type::FLOAT64:
+        case Type::BOOL:
+            return true;
+        default:
+            return false;
+    }
+}
+}  // namespace
+
+TrajectoryRecorder::TrajectoryRecorder(
+    const std::string& path, const ics::index::IndexStore& indexStore,
+    const google::protobuf::RepeatedPtrField<bento::protos::AttributeRef>&
+        attributes,
+    uint32_t indexInterval)
+    : file(path), indexInterval(std::max<uint32_t>(indexInterval, 1)) {
+    const auto& compTypeIndex = indexStore.componentType;
+    for (const auto& ref : attributes) {
+        if (!compTypeIndex.hasComponentType(ref.component()) ||
+            !indexStore.attribute.hasLayout(
+                compTypeIndex.getComponentType(ref.component()))) {
+            throw std::invalid_argument("Unknown component type: " +
+                                        ref.component());
+        }
+        auto group = compTypeIndex.getComponentType(ref.component());
+        const auto& layout = indexStore.attribute.getLayout(group);
+        if (!layout.hasAttr(ref.attribute())) {
+            throw std::invalid_argument("Unknown attribute: " +
+                                        ref.component() + "." +
+                                        ref.attribute());
+        }
+        auto attrId = layout.getAttrId(ref.attribute());
+        const auto& type = layout.getAttrType(attrId);
+        if (!isRecordable(type)) {
+            throw std::invalid_argument(
+                "Only attributes of a numeric or bool primitive type can be "
+                "recorded: " +
+                ref.component() + "." + ref.attribute());
+        }
+
+        columns.push_back({type.primitive(), ref.entity_id(), ref.component(),
+                           ref.attribute(), group, attrId});
+    }
+    stepOffsets.reserve(this->indexInterval);
+    writeHeader();
+}
+
+TrajectoryRecorder::~TrajectoryRecorder() {
+    try {
+        close();
+    } catch (const std::exception&) {
+        // The recording can still be read without its trailer
+    }
+}
+
+void TrajectoryRecorder::writeHeader() {
+    scratch.clear();
+    scratch.insert(scratch.end(), HEADER_MAGIC,
+                   HEADER_MAGIC + sizeof(HEADER_MAGIC));
+    put<uint32_t>(scratch, VERSION);
+    put<uint32_t>(scratch, columns.size());
+    put<uint32_t>(scratch, indexInterval);
+    put<uint32_t>(scratch, 0);
+    for (const auto& column : columns) {
+        put<uint32_t>(scratch, column.type);
+        put<uint32_t>(scratch, column.entityId);
+        put<uint32_t>(scratch, column.component.size());
+        put<uint32_t>(scratch, column.attribute.size());
+        scratch.insert(scratch.end(), column.component.begin(),
+                       column.component.end());
+        scratch.insert(scratch.end(), column.attribute.begin(),
+                       column.attribute.end());
+        pad(scratch);
+    }
+    file.append(scratch.data(), scratch.size());
+}
+
+void TrajectoryRecorder::writeFooter() {
+    scratch.clear();
+    put<uint32_t>(scratch, INDEX_MAGIC);
+    put<uint32_t>(scratch, stepOffsets.size());
+    put<uint64_t>(scratch, lastFooterOffset);
+    for (auto offset : stepOffsets) {
+        put<uint64_t>(scratch, offset);
+    }
+    lastFooterOffset = file.append(scratch.data(), scratch.size());
+    stepOffsets.clear();
+    // Let the OS write the recording back in the background, so that closing
+    // the recording does not have to write it all at once
+    file.flush();
+}
+
+void TrajectoryRecorder::recordColumn(ics::index::IndexStore& indexStore,
+                                      ics::ComponentStore& compStore,
+                                      const Column& column) {
+    typedef ics::index::AttributeIndex::AttrRefIds AttrRefIds;
+    auto countOffset = scratch.size();
+    put<uint32_t>(scratch, 0);
+    put<uint32_t>(scratch, 0);
+
+    uint32_t count = 0;
+    if (column.entityId != 0) {
+        // The entity may have been despawned, may not have the component, or
+        // may not have set the attribute
+        auto value = ics::findAttribute(
+            indexStore, compStore,
+            AttrRefIds{column.group, column.entityId, column.attrId});
+        if (value != nullptr && value->has_primitive()) {
+            putValue(scratch, column.type, *value);
+            count = 1;
+        }
+    } else {
+        const auto& entityIds =
+            ics::queryEntities(indexStore, {column.group});
+        count = entityIds.size();
+        for (auto entityId : entityIds) {
+            put<uint32_t>(scratch, entityId);
+        }
+        pad(scratch);
+        for (auto entityId : entityIds) {
+            auto value = ics::findAttribute(
+                indexStore, compStore,
+                AttrRefIds{column.group, entityId, column.attrId});
+            // Attributes which have not been set are recorded as zero, to
+            // keep the values in line with the IDs
+            putValue(scratch, column.type,
+                     value != nullptr && value->has_primitive()
+                         ? *value
+                         : bento::protos::Value::default_instance());
+        }
+    }
+    pad(scratch);
+    std::memcpy(scratch.data() + countOffset, &count, sizeof(count));
+}
+
+void TrajectoryRecorder::record(ics::index::IndexStore& indexStore,
+                                ics::ComponentStore& compStore,
+                                uint64_t step) {
+    scratch.clear();
+    put<uint32_t>(scratch, STEP_MAGIC);
+    put<uint32_t>(scratch, columns.size());
+    put<uint64_t>(scratch, step);
+    for (const auto& column : columns) {
+        recordColumn(indexStore, compStore, column);
+    }
+
+    stepOffsets.push_back(file.append(scratch.data(), scratch.size()));
+    stepCount++;
+    if (stepOffsets.size() >= indexInterval) {
+        writeFooter();
+    }
+}
+
+void TrajectoryRecorder::close() {
+    if (file.isClosed()) {
+        return;
+    }
+    if (!stepOffsets.empty() || lastFooterOffset == NO_OFFSET) {
+        writeFooter();
+    }
+    scratch.clear();
+    put<uint64_t>(scratch, lastFooterOffset);
+    scratch.insert(scratch.end(), TRAILER_MAGIC,
+                   TRAILER_MAGIC + sizeof(TRAILER_MAGIC));
+    file.append(scratch.data(), scratch.size());
+    file.close();
+}
+
+}  // namespace recorder
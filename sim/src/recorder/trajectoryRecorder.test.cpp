@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <recorder/trajectoryRecorder.h>
+#include <simulation.h>
+#include <test_simulation.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#define TEST_SUITE TrajectoryRecorder
+
+using namespace recorder;
+
+namespace {
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in),
+                       std::istreambuf_iterator<char>());
+}
+
+template <class T>
+T read(const std::string& contents, size_t offset) {
+    T value;
+    std::memcpy(&value, contents.data() + offset, sizeof(T));
+    return value;
+}
+
+google::protobuf::RepeatedPtrField<bento::protos::AttributeRef> attrRefs(
+    std::initializer_list<bento::protos::AttributeRef> refs) {
+    google::protobuf::RepeatedPtrField<bento::protos::AttributeRef> fields;
+    for (const auto& ref : refs) {
+        fields.Add()->CopyFrom(ref);
+    }
+    return fields;
+}
+
+void setHeight(Simulation& sim, int64_t height) {
+    bento::protos::Value value;
+    value.mutable_primitive()->set_int_64(height);
+    value.mutable_data_type()->set_primitive(
+        bento::protos::Type_Primitive_INT64);
+    ics::setAttribute(sim.indexStore, sim.compStore,
+                      interpreter::createAttrRef(
+                          test_simulation::TEST_COMPONENT_NAME, 1, "height"),
+                      value);
+}
+}  // namespace
+
+TEST(TEST_SUITE, RecordsColumnsOfSteps) {
+    auto testSim = test_simulation::TestSimulation();
+    Simulation sim(testSim.simDef);
+    auto path = testing::TempDir() + "trajectory.bin";
+    // One column of an entity, and one of every entity with the component
+    auto refs = attrRefs(
+        {interpreter::createAttrRef(test_simulation::TEST_COMPONENT_NAME, 1,
+                                    "height"),
+         interpreter::createAttrRef(test_simulation::TEST_COMPONENT_NAME, 0,
+                                    "height")});
+    TrajectoryRecorder recorder(path, sim.indexStore, refs, 2);
+    for (int64_t step = 0; step < 3; step++) {
+        setHeight(sim, 10 + step);
+        recorder.record(sim.indexStore, sim.compStore, step);
+    }
+    recorder.close();
+    ASSERT_EQ(recorder.getStepCount(), 3);
+
+    auto contents = readFile(path);
+    ASSERT_EQ(contents.size(), recorder.getSize());
+    ASSERT_EQ(contents.substr(0, 8), "BBTRAJ01");
+    ASSERT_EQ(read<uint32_t>(contents, 8), TrajectoryRecorder::VERSION);
+    ASSERT_EQ(read<uint32_t>(contents, 12), 2);
+    ASSERT_EQ(read<uint32_t>(contents, 16), 2);
+
+    // Follow the trailer to the last footer, which indexes the last step
+    ASSERT_EQ(contents.substr(contents.size() - 8),
+              std::string("BBTREND\0", 8));
+    auto footer = read<uint64_t>(contents, contents.size() - 16);
+    ASSERT_EQ(read<uint32_t>(contents, footer),
+              TrajectoryRecorder::INDEX_MAGIC);
+    ASSERT_EQ(read<uint32_t>(contents, footer + 4), 1);
+    auto previousFooter = read<uint64_t>(contents, footer + 8);
+    ASSERT_EQ(read<uint32_t>(contents, previousFooter + 4), 2);
+    ASSERT_EQ(read<uint64_t>(contents, previousFooter + 8),
+              TrajectoryRecorder::NO_OFFSET);
+
+    auto step = read<uint64_t>(contents, footer + 16);
+    ASSERT_EQ(step % 8, 0);
+    ASSERT_EQ(read<uint32_t>(contents, step), TrajectoryRecorder::STEP_MAGIC);
+    ASSERT_EQ(read<uint32_t>(contents, step + 4), 2);
+    ASSERT_EQ(read<uint64_t>(contents, step + 8), 2);
+    // Column of entity 1: count, reserved, then the value
+    ASSERT_EQ(read<uint32_t>(contents, step + 16), 1);
+    ASSERT_EQ(read<int64_t>(contents, step + 24), 12);
+    // Column of every entity: count, reserved, the padded IDs, the values
+    ASSERT_EQ(read<uint32_t>(contents, step + 32), 1);
+    ASSERT_EQ(read<uint32_t>(contents, step + 40), 1);
+    ASSERT_EQ(read<int64_t>(contents, step + 48), 12);
+}
+
+TEST(TEST_SUITE, LeavesOutMissingEntities) {
+    auto testSim = test_simulation::TestSimulation();
+    Simulation sim(testSim.simDef);
+    auto path = testing::TempDir() + "trajectoryMissing.bin";
+    auto refs = attrRefs({interpreter::createAttrRef(
+        test_simulation::TEST_COMPONENT_NAME, 42, "height")});
+    TrajectoryRecorder recorder(path, sim.indexStore, refs);
+    recorder.record(sim.indexStore, sim.compStore, 0);
+    recorder.close();
+
+    auto contents = readFile(path);
+    auto footer = read<uint64_t>(contents, contents.size() - 16);
+    auto step = read<uint64_t>(contents, footer + 16);
+    ASSERT_EQ(read<uint32_t>(contents, step + 16), 0);
+}
+
+TEST(TEST_SUITE, RecordsUnsetAttributesAsZero) {
+    auto testSim = test_simulation::TestSimulation();
+    Simulation sim(testSim.simDef);
+    auto path = testing::TempDir() + "trajectoryUnset.bin";
+    // The width of the entity is never set
+    auto refs = attrRefs({interpreter::createAttrRef(
+        test_simulation::TEST_COMPONENT_NAME, 0, "width")});
+    TrajectoryRecorder recorder(path, sim.indexStore, refs);
+    recorder.record(sim.indexStore, sim.compStore, 0);
+    recorder.close();
+
+    auto contents = readFile(path);
+    auto footer = read<uint64_t>(contents, contents.size() - 16);
+    auto step = read<uint64_t>(contents, footer + 16);
+    ASSERT_EQ(read<uint32_t>(contents, step + 16), 1);
+    ASSERT_EQ(read<uint32_t>(contents, step + 24), 1);
+    ASSERT_EQ(read<int64_t>(contents, step + 32), 0);
+}
+
+TEST(TEST_SUITE, ThrowsOnInvalidAttributes) {
+    auto testSim = test_simulation::TestSimulation();
+    Simulation sim(testSim.simDef);
+    auto path = testing::TempDir() + "trajectoryInvalid.bin";
+    auto unknownComp =
+        attrRefs({interpreter::createAttrRef("Unknown", 1, "height")});
+    ASSERT_THROW(TrajectoryRecorder(path, sim.indexStore, unknownComp),
+                 std::invalid_argument);
+    auto unknownAttr = attrRefs({interpreter::createAttrRef(
+        test_simulation::TEST_COMPONENT_NAME, 1, "depth")});
+    ASSERT_THROW(TrajectoryRecorder(path, sim.indexStore, unknownAttr),
+                 std::invalid_argument);
+}
@@ -0,0 +1,117 @@
+#include <benchmark/benchmark.h>
+#include <service/engineService.h>
+
+#include <generator/simGenerator.h>
+#include <interpreter/util.h>
+#include <test_simulation.h>
+
+#include <stdexcept>
+
+using namespace bento::protos;
+
+using test_simulation::TEST_COMPONENT_NAME;
+
+namespace {
+const char SIM_NAME[] = "Bench Simulation";
+
+// Creates a simulation with the given number of entities, with a system that
+// increments the width of every entity. The init graph sets the widths to 0.
+SimulationDef createWorld(int64_t entityCount) {
+    SimulationDef simDef;
+    simDef.set_name(SIM_NAME);
+    *simDef.add_components() = test_simulation::TestComponent().getCompDef();
+
+    auto& initGraph = *simDef.mutable_init_graph();
+    auto& graph = *simDef.add_systems()->mutable_graph();
+    for (int64_t i = 0; i < entityCount; i++) {
+        auto entityId = i + 1;
+        auto& entityDef = *simDef.add_entities();
+        entityDef.set_id(entityId);
+        entityDef.add_components(TEST_COMPONENT_NAME);
+
+        auto widthRef =
+            interpreter::createAttrRef(TEST_COMPONENT_NAME, entityId, "width");
+        auto& initOutput = *initGraph.add_outputs();
+        *initOutput.mutable_mutate_attr() = widthRef;
+        auto& zeroVal = *initOutput.mutable_to_node()
+                             ->mutable_const_op()
+                             ->mutable_held_value();
+        zeroVal.mutable_primitive()->set_int_64(0);
+        zeroVal.mutable_data_type()->set_primitive(Type_Primitive_INT64);
+
+        // width = width + 1
+        auto& output = *graph.add_outputs();
+        *output.mutable_mutate_attr() = widthRef;
+        auto& addOp = *output.mutable_to_node()->mutable_add_op();
+        *addOp.mutable_x()->mutable_retrieve_op()->mutable_retrieve_attr() =
+            widthRef;
+        auto& oneVal =
+            *addOp.mutable_y()->mutable_const_op()->mutable_held_value();
+        oneVal.mutable_primitive()->set_int_64(1);
+        oneVal.mutable_data_type()->set_primitive(Type_Primitive_INT64);
+    }
+    return simDef;
+}
+
+// Steps the simulation end to end, calling the service without going through
+// the network
+void stepSimulation(benchmark::State& state, const SimulationDef& simDef) {
+    service::EngineServiceImpl engineSvc;
+    ApplySimulationReq applyReq;
+    ApplySimulationResp applyResp;
+    *applyReq.mutable_simulation() = simDef;
+    auto status = engineSvc.ApplySimulation(nullptr, &applyReq, &applyResp);
+    if (!status.ok()) {
+        throw std::runtime_error(status.error_message());
+    }
+
+    StepSimulationReq stepReq;
+    StepSimulationResp stepResp;
+    stepReq.set_name(simDef.name());
+    for (auto _ : state) {
+        status = engineSvc.StepSimulation(nullptr, &stepReq, &stepResp);
+        if (!status.ok()) {
+            state.SkipWithError(status.error_message().c_str());
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * simDef.entities_size());
+}
+}  // namespace
+
+static void BM_StepSimulation(benchmark::State& state) {
+    stepSimulation(state, createWorld(state.range(0)));
+}
+BENCHMARK(BM_StepSimulation)
+    ->RangeMultiplier(10)
+    ->Range(100, 1000000)
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_StepNBody(benchmark::State& state) {
+    generator::NBodyConfig config;
+    config.entityCount = state.range(0);
+    stepSimulation(state, generator::generateNBody(config));
+}
+BENCHMARK(BM_StepNBody)
+    ->RangeMultiplier(10)
+    ->Range(100, 10000)
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_StepFlocking(benchmark::State& state) {
+    generator::FlockingConfig config;
+    config.entityCount = state.range(0);
+    stepSimulation(state, generator::generateFlocking(config));
+}
+BENCHMARK(BM_StepFlocking)
+    ->RangeMultiplier(10)
+    ->Range(100, 10000)
+    ->Unit(benchmark::kMillisecond);
+
+// Op trees of increasing depth on 1000 entities
+static void BM_StepOpTree(benchmark::State& state) {
+    generator::OpTreeConfig config;
+    config.entityCount = 1000;
+    config.depth = state.range(0);
+    stepSimulation(state, generator::generateOpTree(config));
+}
+BENCHMARK(BM_StepOpTree)->DenseRange(0, 8, 2)->Unit(benchmark::kMillisecond);
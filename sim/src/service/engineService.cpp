@@ -5,7 +5,12 @@
 
 #include "git.h"
 #include "service/engineService.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <sstream>
+#include <unordered_set>
 #include <interpreter/graphInterpreter.h>
 #include <interpreter/operations.h>
 
@@ -21,9 +26,150 @@ std::string formatError(const std::string& message, const std::exception& e) {
     return err.str();
 }
 
+/**
+ * Resolve a file name given by a client against a directory set on the
+ * engine. Throw std::invalid_argument if the name could point outside of the
+ * directory.
+ **/
+std::filesystem::path resolveInDir(const std::string& dir,
+                                   const std::string& name) {
+    std::filesystem::path path(name);
+    if (name.empty() || path.has_root_path()) {
+        throw std::invalid_argument("The file name must be a relative path.");
+    }
+    for (const auto& part : path) {
+        if (part == "..") {
+            throw std::invalid_argument(
+                "The file name must not contain \"..\".");
+        }
+    }
+    return std::filesystem::path(dir) / path;
+}
+
+EngineServiceImpl::EngineServiceImpl(EngineOptions options)
+    : recordingsDir(std::move(options.recordingsDir)),
+      tracesDir(std::move(options.tracesDir)) {
+    if (options.evalThreads > 0) {
+        evalPool =
+            std::make_unique<interpreter::ThreadPool>(options.evalThreads);
+    }
+}
+
+EngineServiceImpl::~EngineServiceImpl() {
+    std::lock_guard driversLock(driversMutex);
+    for (auto& [name, driver] : drivers) {
+        driver->stop();
+    }
+}
+
+std::string EngineServiceImpl::renderMetrics() {
+    std::vector<Metrics::SimulationGauges> simGauges;
+    {
+        std::shared_lock simsLock(simsMutex);
+        simGauges.reserve(sims.size());
+        // The counts are published by the calls which change them, so a
+        // scrape does not wait for the steps being run
+        for (const auto& [name, sim] : sims) {
+            simGauges.push_back(
+                {name,
+                 sim->publishedEntityCount.load(std::memory_order_relaxed),
+                 sim->publishedComponentCount.load(std::memory_order_relaxed)});
+        }
+    }
+
+    std::ostringstream out;
+    metrics.write(out, simGauges, evalPool ? evalPool->getQueueDepth() : 0);
+    return out.str();
+}
+
+EngineServiceImpl::SimHandle EngineServiceImpl::lockSimulation(
+    const std::string& name) {
+    Tracer::Scope span(tracer, "lock wait");
+    SimHandle handle{std::shared_lock(simsMutex)};
+    auto it = sims.find(name);
+    if (it != sims.end()) {
+        handle.simLock = std::unique_lock(it->second->mutex);
+        handle.sim = it->second.get();
+    }
+    return handle;
+}
+
+void EngineServiceImpl::publishState(Simulation& sim) {
+    auto& watchers = sim.watchers;
+    std::erase_if(watchers,
+                  [](const auto& watcher) { return watcher->isClosed(); });
+    // Changes are tracked for the watchers, and to refill the snapshots of a
+    // ticking simulation
+    auto& version = sim.indexStore.version;
+    if (watchers.empty() && !sim.ticking) {
+        if (version.isTrackingChanges()) {
+            version.trackChanges(false);
+        }
+        return;
+    }
+
+    auto changes = version.takeChanges();
+    if (sim.ticking) {
+        publishSnapshot(sim, changes);
+    }
+    if (watchers.empty()) {
+        return;
+    }
+
+    Tracer::Scope span(tracer, "publish state");
+    // Each message is built once, and only if a watcher needs it
+    std::shared_ptr<bento::protos::WatchSimulationResp> keyframe;
+    std::shared_ptr<bento::protos::WatchSimulationResp> changed;
+    for (auto& watcher : watchers) {
+        if (watcher->needsKeyframe()) {
+            if (keyframe == nullptr) {
+                keyframe =
+                    std::make_shared<bento::protos::WatchSimulationResp>();
+                keyframe->set_step(sim.random.getStep());
+                fillKeyframe(sim.indexStore, sim.compStore, *keyframe);
+            }
+            watcher->push(keyframe);
+        } else {
+            if (changed == nullptr) {
+                changed =
+                    std::make_shared<bento::protos::WatchSimulationResp>();
+                changed->set_step(sim.random.getStep());
+                fillChanges(sim.indexStore, sim.compStore, changes, *changed);
+            }
+            watcher->push(changed);
+        }
+    }
+}
+
+void EngineServiceImpl::publishSnapshot(
+    Simulation& sim, const ics::index::VersionIndex::Changes& changes) {
+    Tracer::Scope span(tracer, "publish snapshot");
+    auto& back = sim.backSnapshot;
+    auto step = sim.random.getStep();
+    // Calls which loaded the back snapshot before it was swapped out may
+    // still be reading it, in which case a new one is filled instead
+    if (back == nullptr || back.use_count() > 1) {
+        back = std::make_shared<StateSnapshot>();
+        back->update(sim.indexStore, sim.compStore, step);
+    } else {
+        back->update(sim.indexStore, sim.compStore, sim.frontChanges, step);
+        back->update(sim.indexStore, sim.compStore, changes, step);
+    }
+    sim.frontChanges = changes;
+    sim.snapshot.store(back);
+    std::swap(back, sim.frontSnapshot);
+}
+
+void EngineServiceImpl::closeWatchers(Simulation& sim) {
+    for (auto& watcher : sim.watchers) {
+        watcher->close();
+    }
+}
+
 Status EngineServiceImpl::GetVersion(
     ServerContext* context, const bento::protos::GetVersionReq* request,
     bento::protos::GetVersionResp* response) {
+    Metrics::RpcTimer rpcTimer(metrics, "GetVersion");
     response->set_commit_hash(GIT_HASH);
     return Status::OK;
 }
@@ -32,18 +178,36 @@ Status EngineServiceImpl::ApplySimulation(
     grpc::ServerContext* context,
     const bento::protos::ApplySimulationReq* request,
     bento::protos::ApplySimulationResp* response) {
+    Tracer::Scope rpcSpan(tracer, "ApplySimulation");
+    Metrics::RpcTimer rpcTimer(metrics, "ApplySimulation");
     // Overrides/Creates a new simulation
     auto name = request->simulation().name();
+    rpcSpan.addArg("sim", name);
+
+    // The simulation is replaced, so no other call may be using it
+    std::lock_guard driversLock(driversMutex);
+    std::unique_lock<std::shared_mutex> simsLock;
+    {
+        Tracer::Scope span(tracer, "lock wait");
+        simsLock = std::unique_lock(simsMutex);
+    }
+
+    if (drivers.contains(name)) {
+        return Status(grpc::ALREADY_EXISTS,
+                      "The simulation is being stepped by the engine.");
+    }
 
     if (sims.contains(name) && sims[name]->locked) {
         return Status(
             grpc::ALREADY_EXISTS,
             "The simulation has been created and stepped at least once.");
     }
+    if (sims.contains(name)) {
+        closeWatchers(*sims[name]);
+    }
 
     try {
-        sims[name] =
-            std::make_unique<Simulation>(Simulation(request->simulation()));
+        sims[name] = std::make_unique<Simulation>(request->simulation());
     } catch (const std::exception& e) {
         return Status(
             grpc::INTERNAL,
@@ -55,9 +219,23 @@ Status EngineServiceImpl::ApplySimulation(
     try {
         // If no init_graph is set, the default graph given by protobuf does
         // nothing, so no checks are needed here for the existence of init_graph
-        interpreter::runGraph(sims[name]->compStore, sims[name]->indexStore,
-                              sims[name]->simDef.init_graph());
+        auto& sim = *sims[name];
+        auto ctx =
+            interpreter::EvalContext{sim.compStore, sim.indexStore,
+                                     sim.stepArena, sim.commands, sim.random};
+        {
+            Tracer::Scope span(tracer, "runGraph");
+            span.addArg("graph", "init");
+            interpreter::runGraph(ctx, sim.simDef.init_graph());
+            metrics.addNodeEvaluations(ctx.evalCount);
+        }
+        Tracer::Scope span(tracer, "flush commands");
+        sim.commands.flush(sim.indexStore, sim.compStore);
+        sim.stepArena.Reset();
+        sim.publishCounts();
     } catch (const std::exception& e) {
+        sims[name]->stepArena.Reset();
+        sims[name]->publishCounts();
         return Status(
             grpc::INTERNAL,
             formatError("Something went wrong while running the initGraph of "
@@ -65,6 +243,7 @@ Status EngineServiceImpl::ApplySimulation(
                         e));
     }
 
+    Tracer::Scope span(tracer, "fill response");
     response->mutable_simulation()->CopyFrom(sims[name]->simDef);
 
     return Status::OK;
@@ -73,14 +252,18 @@ Status EngineServiceImpl::ApplySimulation(
 Status EngineServiceImpl::GetSimulation(
     ServerContext* context, const bento::protos::GetSimulationReq* request,
     bento::protos::GetSimulationResp* response) {
+    Tracer::Scope rpcSpan(tracer, "GetSimulation");
+    Metrics::RpcTimer rpcTimer(metrics, "GetSimulation");
+    rpcSpan.addArg("sim", request->name());
     // Return an error if there is no such simulation
-    if (!sims.contains(request->name())) {
+    auto handle = lockSimulation(request->name());
+    if (handle.sim == nullptr) {
         return Status(grpc::NOT_FOUND,
                       "Could not find simulation with that name.");
     }
 
-    auto& sim = *sims.at(request->name());
-    response->mutable_simulation()->CopyFrom(sim.simDef);
+    Tracer::Scope span(tracer, "fill response");
+    response->mutable_simulation()->CopyFrom(handle.sim->simDef);
 
     return Status::OK;
 }
@@ -88,6 +271,14 @@ Status EngineServiceImpl::GetSimulation(
 Status EngineServiceImpl::ListSimulation(
     ServerContext* context, const bento::protos::ListSimulationReq* request,
     bento::protos::ListSimulationResp* response) {
+    Tracer::Scope rpcSpan(tracer, "ListSimulation");
+    Metrics::RpcTimer rpcTimer(metrics, "ListSimulation");
+    std::shared_lock<std::shared_mutex> simsLock;
+    {
+        Tracer::Scope span(tracer, "lock wait");
+        simsLock = std::shared_lock(simsMutex);
+    }
+
     // mutable_sim_names needs to be called so that protobuf knows that it has
     // been defined, regardless of whether there are names
     auto simNames = response->mutable_sim_names();
@@ -103,24 +294,35 @@ Status EngineServiceImpl::ListSimulation(
 Status EngineServiceImpl::DropSimulation(
     ServerContext* context, const bento::protos::DropSimulationReq* request,
     bento::protos::DropSimulationResp* response) {
+    Tracer::Scope rpcSpan(tracer, "DropSimulation");
+    Metrics::RpcTimer rpcTimer(metrics, "DropSimulation");
+    rpcSpan.addArg("sim", request->name());
+    // Stop stepping the simulation before waiting for the calls using the
+    // simulation to finish, as the driver's steps hold the simulation
+    std::lock_guard driversLock(driversMutex);
+    drivers.erase(request->name());
+    std::unique_lock<std::shared_mutex> simsLock;
+    {
+        Tracer::Scope span(tracer, "lock wait");
+        simsLock = std::unique_lock(simsMutex);
+    }
+
     if (!sims.contains(request->name())) {
         return Status(grpc::NOT_FOUND,
                       "Could not find simulation with that name.");
     }
 
+    closeWatchers(*sims[request->name()]);
     sims.erase(request->name());
+    metrics.dropSimulation(request->name());
     return Status::OK;
 }
 
-Status EngineServiceImpl::StepSimulation(
-    ServerContext* context, const bento::protos::StepSimulationReq* request,
-    bento::protos::StepSimulationResp* response) {
-    if (!sims.contains(request->name())) {
-        return Status(grpc::NOT_FOUND,
-                      "Could not find simulation with that name.");
-    }
-
-    auto& sim = sims.at(request->name());
+Status EngineServiceImpl::runStep(Simulation* sim, const std::string& name,
+                                  uint64_t seed, bool profile) {
+    // The step runs on this thread, so the allocations made by this thread
+    // during the step are the step's
+    auto allocationsBefore = memory::getThreadAllocations();
 
     // TODO: Run built-in systems as well
     auto& indexStore = sim->indexStore;
@@ -132,19 +334,241 @@ Status EngineServiceImpl::StepSimulation(
         sim->locked = true;
     }
 
+    // Each step draws new random numbers
+    if (seed != 0) {
+        sim->random.setSeed(seed);
+    }
+    sim->random.nextStep();
+
+    auto ctx = interpreter::EvalContext{compStore,     indexStore,
+                                        sim->stepArena, sim->commands,
+                                        sim->random,   &sim->outputCache};
+    ctx.parallelPlan = &sim->parallelPlan;
+    ctx.threadPool = evalPool.get();
+    if (profile) {
+        ctx.profiler = &sim->profiler;
+    }
+    auto doubleBuffered =
+        simDef.step_mode() == bento::protos::SimulationDef::DOUBLE_BUFFERED;
+    if (doubleBuffered) {
+        // Skipping outputs relies on their attributes being written as they
+        // are evaluated
+        ctx.outputCache = nullptr;
+        ctx.writes = &sim->writeBuffer;
+    }
+    auto status = Status::OK;
     for (size_t i = 0; i < simDef.systems_size(); i++) {
         const auto& graph = simDef.systems(i).graph();
 
+        Tracer::Scope span(tracer, "runGraph");
+        span.addArg("system_id", simDef.systems(i).id());
         try {
-            interpreter::runGraph(compStore, indexStore, graph);
+            if (ctx.profiler == nullptr) {
+                interpreter::runGraph(ctx, graph);
+            } else {
+                typedef interpreter::Profiler::Clock Clock;
+                auto start = Clock::now();
+                interpreter::runGraph(ctx, graph);
+                ctx.profiler->addSystem(simDef.systems(i).id(),
+                                        Clock::now() - start);
+            }
         } catch (const std::exception& e) {
-            return Status(
+            status = Status(
                 grpc::INTERNAL,
                 formatError(
                     "Something went wrong while running system with ID: " +
                         std::to_string(simDef.systems(i).id()) + ".",
                     e));
+            break;
+        }
+    }
+
+    // Swap in the attributes mutated by the step. Like in immediate mode,
+    // the mutations made before a failing system are kept.
+    if (doubleBuffered) {
+        try {
+            Tracer::Scope span(tracer, "write buffer");
+            sim->writeBuffer.write(indexStore, compStore);
+        } catch (const std::exception& e) {
+            if (status.ok()) {
+                status = Status(
+                    grpc::INTERNAL,
+                    formatError("Something went wrong while writing the "
+                                "attributes mutated by the step",
+                                e));
+            }
+        }
+    }
+
+    // The step has ended, so apply the entities spawned and despawned by the
+    // systems. The changes made before a failing system are kept, like the
+    // attributes that were mutated.
+    try {
+        Tracer::Scope span(tracer, "flush commands");
+        sim->commands.flush(indexStore, compStore);
+    } catch (const std::exception& e) {
+        if (status.ok()) {
+            status = Status(
+                grpc::INTERNAL,
+                formatError("Something went wrong while spawning or "
+                            "despawning entities",
+                            e));
+        }
+    }
+
+    // Free all the temporaries created during the step at once
+    sim->stepArena.Reset();
+    sim->publishCounts();
+
+    if (sim->recorder && status.ok()) {
+        try {
+            Tracer::Scope span(tracer, "record");
+            sim->recorder->record(indexStore, compStore, sim->random.getStep());
+        } catch (const std::exception& e) {
+            // Stop recording, so that the recording is not left with gaps
+            sim->recorder.reset();
+            status = Status(
+                grpc::INTERNAL,
+                formatError("Something went wrong while recording the step, "
+                            "so recording has been stopped",
+                            e));
+        }
+    }
+
+    sim->lastStepAllocations =
+        memory::getThreadAllocations() - allocationsBefore;
+    // Outputs evaluated on the eval threads allocate on those threads
+    sim->lastStepAllocations += ctx.poolAllocations;
+    sim->totalStepAllocations += sim->lastStepAllocations;
+
+    publishState(*sim);
+    if (status.ok()) {
+        metrics.addStep(name);
+    }
+    metrics.addNodeEvaluations(ctx.evalCount);
+
+    return status;
+}
+
+Status EngineServiceImpl::StepSimulation(
+    ServerContext* context, const bento::protos::StepSimulationReq* request,
+    bento::protos::StepSimulationResp* response) {
+    Tracer::Scope rpcSpan(tracer, "StepSimulation");
+    Metrics::RpcTimer rpcTimer(metrics, "StepSimulation");
+    rpcSpan.addArg("sim", request->name());
+    auto handle = lockSimulation(request->name());
+    if (handle.sim == nullptr) {
+        return Status(grpc::NOT_FOUND,
+                      "Could not find simulation with that name.");
+    }
+
+    if (handle.sim->ticking) {
+        return Status(grpc::FAILED_PRECONDITION,
+                      "The simulation is being stepped by the engine.");
+    }
+
+    return runStep(handle.sim, request->name(), request->seed(),
+                   request->profile());
+}
+
+Status EngineServiceImpl::CreateEntities(
+    ServerContext* context, const bento::protos::CreateEntitiesReq* request,
+    bento::protos::CreateEntitiesResp* response) {
+    Tracer::Scope rpcSpan(tracer, "CreateEntities");
+    Metrics::RpcTimer rpcTimer(metrics, "CreateEntities");
+    rpcSpan.addArg("sim", request->sim_name());
+    auto handle = lockSimulation(request->sim_name());
+    if (handle.sim == nullptr) {
+        return Status(grpc::NOT_FOUND,
+                      "Could not find simulation with that name.");
+    }
+
+    auto& sim = *handle.sim;
+    auto& indexStore = sim.indexStore;
+
+    // Validate all the entities first so that either all or none of them are
+    // created
+    std::vector<std::vector<ics::CompGroup>> entityGroups;
+    entityGroups.reserve(request->entities_size());
+    std::unordered_set<ics::index::EntityIndex::EntityId> requestedIds;
+    // Position of the first ID of each EntityDef in the response
+    std::vector<size_t> offsets;
+    offsets.reserve(request->entities_size());
+    size_t entityCount = 0;
+    for (const auto& entity : request->entities()) {
+        if (entity.id() != Simulation::UNSET_ENTITY_ID && entity.count() > 1) {
+            return Status(grpc::INVALID_ARGUMENT,
+                          "An entity definition with a count cannot have an "
+                          "ID.");
+        }
+        if (entity.id() != Simulation::UNSET_ENTITY_ID &&
+            (indexStore.entity.hasEntity(entity.id()) ||
+             !requestedIds.insert(entity.id()).second)) {
+            return Status(grpc::ALREADY_EXISTS,
+                          "An entity with ID " + std::to_string(entity.id()) +
+                              " already exists.");
+        }
+
+        std::vector<ics::CompGroup> groups;
+        groups.reserve(entity.components_size());
+        for (const auto& typeName : entity.components()) {
+            if (!indexStore.componentType.hasComponentType(typeName) ||
+                !indexStore.attribute.hasLayout(
+                    indexStore.componentType.getComponentType(typeName))) {
+                return Status(grpc::INVALID_ARGUMENT,
+                              "Unknown component type: " + typeName);
+            }
+            groups.push_back(
+                indexStore.componentType.getComponentType(typeName));
+        }
+        if (indexStore.useArchetypes) {
+            auto sorted = groups;
+            std::sort(sorted.begin(), sorted.end());
+            if (std::adjacent_find(sorted.begin(), sorted.end()) !=
+                sorted.end()) {
+                return Status(grpc::INVALID_ARGUMENT,
+                              "An entity can only have one component of each "
+                              "type in archetype storage.");
+            }
+        }
+        entityGroups.push_back(std::move(groups));
+        offsets.push_back(entityCount);
+        entityCount += std::max<size_t>(entity.count(), 1);
+    }
+
+    auto entityIds = response->mutable_entity_ids();
+    entityIds->Resize(entityCount, 0);
+    try {
+        // Reserve the given IDs before generating the other IDs, so that a
+        // generated ID cannot take a given ID
+        for (size_t i = 0; i < request->entities_size(); i++) {
+            auto entityId = request->entities(i).id();
+            if (entityId != Simulation::UNSET_ENTITY_ID) {
+                sim.commands.spawn(indexStore, entityGroups[i], entityId);
+                entityIds->Set(offsets[i], entityId);
+            }
+        }
+        for (size_t i = 0; i < request->entities_size(); i++) {
+            const auto& entity = request->entities(i);
+            if (entity.id() != Simulation::UNSET_ENTITY_ID) {
+                continue;
+            }
+            for (size_t j = 0; j < std::max<size_t>(entity.count(), 1); j++) {
+                entityIds->Set(offsets[i] + j,
+                               sim.commands.spawn(indexStore, entityGroups[i]));
+            }
         }
+
+        // No step is running, so the entities can be created right away
+        Tracer::Scope span(tracer, "flush commands");
+        sim.commands.flush(indexStore, sim.compStore);
+        sim.publishCounts();
+    } catch (const std::exception& e) {
+        sim.publishCounts();
+        return Status(grpc::INTERNAL,
+                      formatError("Something went wrong while creating the "
+                                  "entities",
+                                  e));
     }
 
     return Status::OK;
@@ -153,14 +577,45 @@ Status EngineServiceImpl::StepSimulation(
 Status EngineServiceImpl::GetAttribute(
     ServerContext* context, const bento::protos::GetAttributeReq* request,
     bento::protos::GetAttributeResp* response) {
-    if (!sims.contains(request->sim_name())) {
+    Tracer::Scope rpcSpan(tracer, "GetAttribute");
+    Metrics::RpcTimer rpcTimer(metrics, "GetAttribute");
+    rpcSpan.addArg("sim", request->sim_name());
+    {
+        // Read simulations which are being ticked from their latest
+        // snapshot, so that the read does not wait for the step being run
+        std::shared_lock simsLock(simsMutex);
+        auto it = sims.find(request->sim_name());
+        auto snapshot = it != sims.end() ? it->second->snapshot.load()
+                                         : nullptr;
+        if (snapshot != nullptr) {
+            const bento::protos::Value* value;
+            try {
+                value = snapshot->find(request->attribute());
+            } catch (const std::exception& e) {
+                return Status(grpc::NOT_FOUND,
+                              formatError("RetrieveOp failed when retrieving "
+                                          "requested attribute.",
+                                          e));
+            }
+            if (value == nullptr) {
+                return Status(grpc::NOT_FOUND,
+                              "Could not find the requested attribute.");
+            }
+            Tracer::Scope span(tracer, "fill response");
+            response->mutable_value()->CopyFrom(*value);
+            return Status::OK;
+        }
+    }
+
+    auto handle = lockSimulation(request->sim_name());
+    if (handle.sim == nullptr) {
         return Status(grpc::NOT_FOUND,
                       "Could not find simulation with that name.");
     }
 
-    auto& indexStore = sims.at(request->sim_name())->indexStore;
-    auto& compStore = sims.at(request->sim_name())->compStore;
-    auto& simDef = sims.at(request->sim_name())->simDef;
+    auto& indexStore = handle.sim->indexStore;
+    auto& compStore = handle.sim->compStore;
+    auto& simDef = handle.sim->simDef;
 
     // Use interpreter's operations to find the attribute for consistency
     // Create the retrieve node
@@ -169,6 +624,7 @@ Status EngineServiceImpl::GetAttribute(
 
     try {
         auto val = interpreter::retrieveOp(compStore, indexStore, retrieveNode);
+        Tracer::Scope span(tracer, "fill response");
         // CopyFrom does not accept rvalue references, so there is no speed-up
         // from moving
         response->mutable_value()->CopyFrom(val);
@@ -187,14 +643,18 @@ Status EngineServiceImpl::GetAttribute(
 Status EngineServiceImpl::SetAttribute(
     ServerContext* context, const bento::protos::SetAttributeReq* request,
     bento::protos::SetAttributeResp* response) {
-    if (!sims.contains(request->sim_name())) {
+    Tracer::Scope rpcSpan(tracer, "SetAttribute");
+    Metrics::RpcTimer rpcTimer(metrics, "SetAttribute");
+    rpcSpan.addArg("sim", request->sim_name());
+    auto handle = lockSimulation(request->sim_name());
+    if (handle.sim == nullptr) {
         return Status(grpc::NOT_FOUND,
                       "Could not find simulation with that name.");
     }
 
-    auto& indexStore = sims.at(request->sim_name())->indexStore;
-    auto& compStore = sims.at(request->sim_name())->compStore;
-    auto& simDef = sims.at(request->sim_name())->simDef;
+    auto& indexStore = handle.sim->indexStore;
+    auto& compStore = handle.sim->compStore;
+    auto& simDef = handle.sim->simDef;
 
     // Use interpreter's node to find the attribute for consistency
     // Create a const node holding the value
@@ -218,4 +678,342 @@ Status EngineServiceImpl::SetAttribute(
     return Status::OK;
 }
 
+Status EngineServiceImpl::WatchSimulation(
+    ServerContext* context, const bento::protos::WatchSimulationReq* request,
+    grpc::ServerWriter<bento::protos::WatchSimulationResp>* writer) {
+    // Only subscribing is traced and timed, as the stream lasts for as long
+    // as the client watches
+    auto watcher = std::make_shared<StateWatcher>(
+        request->keyframe_interval() != 0
+            ? request->keyframe_interval()
+            : StateWatcher::DEFAULT_KEYFRAME_INTERVAL);
+    {
+        Tracer::Scope rpcSpan(tracer, "WatchSimulation");
+        Metrics::RpcTimer rpcTimer(metrics, "WatchSimulation");
+        rpcSpan.addArg("sim", request->sim_name());
+        auto handle = lockSimulation(request->sim_name());
+        if (handle.sim == nullptr) {
+            return Status(grpc::NOT_FOUND,
+                          "Could not find simulation with that name.");
+        }
+
+        auto& sim = *handle.sim;
+        if (!sim.indexStore.version.isTrackingChanges()) {
+            sim.indexStore.version.trackChanges(true);
+        }
+        sim.watchers.push_back(watcher);
+
+        Tracer::Scope span(tracer, "fill response");
+        auto keyframe = std::make_shared<bento::protos::WatchSimulationResp>();
+        keyframe->set_step(sim.random.getStep());
+        fillKeyframe(sim.indexStore, sim.compStore, *keyframe);
+        watcher->push(std::move(keyframe));
+    }
+
+    // Wake up regularly to notice when the client has gone away
+    const auto pollInterval = std::chrono::milliseconds(100);
+    while (!context->IsCancelled()) {
+        auto message = watcher->pop(pollInterval);
+        if (message == nullptr) {
+            if (watcher->isClosed()) {
+                break;
+            }
+            continue;
+        }
+        if (!writer->Write(*message)) {
+            break;
+        }
+    }
+    // The simulation forgets the watcher on its next step
+    watcher->close();
+    return Status::OK;
+}
+
+Status EngineServiceImpl::GetProfile(
+    ServerContext* context, const bento::protos::GetProfileReq* request,
+    bento::protos::GetProfileResp* response) {
+    Tracer::Scope rpcSpan(tracer, "GetProfile");
+    Metrics::RpcTimer rpcTimer(metrics, "GetProfile");
+    rpcSpan.addArg("sim", request->sim_name());
+    auto handle = lockSimulation(request->sim_name());
+    if (handle.sim == nullptr) {
+        return Status(grpc::NOT_FOUND,
+                      "Could not find simulation with that name.");
+    }
+
+    Tracer::Scope span(tracer, "fill response");
+    auto& profiler = handle.sim->profiler;
+    auto toNs = [](interpreter::Profiler::Clock::duration duration) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(duration)
+            .count();
+    };
+    for (const auto& [systemId, counter] : profiler.getSystems()) {
+        auto& system = *response->add_systems();
+        system.set_system_id(systemId);
+        system.set_run_count(counter.count);
+        system.set_total_ns(toNs(counter.total));
+    }
+    const auto* nodeDescriptor = bento::protos::Node::descriptor();
+    for (const auto& [op, counter] : profiler.getNodes()) {
+        auto& node = *response->add_nodes();
+        node.set_op(nodeDescriptor->FindFieldByNumber(op)->name());
+        node.set_eval_count(counter.count);
+        node.set_total_ns(toNs(counter.total));
+    }
+
+    if (request->reset()) {
+        profiler.reset();
+    }
+    return Status::OK;
+}
+
+Status EngineServiceImpl::GetSimulationStats(
+    ServerContext* context, const bento::protos::GetSimulationStatsReq* request,
+    bento::protos::GetSimulationStatsResp* response) {
+    Tracer::Scope rpcSpan(tracer, "GetSimulationStats");
+    Metrics::RpcTimer rpcTimer(metrics, "GetSimulationStats");
+    rpcSpan.addArg("sim", request->name());
+    auto handle = lockSimulation(request->name());
+    if (handle.sim == nullptr) {
+        return Status(grpc::NOT_FOUND,
+                      "Could not find simulation with that name.");
+    }
+
+    Tracer::Scope span(tracer, "fill response");
+    const auto& sim = *handle.sim;
+    auto usage = sim.getMemoryUsage();
+    auto& memoryUsage = *response->mutable_memory();
+    memoryUsage.set_component_bytes(usage.componentBytes);
+    memoryUsage.set_index_bytes(usage.indexBytes);
+    memoryUsage.set_schema_bytes(usage.schemaBytes);
+    memoryUsage.set_graph_bytes(usage.graphBytes);
+    memoryUsage.set_other_bytes(usage.otherBytes);
+    memoryUsage.set_total_bytes(usage.getTotalBytes());
+
+    response->set_entity_count(sim.indexStore.entity.getEntityIds().size());
+    // The init graph runs in step 0
+    response->set_step_count(sim.random.getStep());
+    auto& lastStep = *response->mutable_last_step_allocations();
+    lastStep.set_count(sim.lastStepAllocations.allocations);
+    lastStep.set_bytes(sim.lastStepAllocations.bytes);
+    auto& totalSteps = *response->mutable_total_step_allocations();
+    totalSteps.set_count(sim.totalStepAllocations.allocations);
+    totalSteps.set_bytes(sim.totalStepAllocations.bytes);
+    return Status::OK;
+}
+
+Status EngineServiceImpl::StartTicking(
+    ServerContext* context, const bento::protos::StartTickingReq* request,
+    bento::protos::StartTickingResp* response) {
+    Tracer::Scope rpcSpan(tracer, "StartTicking");
+    Metrics::RpcTimer rpcTimer(metrics, "StartTicking");
+    rpcSpan.addArg("sim", request->sim_name());
+    if (request->tick_rate() < 0) {
+        return Status(grpc::INVALID_ARGUMENT,
+                      "The tick rate cannot be negative.");
+    }
+
+    auto name = request->sim_name();
+    std::lock_guard driversLock(driversMutex);
+    if (drivers.contains(name)) {
+        return Status(grpc::ALREADY_EXISTS,
+                      "The simulation is already being stepped by the "
+                      "engine.");
+    }
+    {
+        auto handle = lockSimulation(name);
+        if (handle.sim == nullptr) {
+            return Status(grpc::NOT_FOUND,
+                          "Could not find simulation with that name.");
+        }
+        // Publish the current state, so that it can be read before the
+        // first tick. The snapshots are refilled with the changes from then.
+        auto& sim = *handle.sim;
+        sim.ticking = true;
+        if (!sim.indexStore.version.isTrackingChanges()) {
+            sim.indexStore.version.trackChanges(true);
+        }
+        publishSnapshot(sim, {});
+    }
+
+    auto period = std::chrono::duration_cast<TickDriver::Clock::duration>(
+        std::chrono::duration<double>(
+            request->tick_rate() > 0 ? 1 / request->tick_rate() : 0));
+    drivers[name] = std::make_unique<TickDriver>(period, [this, name]() {
+        Tracer::Scope span(tracer, "tick");
+        span.addArg("sim", name);
+        auto handle = lockSimulation(name);
+        if (handle.sim == nullptr) {
+            throw std::runtime_error("The simulation has been dropped.");
+        }
+        auto status = runStep(handle.sim, name, 0, false);
+        if (!status.ok()) {
+            throw std::runtime_error(status.error_message());
+        }
+    });
+    return Status::OK;
+}
+
+Status EngineServiceImpl::StopTicking(
+    ServerContext* context, const bento::protos::StopTickingReq* request,
+    bento::protos::StopTickingResp* response) {
+    Tracer::Scope rpcSpan(tracer, "StopTicking");
+    Metrics::RpcTimer rpcTimer(metrics, "StopTicking");
+    rpcSpan.addArg("sim", request->sim_name());
+    std::lock_guard driversLock(driversMutex);
+    auto it = drivers.find(request->sim_name());
+    if (it == drivers.end()) {
+        return Status(grpc::FAILED_PRECONDITION,
+                      "The simulation is not being stepped by the engine.");
+    }
+    auto driver = std::move(it->second);
+    drivers.erase(it);
+    driver->stop();
+    response->set_tick_count(driver->getTickCount());
+    response->set_skipped_ticks(driver->getSkippedTicks());
+    response->set_error(driver->getError());
+
+    // Attributes are read from the simulation again, which sees the
+    // attributes set between steps
+    auto handle = lockSimulation(request->sim_name());
+    if (handle.sim != nullptr) {
+        handle.sim->ticking = false;
+        handle.sim->snapshot.store(nullptr);
+        handle.sim->frontSnapshot.reset();
+        handle.sim->backSnapshot.reset();
+        handle.sim->frontChanges = {};
+    }
+    return Status::OK;
+}
+
+Status EngineServiceImpl::StartRecording(
+    ServerContext* context, const bento::protos::StartRecordingReq* request,
+    bento::protos::StartRecordingResp* response) {
+    Tracer::Scope rpcSpan(tracer, "StartRecording");
+    Metrics::RpcTimer rpcTimer(metrics, "StartRecording");
+    rpcSpan.addArg("sim", request->sim_name());
+    auto handle = lockSimulation(request->sim_name());
+    if (handle.sim == nullptr) {
+        return Status(grpc::NOT_FOUND,
+                      "Could not find simulation with that name.");
+    }
+
+    auto& sim = *handle.sim;
+    if (sim.recorder) {
+        return Status(grpc::ALREADY_EXISTS,
+                      "The simulation is already being recorded.");
+    }
+    if (recordingsDir.empty()) {
+        return Status(grpc::FAILED_PRECONDITION,
+                      "No recordings directory has been set on the engine.");
+    }
+    std::filesystem::path path;
+    try {
+        path = resolveInDir(recordingsDir, request->path());
+    } catch (const std::invalid_argument& e) {
+        return Status(grpc::INVALID_ARGUMENT, e.what());
+    }
+    try {
+        sim.recorder = std::make_unique<recorder::TrajectoryRecorder>(
+            path.string(), sim.indexStore, request->attributes(),
+            request->index_interval() != 0
+                ? request->index_interval()
+                : recorder::TrajectoryRecorder::DEFAULT_INDEX_INTERVAL);
+    } catch (const std::invalid_argument& e) {
+        return Status(grpc::INVALID_ARGUMENT, e.what());
+    } catch (const std::exception& e) {
+        return Status(grpc::INTERNAL,
+                      formatError("Could not start recording", e));
+    }
+
+    // Record the state that the first recorded step starts from
+    try {
+        sim.recorder->record(sim.indexStore, sim.compStore,
+                             sim.random.getStep());
+    } catch (const std::exception& e) {
+        sim.recorder.reset();
+        return Status(grpc::INTERNAL,
+                      formatError("Could not start recording", e));
+    }
+    return Status::OK;
+}
+
+Status EngineServiceImpl::StopRecording(
+    ServerContext* context, const bento::protos::StopRecordingReq* request,
+    bento::protos::StopRecordingResp* response) {
+    Tracer::Scope rpcSpan(tracer, "StopRecording");
+    Metrics::RpcTimer rpcTimer(metrics, "StopRecording");
+    rpcSpan.addArg("sim", request->sim_name());
+    auto handle = lockSimulation(request->sim_name());
+    if (handle.sim == nullptr) {
+        return Status(grpc::NOT_FOUND,
+                      "Could not find simulation with that name.");
+    }
+
+    auto recorder = std::move(handle.sim->recorder);
+    if (!recorder) {
+        return Status(grpc::FAILED_PRECONDITION,
+                      "The simulation is not being recorded.");
+    }
+    try {
+        recorder->close();
+    } catch (const std::exception& e) {
+        return Status(grpc::INTERNAL,
+                      formatError("Could not finish the recording", e));
+    }
+    response->set_step_count(recorder->getStepCount());
+    response->set_size_bytes(recorder->getSize());
+    return Status::OK;
+}
+
+Status EngineServiceImpl::StartTrace(
+    ServerContext* context, const bento::protos::StartTraceReq* request,
+    bento::protos::StartTraceResp* response) {
+    Metrics::RpcTimer rpcTimer(metrics, "StartTrace");
+    tracer.start(request->max_spans() != 0 ? request->max_spans()
+                                           : Tracer::DEFAULT_MAX_SPANS);
+    return Status::OK;
+}
+
+Status EngineServiceImpl::StopTrace(
+    ServerContext* context, const bento::protos::StopTraceReq* request,
+    bento::protos::StopTraceResp* response) {
+    Metrics::RpcTimer rpcTimer(metrics, "StopTrace");
+    if (!tracer.isEnabled()) {
+        return Status(grpc::FAILED_PRECONDITION, "No trace has been started.");
+    }
+
+    // Check the path first, so that the trace is kept if it is refused
+    std::filesystem::path path;
+    if (!request->path().empty()) {
+        if (tracesDir.empty()) {
+            return Status(grpc::FAILED_PRECONDITION,
+                          "No traces directory has been set on the engine.");
+        }
+        try {
+            path = resolveInDir(tracesDir, request->path());
+        } catch (const std::invalid_argument& e) {
+            return Status(grpc::INVALID_ARGUMENT, e.what());
+        }
+    }
+
+    auto trace = tracer.stop();
+    response->set_dropped_count(trace.droppedCount);
+    if (path.empty()) {
+        std::ostringstream out;
+        writeChromeTrace(out, trace);
+        response->set_trace_json(out.str());
+        return Status::OK;
+    }
+
+    std::ofstream out(path);
+    writeChromeTrace(out, trace);
+    out.close();
+    if (!out) {
+        return Status(grpc::INTERNAL,
+                      "Could not write the trace to " + request->path() + ".");
+    }
+    return Status::OK;
+}
+
 }  // namespace service
@@ -13,6 +13,12 @@
 #include <test_simulation.h>
 #include <simulation.h>
 
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <thread>
+
 #define TEST_SUITE EngineServiceImpl
 #define TEST_PORT 54243
 
@@ -32,7 +38,10 @@ class EngineServiceTest : public testing::Test {
 
     EngineServiceTest() {
         // setup test server serving engine
-        engineSvc = std::make_unique<EngineServiceImpl>();
+        EngineOptions options;
+        options.recordingsDir = testing::TempDir();
+        options.tracesDir = testing::TempDir();
+        engineSvc = std::make_unique<EngineServiceImpl>(options);
         std::list<grpc::Service*> services = {engineSvc.get()};
         server = std::make_unique<GRPCServer>("localhost", TEST_PORT, services);
         std::string address = "localhost:" + std::to_string(TEST_PORT);
@@ -147,7 +156,7 @@ TEST_F(EngineServiceTest, ApplyCreatesEntityAndSystemIds) {
     // simDef. This means that compDef and entityDef will be undefined.
     {
         // Create comp def
-        auto compDef = test_simulation::TestComponent().compDef;
+        auto compDef = test_simulation::TestComponent().getCompDef();
 
         // Create entity def
         auto entityDef = bento::protos::EntityDef();
@@ -187,6 +196,40 @@ TEST_F(EngineServiceTest, ApplyCreatesEntityAndSystemIds) {
     ASSERT_NE(updatedSimDef.systems(0).id(), UNSET_SYSTEM_ID);
 }
 
+TEST_F(EngineServiceTest, ApplyCreatesEntitiesFromTemplate) {
+    auto testSim = test_simulation::TestSimulation();
+    auto templateDef = testSim.simDef.add_entities();
+    templateDef->add_components(testSim.COMP_TYPE_NAME);
+    templateDef->set_count(1000);
+    applySim(testSim.simDef);
+
+    // The template's entities are numbered after the configured entity
+    auto createdSimDef = getSim(testSim.SIM_NAME).simulation();
+    auto firstId = createdSimDef.entities(1).id();
+    ASSERT_GT(firstId, testSim.entityDef.id());
+
+    auto newValProto = bento::protos::Value();
+    newValProto.mutable_primitive()->set_int_64(5);
+    newValProto.mutable_data_type()->set_primitive(
+        bento::protos::Type_Primitive_INT64);
+    for (auto entityId : {firstId, firstId + 999}) {
+        auto attr = interpreter::createAttrRef(testSim.COMP_TYPE_NAME,
+                                               entityId, "width");
+        setAttr(testSim.SIM_NAME, attr, newValProto);
+        ASSERT_EQ(getAttr(testSim.SIM_NAME, attr).value().primitive().int_64(),
+                  5);
+    }
+    ASSERT_ANY_THROW(getAttr(
+        testSim.SIM_NAME, interpreter::createAttrRef(testSim.COMP_TYPE_NAME,
+                                                     firstId + 1000, "width")));
+
+    // A template cannot be given an ID
+    auto badSimDef = testSim.simDef;
+    badSimDef.set_name("bad simulation");
+    badSimDef.mutable_entities(1)->set_id(500);
+    ASSERT_ANY_THROW(applySim(badSimDef));
+}
+
 TEST_F(EngineServiceTest, ListSims) {
     Status s;
     // Start with no simulations
@@ -250,6 +293,438 @@ TEST_F(EngineServiceTest, StepSim) {
     ASSERT_EQ(getResp.value().primitive().int_64(), testSim.COMP_START_VAL + 1);
 }
 
+TEST_F(EngineServiceTest, GetProfile) {
+    auto testSim = test_simulation::TestSimulation();
+    auto simDef = applySim(testSim.simDef).simulation();
+
+    // Steps are only profiled when asked to
+    for (bool profile : {false, true, true}) {
+        StepSimulationReq stepReq;
+        StepSimulationResp stepResp;
+        ClientContext stepContext;
+        stepReq.set_name(testSim.SIM_NAME);
+        stepReq.set_profile(profile);
+        Status s = client->StepSimulation(&stepContext, stepReq, &stepResp);
+        ASSERT_TRUE(s.ok());
+    }
+
+    GetProfileReq req;
+    GetProfileResp resp;
+    ClientContext context;
+    req.set_sim_name(testSim.SIM_NAME);
+    req.set_reset(true);
+    Status s = client->GetProfile(&context, req, &resp);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(resp.systems_size(), simDef.systems_size());
+    ASSERT_EQ(resp.systems(0).system_id(), simDef.systems(0).id());
+    ASSERT_EQ(resp.systems(0).run_count(), 2);
+    ASSERT_GT(resp.nodes_size(), 0);
+    for (const auto& node : resp.nodes()) {
+        ASSERT_GT(node.eval_count(), 0);
+        ASSERT_FALSE(node.op().empty());
+    }
+
+    // The profile was cleared after it was returned
+    ClientContext resetContext;
+    resp.Clear();
+    s = client->GetProfile(&resetContext, req, &resp);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(resp.systems_size(), 0);
+    ASSERT_EQ(resp.nodes_size(), 0);
+}
+
+TEST_F(EngineServiceTest, GetSimulationStats) {
+    auto testSim = test_simulation::TestSimulation();
+    auto simDef = applySim(testSim.simDef).simulation();
+
+    GetSimulationStatsReq req;
+    GetSimulationStatsResp resp;
+    ClientContext context;
+    req.set_name(testSim.SIM_NAME);
+    Status s = client->GetSimulationStats(&context, req, &resp);
+    ASSERT_TRUE(s.ok());
+    const auto& memory = resp.memory();
+    ASSERT_GT(memory.component_bytes(), 0);
+    ASSERT_GT(memory.index_bytes(), 0);
+    ASSERT_GT(memory.schema_bytes(), 0);
+    ASSERT_GT(memory.graph_bytes(), 0);
+    ASSERT_EQ(memory.total_bytes(),
+              memory.component_bytes() + memory.index_bytes() +
+                  memory.schema_bytes() + memory.graph_bytes() +
+                  memory.other_bytes());
+    ASSERT_EQ(resp.step_count(), 0);
+    ASSERT_EQ(resp.total_step_allocations().count(), 0);
+
+    for (int i = 0; i < 2; i++) {
+        StepSimulationReq stepReq;
+        StepSimulationResp stepResp;
+        ClientContext stepContext;
+        stepReq.set_name(testSim.SIM_NAME);
+        s = client->StepSimulation(&stepContext, stepReq, &stepResp);
+        ASSERT_TRUE(s.ok());
+    }
+
+    ClientContext steppedContext;
+    s = client->GetSimulationStats(&steppedContext, req, &resp);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(resp.step_count(), 2);
+    ASSERT_GE(resp.total_step_allocations().count(),
+              resp.last_step_allocations().count());
+    ASSERT_GE(resp.total_step_allocations().bytes(),
+              resp.last_step_allocations().bytes());
+
+    ClientContext missingContext;
+    req.set_name("missing");
+    s = client->GetSimulationStats(&missingContext, req, &resp);
+    ASSERT_EQ(s.error_code(), grpc::NOT_FOUND);
+}
+
+TEST_F(EngineServiceTest, RecordSim) {
+    auto testSim = test_simulation::TestSimulation();
+    applySim(testSim.simDef);
+
+    StartRecordingReq startReq;
+    StartRecordingResp startResp;
+    ClientContext startContext;
+    startReq.set_sim_name(testSim.SIM_NAME);
+    startReq.set_path("engineRecording.bin");
+    startReq.mutable_attributes()->Add()->CopyFrom(interpreter::createAttrRef(
+        test_simulation::TEST_COMPONENT_NAME, 1, "height"));
+    Status s = client->StartRecording(&startContext, startReq, &startResp);
+    ASSERT_TRUE(s.ok());
+
+    // Only one recording of a simulation can be made at a time
+    ClientContext againContext;
+    s = client->StartRecording(&againContext, startReq, &startResp);
+    ASSERT_EQ(s.error_code(), grpc::ALREADY_EXISTS);
+
+    for (int i = 0; i < 2; i++) {
+        StepSimulationReq stepReq;
+        StepSimulationResp stepResp;
+        ClientContext stepContext;
+        stepReq.set_name(testSim.SIM_NAME);
+        s = client->StepSimulation(&stepContext, stepReq, &stepResp);
+        ASSERT_TRUE(s.ok());
+    }
+
+    StopRecordingReq stopReq;
+    StopRecordingResp stopResp;
+    ClientContext stopContext;
+    stopReq.set_sim_name(testSim.SIM_NAME);
+    s = client->StopRecording(&stopContext, stopReq, &stopResp);
+    ASSERT_TRUE(s.ok());
+    // The values on start are recorded with those of each step
+    ASSERT_EQ(stopResp.step_count(), 3);
+    ASSERT_GT(stopResp.size_bytes(), 0);
+
+    ClientContext stoppedContext;
+    s = client->StopRecording(&stoppedContext, stopReq, &stopResp);
+    ASSERT_EQ(s.error_code(), grpc::FAILED_PRECONDITION);
+
+    ClientContext invalidContext;
+    startReq.mutable_attributes(0)->set_attribute("missing");
+    s = client->StartRecording(&invalidContext, startReq, &startResp);
+    ASSERT_EQ(s.error_code(), grpc::INVALID_ARGUMENT);
+
+    // Files outside of the recordings directory cannot be written
+    startReq.mutable_attributes(0)->set_attribute("height");
+    for (const char* path :
+         {"/tmp/engineRecording.bin", "../engineRecording.bin", "a/../../b"}) {
+        ClientContext pathContext;
+        startReq.set_path(path);
+        s = client->StartRecording(&pathContext, startReq, &startResp);
+        ASSERT_EQ(s.error_code(), grpc::INVALID_ARGUMENT);
+    }
+}
+
+TEST_F(EngineServiceTest, WatchSim) {
+    auto testSim = test_simulation::TestSimulation();
+    applySim(testSim.simDef);
+
+    WatchSimulationReq watchReq;
+    ClientContext watchContext;
+    watchReq.set_sim_name(testSim.SIM_NAME);
+    watchReq.set_keyframe_interval(2);
+    auto reader = client->WatchSimulation(&watchContext, watchReq);
+
+    // Every attribute is sent on subscribe
+    WatchSimulationResp resp;
+    ASSERT_TRUE(reader->Read(&resp));
+    ASSERT_TRUE(resp.keyframe());
+    ASSERT_EQ(resp.attributes_size(), 2);
+
+    // Only the height is changed by each step, until a keyframe is due
+    for (int step = 1; step <= 3; step++) {
+        StepSimulationReq stepReq;
+        StepSimulationResp stepResp;
+        ClientContext stepContext;
+        stepReq.set_name(testSim.SIM_NAME);
+        Status s = client->StepSimulation(&stepContext, stepReq, &stepResp);
+        ASSERT_TRUE(s.ok());
+
+        ASSERT_TRUE(reader->Read(&resp));
+        ASSERT_EQ(resp.keyframe(), step == 3);
+        ASSERT_EQ(resp.attributes_size(), step == 3 ? 2 : 1);
+        if (step < 3) {
+            ASSERT_EQ(resp.attributes(0).attribute().attribute(), "height");
+            ASSERT_EQ(resp.attributes(0).value().primitive().int_64(),
+                      testSim.COMP_START_VAL + step);
+        }
+    }
+
+    // Dropping the simulation ends the stream
+    DropSimulationReq dropReq;
+    DropSimulationResp dropResp;
+    ClientContext dropContext;
+    dropReq.set_name(testSim.SIM_NAME);
+    ASSERT_TRUE(client->DropSimulation(&dropContext, dropReq, &dropResp).ok());
+    ASSERT_FALSE(reader->Read(&resp));
+    ASSERT_TRUE(reader->Finish().ok());
+}
+
+TEST_F(EngineServiceTest, TickSim) {
+    auto testSim = test_simulation::TestSimulation();
+    applySim(testSim.simDef);
+
+    // An entity whose attributes are never set
+    CreateEntitiesReq createReq;
+    CreateEntitiesResp createResp;
+    ClientContext createContext;
+    createReq.set_sim_name(testSim.SIM_NAME);
+    auto newEntity = createReq.add_entities();
+    newEntity->set_id(300);
+    newEntity->add_components(testSim.COMP_TYPE_NAME);
+    ASSERT_TRUE(
+        client->CreateEntities(&createContext, createReq, &createResp).ok());
+    GetAttributeReq unsetReq;
+    GetAttributeResp unsetResp;
+    unsetReq.set_sim_name(testSim.SIM_NAME);
+    *unsetReq.mutable_attribute() = interpreter::createAttrRef(
+        test_simulation::TEST_COMPONENT_NAME, 300, "height");
+    ClientContext unsetContext;
+    auto unsetStatus =
+        client->GetAttribute(&unsetContext, unsetReq, &unsetResp);
+    ASSERT_EQ(unsetStatus.error_code(), grpc::NOT_FOUND);
+
+    StartTickingReq startReq;
+    StartTickingResp startResp;
+    ClientContext startContext;
+    startReq.set_sim_name(testSim.SIM_NAME);
+    Status s = client->StartTicking(&startContext, startReq, &startResp);
+    ASSERT_TRUE(s.ok());
+
+    // Attributes are read from the latest step while the engine steps
+    auto heightRef = interpreter::createAttrRef(
+        test_simulation::TEST_COMPONENT_NAME, 1, "height");
+    auto resp = getAttr(testSim.SIM_NAME, heightRef);
+    // The height cycles from 0 to 100
+    ASSERT_TRUE(resp.value().has_primitive());
+    ASSERT_LE(resp.value().primitive().int_64(), 101);
+    // Unset attributes fail as they do when the simulation is not ticking
+    ClientContext tickingContext;
+    auto tickingStatus =
+        client->GetAttribute(&tickingContext, unsetReq, &unsetResp);
+    ASSERT_EQ(tickingStatus.error_code(), unsetStatus.error_code());
+    ASSERT_EQ(tickingStatus.error_message(), unsetStatus.error_message());
+
+    // Attributes set between steps are read once a step has published them
+    auto newValProto = bento::protos::Value();
+    newValProto.mutable_primitive()->set_int_64(42);
+    newValProto.mutable_data_type()->set_primitive(
+        bento::protos::Type_Primitive_INT64);
+    setAttr(testSim.SIM_NAME, unsetReq.attribute(), newValProto);
+    int64_t newVal = 0;
+    for (int i = 0; i < 100 && newVal != 42; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        ClientContext newContext;
+        if (client->GetAttribute(&newContext, unsetReq, &unsetResp).ok()) {
+            newVal = unsetResp.value().primitive().int_64();
+        }
+    }
+    ASSERT_EQ(newVal, 42);
+
+    // Only the engine can step the simulation
+    StepSimulationReq stepReq;
+    StepSimulationResp stepResp;
+    ClientContext stepContext;
+    stepReq.set_name(testSim.SIM_NAME);
+    s = client->StepSimulation(&stepContext, stepReq, &stepResp);
+    ASSERT_EQ(s.error_code(), grpc::FAILED_PRECONDITION);
+
+    StopTickingReq stopReq;
+    StopTickingResp stopResp;
+    ClientContext stopContext;
+    stopReq.set_sim_name(testSim.SIM_NAME);
+    s = client->StopTicking(&stopContext, stopReq, &stopResp);
+    ASSERT_TRUE(s.ok());
+    ASSERT_TRUE(stopResp.error().empty());
+
+    ClientContext stoppedContext;
+    s = client->StopTicking(&stoppedContext, stopReq, &stopResp);
+    ASSERT_EQ(s.error_code(), grpc::FAILED_PRECONDITION);
+    ClientContext steppedContext;
+    s = client->StepSimulation(&steppedContext, stepReq, &stepResp);
+    ASSERT_TRUE(s.ok());
+}
+
+TEST_F(EngineServiceTest, DestroyWhileTicking) {
+    auto testSim = test_simulation::TestSimulation();
+    applySim(testSim.simDef);
+
+    // Ticks are traced, so they use the tracer as well as the simulation
+    StartTraceReq traceReq;
+    StartTraceResp traceResp;
+    ClientContext traceContext;
+    Status s = client->StartTrace(&traceContext, traceReq, &traceResp);
+    ASSERT_TRUE(s.ok());
+    StartTickingReq startReq;
+    StartTickingResp startResp;
+    ClientContext startContext;
+    startReq.set_sim_name(testSim.SIM_NAME);
+    s = client->StartTicking(&startContext, startReq, &startResp);
+    ASSERT_TRUE(s.ok());
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    // The engine stops ticking before it is torn down
+    server.reset();
+    engineSvc.reset();
+}
+
+TEST_F(EngineServiceTest, StepDoubleBufferedSim) {
+    auto testSim = test_simulation::TestSimulation();
+    testSim.simDef.set_step_mode(SimulationDef::DOUBLE_BUFFERED);
+    // A second system reads the height that the first system mutates
+    auto widthRef = interpreter::createAttrRef(
+        test_simulation::TEST_COMPONENT_NAME, 1, "width");
+    auto heightRef = interpreter::createAttrRef(
+        test_simulation::TEST_COMPONENT_NAME, 1, "height");
+    auto copySystem = testSim.simDef.add_systems();
+    copySystem->set_id(2);
+    auto output = copySystem->mutable_graph()->add_outputs();
+    output->mutable_mutate_attr()->CopyFrom(widthRef);
+    output->mutable_to_node()
+        ->mutable_retrieve_op()
+        ->mutable_retrieve_attr()
+        ->CopyFrom(heightRef);
+    applySim(testSim.simDef);
+
+    StepSimulationReq stepReq;
+    StepSimulationResp stepResp;
+    ClientContext stepContext;
+    stepReq.set_name(testSim.SIM_NAME);
+    Status s = client->StepSimulation(&stepContext, stepReq, &stepResp);
+    ASSERT_TRUE(s.ok());
+
+    // The width is copied from the height before the step
+    ASSERT_EQ(getAttr(testSim.SIM_NAME, heightRef).value().primitive().int_64(),
+              testSim.COMP_START_VAL + 1);
+    ASSERT_EQ(getAttr(testSim.SIM_NAME, widthRef).value().primitive().int_64(),
+              testSim.COMP_START_VAL);
+}
+
+TEST_F(EngineServiceTest, RenderMetrics) {
+    auto testSim = test_simulation::TestSimulation();
+    applySim(testSim.simDef);
+
+    StepSimulationReq stepReq;
+    StepSimulationResp stepResp;
+    ClientContext stepContext;
+    stepReq.set_name(testSim.SIM_NAME);
+    Status s = client->StepSimulation(&stepContext, stepReq, &stepResp);
+    ASSERT_TRUE(s.ok());
+
+    auto text = engineSvc->renderMetrics();
+    auto simLabel = "{sim=\"" + std::string(testSim.SIM_NAME) + "\"}";
+    ASSERT_NE(text.find("bentobox_simulations 1\n"), std::string::npos);
+    ASSERT_NE(text.find("bentobox_simulation_steps_total" + simLabel + " 1\n"),
+              std::string::npos);
+    ASSERT_NE(text.find("bentobox_simulation_entities" + simLabel),
+              std::string::npos);
+    ASSERT_NE(text.find("bentobox_rpc_duration_seconds_count{method="
+                        "\"StepSimulation\"} 1\n"),
+              std::string::npos);
+    ASSERT_EQ(text.find("bentobox_node_evaluations_total 0\n"),
+              std::string::npos);
+
+    // Failed steps are not counted
+    auto failingSim = bento::protos::SimulationDef();
+    failingSim.set_name("failing");
+    auto& output = *failingSim.add_systems()->mutable_graph()->add_outputs();
+    *output.mutable_mutate_attr() =
+        interpreter::createAttrRef("Unknown", 1, "value");
+    output.mutable_to_node()
+        ->mutable_const_op()
+        ->mutable_held_value()
+        ->mutable_primitive()
+        ->set_int_64(1);
+    applySim(failingSim);
+    ClientContext failingContext;
+    stepReq.set_name("failing");
+    s = client->StepSimulation(&failingContext, stepReq, &stepResp);
+    ASSERT_FALSE(s.ok());
+    text = engineSvc->renderMetrics();
+    ASSERT_EQ(text.find("bentobox_simulation_steps_total{sim=\"failing\"}"),
+              std::string::npos);
+    ASSERT_NE(text.find("bentobox_simulation_entities{sim=\"failing\"} 0\n"),
+              std::string::npos);
+}
+
+TEST_F(EngineServiceTest, Trace) {
+    auto testSim = test_simulation::TestSimulation();
+    applySim(testSim.simDef);
+
+    // Stopping a trace that has not been started fails
+    StopTraceReq stopReq;
+    StopTraceResp stopResp;
+    ClientContext notStartedContext;
+    Status s = client->StopTrace(&notStartedContext, stopReq, &stopResp);
+    ASSERT_EQ(s.error_code(), grpc::FAILED_PRECONDITION);
+
+    StartTraceReq startReq;
+    StartTraceResp startResp;
+    ClientContext startContext;
+    s = client->StartTrace(&startContext, startReq, &startResp);
+    ASSERT_TRUE(s.ok());
+
+    // Files outside of the traces directory cannot be written, and the trace
+    // is kept when the path is refused
+    StopTraceReq outsideReq;
+    outsideReq.set_path("../trace.json");
+    ClientContext outsideContext;
+    s = client->StopTrace(&outsideContext, outsideReq, &stopResp);
+    ASSERT_EQ(s.error_code(), grpc::INVALID_ARGUMENT);
+
+    StepSimulationReq stepReq;
+    StepSimulationResp stepResp;
+    ClientContext stepContext;
+    stepReq.set_name(testSim.SIM_NAME);
+    s = client->StepSimulation(&stepContext, stepReq, &stepResp);
+    ASSERT_TRUE(s.ok());
+
+    ClientContext stopContext;
+    s = client->StopTrace(&stopContext, stopReq, &stopResp);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(stopResp.dropped_count(), 0);
+    const auto& json = stopResp.trace_json();
+    for (const char* name :
+         {"StepSimulation", "lock wait", "runGraph", "flush commands"}) {
+        ASSERT_NE(json.find("\"name\":\"" + std::string(name) + "\""),
+                  std::string::npos)
+            << name;
+    }
+    // Traces can be written to the traces directory instead
+    ClientContext restartContext;
+    s = client->StartTrace(&restartContext, startReq, &startResp);
+    ASSERT_TRUE(s.ok());
+    StopTraceReq fileReq;
+    fileReq.set_path("engineTrace.json");
+    ClientContext fileContext;
+    s = client->StopTrace(&fileContext, fileReq, &stopResp);
+    ASSERT_TRUE(s.ok());
+    std::ifstream traceFile(testing::TempDir() + "engineTrace.json");
+    ASSERT_TRUE(traceFile.good());
+}
+
 TEST_F(EngineServiceTest, StepSimLocksSim) {
     // Apply a sim
     auto testSim = test_simulation::TestSimulation();
@@ -267,6 +742,87 @@ TEST_F(EngineServiceTest, StepSimLocksSim) {
     EXPECT_ANY_THROW(applySim(testSim.simDef));
 }
 
+TEST_F(EngineServiceTest, ConcurrentCallsDoNotDeadlock) {
+    // Each call takes the drivers lock, the lock on the simulations and the
+    // simulation's own lock in that order, skipping those it does not need.
+    // Calls taking different subsets of the locks run concurrently here, with
+    // the simulation being ticked, so a call taking them out of order would
+    // deadlock.
+    auto testSim = test_simulation::TestSimulation();
+    applySim(testSim.simDef);
+    const std::string name = testSim.SIM_NAME;
+
+    auto repeat = [](auto call) {
+        return std::async(std::launch::async, [call]() {
+            for (int i = 0; i < 50; i++) {
+                call();
+            }
+        });
+    };
+    std::vector<std::future<void>> calls;
+    calls.push_back(repeat([&]() {
+        StartTickingReq req;
+        StartTickingResp resp;
+        ClientContext context;
+        req.set_sim_name(name);
+        client->StartTicking(&context, req, &resp);
+    }));
+    calls.push_back(repeat([&]() {
+        StopTickingReq req;
+        StopTickingResp resp;
+        ClientContext context;
+        req.set_sim_name(name);
+        client->StopTicking(&context, req, &resp);
+    }));
+    calls.push_back(repeat([&]() {
+        StepSimulationReq req;
+        StepSimulationResp resp;
+        ClientContext context;
+        req.set_name(name);
+        client->StepSimulation(&context, req, &resp);
+    }));
+    calls.push_back(repeat([&]() {
+        ApplySimulationReq req;
+        ApplySimulationResp resp;
+        ClientContext context;
+        req.mutable_simulation()->CopyFrom(testSim.simDef);
+        client->ApplySimulation(&context, req, &resp);
+    }));
+    calls.push_back(repeat([&]() {
+        ListSimulationReq req;
+        ListSimulationResp resp;
+        ClientContext context;
+        client->ListSimulation(&context, req, &resp);
+    }));
+    calls.push_back(repeat([&]() {
+        GetSimulationStatsReq req;
+        GetSimulationStatsResp resp;
+        ClientContext context;
+        req.set_name(name);
+        client->GetSimulationStats(&context, req, &resp);
+    }));
+    calls.push_back(repeat([&]() { engineSvc->renderMetrics(); }));
+
+    for (auto& call : calls) {
+        // The futures wait for their calls when destroyed, so abort instead
+        // of failing the test, which would hang
+        if (call.wait_for(std::chrono::seconds(30)) !=
+            std::future_status::ready) {
+            ADD_FAILURE() << "The calls did not finish, they may deadlock";
+            std::abort();
+        }
+    }
+
+    // Dropping the simulation stops it being ticked
+    DropSimulationReq dropReq;
+    DropSimulationResp dropResp;
+    ClientContext dropContext;
+    dropReq.set_name(name);
+    Status s = client->DropSimulation(&dropContext, dropReq, &dropResp);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(listSims().sim_names_size(), 0);
+}
+
 TEST_F(EngineServiceTest, GetAndSetAttribute) {
     // Apply a sim
     auto testSim = test_simulation::TestSimulation();
@@ -292,3 +848,70 @@ TEST_F(EngineServiceTest, GetAndSetAttribute) {
     resp = getAttr(testSim.SIM_NAME, attr);
     ASSERT_EQ(resp.value().primitive().int_64(), newVal);
 }
+
+TEST_F(EngineServiceTest, CreateEntities) {
+    auto testSim = test_simulation::TestSimulation();
+    applySim(testSim.simDef);
+
+    CreateEntitiesReq req;
+    CreateEntitiesResp resp;
+    req.set_sim_name(testSim.SIM_NAME);
+    req.add_entities()->add_components(testSim.COMP_TYPE_NAME);
+    auto withId = req.add_entities();
+    withId->set_id(100);
+    withId->add_components(testSim.COMP_TYPE_NAME);
+    ClientContext context;
+    Status s = client->CreateEntities(&context, req, &resp);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(resp.entity_ids_size(), 2);
+    ASSERT_NE(resp.entity_ids(0), 0);
+    ASSERT_EQ(resp.entity_ids(1), 100);
+
+    // The new entities' components can be used right away
+    auto attr = interpreter::createAttrRef(testSim.COMP_TYPE_NAME,
+                                           resp.entity_ids(0), "height");
+    auto newValProto = bento::protos::Value();
+    newValProto.mutable_primitive()->set_int_64(7);
+    newValProto.mutable_data_type()->set_primitive(
+        bento::protos::Type_Primitive_INT64);
+    setAttr(testSim.SIM_NAME, attr, newValProto);
+    ASSERT_EQ(getAttr(testSim.SIM_NAME, attr).value().primitive().int_64(), 7);
+
+    // Nothing is created when any of the entities is invalid
+    CreateEntitiesReq badReq;
+    CreateEntitiesResp badResp;
+    badReq.set_sim_name(testSim.SIM_NAME);
+    auto newEntity = badReq.add_entities();
+    newEntity->set_id(200);
+    newEntity->add_components(testSim.COMP_TYPE_NAME);
+    badReq.add_entities()->set_id(100);
+    ClientContext badContext;
+    s = client->CreateEntities(&badContext, badReq, &badResp);
+    ASSERT_EQ(s.error_code(), grpc::ALREADY_EXISTS);
+    ASSERT_ANY_THROW(getAttr(
+        testSim.SIM_NAME,
+        interpreter::createAttrRef(testSim.COMP_TYPE_NAME, 200, "height")));
+}
+
+TEST_F(EngineServiceTest, CreateEntitiesWithDuplicateTypesInArchetypes) {
+    auto testSim = test_simulation::TestSimulation();
+    testSim.simDef.set_storage(bento::protos::SimulationDef::ARCHETYPE);
+    applySim(testSim.simDef);
+
+    // Nothing is created when an entity has a type twice
+    CreateEntitiesReq req;
+    CreateEntitiesResp resp;
+    req.set_sim_name(testSim.SIM_NAME);
+    auto newEntity = req.add_entities();
+    newEntity->set_id(200);
+    newEntity->add_components(testSim.COMP_TYPE_NAME);
+    auto duplicated = req.add_entities();
+    duplicated->add_components(testSim.COMP_TYPE_NAME);
+    duplicated->add_components(testSim.COMP_TYPE_NAME);
+    ClientContext context;
+    Status s = client->CreateEntities(&context, req, &resp);
+    ASSERT_EQ(s.error_code(), grpc::INVALID_ARGUMENT);
+    ASSERT_ANY_THROW(getAttr(
+        testSim.SIM_NAME,
+        interpreter::createAttrRef(testSim.COMP_TYPE_NAME, 200, "height")));
+}
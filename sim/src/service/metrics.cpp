@@ -0,0 +1,142 @@
+#include <service/metrics.h>
+
+#include <algorithm>
+#include <cstdio>
+
+namespace service {
+namespace {
+// Label values are quoted, so quotes, backslashes and newlines are escaped
+std::string formatLabel(const char* name, const std::string& value) {
+    std::string label = name;
+    label += "=\"";
+    for (char c : value) {
+        switch (c) {
+            case '"':
+                label += "\\\"";
+                break;
+            case '\\':
+                label += "\\\\";
+                break;
+            case '\n':
+                label += "\\n";
+                break;
+            default:
+                label += c;
+        }
+    }
+    label += '"';
+    return label;
+}
+
+std::string formatNumber(double value) {
+    char number[32];
+    std::snprintf(number, sizeof(number), "%.9g", value);
+    return number;
+}
+
+void writeHeader(std::ostream& out, const char* name, const char* type,
+                 const char* help) {
+    out << "# HELP " << name << ' ' << help << '\n';
+    out << "# TYPE " << name << ' ' << type << '\n';
+}
+}  // namespace
+
+void Metrics::Histogram::observe(double value) {
+    auto bucket = std::lower_bound(LATENCY_BUCKETS.begin(),
+                                   LATENCY_BUCKETS.end(), value) -
+                  LATENCY_BUCKETS.begin();
+    bucketCounts[bucket]++;
+    sum += value;
+    count++;
+}
+
+Metrics::RpcTimer::RpcTimer(Metrics& metrics, const char* method)
+    : metrics(metrics), method(method), start(Clock::now()) {
+    metrics.rpcsInFlight++;
+}
+
+Metrics::RpcTimer::~RpcTimer() {
+    std::chrono::duration<double> latency = Clock::now() - start;
+    metrics.rpcsInFlight--;
+    std::lock_guard lock(metrics.mutex);
+    metrics.rpcLatencies[method].observe(latency.count());
+}
+
+void Metrics::addStep(const std::string& simName) {
+    std::lock_guard lock(mutex);
+    simSteps[simName]++;
+}
+
+void Metrics::addNodeEvaluations(uint64_t count) { nodeEvaluations += count; }
+
+void Metrics::dropSimulation(const std::string& simName) {
+    std::lock_guard lock(mutex);
+    simSteps.erase(simName);
+}
+
+void Metrics::write(std::ostream& out,
+                    const std::vector<SimulationGauges>& sims,
+                    size_t evalQueueDepth) {
+    std::lock_guard lock(mutex);
+
+    writeHeader(out, "bentobox_rpc_duration_seconds", "histogram",
+                "Time taken to handle the engine's RPCs.");
+    for (const auto& [method, histogram] : rpcLatencies) {
+        auto methodLabel = formatLabel("method", method);
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < histogram.bucketCounts.size(); i++) {
+            cumulative += histogram.bucketCounts[i];
+            auto bound = i < LATENCY_BUCKETS.size()
+                             ? formatNumber(LATENCY_BUCKETS[i])
+                             : std::string("+Inf");
+            out << "bentobox_rpc_duration_seconds_bucket{" << methodLabel
+                << ",le=\"" << bound << "\"} " << cumulative << '\n';
+        }
+        out << "bentobox_rpc_duration_seconds_sum{" << methodLabel << "} "
+            << formatNumber(histogram.sum) << '\n';
+        out << "bentobox_rpc_duration_seconds_count{" << methodLabel << "} "
+            << histogram.count << '\n';
+    }
+
+    writeHeader(out, "bentobox_rpcs_in_flight", "gauge",
+                "Number of RPCs being handled, including those waiting for "
+                "a simulation's lock.");
+    out << "bentobox_rpcs_in_flight " << rpcsInFlight << '\n';
+
+    writeHeader(out, "bentobox_eval_queue_depth", "gauge",
+                "Number of requests for help with evaluating graph outputs "
+                "waiting for an eval thread.");
+    out << "bentobox_eval_queue_depth " << evalQueueDepth << '\n';
+
+    writeHeader(out, "bentobox_node_evaluations_total", "counter",
+                "Number of graph nodes evaluated.");
+    out << "bentobox_node_evaluations_total " << nodeEvaluations << '\n';
+
+    writeHeader(out, "bentobox_simulation_steps_total", "counter",
+                "Number of steps run successfully by each simulation.");
+    for (const auto& [simName, steps] : simSteps) {
+        out << "bentobox_simulation_steps_total{" << formatLabel("sim", simName)
+            << "} " << steps << '\n';
+    }
+
+    writeHeader(out, "bentobox_simulations", "gauge",
+                "Number of applied simulations.");
+    out << "bentobox_simulations " << sims.size() << '\n';
+
+    writeHeader(out, "bentobox_simulation_entities", "gauge",
+                "Number of entities in each simulation.");
+    for (const auto& sim : sims) {
+        out << "bentobox_simulation_entities{" << formatLabel("sim", sim.name)
+            << "} " << sim.entityCount << '\n';
+    }
+
+    writeHeader(out, "bentobox_simulation_components", "gauge",
+                "Number of components in each simulation.");
+    for (const auto& sim : sims) {
+        out << "bentobox_simulation_components{"
+            << formatLabel("sim", sim.name) << "} " << sim.componentCount
+            << '\n';
+    }
+}
+
+}  // namespace service
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include <service/metrics.h>
+
+#include <sstream>
+
+#define TEST_SUITE Metrics
+
+using namespace service;
+
+TEST(TEST_SUITE, HistogramBuckets) {
+    Metrics::Histogram histogram;
+    // Bounds are inclusive
+    histogram.observe(0.0001);
+    histogram.observe(0.0002);
+    histogram.observe(100);
+
+    ASSERT_EQ(histogram.count, 3);
+    ASSERT_DOUBLE_EQ(histogram.sum, 100.0003);
+    ASSERT_EQ(histogram.bucketCounts[0], 1);
+    ASSERT_EQ(histogram.bucketCounts[1], 1);
+    ASSERT_EQ(histogram.bucketCounts.back(), 1);
+}
+
+TEST(TEST_SUITE, Write) {
+    Metrics metrics;
+    { Metrics::RpcTimer timer(metrics, "StepSimulation"); }
+    metrics.addStep("sim");
+    metrics.addStep("sim");
+    metrics.addStep("dropped");
+    metrics.dropSimulation("dropped");
+    metrics.addNodeEvaluations(42);
+
+    std::ostringstream out;
+    metrics.write(out, {{"sim", 3, 6}, {"a \"quoted\" name", 0, 0}}, 5);
+    auto text = out.str();
+    for (const char* line :
+         {"# TYPE bentobox_rpc_duration_seconds histogram\n",
+          "bentobox_rpc_duration_seconds_bucket{method=\"StepSimulation\","
+          "le=\"+Inf\"} 1\n",
+          "bentobox_rpc_duration_seconds_count{method=\"StepSimulation\"} 1\n",
+          "bentobox_rpcs_in_flight 0\n",
+          "bentobox_eval_queue_depth 5\n",
+          "bentobox_node_evaluations_total 42\n",
+          "bentobox_simulation_steps_total{sim=\"sim\"} 2\n",
+          "bentobox_simulations 2\n",
+          "bentobox_simulation_entities{sim=\"sim\"} 3\n",
+          "bentobox_simulation_components{sim=\"sim\"} 6\n",
+          "bentobox_simulation_entities{sim=\"a \\\"quoted\\\" name\"} 0\n"}) {
+        ASSERT_NE(text.find(line), std::string::npos) << line;
+    }
+    ASSERT_EQ(text.find("dropped"), std::string::npos);
+}
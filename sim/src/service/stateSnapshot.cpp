@@ -0,0 +1,145 @@
+#include <service/stateSnapshot.h>
+#include <core/ics/util/memoryUsage.h>
+#include <ics.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace service {
+namespace {
+bool hasComponent(const ics::index::IndexStore& indexStore,
+                  ics::index::EntityIndex::EntityId entityId,
+                  ics::CompGroup group) {
+    if (!indexStore.entity.hasEntity(entityId)) {
+        return false;
+    }
+    if (indexStore.useArchetypes) {
+        return indexStore.archetype.hasComponent(entityId, group);
+    }
+    auto compStoreIds = indexStore.entity.getComponents(entityId);
+    return std::ranges::any_of(compStoreIds, [group](const auto& compStoreId) {
+        return compStoreId.first == group;
+    });
+}
+}  // namespace
+
+size_t StateSnapshot::KeyHash::operator()(const Key& key) const {
+    return std::hash<uint64_t>()((uint64_t(key.group) << 32) | key.entityId);
+}
+
+size_t StateSnapshot::ComponentValues::getMemoryUsage() const {
+    return util::getMemoryUsage(values);
+}
+
+void StateSnapshot::addComponentType(const ics::index::IndexStore& indexStore,
+                                     ics::CompGroup group) {
+    if (group >= knownGroups.size()) {
+        knownGroups.resize(group + 1, false);
+    }
+    auto layout = indexStore.attribute.getSharedLayout(group);
+    const auto& name = layout->getCompDef().name();
+    componentTypes[name] = ComponentType{group, layout};
+    knownGroups[group] = true;
+}
+
+StateSnapshot::ComponentValues& StateSnapshot::getComponent(
+    const ics::index::IndexStore& indexStore,
+    ics::index::EntityIndex::EntityId entityId, ics::CompGroup group) {
+    if (group >= knownGroups.size() || !knownGroups[group]) {
+        addComponentType(indexStore, group);
+    }
+    auto& component = components[Key{entityId, group}];
+    component.values.resize(indexStore.attribute.getLayout(group).size());
+    component.update = updateCount;
+    return component;
+}
+
+void StateSnapshot::update(ics::index::IndexStore& indexStore,
+                           ics::ComponentStore& compStore, uint64_t step) {
+    this->step = step;
+    updateCount++;
+    for (auto entityId : indexStore.entity.getEntityIds()) {
+        if (indexStore.useArchetypes) {
+            for (auto group : indexStore.archetype.getSignature(entityId)) {
+                auto& component = getComponent(indexStore, entityId, group);
+                for (ics::component::AttrId attrId = 0;
+                     attrId < component.values.size(); attrId++) {
+                    component.values[attrId] =
+                        indexStore.archetype.getStoredValue(entityId, group,
+                                                            attrId);
+                }
+            }
+            continue;
+        }
+
+        for (const auto& compStoreId :
+             indexStore.entity.getComponents(entityId)) {
+            auto& component =
+                getComponent(indexStore, entityId, compStoreId.first);
+            // Assigning the values reuses the memory of the values copied
+            // before
+            component.values =
+                ics::getComponent<ics::component::UserComponent>(compStore,
+                                                                 compStoreId)
+                    .getValues();
+        }
+    }
+
+    // Components which were not copied have been removed since
+    std::erase_if(components, [this](const auto& entry) {
+        return entry.second.update != updateCount;
+    });
+}
+
+void StateSnapshot::update(ics::index::IndexStore& indexStore,
+                           ics::ComponentStore& compStore,
+                           const ics::index::VersionIndex::Changes& changes,
+                           uint64_t step) {
+    this->step = step;
+    updateCount++;
+    // The changes are only listed, so the values are read from the current
+    // state, which also tells whether a component removed was added again
+    for (const auto& [entityId, group] : changes.removedComponents) {
+        if (!hasComponent(indexStore, entityId, group)) {
+            components.erase(Key{entityId, group});
+        }
+    }
+    for (const auto& refIds : changes.attributes) {
+        auto value = ics::findAttribute(indexStore, compStore, refIds);
+        if (value != nullptr) {
+            getComponent(indexStore, refIds.entityId, refIds.group)
+                .values[refIds.attrId] = *value;
+        }
+    }
+}
+
+const bento::protos::Value* StateSnapshot::find(
+    const bento::protos::AttributeRef& ref) const {
+    auto type = componentTypes.find(ref.component());
+    if (type == componentTypes.end()) {
+        return nullptr;
+    }
+    const auto& layout = *type->second.layout;
+    if (!layout.hasAttr(ref.attribute())) {
+        return nullptr;
+    }
+
+    auto it = components.find(Key{ref.entity_id(), type->second.group});
+    if (it == components.end()) {
+        return nullptr;
+    }
+    const auto& value = it->second.values[layout.getAttrId(ref.attribute())];
+    if (value.kind_case() == bento::protos::Value::KIND_NOT_SET) {
+        throw std::runtime_error(
+            "Attempting to retrieve primitive value which has not been set");
+    }
+    return &value;
+}
+
+size_t StateSnapshot::getMemoryUsage() const {
+    // The layouts are shared with the simulation, so they are not counted
+    return util::getMemoryUsage(components) +
+           util::getMemoryUsage(componentTypes) + knownGroups.capacity() / 8;
+}
+
+}  // namespace service
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include <service/stateSnapshot.h>
+#include <simulation.h>
+#include <test_simulation.h>
+
+#define TEST_SUITE StateSnapshot
+
+using namespace service;
+
+TEST(TEST_SUITE, CopiesState) {
+    auto testSim = test_simulation::TestSimulation();
+    Simulation sim(testSim.simDef);
+    auto heightRef = interpreter::createAttrRef(
+        test_simulation::TEST_COMPONENT_NAME, 1, "height");
+    bento::protos::Value height;
+    height.mutable_primitive()->set_int_64(5);
+    height.mutable_data_type()->set_primitive(
+        bento::protos::Type_Primitive_INT64);
+    ics::setAttribute(sim.indexStore, sim.compStore, heightRef, height);
+
+    StateSnapshot snapshot;
+    auto emptyBytes = snapshot.getMemoryUsage();
+    snapshot.update(sim.indexStore, sim.compStore, 3);
+    ASSERT_EQ(snapshot.getStep(), 3);
+    ASSERT_GT(snapshot.getMemoryUsage(), emptyBytes);
+    ASSERT_EQ(snapshot.find(heightRef)->primitive().int_64(), 5);
+
+    // Later writes are not seen until the snapshot is updated
+    height.mutable_primitive()->set_int_64(6);
+    ics::setAttribute(sim.indexStore, sim.compStore, heightRef, height);
+    ASSERT_EQ(snapshot.find(heightRef)->primitive().int_64(), 5);
+    snapshot.update(sim.indexStore, sim.compStore, 4);
+    ASSERT_EQ(snapshot.find(heightRef)->primitive().int_64(), 6);
+
+    ASSERT_EQ(snapshot.find(interpreter::createAttrRef(
+                  test_simulation::TEST_COMPONENT_NAME, 2, "height")),
+              nullptr);
+    ASSERT_EQ(snapshot.find(interpreter::createAttrRef(
+                  test_simulation::TEST_COMPONENT_NAME, 1, "depth")),
+              nullptr);
+    ASSERT_EQ(snapshot.find(interpreter::createAttrRef("Unknown", 1, "x")),
+              nullptr);
+}
+
+TEST(TEST_SUITE, UnsetAttributesThrow) {
+    auto testSim = test_simulation::TestSimulation();
+    Simulation sim(testSim.simDef);
+    auto entityId = sim.indexStore.entity.addEntityId();
+    auto group = sim.indexStore.componentType.getComponentType(
+        test_simulation::TEST_COMPONENT_NAME);
+    ics::addEntities(sim.indexStore, sim.compStore, std::vector{entityId},
+                     {group});
+
+    StateSnapshot snapshot;
+    snapshot.update(sim.indexStore, sim.compStore, 0);
+    auto heightRef = interpreter::createAttrRef(
+        test_simulation::TEST_COMPONENT_NAME, entityId, "height");
+    ASSERT_THROW(snapshot.find(heightRef), std::runtime_error);
+}
+
+TEST(TEST_SUITE, ForgetsRemovedComponents) {
+    auto testSim = test_simulation::TestSimulation();
+    Simulation sim(testSim.simDef);
+    auto heightRef = interpreter::createAttrRef(
+        test_simulation::TEST_COMPONENT_NAME, 1, "height");
+    bento::protos::Value height;
+    height.mutable_primitive()->set_int_64(5);
+    height.mutable_data_type()->set_primitive(
+        bento::protos::Type_Primitive_INT64);
+    ics::setAttribute(sim.indexStore, sim.compStore, heightRef, height);
+    StateSnapshot snapshot;
+    snapshot.update(sim.indexStore, sim.compStore, 0);
+    ASSERT_NE(snapshot.find(heightRef), nullptr);
+
+    ics::removeEntity(sim.indexStore, sim.compStore, 1);
+    snapshot.update(sim.indexStore, sim.compStore, 1);
+    ASSERT_EQ(snapshot.find(heightRef), nullptr);
+}
+
+TEST(TEST_SUITE, UpdatesWithChanges) {
+    auto testSim = test_simulation::TestSimulation();
+    Simulation sim(testSim.simDef);
+    auto heightRef = interpreter::createAttrRef(
+        test_simulation::TEST_COMPONENT_NAME, 1, "height");
+    bento::protos::Value height;
+    height.mutable_primitive()->set_int_64(5);
+    height.mutable_data_type()->set_primitive(
+        bento::protos::Type_Primitive_INT64);
+    ics::setAttribute(sim.indexStore, sim.compStore, heightRef, height);
+
+    StateSnapshot snapshot;
+    snapshot.update(sim.indexStore, sim.compStore, 0);
+    sim.indexStore.version.trackChanges(true);
+    height.mutable_primitive()->set_int_64(6);
+    ics::setAttribute(sim.indexStore, sim.compStore, heightRef, height);
+    // A new entity, whose height is set, and a removed one
+    auto entityId = sim.indexStore.entity.addEntityId();
+    auto group = sim.indexStore.componentType.getComponentType(
+        test_simulation::TEST_COMPONENT_NAME);
+    ics::addEntities(sim.indexStore, sim.compStore, std::vector{entityId},
+                     {group});
+    auto newHeightRef = interpreter::createAttrRef(
+        test_simulation::TEST_COMPONENT_NAME, entityId, "height");
+    ics::setAttribute(sim.indexStore, sim.compStore, newHeightRef, height);
+    auto removedId = sim.indexStore.entity.addEntityId();
+    ics::addEntities(sim.indexStore, sim.compStore, std::vector{removedId},
+                     {group});
+    ics::removeEntity(sim.indexStore, sim.compStore, removedId);
+
+    snapshot.update(sim.indexStore, sim.compStore,
+                    sim.indexStore.version.takeChanges(), 1);
+    ASSERT_EQ(snapshot.getStep(), 1);
+    ASSERT_EQ(snapshot.find(heightRef)->primitive().int_64(), 6);
+    ASSERT_EQ(snapshot.find(newHeightRef)->primitive().int_64(), 6);
+    ASSERT_EQ(snapshot.find(interpreter::createAttrRef(
+                  test_simulation::TEST_COMPONENT_NAME, removedId, "height")),
+              nullptr);
+}
@@ -0,0 +1,133 @@
+#include <service/stateWatcher.h>
+#include <ics.h>
+
+#include <stdexcept>
+
+namespace service {
+namespace {
+void addValue(bento::protos::WatchSimulationResp& message,
+              const ics::component::ComponentLayout& layout,
+              ics::index::EntityIndex::EntityId entityId,
+              ics::component::AttrId attrId,
+              const bento::protos::Value& value) {
+    auto attribute = message.add_attributes();
+    auto ref = attribute->mutable_attribute();
+    ref->set_entity_id(entityId);
+    ref->set_component(layout.getCompDef().name());
+    ref->set_attribute(layout.getAttrName(attrId));
+    attribute->mutable_value()->CopyFrom(value);
+}
+}  // namespace
+
+StateWatcher::StateWatcher(uint32_t keyframeInterval)
+    : keyframeInterval(keyframeInterval) {}
+
+bool StateWatcher::needsKeyframe() const {
+    return keyframeNeeded || changesSinceKeyframe >= keyframeInterval;
+}
+
+void StateWatcher::push(Message message) {
+    std::lock_guard lock(mutex);
+    if (message->keyframe()) {
+        queue.clear();
+        keyframeNeeded = false;
+        changesSinceKeyframe = 0;
+    } else if (queue.size() >= MAX_QUEUED) {
+        // The changes cannot be applied without those dropped, so nothing is
+        // sent until the next keyframe
+        queue.clear();
+        keyframeNeeded = true;
+        return;
+    } else {
+        changesSinceKeyframe++;
+    }
+    queue.push_back(std::move(message));
+    queued.notify_one();
+}
+
+StateWatcher::Message StateWatcher::pop(std::chrono::milliseconds timeout) {
+    std::unique_lock lock(mutex);
+    queued.wait_for(lock, timeout,
+                    [this]() { return closed || !queue.empty(); });
+    if (closed || queue.empty()) {
+        return nullptr;
+    }
+    auto message = std::move(queue.front());
+    queue.pop_front();
+    return message;
+}
+
+void StateWatcher::close() {
+    std::lock_guard lock(mutex);
+    closed = true;
+    queue.clear();
+    queued.notify_all();
+}
+
+bool StateWatcher::isClosed() {
+    std::lock_guard lock(mutex);
+    return closed;
+}
+
+void fillKeyframe(ics::index::IndexStore& indexStore,
+                  ics::ComponentStore& compStore,
+                  bento::protos::WatchSimulationResp& message) {
+    message.set_keyframe(true);
+    for (auto entityId : indexStore.entity.getEntityIds()) {
+        if (indexStore.useArchetypes) {
+            for (auto group : indexStore.archetype.getSignature(entityId)) {
+                const auto& layout = indexStore.attribute.getLayout(group);
+                for (ics::component::AttrId attrId = 0;
+                     attrId < layout.size(); attrId++) {
+                    addValue(message, layout, entityId, attrId,
+                             indexStore.archetype.getValue(entityId, group,
+                                                           attrId));
+                }
+            }
+            continue;
+        }
+
+        // Read the values of each component at once, rather than looking up
+        // the component for every attribute
+        for (const auto& compStoreId :
+             indexStore.entity.getComponents(entityId)) {
+            auto& component =
+                ics::getComponent<ics::component::UserComponent>(
+                    compStore, compStoreId);
+            const auto& layout = *component.getLayout();
+            const auto& values = component.getValues();
+            for (ics::component::AttrId attrId = 0; attrId < values.size();
+                 attrId++) {
+                addValue(message, layout, entityId, attrId, values[attrId]);
+            }
+        }
+    }
+}
+
+void fillChanges(ics::index::IndexStore& indexStore,
+                 ics::ComponentStore& compStore,
+                 const ics::index::VersionIndex::Changes& changes,
+                 bento::protos::WatchSimulationResp& message) {
+    for (const auto& [entityId, group] : changes.removedComponents) {
+        auto removed = message.add_removed_components();
+        removed->set_entity_id(entityId);
+        removed->set_component(
+            indexStore.attribute.getLayout(group).getCompDef().name());
+    }
+
+    for (const auto& refIds : changes.attributes) {
+        // The component may have been removed after the attribute changed
+        if (!indexStore.entity.hasEntity(refIds.entityId)) {
+            continue;
+        }
+        try {
+            const auto& value =
+                ics::getAttribute(indexStore, compStore, refIds);
+            addValue(message, indexStore.attribute.getLayout(refIds.group),
+                     refIds.entityId, refIds.attrId, value);
+        } catch (const std::runtime_error&) {
+        }
+    }
+}
+
+}  // namespace service
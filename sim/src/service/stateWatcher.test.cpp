@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include <service/stateWatcher.h>
+
+#include <memory>
+
+#define TEST_SUITE StateWatcher
+
+using namespace service;
+using bento::protos::WatchSimulationResp;
+
+namespace {
+StateWatcher::Message createMessage(uint64_t step, bool keyframe) {
+    auto message = std::make_shared<WatchSimulationResp>();
+    message->set_step(step);
+    message->set_keyframe(keyframe);
+    return message;
+}
+}  // namespace
+
+TEST(TEST_SUITE, SendsKeyframesAtInterval) {
+    StateWatcher watcher(2);
+    ASSERT_TRUE(watcher.needsKeyframe());
+    watcher.push(createMessage(0, true));
+    ASSERT_FALSE(watcher.needsKeyframe());
+    watcher.push(createMessage(1, false));
+    watcher.push(createMessage(2, false));
+    ASSERT_TRUE(watcher.needsKeyframe());
+
+    for (uint64_t step = 0; step < 3; step++) {
+        auto message = watcher.pop(std::chrono::milliseconds(0));
+        ASSERT_NE(message, nullptr);
+        ASSERT_EQ(message->step(), step);
+    }
+    ASSERT_EQ(watcher.pop(std::chrono::milliseconds(0)), nullptr);
+}
+
+TEST(TEST_SUITE, DropsChangesWhenBehind) {
+    StateWatcher watcher(StateWatcher::MAX_QUEUED * 2);
+    watcher.push(createMessage(0, true));
+    for (uint64_t step = 1; step <= StateWatcher::MAX_QUEUED; step++) {
+        watcher.push(createMessage(step, false));
+    }
+    ASSERT_TRUE(watcher.needsKeyframe());
+    ASSERT_EQ(watcher.pop(std::chrono::milliseconds(0)), nullptr);
+
+    // The keyframe catches the watcher up
+    watcher.push(createMessage(100, true));
+    ASSERT_EQ(watcher.pop(std::chrono::milliseconds(0))->step(), 100);
+}
+
+TEST(TEST_SUITE, CloseEndsStream) {
+    StateWatcher watcher;
+    watcher.push(createMessage(0, true));
+    watcher.close();
+    ASSERT_TRUE(watcher.isClosed());
+    ASSERT_EQ(watcher.pop(std::chrono::milliseconds(0)), nullptr);
+}
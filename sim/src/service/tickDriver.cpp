@@ -0,0 +1,60 @@
+#include <service/tickDriver.h>
+
+#include <exception>
+
+namespace service {
+
+TickDriver::TickDriver(Clock::duration period, std::function<void()> tick)
+    : period(period), tick(std::move(tick)) {
+    thread = std::jthread(
+        [this](std::stop_token stopToken) { this->run(stopToken); });
+}
+
+void TickDriver::run(std::stop_token stopToken) {
+    std::mutex sleepMutex;
+    std::condition_variable_any wake;
+    auto deadline = Clock::now();
+    while (!stopToken.stop_requested()) {
+        if (period > Clock::duration::zero()) {
+            auto now = Clock::now();
+            if (now < deadline) {
+                // Sleep until the next tick is due, or ticking is stopped
+                std::unique_lock lock(sleepMutex);
+                wake.wait_until(lock, stopToken, deadline,
+                                []() { return false; });
+                continue;
+            }
+            uint64_t missed = (now - deadline) / period;
+            if (missed > MAX_CATCH_UP_TICKS) {
+                skippedTicks += missed;
+                deadline += missed * period;
+            }
+        }
+
+        try {
+            tick();
+        } catch (const std::exception& e) {
+            std::lock_guard lock(errorMutex);
+            error = e.what();
+            break;
+        }
+        tickCount++;
+        deadline += period;
+    }
+    running = false;
+}
+
+void TickDriver::stop() {
+    if (thread.joinable()) {
+        thread.request_stop();
+        thread.join();
+    }
+    running = false;
+}
+
+std::string TickDriver::getError() {
+    std::lock_guard lock(errorMutex);
+    return error;
+}
+
+}  // namespace service
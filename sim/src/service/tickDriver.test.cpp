@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <service/tickDriver.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+#define TEST_SUITE TickDriver
+
+using namespace service;
+using namespace std::chrono_literals;
+
+TEST(TEST_SUITE, TicksUntilStopped) {
+    std::atomic<int> ticks = 0;
+    TickDriver driver(TickDriver::Clock::duration::zero(),
+                      [&ticks]() { ticks++; });
+    while (ticks < 10) {
+        std::this_thread::yield();
+    }
+    driver.stop();
+    ASSERT_FALSE(driver.isRunning());
+    ASSERT_EQ(driver.getTickCount(), ticks);
+
+    // No more ticks are run once stopped
+    auto stoppedTicks = ticks.load();
+    std::this_thread::sleep_for(10ms);
+    ASSERT_EQ(ticks, stoppedTicks);
+}
+
+TEST(TEST_SUITE, TicksAtRate) {
+    std::atomic<int> ticks = 0;
+    TickDriver driver(20ms, [&ticks]() { ticks++; });
+    std::this_thread::sleep_for(100ms);
+    driver.stop();
+    // The first tick runs right away
+    ASSERT_GE(ticks, 2);
+    ASSERT_LE(ticks, 7);
+}
+
+TEST(TEST_SUITE, SkipsTicksTooFarBehind) {
+    std::atomic<int> ticks = 0;
+    TickDriver driver(1ms, [&ticks]() {
+        // Fall behind by much more than can be caught up
+        if (ticks++ == 0) {
+            std::this_thread::sleep_for(50ms);
+        }
+    });
+    while (ticks < 2) {
+        std::this_thread::yield();
+    }
+    driver.stop();
+    ASSERT_GT(driver.getSkippedTicks(), TickDriver::MAX_CATCH_UP_TICKS);
+}
+
+TEST(TEST_SUITE, StopsOnError) {
+    TickDriver driver(TickDriver::Clock::duration::zero(), []() {
+        throw std::runtime_error("failed");
+    });
+    while (driver.isRunning()) {
+        std::this_thread::yield();
+    }
+    ASSERT_EQ(driver.getTickCount(), 0);
+    ASSERT_EQ(driver.getError(), "failed");
+}
@@ -0,0 +1,137 @@
+#include <service/tracer.h>
+
+#include <cstdio>
+
+namespace service {
+namespace {
+void writeJsonString(std::ostream& out, const std::string& str) {
+    out << '"';
+    for (char c : str) {
+        switch (c) {
+            case '"':
+                out << "\\\"";
+                break;
+            case '\\':
+                out << "\\\\";
+                break;
+            case '\n':
+                out << "\\n";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out << escaped;
+                } else {
+                    out << c;
+                }
+        }
+    }
+    out << '"';
+}
+
+// Trace event times are in microseconds
+void writeMicroseconds(std::ostream& out, Tracer::Clock::duration duration) {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration);
+    char us[32];
+    std::snprintf(us, sizeof(us), "%.3f", ns.count() / 1000.0);
+    out << us;
+}
+}  // namespace
+
+Tracer::Scope::Scope(Tracer& tracer, const char* name) {
+    if (!tracer.isEnabled()) {
+        return;
+    }
+    this->tracer = &tracer;
+    span.name = name;
+    span.threadId = getThreadId();
+    span.start = Clock::now();
+}
+
+Tracer::Scope::~Scope() {
+    if (tracer == nullptr) {
+        return;
+    }
+    span.duration = Clock::now() - span.start;
+    tracer->add(std::move(span));
+}
+
+void Tracer::Scope::addArg(const char* key, std::string_view value) {
+    if (tracer != nullptr) {
+        span.args.emplace_back(key, value);
+    }
+}
+
+void Tracer::Scope::addArg(const char* key, uint64_t value) {
+    if (tracer != nullptr) {
+        span.args.emplace_back(key, std::to_string(value));
+    }
+}
+
+void Tracer::add(Span span) {
+    std::lock_guard lock(mutex);
+    // Tracing may have been stopped while the span was open
+    if (!isEnabled()) {
+        return;
+    }
+    if (trace.spans.size() >= maxSpans) {
+        trace.droppedCount++;
+        return;
+    }
+    trace.spans.push_back(std::move(span));
+}
+
+void Tracer::start(size_t maxSpans) {
+    std::lock_guard lock(mutex);
+    trace = Trace{Clock::now(), {}, 0};
+    this->maxSpans = maxSpans;
+    enabled = true;
+}
+
+Tracer::Trace Tracer::stop() {
+    std::lock_guard lock(mutex);
+    enabled = false;
+    return std::exchange(trace, Trace{});
+}
+
+uint32_t Tracer::getThreadId() {
+    static std::atomic<uint32_t> nextThreadId = 1;
+    thread_local uint32_t threadId = nextThreadId++;
+    return threadId;
+}
+
+void writeChromeTrace(std::ostream& out, const Tracer::Trace& trace) {
+    out << "{\"traceEvents\":[";
+    for (size_t i = 0; i < trace.spans.size(); i++) {
+        const auto& span = trace.spans[i];
+        if (i > 0) {
+            out << ',';
+        }
+        // Complete events ("X") hold both the start and the duration
+        out << "\n{\"name\":";
+        writeJsonString(out, span.name);
+        out << ",\"cat\":\"bentobox\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+            << span.threadId << ",\"ts\":";
+        writeMicroseconds(out, span.start - trace.origin);
+        out << ",\"dur\":";
+        writeMicroseconds(out, span.duration);
+        if (!span.args.empty()) {
+            out << ",\"args\":{";
+            for (size_t j = 0; j < span.args.size(); j++) {
+                if (j > 0) {
+                    out << ',';
+                }
+                writeJsonString(out, span.args[j].first);
+                out << ':';
+                writeJsonString(out, span.args[j].second);
+            }
+            out << '}';
+        }
+        out << '}';
+    }
+    out << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_spans\":"
+        << trace.droppedCount << "}}\n";
+}
+
+}  // namespace service
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <service/tracer.h>
+
+#include <sstream>
+#include <thread>
+
+#define TEST_SUITE Tracer
+
+using namespace service;
+
+TEST(TEST_SUITE, RecordsOnlyWhileStarted) {
+    Tracer tracer;
+    { Tracer::Scope span(tracer, "before"); }
+
+    tracer.start();
+    {
+        Tracer::Scope outer(tracer, "outer");
+        outer.addArg("sim", "test");
+        outer.addArg("step", uint64_t{3});
+        Tracer::Scope inner(tracer, "inner");
+    }
+    auto trace = tracer.stop();
+
+    { Tracer::Scope span(tracer, "after"); }
+    ASSERT_FALSE(tracer.isEnabled());
+    ASSERT_TRUE(tracer.stop().spans.empty());
+
+    // Spans are recorded when they end
+    ASSERT_EQ(trace.spans.size(), 2);
+    const auto& inner = trace.spans[0];
+    const auto& outer = trace.spans[1];
+    ASSERT_EQ(inner.name, "inner");
+    ASSERT_EQ(outer.name, "outer");
+    ASSERT_EQ(outer.args.size(), 2);
+    ASSERT_EQ(outer.args[0].second, "test");
+    ASSERT_EQ(outer.args[1].second, "3");
+    ASSERT_GE(inner.start, outer.start);
+    ASSERT_LE(inner.start + inner.duration, outer.start + outer.duration);
+    ASSERT_EQ(inner.threadId, Tracer::getThreadId());
+}
+
+TEST(TEST_SUITE, DropsSpansPastLimit) {
+    Tracer tracer;
+    tracer.start(2);
+    for (int i = 0; i < 5; i++) {
+        Tracer::Scope span(tracer, "span");
+    }
+    auto trace = tracer.stop();
+    ASSERT_EQ(trace.spans.size(), 2);
+    ASSERT_EQ(trace.droppedCount, 3);
+}
+
+TEST(TEST_SUITE, ThreadIdsDiffer) {
+    Tracer tracer;
+    tracer.start();
+    std::thread thread([&tracer]() { Tracer::Scope span(tracer, "thread"); });
+    thread.join();
+    { Tracer::Scope span(tracer, "main"); }
+    auto trace = tracer.stop();
+
+    ASSERT_EQ(trace.spans.size(), 2);
+    ASSERT_NE(trace.spans[0].threadId, trace.spans[1].threadId);
+}
+
+TEST(TEST_SUITE, WriteChromeTrace) {
+    Tracer::Trace trace;
+    Tracer::Span span;
+    span.name = "runGraph";
+    span.args.emplace_back("sim", "a \"quoted\" name");
+    span.threadId = 3;
+    span.start = trace.origin + std::chrono::microseconds(1500);
+    span.duration = std::chrono::nanoseconds(2500);
+    trace.spans.push_back(span);
+
+    std::ostringstream out;
+    writeChromeTrace(out, trace);
+    ASSERT_EQ(out.str(),
+              "{\"traceEvents\":[\n"
+              "{\"name\":\"runGraph\",\"cat\":\"bentobox\",\"ph\":\"X\","
+              "\"pid\":1,\"tid\":3,\"ts\":1500.000,\"dur\":2.500,"
+              "\"args\":{\"sim\":\"a \\\"quoted\\\" name\"}}\n"
+              "],\"displayTimeUnit\":\"ns\","
+              "\"otherData\":{\"dropped_spans\":0}}\n");
+}
@@ -0,0 +1,68 @@
+#include <simulation.h>
+
+Simulation::MemoryUsage Simulation::getMemoryUsage() const {
+    MemoryUsage usage;
+
+    // Only one of the storages holds components, the other is empty
+    usage.componentBytes = indexStore.archetype.getMemoryUsage() +
+                           compStore.bucket_count() * sizeof(void*);
+    for (const auto& [group, compVec] : compStore) {
+        usage.componentBytes +=
+            sizeof(*compVec) +
+            ics::getCompVec<ics::component::UserComponent>(compStore, group)
+                .getMemoryUsage();
+    }
+
+    usage.indexBytes = indexStore.componentType.getMemoryUsage() +
+                       indexStore.attribute.getMemoryUsage() +
+                       indexStore.entity.getMemoryUsage() +
+                       indexStore.signature.getMemoryUsage() +
+                       indexStore.version.getMemoryUsage();
+
+    // The graphs are allocated separately from simDef, so the size of the
+    // messages is counted as well
+    if (simDef.has_init_graph()) {
+        usage.graphBytes = simDef.init_graph().SpaceUsedLong();
+    }
+    for (const auto& system : simDef.systems()) {
+        usage.graphBytes += system.SpaceUsedLong();
+    }
+    usage.schemaBytes = util::getMemoryUsage(simDef) - usage.graphBytes;
+    for (const auto& compDef : simDef.components()) {
+        const auto& compTypeIndex = indexStore.componentType;
+        if (compTypeIndex.hasComponentType(compDef.name())) {
+            usage.schemaBytes +=
+                indexStore.attribute
+                    .getLayout(compTypeIndex.getComponentType(compDef.name()))
+                    .getMemoryUsage();
+        }
+    }
+
+    usage.otherBytes = util::getMemoryUsage(stepArenaBlock) +
+                       outputCache.getMemoryUsage() +
+                       parallelPlan.getMemoryUsage();
+    // Each snapshot is a copy of the state of a step
+    for (const auto& snapshot : {frontSnapshot, backSnapshot}) {
+        if (snapshot != nullptr) {
+            usage.otherBytes +=
+                sizeof(service::StateSnapshot) + snapshot->getMemoryUsage();
+        }
+    }
+    return usage;
+}
+
+void Simulation::publishCounts() {
+    publishedEntityCount.store(indexStore.entity.getEntityIds().size(),
+                               std::memory_order_relaxed);
+    publishedComponentCount.store(getComponentCount(),
+                                  std::memory_order_relaxed);
+}
+
+size_t Simulation::getComponentCount() const {
+    // Only one of the storages holds components, the other is empty
+    auto count = indexStore.archetype.getComponentCount();
+    for (const auto& [group, compVec] : compStore) {
+        count += compVec->size();
+    }
+    return count;
+}
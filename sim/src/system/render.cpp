@@ -1,6 +1,5 @@
 #include <component/textureComponent.h>
 #include <core/ics/componentStore.h>
-#include <core/ics/util/composable.h>
 #include <system/render.h>
 
 #include <iostream>
@@ -10,13 +9,12 @@ void render(GraphicsContext &graphicsContext,
             ics::ComponentStore &componentStore,
             ics::index::IndexStore &indexStore) {
     auto &componentType = indexStore.componentType;
-    auto components =
-        util::Composable<ComponentStore &>(componentStore) | ics::asCompSet |
-        componentType.filterCompType(ics::component::TEXTURE2D_COMPONENT_NAME);
+    auto textureGroup = componentType.getComponentType(
+        ics::component::TEXTURE2D_COMPONENT_NAME);
 
-    for (auto componentId : components.data) {
-        auto component = ics::getComponent<ics::component::Texture2DComponent>(
-            componentStore, componentId);
+    for (auto [componentId, component] :
+         ics::viewComponents<ics::component::Texture2DComponent>(
+             componentStore, textureGroup)) {
         // TODO(joeltio): Use the graphics context to render the texture
     }
 }
@@ -8,13 +8,13 @@ TestComponent::TestComponent(int width, int height)
     widthVal.mutable_primitive()->set_int_64(width);
     widthVal.mutable_data_type()->set_primitive(
         bento::protos::Type_Primitive_INT64);
-    setValue("width", widthVal);
+    setValue(WIDTH, widthVal);
 
     auto heightVal = bento::protos::Value();
     heightVal.mutable_primitive()->set_int_64(height);
     heightVal.mutable_data_type()->set_primitive(
         bento::protos::Type_Primitive_INT64);
-    setValue("height", heightVal);
+    setValue(HEIGHT, heightVal);
 }
 
 bento::protos::SystemDef cycle100System(
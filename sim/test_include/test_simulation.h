@@ -23,6 +23,10 @@ bento::protos::ComponentDef createCompDef() {
 }  // namespace
 
 struct TestComponent : public ics::component::UserComponent {
+    // AttrIds of the attributes, which the layout assigns in name order
+    static constexpr ics::component::AttrId HEIGHT = 0;
+    static constexpr ics::component::AttrId WIDTH = 1;
+
     TestComponent() : UserComponent(TEST_COMPONENT_NAME, createCompDef()){};
     TestComponent(int width, int height);
 };